@@ -0,0 +1,179 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string_view>
+
+namespace benchmarks {
+
+namespace {
+
+constexpr uint32_t DEFAULT_REPETITIONS = 10;
+constexpr std::chrono::milliseconds DEFAULT_WARMUP_TIME(100);
+constexpr std::chrono::milliseconds DEFAULT_MINIMUM_SAMPLE_TIME(20);
+
+bool parseFlag(
+	std::string_view argument, std::string_view flag, std::string_view& value
+) {
+	if (!argument.starts_with(flag) || argument.size() <= flag.size() ||
+		argument[flag.size()] != '=')
+		return false;
+	value = argument.substr(flag.size() + 1);
+	return true;
+}
+
+uint32_t parseNumber(std::string_view value, uint32_t fallback) {
+	uint32_t result;
+	const auto [end, error] =
+		std::from_chars(value.data(), value.data() + value.size(), result);
+	if (error != std::errc() || end != value.data() + value.size()) {
+		std::cerr << "Expected a number but got " << value << std::endl;
+		return fallback;
+	}
+	return result;
+}
+
+// Benchmark names are plain ASCII, but quotes and backslashes still need
+// escaping to keep the output valid.
+void writeJsonString(std::ostream& stream, std::string_view string) {
+	stream << '"';
+	for (char character : string) {
+		if (character == '"' || character == '\\') stream << '\\';
+		stream << character;
+	}
+	stream << '"';
+}
+
+void printResult(const Result& result) {
+	const Statistics& statistics = result.nanosecondsPerIteration;
+	const double relativeDeviation =
+		statistics.mean > 0
+			? 100.0 * statistics.standardDeviation / statistics.mean
+			: 0.0;
+	std::cout << std::left << std::setw(56) << result.name << std::right
+			  << std::fixed << std::setprecision(2) << std::setw(14)
+			  << statistics.median << " ns/iter" << std::setw(12)
+			  << statistics.median / result.itemsPerIteration << " ns/item"
+			  << std::setw(8) << relativeDeviation << "% stddev"
+			  << std::endl;
+}
+
+}  // namespace
+
+Options Options::parse(std::span<char*> arguments) {
+	Options options = {
+		.filter = "",
+		.jsonPath = "",
+		.repetitions = DEFAULT_REPETITIONS,
+		.warmupTime = DEFAULT_WARMUP_TIME,
+		.minimumSampleTime = DEFAULT_MINIMUM_SAMPLE_TIME,
+	};
+
+	for (const char* rawArgument : arguments.subspan(1)) {
+		const std::string_view argument = rawArgument;
+		std::string_view value;
+		if (parseFlag(argument, "--filter", value)) {
+			options.filter = value;
+		} else if (parseFlag(argument, "--json", value)) {
+			options.jsonPath = value;
+		} else if (parseFlag(argument, "--repetitions", value)) {
+			options.repetitions =
+				std::max(parseNumber(value, options.repetitions), 1u);
+		} else if (parseFlag(argument, "--warmup-ms", value)) {
+			options.warmupTime = std::chrono::milliseconds(
+				parseNumber(value, DEFAULT_WARMUP_TIME.count())
+			);
+		} else if (parseFlag(argument, "--min-sample-ms", value)) {
+			options.minimumSampleTime = std::chrono::milliseconds(
+				parseNumber(value, DEFAULT_MINIMUM_SAMPLE_TIME.count())
+			);
+		} else {
+			std::cerr << "Ignoring unknown argument " << argument << "\n"
+					  << "Usage: " << arguments[0]
+					  << " [--filter=<substring>] [--json=<path>]"
+						 " [--repetitions=<n>] [--warmup-ms=<n>]"
+						 " [--min-sample-ms=<n>]"
+					  << std::endl;
+		}
+	}
+	return options;
+}
+
+Statistics computeStatistics(std::span<const double> samples) {
+	if (samples.empty()) return {0, 0, 0, 0};
+
+	std::vector<double> sorted(samples.begin(), samples.end());
+	std::sort(sorted.begin(), sorted.end());
+	const size_t middle = sorted.size() / 2;
+	const double median = sorted.size() % 2
+							  ? sorted[middle]
+							  : (sorted[middle - 1] + sorted[middle]) / 2;
+
+	const double mean =
+		std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+	double squaredDeviations = 0;
+	for (double sample : sorted)
+		squaredDeviations += (sample - mean) * (sample - mean);
+	const double standardDeviation =
+		sorted.size() > 1
+			? std::sqrt(squaredDeviations / (sorted.size() - 1))
+			: 0.0;
+
+	return {
+		.min = sorted.front(),
+		.median = median,
+		.mean = mean,
+		.standardDeviation = standardDeviation,
+	};
+}
+
+std::vector<Result> runAll(
+	std::span<const Benchmark> benchmarks, const Options& options
+) {
+	std::vector<Result> results;
+	for (const Benchmark& benchmark : benchmarks) {
+		if (benchmark.name.find(options.filter) == std::string::npos) continue;
+
+		State state = {.options = options};
+		benchmark.run(state);
+		results.push_back({
+			.name = benchmark.name,
+			.itemsPerIteration = state.itemsPerIteration,
+			.iterationsPerSample = state.iterationsPerSample,
+			.samples = state.samples,
+			.nanosecondsPerIteration = computeStatistics(state.samples),
+		});
+		printResult(results.back());
+	}
+	return results;
+}
+
+void writeJson(std::ostream& stream, std::span<const Result> results) {
+	stream << std::setprecision(6) << std::defaultfloat;
+	stream << "{\n  \"benchmarks\": [";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& result = results[i];
+		const Statistics& statistics = result.nanosecondsPerIteration;
+		stream << (i ? ",\n" : "\n") << "    {\"name\": ";
+		writeJsonString(stream, result.name);
+		stream << ", \"items_per_iteration\": " << result.itemsPerIteration
+			   << ", \"iterations_per_sample\": " << result.iterationsPerSample
+			   << ", \"ns_per_iteration\": {\"min\": " << statistics.min
+			   << ", \"median\": " << statistics.median
+			   << ", \"mean\": " << statistics.mean
+			   << ", \"stddev\": " << statistics.standardDeviation
+			   << "}, \"ns_per_item\": "
+			   << statistics.median / result.itemsPerIteration
+			   << ", \"samples\": [";
+		for (size_t j = 0; j < result.samples.size(); j++)
+			stream << (j ? ", " : "") << result.samples[j];
+		stream << "]}";
+	}
+	stream << "\n  ]\n}\n";
+}
+
+}  // namespace benchmarks
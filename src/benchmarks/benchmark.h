@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+
+// Keeps the optimizer from discarding a value that is only computed so that
+// it can be measured.
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(_MSC_VER)
+	const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+	(void)*sink;
+#else
+	asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+struct Options {
+	// Only benchmarks whose name contains this run
+	std::string filter;
+	// Results are also written here as JSON when not empty
+	std::string jsonPath;
+	uint32_t repetitions;
+	std::chrono::nanoseconds warmupTime;
+	std::chrono::nanoseconds minimumSampleTime;
+
+   public:
+	static Options parse(std::span<char*> arguments);
+};
+
+struct Statistics {
+	double min;
+	double median;
+	double mean;
+	double standardDeviation;
+};
+
+Statistics computeStatistics(std::span<const double> samples);
+
+struct State {
+	const Options& options;
+	// How many elements a single call to the measured work touches, so that
+	// results can be reported per element as well as per call.
+	uint64_t itemsPerIteration = 1;
+	uint64_t iterationsPerSample = 0;
+	// Nanoseconds per call of the measured work, one entry per repetition
+	std::vector<double> samples = {};
+
+   public:
+	// Runs `work` untimed for the warmup period, sizes a batch from how long
+	// the warmup calls took, then times one batch per repetition.
+	template <typename Work>
+	void measure(Work&& work);
+};
+
+struct Benchmark {
+	// Group/case/parameters, the group in PascalCase and the rest in
+	// snake_case, so that filters and runs line up across groups
+	std::string name;
+	std::function<void(State&)> run;
+};
+
+struct Result {
+	std::string name;
+	uint64_t itemsPerIteration;
+	uint64_t iterationsPerSample;
+	std::vector<double> samples;
+	Statistics nanosecondsPerIteration;
+};
+
+// Problem sizes the primitives are swept over: 10^3 to 10^6 elements.
+inline constexpr std::array<uint32_t, 4> SIZES = {
+	1'000, 10'000, 100'000, 1'000'000
+};
+
+void registerGenerationIndexArrayBenchmarks(std::vector<Benchmark>& benchmarks);
+void registerBVHBenchmarks(std::vector<Benchmark>& benchmarks);
+void registerCullingBenchmarks(std::vector<Benchmark>& benchmarks);
+void registerEcsBenchmarks(std::vector<Benchmark>& benchmarks);
+void registerEventSystemBenchmarks(std::vector<Benchmark>& benchmarks);
+void registerJobsBenchmarks(std::vector<Benchmark>& benchmarks);
+void registerMathBenchmarks(std::vector<Benchmark>& benchmarks);
+void registerSortBenchmarks(std::vector<Benchmark>& benchmarks);
+void registerVertexBenchmarks(std::vector<Benchmark>& benchmarks);
+
+std::vector<Result> runAll(
+	std::span<const Benchmark> benchmarks, const Options& options
+);
+
+void writeJson(std::ostream& stream, std::span<const Result> results);
+
+template <typename Work>
+void State::measure(Work&& work) {
+	using Clock = std::chrono::steady_clock;
+
+	uint64_t warmupIterations = 0;
+	const Clock::time_point warmupStart = Clock::now();
+	std::chrono::nanoseconds warmupElapsed;
+	do {
+		work();
+		warmupIterations++;
+		warmupElapsed = Clock::now() - warmupStart;
+	} while (warmupElapsed < options.warmupTime);
+
+	// Batch enough calls that a sample dwarfs the clock resolution
+	const double estimatedNanoseconds =
+		static_cast<double>(warmupElapsed.count()) / warmupIterations;
+	iterationsPerSample = std::max<uint64_t>(
+		1,
+		static_cast<uint64_t>(
+			static_cast<double>(options.minimumSampleTime.count()) /
+			std::max(estimatedNanoseconds, 1.0)
+		)
+	);
+
+	samples.clear();
+	samples.reserve(options.repetitions);
+	for (uint32_t repetition = 0; repetition < options.repetitions;
+		 repetition++) {
+		const Clock::time_point start = Clock::now();
+		for (uint64_t i = 0; i < iterationsPerSample; i++) work();
+		const std::chrono::nanoseconds elapsed = Clock::now() - start;
+		samples.push_back(
+			static_cast<double>(elapsed.count()) / iterationsPerSample
+		);
+	}
+}
+
+}  // namespace benchmarks
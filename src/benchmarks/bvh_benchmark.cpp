@@ -0,0 +1,236 @@
+#include <tiny_obj_loader.h>
+
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <map>
+#include <random>
+#include <string>
+
+#include "benchmark.h"
+#include "core/logger/assert.h"
+#include "core/logger/logger.h"
+#include "core/math/bvh.h"
+
+namespace {
+
+struct Scene {
+	std::string name;
+	std::string modelPath;
+	std::string mtlDirectory;
+};
+
+// Paths relative to the build directory, where models are copied
+const std::array<Scene, 2> SCENES = {
+	Scene{"sponza", "models/sponza/sponza.obj", "models/sponza/"},
+	Scene{"bedroom", "models/bedroom/iscv2.obj", "models/bedroom/"},
+};
+
+constexpr uint32_t QUERIES_PER_ITERATION = 64;
+
+// The scenes are a handful of statics each, too few to stress the tree, so
+// every triangle of their models stands in for a static
+const std::vector<math::AABB>& loadTriangleBounds(const Scene& scene) {
+	static std::map<std::string, std::vector<math::AABB>> cache;
+	if (const auto cached = cache.find(scene.name); cached != cache.end())
+		return cached->second;
+
+	tinyobj::attrib_t attrib;
+	std::vector<tinyobj::shape_t> shapes;
+	std::vector<tinyobj::material_t> materials;
+	std::string warn, err;
+	const bool successfullyLoadedModel = tinyobj::LoadObj(
+		&attrib,
+		&shapes,
+		&materials,
+		&warn,
+		&err,
+		scene.modelPath.c_str(),
+		scene.mtlDirectory.c_str()
+	);
+	ASSERT(
+		successfullyLoadedModel,
+		"Can't load model at " << scene.modelPath << " " << warn << " " << err
+	);
+
+	std::vector<math::AABB> bounds;
+	for (const tinyobj::shape_t& shape : shapes) {
+		for (size_t i = 0; i + 2 < shape.mesh.indices.size(); i += 3) {
+			std::array<glm::vec3, 3> corners;
+			for (size_t corner = 0; corner < 3; corner++) {
+				const int vertex = shape.mesh.indices[i + corner].vertex_index;
+				corners[corner] = glm::vec3(
+					attrib.vertices[3 * vertex + 0],
+					attrib.vertices[3 * vertex + 1],
+					attrib.vertices[3 * vertex + 2]
+				);
+			}
+			bounds.push_back(math::computeBounds(corners).box);
+		}
+	}
+	return cache.emplace(scene.name, std::move(bounds)).first->second;
+}
+
+math::AABB getSceneBounds(std::span<const math::AABB> bounds) {
+	math::AABB result = bounds.front();
+	for (const math::AABB& box : bounds) result = math::merge(result, box);
+	return result;
+}
+
+void build(benchmarks::State& state, const Scene& scene) {
+	const std::vector<math::AABB>& bounds = loadTriangleBounds(scene);
+	state.itemsPerIteration = bounds.size();
+	state.measure([&]() {
+		const math::BVH bvh = math::BVH::create(bounds);
+		benchmarks::doNotOptimize(bvh.nodes.data());
+	});
+}
+
+void refit(benchmarks::State& state, const Scene& scene) {
+	std::vector<math::AABB> bounds = loadTriangleBounds(scene);
+	math::BVH bvh = math::BVH::create(bounds);
+	for (math::AABB& box : bounds) {
+		box.min += glm::vec3(0.01f);
+		box.max += glm::vec3(0.01f);
+	}
+
+	state.itemsPerIteration = bounds.size();
+	state.measure([&]() {
+		math::refit(bvh, bounds);
+		benchmarks::doNotOptimize(bvh.nodes.data());
+	});
+}
+
+// Cameras placed around the middle of the scene, looking every which way
+std::vector<math::Frustum> createFrustums(const math::AABB& sceneBounds) {
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	const glm::vec3 center = (sceneBounds.min + sceneBounds.max) * 0.5f;
+	const glm::vec3 extent = sceneBounds.max - sceneBounds.min;
+	const float depth = glm::length(extent);
+	const glm::mat4 projection =
+		glm::perspective(glm::radians(60.0f), 16 / 9.0f, 0.1f, depth);
+
+	std::vector<math::Frustum> frustums;
+	for (uint32_t i = 0; i < QUERIES_PER_ITERATION; i++) {
+		const glm::vec3 eye =
+			center + 0.25f * extent * glm::vec3(unit(random), 0, unit(random));
+		const glm::vec3 target =
+			eye + glm::vec3(unit(random), 0.2f * unit(random), unit(random));
+		frustums.push_back(math::Frustum::create(
+			projection * glm::lookAt(eye, target, glm::vec3(0, 1, 0))
+		));
+	}
+	return frustums;
+}
+
+template <bool IS_LINEAR>
+void queryFrustum(benchmarks::State& state, const Scene& scene) {
+	const std::vector<math::AABB>& bounds = loadTriangleBounds(scene);
+	const math::BVH bvh = math::BVH::create(bounds);
+	const std::vector<math::Frustum> frustums =
+		createFrustums(getSceneBounds(bounds));
+
+	// The same question without an index: every bounding sphere against every
+	// plane, as the draw list is culled
+	math::BoundingSpheres spheres;
+	for (const math::AABB& box : bounds)
+		math::append(
+			spheres,
+			{.center = (box.min + box.max) * 0.5f,
+			 .radius = glm::length(box.max - box.min) * 0.5f}
+		);
+
+	std::vector<uint32_t> result;
+	state.itemsPerIteration = QUERIES_PER_ITERATION;
+	state.measure([&]() {
+		for (const math::Frustum& frustum : frustums) {
+			result.clear();
+			if constexpr (IS_LINEAR) math::cull(frustum, spheres, result);
+			else math::query(bvh, frustum, result);
+			benchmarks::doNotOptimize(result.data());
+		}
+	});
+}
+
+void queryOverlap(benchmarks::State& state, const Scene& scene) {
+	const std::vector<math::AABB>& bounds = loadTriangleBounds(scene);
+	const math::BVH bvh = math::BVH::create(bounds);
+	const math::AABB sceneBounds = getSceneBounds(bounds);
+
+	// Boxes a tenth of the scene wide, as a proximity query around a player
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	const glm::vec3 extent = sceneBounds.max - sceneBounds.min;
+	std::vector<math::AABB> boxes;
+	for (uint32_t i = 0; i < QUERIES_PER_ITERATION; i++) {
+		const glm::vec3 center =
+			sceneBounds.min +
+			extent * glm::vec3(unit(random), unit(random), unit(random));
+		boxes.push_back({center - 0.05f * extent, center + 0.05f * extent});
+	}
+
+	std::vector<uint32_t> result;
+	state.itemsPerIteration = QUERIES_PER_ITERATION;
+	state.measure([&]() {
+		for (const math::AABB& box : boxes) {
+			result.clear();
+			math::query(bvh, box, result);
+			benchmarks::doNotOptimize(result.data());
+		}
+	});
+}
+
+void raycast(benchmarks::State& state, const Scene& scene) {
+	const std::vector<math::AABB>& bounds = loadTriangleBounds(scene);
+	const math::BVH bvh = math::BVH::create(bounds);
+	const math::AABB sceneBounds = getSceneBounds(bounds);
+	const glm::vec3 center = (sceneBounds.min + sceneBounds.max) * 0.5f;
+	const float maxDistance = glm::length(sceneBounds.max - sceneBounds.min);
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<math::Ray> rays;
+	for (uint32_t i = 0; i < QUERIES_PER_ITERATION; i++)
+		rays.push_back(
+			{.origin = center,
+			 .direction = glm::normalize(
+				 glm::vec3(unit(random), unit(random), unit(random))
+			 )}
+		);
+
+	state.itemsPerIteration = QUERIES_PER_ITERATION;
+	state.measure([&]() {
+		for (const math::Ray& ray : rays)
+			benchmarks::doNotOptimize(math::raycast(bvh, ray, maxDistance));
+	});
+}
+
+}  // namespace
+
+namespace benchmarks {
+
+void registerBVHBenchmarks(std::vector<Benchmark>& benchmarks) {
+	for (const Scene& scene : SCENES) {
+		if (!std::filesystem::exists(scene.modelPath)) {
+			LLOG_WARNING << "Skipping BVH benchmarks on " << scene.name
+						 << ": no model at " << scene.modelPath;
+			continue;
+		}
+		const auto add = [&](std::string name, void (*run)(State&, const Scene&)
+						 ) {
+			benchmarks.push_back(
+				{.name = "BVH/" + name + "/" + scene.name,
+				 .run = [run, &scene](State& state) { run(state, scene); }}
+			);
+		};
+		add("build", build);
+		add("refit", refit);
+		add("frustum", queryFrustum<false>);
+		add("frustum_linear", queryFrustum<true>);
+		add("overlap", queryOverlap);
+		add("raycast", raycast);
+	}
+}
+
+}  // namespace benchmarks
@@ -0,0 +1,80 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <string>
+
+#include "benchmark.h"
+#include "core/logger/assert.h"
+#include "core/math/frustum.h"
+
+namespace {
+
+math::BoundingSpheres createSpheres(uint32_t size) {
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> radius(0.1f, 5.0f);
+
+	math::BoundingSpheres spheres;
+	for (uint32_t i = 0; i < size; i++) {
+		math::append(
+			spheres,
+			{.center = {position(random), position(random), position(random)},
+			 .radius = radius(random)}
+		);
+	}
+	return spheres;
+}
+
+math::Frustum createFrustum() {
+	const glm::mat4 view = glm::lookAt(
+		glm::vec3(0, 0, -150), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0)
+	);
+	const glm::mat4 projection =
+		glm::perspective(glm::radians(60.0f), 16 / 9.0f, 0.1f, 300.0f);
+	return math::Frustum::create(projection * view);
+}
+
+template <bool IS_SCALAR>
+void cull(benchmarks::State& state, uint32_t size) {
+	const math::BoundingSpheres spheres = createSpheres(size);
+	const math::Frustum frustum = createFrustum();
+	std::vector<uint32_t> visible;
+	visible.reserve(size);
+
+	// The vectorized path has to agree exactly with the reference
+	std::vector<uint32_t> expected;
+	math::cullScalar(frustum, spheres, expected);
+	math::cull(frustum, spheres, visible);
+	ASSERT(
+		visible == expected,
+		"Culling kept " << visible.size() << " spheres but the scalar "
+						<< "reference kept " << expected.size()
+	);
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		visible.clear();
+		if constexpr (IS_SCALAR) math::cullScalar(frustum, spheres, visible);
+		else math::cull(frustum, spheres, visible);
+		benchmarks::doNotOptimize(visible.data());
+	});
+}
+
+}  // namespace
+
+namespace benchmarks {
+
+void registerCullingBenchmarks(std::vector<Benchmark>& benchmarks) {
+	for (uint32_t size : SIZES) {
+		benchmarks.push_back(
+			{.name = "Culling/scalar/" + std::to_string(size),
+			 .run = [size](State& state) { cull<true>(state, size); }}
+		);
+		benchmarks.push_back(
+			{.name = "Culling/simd/" + std::to_string(size),
+			 .run = [size](State& state) { cull<false>(state, size); }}
+		);
+	}
+}
+
+}  // namespace benchmarks
@@ -0,0 +1,156 @@
+#include <string>
+
+#include "benchmark.h"
+#include "ecs/command_buffer.h"
+#include "ecs/registry.h"
+
+namespace {
+
+constexpr uint32_t NUM_ENTITIES = 1'000'000;
+constexpr float DELTA_TIME = 1.0f / 60.0f;
+
+struct Position {
+	float x, y, z;
+};
+
+struct Velocity {
+	float x, y, z;
+};
+
+struct Acceleration {
+	float x, y, z;
+};
+
+struct Lifetime {
+	float remaining;
+};
+
+ecs::Registry createPopulatedRegistry(uint32_t numComponents) {
+	ecs::Registry registry = ecs::Registry::create();
+	const Position position = {0, 0, 0};
+	const Velocity velocity = {1, 2, 3};
+	const Acceleration acceleration = {0, -9.8f, 0};
+	const Lifetime lifetime = {10};
+	for (uint32_t i = 0; i < NUM_ENTITIES; i++) {
+		switch (numComponents) {
+			case 2: (void)ecs::createEntity(registry, position, velocity); break;
+			case 3:
+				(void)ecs::createEntity(
+					registry, position, velocity, acceleration
+				);
+				break;
+			default:
+				(void)ecs::createEntity(
+					registry, position, velocity, acceleration, lifetime
+				);
+				break;
+		}
+	}
+	return registry;
+}
+
+void iterate(benchmarks::State& state, uint32_t numComponents) {
+	ecs::Registry registry = createPopulatedRegistry(numComponents);
+	state.itemsPerIteration = NUM_ENTITIES;
+
+	switch (numComponents) {
+		case 2:
+			state.measure([&]() {
+				ecs::forEach<Position, const Velocity>(
+					registry,
+					[](Position& position, const Velocity& velocity) {
+						position.x += velocity.x * DELTA_TIME;
+						position.y += velocity.y * DELTA_TIME;
+						position.z += velocity.z * DELTA_TIME;
+					}
+				);
+			});
+			break;
+		case 3:
+			state.measure([&]() {
+				ecs::forEach<Position, Velocity, const Acceleration>(
+					registry,
+					[](Position& position,
+					   Velocity& velocity,
+					   const Acceleration& acceleration) {
+						velocity.x += acceleration.x * DELTA_TIME;
+						velocity.y += acceleration.y * DELTA_TIME;
+						velocity.z += acceleration.z * DELTA_TIME;
+						position.x += velocity.x * DELTA_TIME;
+						position.y += velocity.y * DELTA_TIME;
+						position.z += velocity.z * DELTA_TIME;
+					}
+				);
+			});
+			break;
+		default:
+			state.measure([&]() {
+				ecs::forEach<Position, Velocity, const Acceleration, Lifetime>(
+					registry,
+					[](Position& position,
+					   Velocity& velocity,
+					   const Acceleration& acceleration,
+					   Lifetime& lifetime) {
+						velocity.x += acceleration.x * DELTA_TIME;
+						velocity.y += acceleration.y * DELTA_TIME;
+						velocity.z += acceleration.z * DELTA_TIME;
+						position.x += velocity.x * DELTA_TIME;
+						position.y += velocity.y * DELTA_TIME;
+						position.z += velocity.z * DELTA_TIME;
+						lifetime.remaining -= DELTA_TIME;
+					}
+				);
+			});
+			break;
+	}
+
+	float checksum = 0;
+	ecs::forEach<const Position>(registry, [&](const Position& position) {
+		checksum += position.x;
+	});
+	benchmarks::doNotOptimize(checksum);
+}
+
+// Creates a batch of entities through a command buffer and destroys them
+// again, which is how gameplay code spawns and despawns projectiles.
+void commandBufferChurn(benchmarks::State& state) {
+	constexpr uint32_t BATCH_SIZE = 10'000;
+	ecs::Registry registry = ecs::Registry::create();
+	ecs::CommandBuffer commands = ecs::CommandBuffer::create();
+	std::vector<ecs::Entity> spawned;
+	spawned.reserve(BATCH_SIZE);
+
+	state.itemsPerIteration = BATCH_SIZE;
+	state.measure([&]() {
+		spawned.clear();
+		for (uint32_t i = 0; i < BATCH_SIZE; i++)
+			spawned.push_back(ecs::createEntity(
+				commands, registry, Position{0, 0, 0}, Velocity{1, 0, 0}
+			));
+		ecs::apply(commands, registry);
+
+		for (ecs::Entity entity : spawned) ecs::destroyEntity(commands, entity);
+		ecs::apply(commands, registry);
+	});
+}
+
+}  // namespace
+
+namespace benchmarks {
+
+void registerEcsBenchmarks(std::vector<Benchmark>& benchmarks) {
+	for (uint32_t numComponents : {2u, 3u, 4u}) {
+		benchmarks.push_back(
+			{.name = "Ecs/iterate_1M/" + std::to_string(numComponents) +
+					 "_components",
+			 .run = [numComponents](State& state) {
+				 iterate(state, numComponents);
+			 }}
+		);
+	}
+	benchmarks.push_back(
+		{.name = "Ecs/command_buffer_churn/10k", .run = commandBufferChurn}
+	);
+}
+
+}  // namespace benchmarks
@@ -0,0 +1,106 @@
+#include <string>
+
+#include "benchmark.h"
+#include "core/algo/event_system.h"
+
+namespace {
+
+enum class Event {
+	MouseX,
+	MouseY,
+	MovementX,
+	MovementY,
+	Count,
+};
+
+constexpr uint32_t LISTENERS_PER_EVENT = 4;
+
+void subscribeListeners(EventSystem<Event, float>& events, float& sink) {
+	for (uint32_t event = 0; event < static_cast<uint32_t>(Event::Count);
+		 event++)
+		for (uint32_t i = 0; i < LISTENERS_PER_EVENT; i++)
+			(void)events.Register(
+				static_cast<Event>(event), [&sink](float value) { sink += value; }
+			);
+}
+
+// Dispatches `size` events immediately, cycling through the event kinds.
+void trigger(benchmarks::State& state, uint32_t size) {
+	EventSystem<Event, float> events;
+	float sink = 0;
+	subscribeListeners(events, sink);
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		for (uint32_t i = 0; i < size; i++)
+			events.Trigger(
+				static_cast<Event>(i % static_cast<uint32_t>(Event::Count)),
+				1.0f
+			);
+		benchmarks::doNotOptimize(sink);
+	});
+}
+
+// Queues `size` events and drains them in one flush, like mouse motion does
+// within a frame.
+void enqueueAndFlush(benchmarks::State& state, uint32_t size) {
+	EventSystem<Event, float> events;
+	float sink = 0;
+	subscribeListeners(events, sink);
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		for (uint32_t i = 0; i < size; i++)
+			events.Enqueue(
+				static_cast<Event>(i % static_cast<uint32_t>(Event::Count)),
+				1.0f
+			);
+		events.Flush();
+		benchmarks::doNotOptimize(sink);
+	});
+}
+
+// Subscribes `size` listeners to one event and removes them again.
+void registerAndRemove(benchmarks::State& state, uint32_t size) {
+	EventSystem<Event, float> events;
+	std::vector<EventSystem<Event, float>::Subscription> subscriptions;
+	subscriptions.reserve(size);
+	float sink = 0;
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		subscriptions.clear();
+		for (uint32_t i = 0; i < size; i++)
+			subscriptions.push_back(events.Register(
+				Event::MouseX, [&sink](float value) { sink += value; }
+			));
+		// Newest first, the order short-lived listeners usually go away in
+		for (size_t i = subscriptions.size(); i-- > 0;)
+			events.Remove(subscriptions[i]);
+	});
+}
+
+}  // namespace
+
+namespace benchmarks {
+
+void registerEventSystemBenchmarks(std::vector<Benchmark>& benchmarks) {
+	for (uint32_t size : SIZES) {
+		benchmarks.push_back(
+			{.name = "EventSystem/trigger/" + std::to_string(size),
+			 .run = [size](State& state) { trigger(state, size); }}
+		);
+		benchmarks.push_back(
+			{.name = "EventSystem/enqueue_flush/" + std::to_string(size),
+			 .run = [size](State& state) { enqueueAndFlush(state, size); }}
+		);
+	}
+	for (uint32_t size : SIZES) {
+		benchmarks.push_back(
+			{.name = "EventSystem/register_remove/" + std::to_string(size),
+			 .run = [size](State& state) { registerAndRemove(state, size); }}
+		);
+	}
+}
+
+}  // namespace benchmarks
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "benchmark.h"
+#include "core/algo/generation_index_array.h"
+
+namespace {
+
+constexpr uint32_t TABLE_SIZE = 100000;
+
+// Fills a table to TABLE_SIZE slots, then destroys a random subset so that
+// only `occupancy` of them stay live. Fixed seed keeps runs comparable.
+algo::GenerationIndexArray createTableWithOccupancy(float occupancy) {
+	algo::GenerationIndexArray array = algo::GenerationIndexArray::create();
+	std::vector<algo::GenerationIndexPair> handles;
+	handles.reserve(TABLE_SIZE);
+	for (uint32_t i = 0; i < TABLE_SIZE; i++)
+		handles.push_back(algo::reserveIndex(array));
+
+	std::mt19937 random(1234);
+	std::shuffle(handles.begin(), handles.end(), random);
+	const size_t numLive = static_cast<size_t>(TABLE_SIZE * occupancy);
+	algo::destroy(array, std::span(handles).subspan(numLive));
+	return array;
+}
+
+void iterateDense(benchmarks::State& state, float occupancy) {
+	const algo::GenerationIndexArray array =
+		createTableWithOccupancy(occupancy);
+	state.itemsPerIteration =
+		std::max<size_t>(algo::getLiveCount(array), 1);
+	state.measure([&]() {
+		uint64_t sum = 0;
+		algo::forEachLiveIndex(array, [&](uint32_t index) { sum += index; });
+		benchmarks::doNotOptimize(sum);
+	});
+}
+
+// What iteration cost before the dense array: visit every slot ever handed
+// out and skip the free ones.
+void iterateSparse(benchmarks::State& state, float occupancy) {
+	const algo::GenerationIndexArray array =
+		createTableWithOccupancy(occupancy);
+	state.itemsPerIteration =
+		std::max<size_t>(algo::getLiveCount(array), 1);
+	state.measure([&]() {
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < algo::getCapacity(array); i++)
+			if (algo::isLive(array, i)) sum += i;
+		benchmarks::doNotOptimize(sum);
+	});
+}
+
+// Reserves `size` handles into an empty table, validates and destroys them.
+void reserveValidateDestroy(benchmarks::State& state, uint32_t size) {
+	algo::GenerationIndexArray array = algo::GenerationIndexArray::create();
+	std::vector<algo::GenerationIndexPair> handles;
+	handles.reserve(size);
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		handles.clear();
+		for (uint32_t i = 0; i < size; i++)
+			handles.push_back(algo::reserveIndex(array));
+		uint32_t numValid = 0;
+		for (const algo::GenerationIndexPair& handle : handles)
+			numValid += algo::isIndexValid(array, handle);
+		benchmarks::doNotOptimize(numValid);
+		algo::destroy(array, handles);
+	});
+}
+
+constexpr uint32_t CHURN_BATCH_SIZE = 64;
+constexpr uint32_t CHURN_BATCHES_PER_THREAD = 64;
+
+// Every thread repeatedly reserves a batch of handles and destroys it again.
+// One in eight handles is handed to whichever thread drains the shared queue
+// next, so slots are also destroyed away from the thread that reserved them.
+// Doubles as a stress test: build with LIEBESKIND_SANITIZE_THREAD to run it
+// under ThreadSanitizer.
+void concurrentChurn(benchmarks::State& state, uint32_t numThreads) {
+	algo::GenerationIndexArray array = algo::GenerationIndexArray::create();
+	std::mutex handoffMutex;
+	std::vector<algo::GenerationIndexPair> handoff;
+
+	const auto churn = [&]() {
+		std::vector<algo::GenerationIndexPair> batch;
+		std::vector<algo::GenerationIndexPair> adopted;
+		for (uint32_t i = 0; i < CHURN_BATCHES_PER_THREAD; i++) {
+			batch.clear();
+			for (uint32_t j = 0; j < CHURN_BATCH_SIZE; j++)
+				batch.push_back(algo::reserveIndex(array));
+			for (const algo::GenerationIndexPair& index : batch)
+				ASSERT(
+					algo::isIndexValid(array, index),
+					"Freshly reserved index " << index.index << " is invalid"
+				);
+
+			{
+				std::lock_guard<std::mutex> lock(handoffMutex);
+				for (uint32_t j = 0; j < CHURN_BATCH_SIZE; j += 8)
+					handoff.push_back(batch[j]);
+				adopted.swap(handoff);
+				handoff.clear();
+			}
+			std::erase_if(batch, [&](const algo::GenerationIndexPair& index) {
+				return std::find(adopted.begin(), adopted.end(), index) !=
+					   adopted.end();
+			});
+
+			algo::destroy(array, batch);
+			algo::destroy(array, adopted);
+			for (const algo::GenerationIndexPair& index : batch)
+				ASSERT(
+					!algo::isIndexValid(array, index),
+					"Destroyed index " << index.index << " is still valid"
+				);
+		}
+	};
+
+	state.itemsPerIteration =
+		uint64_t{numThreads} * CHURN_BATCHES_PER_THREAD * CHURN_BATCH_SIZE;
+	state.measure([&]() {
+		std::vector<std::thread> threads;
+		for (uint32_t i = 0; i < numThreads; i++) threads.emplace_back(churn);
+		for (std::thread& thread : threads) thread.join();
+
+		algo::destroy(array, handoff);
+		handoff.clear();
+		ASSERT(
+			algo::getLiveCount(array) == 0,
+			algo::getLiveCount(array) << " indices leaked"
+		);
+	});
+}
+
+}  // namespace
+
+namespace benchmarks {
+
+void registerGenerationIndexArrayBenchmarks(std::vector<Benchmark>& benchmarks
+) {
+	constexpr std::array<std::pair<const char*, float>, 3> occupancies = {{
+		{"1%", 0.01f},
+		{"50%", 0.5f},
+		{"100%", 1.0f},
+	}};
+	for (const auto& [label, occupancy] : occupancies) {
+		benchmarks.push_back(
+			{.name = std::string("GenerationIndexArray/iterate_dense/") + label,
+			 .run = [occupancy](State& state) {
+				 iterateDense(state, occupancy);
+			 }}
+		);
+		benchmarks.push_back(
+			{.name = std::string("GenerationIndexArray/iterate_sparse/") + label,
+			 .run = [occupancy](State& state) {
+				 iterateSparse(state, occupancy);
+			 }}
+		);
+	}
+
+	for (uint32_t size : SIZES) {
+		benchmarks.push_back(
+			{.name = "GenerationIndexArray/reserve_validate_destroy/" +
+					 std::to_string(size),
+			 .run = [size](State& state) {
+				 reserveValidateDestroy(state, size);
+			 }}
+		);
+	}
+
+	for (uint32_t numThreads : {1u, 2u, 4u, 8u}) {
+		benchmarks.push_back(
+			{.name = "GenerationIndexArray/concurrent_churn/" +
+					 std::to_string(numThreads) + "_threads",
+			 .run = [numThreads](State& state) {
+				 concurrentChurn(state, numThreads);
+			 }}
+		);
+	}
+}
+
+}  // namespace benchmarks
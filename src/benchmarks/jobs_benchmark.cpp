@@ -0,0 +1,80 @@
+#include <cmath>
+#include <string>
+#include <thread>
+
+#include "benchmark.h"
+#include "core/jobs/scheduler.h"
+
+namespace {
+
+constexpr uint32_t ITEMS = 1'000'000;
+constexpr uint32_t BATCH_SIZE = 4096;
+constexpr uint32_t EMPTY_JOBS = 10'000;
+
+// 1, 2, 4, ... up to and including every core
+std::vector<uint32_t> getThreadCounts() {
+	const uint32_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<uint32_t> counts;
+	for (uint32_t count = 1; count < cores; count *= 2) counts.push_back(count);
+	counts.push_back(cores);
+	return counts;
+}
+
+// Enough arithmetic per element that the loop is compute bound, so scaling
+// reflects the scheduler rather than memory bandwidth
+void parallelFor(benchmarks::State& state, uint32_t threads) {
+	jobs::Scheduler scheduler = jobs::Scheduler::create(threads - 1);
+	std::vector<float> values(ITEMS);
+
+	state.itemsPerIteration = ITEMS;
+	state.measure([&]() {
+		jobs::parallelFor(
+			scheduler,
+			ITEMS,
+			BATCH_SIZE,
+			[&](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; i++) {
+					float x = static_cast<float>(i);
+					for (int step = 0; step < 16; step++)
+						x = std::sqrt(x * x + 1.0f);
+					values[i] = x;
+				}
+			}
+		);
+		benchmarks::doNotOptimize(values.data());
+	});
+	scheduler.destroy();
+}
+
+// Cost of submitting, running and waiting on jobs that do nothing
+void emptyJobs(benchmarks::State& state, uint32_t threads) {
+	jobs::Scheduler scheduler = jobs::Scheduler::create(threads - 1);
+
+	state.itemsPerIteration = EMPTY_JOBS;
+	state.measure([&]() {
+		jobs::Counter counter;
+		for (uint32_t i = 0; i < EMPTY_JOBS; i++)
+			jobs::submit(scheduler, []() {}, &counter);
+		jobs::wait(scheduler, counter);
+	});
+	scheduler.destroy();
+}
+
+}  // namespace
+
+namespace benchmarks {
+
+void registerJobsBenchmarks(std::vector<Benchmark>& benchmarks) {
+	for (uint32_t threads : getThreadCounts()) {
+		benchmarks.push_back(
+			{.name = "Jobs/parallel_for/" + std::to_string(threads),
+			 .run = [threads](State& state) { parallelFor(state, threads); }}
+		);
+		benchmarks.push_back(
+			{.name = "Jobs/empty_jobs/" + std::to_string(threads),
+			 .run = [threads](State& state) { emptyJobs(state, threads); }}
+		);
+	}
+}
+
+}  // namespace benchmarks
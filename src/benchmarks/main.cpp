@@ -0,0 +1,36 @@
+#include <fstream>
+#include <iostream>
+
+#include "benchmark.h"
+#include "core/logger/logger.h"
+
+int main(int argc, char** argv) {
+	Logging::initializeLogger();
+
+	const benchmarks::Options options =
+		benchmarks::Options::parse(std::span(argv, argc));
+
+	std::vector<benchmarks::Benchmark> all;
+	benchmarks::registerGenerationIndexArrayBenchmarks(all);
+	benchmarks::registerBVHBenchmarks(all);
+	benchmarks::registerCullingBenchmarks(all);
+	benchmarks::registerEcsBenchmarks(all);
+	benchmarks::registerEventSystemBenchmarks(all);
+	benchmarks::registerJobsBenchmarks(all);
+	benchmarks::registerMathBenchmarks(all);
+	benchmarks::registerSortBenchmarks(all);
+	benchmarks::registerVertexBenchmarks(all);
+
+	const std::vector<benchmarks::Result> results =
+		benchmarks::runAll(all, options);
+
+	if (!options.jsonPath.empty()) {
+		std::ofstream file(options.jsonPath);
+		if (!file) {
+			std::cerr << "Could not open " << options.jsonPath << std::endl;
+			return 1;
+		}
+		benchmarks::writeJson(file, results);
+	}
+	return 0;
+}
@@ -0,0 +1,53 @@
+#include <glm/glm.hpp>
+#include <random>
+#include <string>
+
+#include "benchmark.h"
+#include "core/math/transform.h"
+
+namespace {
+
+std::vector<math::Transform> createTransforms(uint32_t size) {
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+	std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+
+	std::vector<math::Transform> transforms;
+	transforms.reserve(size);
+	for (uint32_t i = 0; i < size; i++) {
+		transforms.push_back({
+			.position = {position(random), position(random), position(random)},
+			.eulers = {angle(random), angle(random), angle(random)},
+			.scale = {scale(random), scale(random), scale(random)},
+		});
+	}
+	return transforms;
+}
+
+void toMat4(benchmarks::State& state, uint32_t size) {
+	const std::vector<math::Transform> transforms = createTransforms(size);
+	std::vector<glm::mat4> matrices(size);
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		for (uint32_t i = 0; i < size; i++)
+			matrices[i] = math::toMat4(transforms[i]);
+		benchmarks::doNotOptimize(matrices.data());
+	});
+}
+
+}  // namespace
+
+namespace benchmarks {
+
+void registerMathBenchmarks(std::vector<Benchmark>& benchmarks) {
+	for (uint32_t size : SIZES) {
+		benchmarks.push_back(
+			{.name = "Math/to_mat4/" + std::to_string(size),
+			 .run = [size](State& state) { toMat4(state, size); }}
+		);
+	}
+}
+
+}  // namespace benchmarks
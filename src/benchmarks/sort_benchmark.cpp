@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <glm/mat4x4.hpp>
+#include <random>
+#include <string>
+
+#include "benchmark.h"
+#include "core/algo/radix_sort.h"
+#include "core/logger/assert.h"
+#include "low_level_renderer/sort_key.h"
+
+namespace {
+
+// What the scene graph sorts each frame: the state a render object binds, its
+// transform, and its view depth
+struct DepthSortedObject {
+	graphics::PipelineSpecializationConstants variant;
+	glm::mat4 transform;
+	uint32_t material;
+	uint32_t mesh;
+	uint16_t depth;
+};
+
+std::vector<DepthSortedObject> createObjects(uint32_t size) {
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<uint32_t> samplerInclusion(0, 15);
+	std::uniform_int_distribution<uint32_t> parallaxMappingMode(0, 3);
+	std::uniform_int_distribution<uint32_t> material(0, 255);
+	std::uniform_int_distribution<uint32_t> mesh(0, 1023);
+	std::uniform_int_distribution<uint32_t> depth(0, 0xFFFF);
+
+	std::vector<DepthSortedObject> objects;
+	objects.reserve(size);
+	for (uint32_t i = 0; i < size; i++) {
+		objects.push_back(
+			{.variant =
+				 {.samplerInclusion = samplerInclusion(random),
+				  .parallaxMappingMode =
+					  static_cast<graphics::ParallaxMappingMode>(
+						  parallaxMappingMode(random)
+					  )},
+			 .transform = glm::mat4(1),
+			 .material = material(random),
+			 .mesh = mesh(random),
+			 .depth = static_cast<uint16_t>(depth(random))}
+		);
+	}
+	return objects;
+}
+
+bool isDrawnBefore(const DepthSortedObject& a, const DepthSortedObject& b) {
+	if (!(a.variant == b.variant)) return a.variant < b.variant;
+	if (a.material != b.material) return a.material < b.material;
+	if (a.mesh != b.mesh) return a.mesh < b.mesh;
+	return a.depth < b.depth;
+}
+
+void sortObjects(benchmarks::State& state, uint32_t size) {
+	const std::vector<DepthSortedObject> objects = createObjects(size);
+	std::vector<DepthSortedObject> sorted;
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		sorted = objects;
+		std::sort(sorted.begin(), sorted.end(), isDrawnBefore);
+		benchmarks::doNotOptimize(sorted.data());
+	});
+}
+
+void sortKeys(benchmarks::State& state, uint32_t size) {
+	const std::vector<DepthSortedObject> objects = createObjects(size);
+	std::vector<graphics::SortKey> keys;
+	std::vector<uint32_t> indices;
+	std::vector<graphics::SortKey> keyScratch;
+	std::vector<uint32_t> indexScratch;
+	const auto sort = [&]() {
+		keys.clear();
+		indices.clear();
+		for (uint32_t i = 0; i < size; i++) {
+			const DepthSortedObject& object = objects[i];
+			keys.push_back(graphics::getSortKey(
+				object.variant, object.material, object.mesh, object.depth
+			));
+			indices.push_back(i);
+		}
+		algo::radixSort(keys, indices, keyScratch, indexScratch);
+	};
+
+	// The keys have to order objects exactly as the comparator does
+	std::vector<DepthSortedObject> expected = objects;
+	std::stable_sort(expected.begin(), expected.end(), isDrawnBefore);
+	sort();
+	for (uint32_t i = 0; i < size; i++) {
+		const DepthSortedObject& actual = objects[indices[i]];
+		ASSERT(
+			!isDrawnBefore(actual, expected[i]) &&
+				!isDrawnBefore(expected[i], actual),
+			"Radix sort placed the wrong object at " << i
+		);
+	}
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		sort();
+		benchmarks::doNotOptimize(indices.data());
+	});
+}
+
+}  // namespace
+
+namespace benchmarks {
+
+void registerSortBenchmarks(std::vector<Benchmark>& benchmarks) {
+	for (uint32_t size : SIZES) {
+		benchmarks.push_back(
+			{.name = "Sort/std_sort/" + std::to_string(size),
+			 .run = [size](State& state) { sortObjects(state, size); }}
+		);
+		benchmarks.push_back(
+			{.name = "Sort/radix/" + std::to_string(size),
+			 .run = [size](State& state) { sortKeys(state, size); }}
+		);
+	}
+}
+
+}  // namespace benchmarks
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "benchmark.h"
+#include "low_level_renderer/mesh_optimizer.h"
+#include "low_level_renderer/vertex.h"
+
+namespace {
+
+// Roughly what an OBJ mesh looks like after triangulation: every vertex is
+// referenced by several faces, so only about a sixth of them are unique.
+std::vector<graphics::Vertex> createVertices(uint32_t size) {
+	constexpr uint32_t DUPLICATION = 6;
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> texCoord(0.0f, 1.0f);
+
+	const uint32_t numUnique = std::max(size / DUPLICATION, 1u);
+	std::vector<graphics::Vertex> unique;
+	unique.reserve(numUnique);
+	for (uint32_t i = 0; i < numUnique; i++) {
+		const glm::vec3 position = {
+			coordinate(random), coordinate(random), coordinate(random)
+		};
+		unique.push_back({
+			.position = position,
+			.normal = glm::normalize(position),
+			.tangent = {1, 0, 0},
+			.color = {1, 1, 1},
+			.texCoord = {texCoord(random), texCoord(random)},
+		});
+	}
+
+	std::uniform_int_distribution<uint32_t> pick(0, numUnique - 1);
+	std::vector<graphics::Vertex> vertices;
+	vertices.reserve(size);
+	for (uint32_t i = 0; i < size; i++) vertices.push_back(unique[pick(random)]);
+	return vertices;
+}
+
+void hashVertices(benchmarks::State& state, uint32_t size) {
+	const std::vector<graphics::Vertex> vertices = createVertices(size);
+	const std::hash<graphics::Vertex> hasher;
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		size_t combined = 0;
+		for (const graphics::Vertex& vertex : vertices)
+			combined ^= hasher(vertex);
+		benchmarks::doNotOptimize(combined);
+	});
+}
+
+// The vertex deduplication the OBJ loader does with this hash.
+void deduplicateVertices(benchmarks::State& state, uint32_t size) {
+	const std::vector<graphics::Vertex> vertices = createVertices(size);
+	std::unordered_map<graphics::Vertex, graphics::IndexType> uniqueVertices;
+	std::vector<graphics::IndexType> indices;
+	indices.reserve(size);
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		uniqueVertices.clear();
+		indices.clear();
+		for (const graphics::Vertex& vertex : vertices) {
+			const auto [iterator, inserted] = uniqueVertices.try_emplace(
+				vertex, static_cast<graphics::IndexType>(uniqueVertices.size())
+			);
+			indices.push_back(iterator->second);
+		}
+		benchmarks::doNotOptimize(indices.data());
+	});
+}
+
+// Packing for the geometry buffer, as every mesh upload does. Consecutive
+// vertices make up the triangles.
+void packVertices(benchmarks::State& state, uint32_t size) {
+	const std::vector<graphics::Vertex> vertices = createVertices(size);
+	std::vector<graphics::IndexType> indices(size - size % 3);
+	for (uint32_t i = 0; i < indices.size(); i++) indices[i] = i;
+
+	state.itemsPerIteration = size;
+	state.measure([&]() {
+		const std::vector<graphics::PackedVertex> packed =
+			graphics::pack(vertices, indices);
+		benchmarks::doNotOptimize(packed.data());
+	});
+}
+
+uint32_t getGridSide(uint32_t size) {
+	return std::max(
+		static_cast<uint32_t>(std::sqrt(static_cast<float>(size))), 2u
+	);
+}
+
+// Row by row triangles of a square grid, the order OBJ exporters tend to
+// write.
+std::vector<graphics::IndexType> createGridIndices(uint32_t side) {
+	std::vector<graphics::IndexType> indices;
+	indices.reserve(6 * (side - 1) * (side - 1));
+	for (uint32_t y = 0; y + 1 < side; y++)
+		for (uint32_t x = 0; x + 1 < side; x++) {
+			const uint32_t corner = y * side + x;
+			indices.insert(
+				indices.end(),
+				{corner,
+				 corner + side,
+				 corner + 1,
+				 corner + 1,
+				 corner + side,
+				 corner + side + 1}
+			);
+		}
+	return indices;
+}
+
+// Tipsify on a square grid of about `size` vertices.
+void optimizeGridVertexCache(benchmarks::State& state, uint32_t size) {
+	const uint32_t side = getGridSide(size);
+	const std::vector<graphics::IndexType> gridIndices =
+		createGridIndices(side);
+	std::vector<graphics::IndexType> indices;
+
+	state.itemsPerIteration = side * side;
+	state.measure([&]() {
+		indices = gridIndices;
+		graphics::optimizeVertexCache(indices, side * side);
+		benchmarks::doNotOptimize(indices.data());
+	});
+}
+
+// Meshlets of a bumpy square grid in cache order, as every mesh upload
+// builds them.
+void buildGridMeshlets(benchmarks::State& state, uint32_t size) {
+	const uint32_t side = getGridSide(size);
+	std::vector<graphics::IndexType> indices = createGridIndices(side);
+	graphics::optimizeVertexCache(indices, side * side);
+	std::vector<graphics::Vertex> vertices;
+	vertices.reserve(side * side);
+	for (uint32_t y = 0; y < side; y++)
+		for (uint32_t x = 0; x < side; x++) {
+			const float height = std::sin(static_cast<float>(x + y) * 0.1f);
+			vertices.push_back({
+				.position =
+					{static_cast<float>(x), height, static_cast<float>(y)},
+				.normal = {0, 1, 0},
+				.tangent = {1, 0, 0},
+				.color = {1, 1, 1},
+				.texCoord = {0, 0},
+			});
+		}
+
+	state.itemsPerIteration = static_cast<uint32_t>(indices.size() / 3);
+	state.measure([&]() {
+		const std::vector<graphics::Meshlet> meshlets =
+			graphics::buildMeshlets(vertices, indices);
+		benchmarks::doNotOptimize(meshlets.data());
+	});
+}
+
+}  // namespace
+
+namespace benchmarks {
+
+void registerVertexBenchmarks(std::vector<Benchmark>& benchmarks) {
+	for (uint32_t size : SIZES) {
+		benchmarks.push_back(
+			{.name = "Vertex/hash/" + std::to_string(size),
+			 .run = [size](State& state) { hashVertices(state, size); }}
+		);
+		benchmarks.push_back(
+			{.name = "Vertex/deduplicate/" + std::to_string(size),
+			 .run = [size](State& state) { deduplicateVertices(state, size); }}
+		);
+		benchmarks.push_back(
+			{.name = "Vertex/pack/" + std::to_string(size),
+			 .run = [size](State& state) { packVertices(state, size); }}
+		);
+		benchmarks.push_back(
+			{.name = "Vertex/optimize_vertex_cache/" + std::to_string(size),
+			 .run = [size](State& state) {
+				 optimizeGridVertexCache(state, size);
+			 }}
+		);
+		benchmarks.push_back(
+			{.name = "Vertex/build_meshlets/" + std::to_string(size),
+			 .run = [size](State& state) { buildGridMeshlets(state, size); }}
+		);
+	}
+}
+
+}  // namespace benchmarks
@@ -1,41 +1,154 @@
 #pragma once
 
-#include <algorithm>
-#include <functional>
-#include <unordered_map>
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-template <typename Event, typename... Data>
+#include "core/algo/inplace_function.h"
+#include "core/logger/assert.h"
+
+// Events are enumerators of an enum ending in a `Count` sentinel, which sizes
+// the flat dispatch table.
+template <typename Event>
+concept CountedEnum = std::is_enum_v<Event> && requires { Event::Count; };
+
+// Listeners are stored per event in a flat table indexed by the enum, and
+// removed through the subscription handle returned when they were registered.
+// Listeners may register or remove listeners while being triggered.
+//
+// Enqueue defers an event until the next Flush, which dispatches everything
+// queued since in order. The queue keeps its capacity between flushes, so a
+// steady stream of events does not allocate.
+template <CountedEnum Event, typename... Data>
 class EventSystem {
    public:
-	using EventListener = std::function<void(Data... data)>;
+	using EventListener = algo::InplaceFunction<void(Data... data)>;
+
+	struct Subscription {
+		Event event;
+		uint32_t id;
+	};
+
+	[[nodiscard]]
+	Subscription Register(Event event, EventListener listener);
+	void Remove(Subscription subscription);
+	void Trigger(Event event, Data... data);
+
+	void Enqueue(Event event, Data... data);
+	void Flush();
 
-	void Register(Event event, EventListener listener);
-	void Remove(Event event, EventListener listener);
-	void Trigger(const Event& event, Data... data);
+   private:
+	static constexpr size_t EVENT_COUNT = static_cast<size_t>(Event::Count);
+	// Never handed out, marks listeners removed during dispatch.
+	static constexpr uint32_t REMOVED_ID = 0;
+
+	struct Listener {
+		uint32_t id;
+		EventListener callback;
+	};
+
+	static size_t toIndex(Event event) {
+		const size_t index = static_cast<size_t>(event);
+		ASSERT(index < EVENT_COUNT, "Event " << index << " is out of range");
+		return index;
+	}
+
+	// Applies registrations and removals deferred while dispatching.
+	void settle();
 
    private:
-	std::unordered_map<Event, std::vector<EventListener>> listeners;
+	std::array<std::vector<Listener>, EVENT_COUNT> listeners;
+	std::array<bool, EVENT_COUNT> hasRemovedListeners = {};
+	std::vector<std::pair<Event, Listener>> pendingListeners;
+	std::vector<std::tuple<Event, Data...>> queued;
+	std::vector<std::tuple<Event, Data...>> flushing;
+	uint32_t nextId = REMOVED_ID + 1;
+	uint32_t dispatchDepth = 0;
 };
 
-template <typename Event, typename... Data>
-void EventSystem<Event, Data...>::Register(
-	Event event, EventListener listener
-) {
-	listeners[event].push_back(listener);
+template <CountedEnum Event, typename... Data>
+typename EventSystem<Event, Data...>::Subscription
+EventSystem<Event, Data...>::Register(Event event, EventListener listener) {
+	const uint32_t id = nextId++;
+	Listener entry = {.id = id, .callback = std::move(listener)};
+	// Growing the vector would move the callable that is currently running
+	if (dispatchDepth > 0)
+		pendingListeners.emplace_back(event, std::move(entry));
+	else
+		listeners[toIndex(event)].push_back(std::move(entry));
+	return {.event = event, .id = id};
+}
+
+template <CountedEnum Event, typename... Data>
+void EventSystem<Event, Data...>::Remove(Subscription subscription) {
+	std::vector<Listener>& eventListeners =
+		listeners[toIndex(subscription.event)];
+	// Newest first, since short-lived listeners are the ones removed most
+	for (size_t i = eventListeners.size(); i-- > 0;) {
+		if (eventListeners[i].id != subscription.id) continue;
+
+		// Erasing would shift the listeners an ongoing Trigger is walking
+		if (dispatchDepth > 0) {
+			eventListeners[i].id = REMOVED_ID;
+			eventListeners[i].callback.reset();
+			hasRemovedListeners[toIndex(subscription.event)] = true;
+		} else {
+			eventListeners.erase(eventListeners.begin() + i);
+		}
+		return;
+	}
+
+	std::erase_if(
+		pendingListeners,
+		[&](const std::pair<Event, Listener>& pending) {
+			return pending.second.id == subscription.id;
+		}
+	);
+}
+
+template <CountedEnum Event, typename... Data>
+void EventSystem<Event, Data...>::Trigger(Event event, Data... data) {
+	std::vector<Listener>& eventListeners = listeners[toIndex(event)];
+
+	dispatchDepth++;
+	for (const Listener& listener : eventListeners)
+		if (listener.id != REMOVED_ID) listener.callback(data...);
+	dispatchDepth--;
+
+	if (dispatchDepth == 0) settle();
 }
 
-template <typename Event, typename... Data>
-void EventSystem<Event, Data...>::Remove(Event event, EventListener listener) {
-    if (listeners.contains(event)) {
-        listeners[event].erase(
-            std::find(listeners[event].begin(), listeners[event].end(), listener)
-        );
-    }
+template <CountedEnum Event, typename... Data>
+void EventSystem<Event, Data...>::Enqueue(Event event, Data... data) {
+	queued.emplace_back(event, data...);
 }
 
-template <typename Event, typename... Data>
-void EventSystem<Event, Data...>::Trigger(const Event& event, Data... data) {
-	if (!listeners.contains(event)) return;
-	for (const EventListener& listener : listeners[event]) listener(data...);
+template <CountedEnum Event, typename... Data>
+void EventSystem<Event, Data...>::Flush() {
+	// Swap so that events enqueued by listeners wait for the next flush
+	std::swap(queued, flushing);
+	for (const std::tuple<Event, Data...>& entry : flushing)
+		std::apply(
+			[this](Event event, Data... data) { Trigger(event, data...); },
+			entry
+		);
+	flushing.clear();
+}
+
+template <CountedEnum Event, typename... Data>
+void EventSystem<Event, Data...>::settle() {
+	for (size_t i = 0; i < EVENT_COUNT; i++) {
+		if (!hasRemovedListeners[i]) continue;
+		std::erase_if(listeners[i], [](const Listener& listener) {
+			return listener.id == REMOVED_ID;
+		});
+		hasRemovedListeners[i] = false;
+	}
+
+	for (std::pair<Event, Listener>& pending : pendingListeners)
+		listeners[toIndex(pending.first)].push_back(std::move(pending.second));
+	pendingListeners.clear();
 }
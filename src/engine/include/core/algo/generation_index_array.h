@@ -1,17 +1,20 @@
 #pragma once
 
-#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <span>
 #include <vector>
-#include <cstdint>
 
+#include "core/algo/paged_array.h"
 #include "core/logger/assert.h"
 
 namespace algo {
 
 struct GenerationIndexPair {
-	uint16_t index;
-	uint16_t generation;
+	uint32_t index;
+	uint32_t generation;
 
    public:
 	bool operator<(const GenerationIndexPair& other) const {
@@ -22,47 +25,82 @@ struct GenerationIndexPair {
 	}
 };
 
-template <size_t N>
+// Free and live slots of one shard. A slot belongs to the shard that first
+// handed it out for its whole lifetime, so recycling never crosses shards.
+struct GenerationIndexShard {
+	std::mutex mutex;
+	std::vector<uint32_t> free;
+	std::vector<uint32_t> dense;
+};
+
+// Slot table that grows on demand. A slot's generation is bumped both when it
+// is reserved and when it is destroyed, so live slots always have an odd
+// generation and stale handles never match a recycled slot.
+//
+// reserveIndex and destroy may be called from any number of threads. Each
+// thread reserves through its own shard, so threads only contend when they
+// destroy each other's slots. Validity checks never lock.
+//
+// Live slots of a shard are kept packed in its `dense` list, with `denseIndex`
+// mapping a slot back to its position there. Destroying swaps the last live
+// slot into the hole, so iterating live slots costs O(live) regardless of
+// capacity.
 struct GenerationIndexArray {
-	std::array<uint16_t, N> generation;
-	std::vector<uint16_t> free;
+	static constexpr size_t SHARD_COUNT = 8;
 
-	static_assert(N <= (1 << 16), "N is too large, keep it under 2^{16}");
+	PagedArray<std::atomic<uint32_t>> generation;
+	PagedArray<uint32_t> denseIndex;
+	PagedArray<uint8_t> shard;
+	std::unique_ptr<std::atomic<uint32_t>> size;
+	std::unique_ptr<GenerationIndexShard[]> shards;
 
    public:
-	GenerationIndexArray() = delete;
 	static GenerationIndexArray create();
-
-   private:
-	GenerationIndexArray(std::vector<uint16_t> free);
 };
 
-template <size_t N>
 [[nodiscard]]
-GenerationIndexPair reserveIndex(GenerationIndexArray<N>& array);
+GenerationIndexPair reserveIndex(GenerationIndexArray& array);
 
-template <size_t N>
-std::vector<uint16_t> getLiveIndices(const GenerationIndexArray<N>& array);
+// Number of slots that have ever been handed out. Storages indexed by this
+// array need at least this many entries.
+inline size_t getCapacity(const GenerationIndexArray& array) {
+	return array.size->load(std::memory_order_acquire);
+}
+
+inline bool isLive(const GenerationIndexArray& array, uint32_t index) {
+	return array.generation[index].load(std::memory_order_acquire) & 1;
+}
 
-template <size_t N>
 inline bool isIndexValid(
-	const GenerationIndexArray<N>& array, GenerationIndexPair index
+	const GenerationIndexArray& array, GenerationIndexPair index
 ) {
 	ASSERT(
-		index.index < N,
-		"Index " << index.index << " exceeds the capacity of " << N
+		index.index < getCapacity(array),
+		"Index " << index.index << " exceeds the capacity of "
+				 << getCapacity(array)
 	);
-	return array.generation[index.index] == index.generation;
+	return array.generation[index.index].load(std::memory_order_acquire) ==
+		   index.generation;
+}
+
+size_t getLiveCount(const GenerationIndexArray& array);
+
+// Calls `visit` with every live index, in unspecified order. Each shard is
+// locked while it is visited, so `visit` must not reserve or destroy indices
+// of the same array.
+template <typename Visitor>
+void forEachLiveIndex(const GenerationIndexArray& array, Visitor&& visit) {
+	for (size_t i = 0; i < GenerationIndexArray::SHARD_COUNT; i++) {
+		GenerationIndexShard& shard = array.shards[i];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		for (uint32_t index : shard.dense) visit(index);
+	}
 }
 
-template <size_t N>
+// Stale handles, whose slot was destroyed since, are skipped, so destroying
+// the same handle twice is harmless.
 void destroy(
-	GenerationIndexArray<N>& array, std::span<const GenerationIndexPair> indices
+	GenerationIndexArray& array, std::span<const GenerationIndexPair> indices
 );
 
 }  // namespace algo
-
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused"
-#include "generation_index_array.cpp"
-#pragma GCC diagnostic pop
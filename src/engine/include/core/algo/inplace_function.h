@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "core/logger/assert.h"
+
+namespace algo {
+
+template <typename Signature, size_t Capacity = 32>
+class InplaceFunction;
+
+// Type-erased callable like std::function, except that the callable is always
+// stored inside the object. Callables that do not fit are rejected at compile
+// time rather than spilled to the heap, so constructing, moving and calling
+// never allocate.
+template <typename Result, typename... Args, size_t Capacity>
+class InplaceFunction<Result(Args...), Capacity> {
+   public:
+	InplaceFunction() = default;
+
+	template <typename Callable>
+		requires(!std::is_same_v<std::decay_t<Callable>, InplaceFunction> &&
+				 std::is_invocable_r_v<Result, Callable&, Args...>)
+	InplaceFunction(Callable&& callable) {
+		using Stored = std::decay_t<Callable>;
+		static_assert(
+			sizeof(Stored) <= Capacity,
+			"Callable does not fit in the InplaceFunction buffer"
+		);
+		static_assert(
+			alignof(Stored) <= alignof(std::max_align_t),
+			"Callable is over-aligned for the InplaceFunction buffer"
+		);
+		static_assert(
+			std::is_nothrow_move_constructible_v<Stored>,
+			"Callable must be nothrow move constructible"
+		);
+
+		new (storage) Stored(std::forward<Callable>(callable));
+		invoker = [](void* storage, Args... args) -> Result {
+			return (*std::launder(reinterpret_cast<Stored*>(storage)))(
+				std::forward<Args>(args)...
+			);
+		};
+		manager = [](void* destination, void* source) {
+			Stored* stored = std::launder(reinterpret_cast<Stored*>(source));
+			if (destination) new (destination) Stored(std::move(*stored));
+			stored->~Stored();
+		};
+	}
+
+	InplaceFunction(InplaceFunction&& other) noexcept { moveFrom(other); }
+
+	InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+		if (this != &other) {
+			reset();
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	InplaceFunction(const InplaceFunction&) = delete;
+	InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+	~InplaceFunction() { reset(); }
+
+	Result operator()(Args... args) const {
+		ASSERT(invoker, "Calling an empty InplaceFunction");
+		return invoker(storage, std::forward<Args>(args)...);
+	}
+
+	explicit operator bool() const { return invoker != nullptr; }
+
+	void reset() {
+		if (manager) manager(nullptr, storage);
+		invoker = nullptr;
+		manager = nullptr;
+	}
+
+   private:
+	void moveFrom(InplaceFunction& other) {
+		if (other.manager) other.manager(storage, other.storage);
+		invoker = other.invoker;
+		manager = other.manager;
+		other.invoker = nullptr;
+		other.manager = nullptr;
+	}
+
+   private:
+	using Invoker = Result (*)(void*, Args...);
+	// Moves the callable into `destination` when it is not null, then destroys
+	// the source.
+	using Manager = void (*)(void* destination, void* source);
+
+	alignas(std::max_align_t) mutable std::byte storage[Capacity];
+	Invoker invoker = nullptr;
+	Manager manager = nullptr;
+};
+
+}  // namespace algo
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "core/logger/assert.h"
+
+namespace algo {
+
+// Growable array that allocates its storage one page at a time. Elements never
+// move once their page exists, so growing does not copy what is already live
+// and nothing is allocated for slots that were never reached.
+//
+// Page k holds FirstPageSize * 2^k elements, so a fixed table of page pointers
+// covers every 32-bit index. Because that table never reallocates,
+// ensureCapacity may race with itself and with element access from other
+// threads; accessing distinct elements concurrently is then safe as well.
+template <typename T, size_t FirstPageSize = 256>
+struct PagedArray {
+	static_assert(
+		std::has_single_bit(FirstPageSize),
+		"FirstPageSize must be a power of two"
+	);
+
+	static constexpr size_t FIRST_PAGE_SHIFT = std::countr_zero(FirstPageSize);
+	static constexpr size_t MAX_PAGES = 33 - FIRST_PAGE_SHIFT;
+
+	std::unique_ptr<std::array<std::atomic<T*>, MAX_PAGES>> pages =
+		std::make_unique<std::array<std::atomic<T*>, MAX_PAGES>>();
+
+   public:
+	PagedArray() = default;
+	PagedArray(PagedArray&&) = default;
+	PagedArray& operator=(PagedArray&&) = default;
+	~PagedArray() {
+		if (!pages) return;
+		for (std::atomic<T*>& page : *pages) delete[] page.load();
+	}
+
+	T& operator[](size_t index) {
+		auto [page, offset] = locate(index);
+		T* data = (*pages)[page].load(std::memory_order_acquire);
+		ASSERT(
+			data != nullptr,
+			"Index " << index << " exceeds the capacity of " << capacity()
+		);
+		return data[offset];
+	}
+
+	const T& operator[](size_t index) const {
+		auto [page, offset] = locate(index);
+		const T* data = (*pages)[page].load(std::memory_order_acquire);
+		ASSERT(
+			data != nullptr,
+			"Index " << index << " exceeds the capacity of " << capacity()
+		);
+		return data[offset];
+	}
+
+	size_t capacity() const {
+		size_t result = 0;
+		for (size_t page = 0; page < MAX_PAGES; page++) {
+			if (!(*pages)[page].load(std::memory_order_acquire)) break;
+			result += pageSize(page);
+		}
+		return result;
+	}
+
+	void ensureCapacity(size_t size) {
+		if (size == 0) return;
+		const size_t lastPage = locate(size - 1).first;
+		for (size_t page = 0; page <= lastPage; page++) {
+			std::atomic<T*>& slot = (*pages)[page];
+			if (slot.load(std::memory_order_acquire)) continue;
+
+			T* allocated = new T[pageSize(page)]();
+			T* expected = nullptr;
+			if (!slot.compare_exchange_strong(
+					expected, allocated, std::memory_order_acq_rel
+				))
+				delete[] allocated;  // Another thread got there first
+		}
+	}
+
+   private:
+	static constexpr size_t pageSize(size_t page) {
+		return FirstPageSize << page;
+	}
+
+	static std::pair<size_t, size_t> locate(size_t index) {
+		const size_t page =
+			std::bit_width((index >> FIRST_PAGE_SHIFT) + 1) - 1;
+		const size_t pageStart = FirstPageSize * ((size_t{1} << page) - 1);
+		ASSERT(page < MAX_PAGES, "Index " << index << " is out of range");
+		return {page, index - pageStart};
+	}
+};
+
+}  // namespace algo
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace algo {
+
+// Stable least-significant-digit radix sort on 64-bit keys, one byte per
+// pass, carrying a 32-bit value (usually an index) along with each key.
+// Histograms for every byte are built in a single read, and a pass is skipped
+// when all keys share that byte, so keys that use few of their bits sort in
+// few passes. The scratch vectors are grown as needed and can be reused
+// between calls to avoid allocating.
+void radixSort(
+	std::vector<uint64_t>& keys,
+	std::vector<uint32_t>& values,
+	std::vector<uint64_t>& keyScratch,
+	std::vector<uint32_t>& valueScratch
+);
+
+}  // namespace algo
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace algo {
+
+struct Range {
+	uint64_t offset;
+	uint64_t size;
+};
+
+// Hands out ranges of [0, capacity) from a free list kept sorted by offset.
+// Allocation takes the smallest free range that fits, and freed ranges merge
+// with their free neighbours, so the list only holds the gaps between live
+// ranges. Units are up to the owner: elements of a buffer, or bytes.
+struct RangeAllocator {
+	// Never empty nor adjacent to one another
+	std::vector<Range> free;
+	uint64_t capacity;
+
+   public:
+	static RangeAllocator create(uint64_t capacity);
+};
+
+// Offset of a range of `size` whose offset is a multiple of `alignment`.
+// Empty if no free range fits it.
+[[nodiscard]]
+std::optional<uint64_t> allocate(
+	RangeAllocator& allocator, uint64_t size, uint64_t alignment = 1
+);
+void release(RangeAllocator& allocator, Range range);
+// Adds [capacity, newCapacity) to the free ranges.
+void grow(RangeAllocator& allocator, uint64_t newCapacity);
+// Frees everything, for owners that move their live ranges elsewhere.
+void reset(RangeAllocator& allocator);
+
+uint64_t getFreeSize(const RangeAllocator& allocator);
+uint64_t getLargestFreeSize(const RangeAllocator& allocator);
+
+}  // namespace algo
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "core/algo/inplace_function.h"
+
+namespace jobs {
+
+using JobFunction = algo::InplaceFunction<void(), 48>;
+
+struct Job;
+
+// Counts jobs that have been submitted against it and not yet finished.
+// Jobs can also wait on a counter, and only become runnable once it drops to
+// zero. Must outlive every job that references it.
+struct Counter {
+	std::atomic<uint32_t> pending = 0;
+	// Jobs waiting for `pending` to reach zero
+	std::mutex waitersMutex;
+	std::vector<Job> waiters;
+};
+
+enum class Affinity {
+	eAnyThread,
+	// Only run by the thread that created the scheduler, from wait or
+	// runMainThreadJobs. For work that touches SDL, ImGui or the graphics
+	// queue.
+	eMainThread,
+};
+
+struct Job {
+	JobFunction function;
+	// Decremented once `function` returns
+	Counter* counter;
+	Affinity affinity;
+};
+
+// Each queue is a deque the owning thread pushes and pops at the back, while
+// idle threads steal from the front, so thieves take the oldest and usually
+// largest pieces of work.
+struct WorkerQueue {
+	std::mutex mutex;
+	std::deque<Job> jobs;
+};
+
+// Everything workers touch. Kept on the heap so the Scheduler can move while
+// workers run.
+struct SchedulerState {
+	// Queue 0 belongs to the main thread, queue i + 1 to worker i
+	std::unique_ptr<WorkerQueue[]> queues;
+	uint32_t numQueues;
+
+	std::mutex mainThreadMutex;
+	std::deque<Job> mainThreadJobs;
+
+	// Jobs sitting in any worker queue, so idle workers know when to sleep
+	std::atomic<uint32_t> numQueued;
+	std::atomic<uint32_t> numSleeping;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::atomic<bool> isStopping;
+
+	std::thread::id mainThread;
+};
+
+struct Scheduler {
+	std::unique_ptr<SchedulerState> state;
+	std::vector<std::thread> workers;
+
+   public:
+	// The calling thread becomes the main thread and takes part in the work
+	// whenever it waits. Defaults to one worker per remaining core.
+	static Scheduler create(std::optional<uint32_t> numWorkers = std::nullopt);
+	// Finishes queued jobs, then joins the workers
+	void destroy();
+};
+
+// Adds one to `counter`, if given, until the job finishes.
+void submit(
+	Scheduler& scheduler,
+	JobFunction function,
+	Counter* counter = nullptr,
+	Affinity affinity = Affinity::eAnyThread
+);
+// Holds the job back until `dependency` reaches zero.
+void submitAfter(
+	Scheduler& scheduler,
+	Counter& dependency,
+	JobFunction function,
+	Counter* counter = nullptr,
+	Affinity affinity = Affinity::eAnyThread
+);
+
+// Runs other jobs on this thread until `counter` reaches zero. The counter
+// may be destroyed as soon as this returns.
+void wait(Scheduler& scheduler, Counter& counter);
+
+// Drains main-thread jobs queued so far. Call once per frame.
+void runMainThreadJobs(Scheduler& scheduler);
+
+uint32_t getThreadCount(const Scheduler& scheduler);
+
+// Splits [0, count) into batches of at most `batchSize` and calls
+// `body(begin, end)` for each across all threads, returning once every batch
+// is done. `body` must be safe to call concurrently.
+template <typename Body>
+void parallelFor(
+	Scheduler& scheduler, uint32_t count, uint32_t batchSize, const Body& body
+) {
+	ASSERT(batchSize > 0, "Parallel for needs a batch size of at least 1");
+	if (count <= batchSize) {
+		if (count > 0) body(0u, count);
+		return;
+	}
+
+	Counter counter;
+	for (uint32_t begin = batchSize; begin < count; begin += batchSize) {
+		const uint32_t end = std::min(count, begin + batchSize);
+		submit(scheduler, [&body, begin, end]() { body(begin, end); }, &counter);
+	}
+	// The first batch runs here rather than waiting on a thief
+	body(0u, batchSize);
+	wait(scheduler, counter);
+}
+
+extern std::optional<Scheduler> scheduler;
+
+}  // namespace jobs
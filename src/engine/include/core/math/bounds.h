@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace math {
+
+struct AABB {
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct Sphere {
+	glm::vec3 center;
+	float radius;
+};
+
+struct Bounds {
+	AABB box;
+	// Centered on the box, just large enough to hold every point
+	Sphere sphere;
+};
+
+Bounds computeBounds(std::span<const glm::vec3> points);
+
+// Smallest axis-aligned box around the transformed box.
+AABB transform(const AABB& box, const glm::mat4& localToWorld);
+AABB merge(const AABB& a, const AABB& b);
+bool overlaps(const AABB& a, const AABB& b);
+float getSurfaceArea(const AABB& box);
+
+// Bounds a sphere after an affine transform. Non-uniform scale grows the
+// radius by the largest axis scale.
+Sphere transform(const Sphere& sphere, const glm::mat4& localToWorld);
+
+// Spheres in structure-of-arrays form, so that culling can load several
+// centers per instruction.
+struct BoundingSpheres {
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radius;
+};
+
+void clear(BoundingSpheres& spheres);
+void resize(BoundingSpheres& spheres, size_t size);
+void append(BoundingSpheres& spheres, const Sphere& sphere);
+void set(BoundingSpheres& spheres, size_t index, const Sphere& sphere);
+
+}  // namespace math
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "core/math/bounds.h"
+#include "core/math/frustum.h"
+
+namespace math {
+
+struct BVHNode {
+	AABB bounds;
+	// Range of BVH::primitives under this node, leaf or not
+	uint32_t primitiveBegin;
+	uint32_t primitiveCount;
+	// Index of the left child; the right one follows it. 0 marks a leaf,
+	// since the root is never anyone's child.
+	uint32_t children;
+};
+
+// Bounding volume hierarchy over boxes, built top down with the binned
+// surface area heuristic. Children are always stored after their parent, so
+// refitting is one backwards pass over the nodes. Queries walk the tree with
+// a fixed-size stack instead of recursing.
+struct BVH {
+	// nodes[0] is the root when there is anything to hold
+	std::vector<BVHNode> nodes;
+	// Caller's primitive indices, grouped so each node owns a contiguous range
+	std::vector<uint32_t> primitives;
+	// Parallel to `primitives`
+	std::vector<AABB> primitiveBounds;
+
+   public:
+	static constexpr uint32_t MAX_DEPTH = 32;
+	static constexpr uint32_t MAX_LEAF_SIZE = 4;
+
+	static BVH create(std::span<const AABB> bounds);
+};
+
+// Updates bounds after primitives moved, keeping the tree's topology. Cheap,
+// but the tree degrades if things move far from where they were built.
+// `bounds` is indexed like the span given to create.
+void refit(BVH& bvh, std::span<const AABB> bounds);
+
+// Each query appends the indices of matching primitives to `result`.
+void query(
+	const BVH& bvh, const Frustum& frustum, std::vector<uint32_t>& result
+);
+void query(const BVH& bvh, const AABB& box, std::vector<uint32_t>& result);
+
+struct Ray {
+	glm::vec3 origin;
+	glm::vec3 direction;
+};
+
+struct RayHit {
+	uint32_t primitive;
+	// In units of the ray's direction
+	float distance;
+};
+
+// Closest primitive box the ray enters within `maxDistance`. A ray starting
+// inside a box hits it at distance 0.
+std::optional<RayHit> raycast(
+	const BVH& bvh, const Ray& ray, float maxDistance
+);
+
+}  // namespace math
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "core/math/bounds.h"
+
+namespace math {
+
+// Six planes facing inward, normalized so that dot(xyz, p) + w is the signed
+// distance of p. Order: left, right, bottom, top, near, far.
+struct Frustum {
+	std::array<glm::vec4, 6> planes;
+
+   public:
+	// Assumes a [0, 1] clip depth range, as GLM_FORCE_DEPTH_ZERO_TO_ONE sets
+	static Frustum create(const glm::mat4& viewProjection);
+};
+
+bool intersects(const Frustum& frustum, const Sphere& sphere);
+
+// Appends the indices of the spheres that touch the frustum to `visible`, in
+// increasing order. Tests 8 spheres at a time with AVX, 4 with SSE, and
+// falls back to `cullScalar` elsewhere.
+void cull(
+	const Frustum& frustum,
+	const BoundingSpheres& spheres,
+	std::vector<uint32_t>& visible
+);
+// One sphere at a time. The reference `cull` has to agree with.
+void cullScalar(
+	const Frustum& frustum,
+	const BoundingSpheres& spheres,
+	std::vector<uint32_t>& visible
+);
+
+}  // namespace math
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ecs/registry.h"
+
+namespace ecs {
+
+enum class CommandType : uint8_t {
+	Create,
+	Destroy,
+	Set,
+	Remove,
+};
+
+struct ComponentValue {
+	const ComponentInfo* component;
+	// Where the value's bytes start in CommandBuffer::payload
+	uint32_t offset;
+};
+
+struct Command {
+	CommandType type;
+	Entity entity;
+	// Range of CommandBuffer::values this command uses
+	uint32_t firstValue;
+	uint32_t valueCount;
+};
+
+// Records structural changes so they can be made while iterating a registry,
+// or from another thread, and applied later in one batch. Commands are applied
+// in the order they were recorded. Buffers keep their capacity across apply,
+// so recording into a reused buffer does not allocate in steady state.
+struct CommandBuffer {
+	std::vector<Command> commands;
+	std::vector<ComponentValue> values;
+	std::vector<std::byte> payload;
+
+   public:
+	static CommandBuffer create();
+};
+
+void recordValue(
+	CommandBuffer& buffer, const ComponentInfo& component, const void* value
+);
+
+// The returned entity is alive straight away but has no components until the
+// buffer is applied. Reserving the entity is thread-safe, so each thread can
+// record into its own buffer.
+template <Component... Components>
+[[nodiscard]]
+Entity createEntity(
+	CommandBuffer& buffer,
+	Registry& registry,
+	const Components&... components
+) {
+	const Entity entity = reserveEntity(registry);
+	buffer.commands.push_back(
+		{.type = CommandType::Create,
+		 .entity = entity,
+		 .firstValue = static_cast<uint32_t>(buffer.values.size()),
+		 .valueCount = sizeof...(Components)}
+	);
+	(recordValue(buffer, getComponentInfo<Components>(), &components), ...);
+	return entity;
+}
+
+void destroyEntity(CommandBuffer& buffer, Entity entity);
+
+template <Component T>
+void addComponent(CommandBuffer& buffer, Entity entity, const T& value) {
+	buffer.commands.push_back(
+		{.type = CommandType::Set,
+		 .entity = entity,
+		 .firstValue = static_cast<uint32_t>(buffer.values.size()),
+		 .valueCount = 1}
+	);
+	recordValue(buffer, getComponentInfo<T>(), &value);
+}
+
+template <Component T>
+void removeComponent(CommandBuffer& buffer, Entity entity) {
+	buffer.commands.push_back(
+		{.type = CommandType::Remove,
+		 .entity = entity,
+		 .firstValue = static_cast<uint32_t>(buffer.values.size()),
+		 .valueCount = 1}
+	);
+	buffer.values.push_back(
+		{.component = &getComponentInfo<T>(), .offset = 0}
+	);
+}
+
+// Commands on entities destroyed in the meantime are skipped.
+void apply(CommandBuffer& buffer, Registry& registry);
+
+}  // namespace ecs
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "core/algo/generation_index_array.h"
+#include "core/algo/paged_array.h"
+#include "core/algo/type_id.h"
+#include "core/logger/assert.h"
+
+namespace ecs {
+
+using Entity = algo::GenerationIndexPair;
+
+// Rows are moved between chunks with memcpy, so components have to be
+// trivially copyable.
+template <typename T>
+concept Component = std::is_trivially_copyable_v<T> && !std::is_const_v<T> &&
+					!std::is_reference_v<T>;
+
+struct ComponentInfo {
+	int id;
+	uint32_t size;
+	uint32_t alignment;
+};
+
+template <Component T>
+const ComponentInfo& getComponentInfo() {
+	static const ComponentInfo info = {
+		.id = getTypeId<T>(),
+		.size = sizeof(T),
+		.alignment = alignof(T),
+	};
+	return info;
+}
+
+constexpr size_t CHUNK_SIZE = 16 * 1024;
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+struct ChunkDeleter {
+	void operator()(std::byte* data) const;
+};
+
+// Fixed size block holding up to `chunkCapacity` rows of one archetype. Each
+// column, the entity column included, starts on its own cache line.
+struct Chunk {
+	std::unique_ptr<std::byte[], ChunkDeleter> data;
+	uint32_t count;
+};
+
+// Every entity with exactly this set of components. Rows are packed: all
+// chunks but the last are full, and removing a row moves the last row into
+// the hole.
+struct Archetype {
+	std::vector<const ComponentInfo*> components;  // Sorted by id
+	std::vector<uint32_t> columnOffsets;
+	uint32_t chunkCapacity;
+	std::vector<Chunk> chunks;
+	size_t count;
+	// Archetypes reached by adding or removing one component, filled lazily
+	std::vector<std::pair<int, uint32_t>> addEdges;
+	std::vector<std::pair<int, uint32_t>> removeEdges;
+
+   public:
+	static constexpr uint32_t ENTITY_COLUMN_OFFSET = 0;
+
+	static Archetype create(std::span<const ComponentInfo* const> components);
+};
+
+// Column of the component in the archetype, or -1 if it has none.
+int findColumn(const Archetype& archetype, int componentId);
+
+inline Entity* getEntities(const Chunk& chunk) {
+	return reinterpret_cast<Entity*>(
+		chunk.data.get() + Archetype::ENTITY_COLUMN_OFFSET
+	);
+}
+
+inline std::byte* getColumn(
+	const Archetype& archetype, const Chunk& chunk, int column
+) {
+	return chunk.data.get() + archetype.columnOffsets[column];
+}
+
+struct EntityLocation {
+	uint32_t archetype;
+	uint32_t row;
+};
+
+// Entities reserved through a command buffer that has not been applied yet.
+constexpr uint32_t NO_ARCHETYPE = std::numeric_limits<uint32_t>::max();
+
+struct Registry {
+	algo::GenerationIndexArray entities;
+	algo::PagedArray<EntityLocation> locations;
+	std::vector<Archetype> archetypes;
+	std::map<std::vector<int>, uint32_t> archetypeLookup;
+
+   public:
+	static Registry create();
+};
+
+inline bool isAlive(const Registry& registry, Entity entity) {
+	return entity.index < algo::getCapacity(registry.entities) &&
+		   algo::isIndexValid(registry.entities, entity);
+}
+
+size_t getEntityCount(const Registry& registry);
+
+// Hands out an entity with no components and no row yet. Safe to call from
+// multiple threads, which is what lets command buffers be recorded in
+// parallel.
+[[nodiscard]]
+Entity reserveEntity(Registry& registry);
+
+// Gives a reserved entity its row. `values[i]` is copied into the column of
+// `components[i]`.
+void placeEntity(
+	Registry& registry,
+	Entity entity,
+	std::span<const ComponentInfo* const> components,
+	std::span<const void* const> values
+);
+
+void destroyEntity(Registry& registry, Entity entity);
+
+// Adds the component if the entity lacks it, then copies `value` into it.
+void setComponent(
+	Registry& registry,
+	Entity entity,
+	const ComponentInfo& component,
+	const void* value
+);
+
+void removeComponent(
+	Registry& registry, Entity entity, const ComponentInfo& component
+);
+
+void* tryGetComponent(Registry& registry, Entity entity, int componentId);
+
+template <Component... Components>
+Entity createEntity(Registry& registry, const Components&... components) {
+	const std::array<const ComponentInfo*, sizeof...(Components)> infos = {
+		&getComponentInfo<Components>()...
+	};
+	const std::array<const void*, sizeof...(Components)> values = {
+		&components...
+	};
+	const Entity entity = reserveEntity(registry);
+	placeEntity(registry, entity, infos, values);
+	return entity;
+}
+
+template <Component T>
+void addComponent(Registry& registry, Entity entity, const T& value) {
+	setComponent(registry, entity, getComponentInfo<T>(), &value);
+}
+
+template <Component T>
+void removeComponent(Registry& registry, Entity entity) {
+	removeComponent(registry, entity, getComponentInfo<T>());
+}
+
+template <Component T>
+T* tryGet(Registry& registry, Entity entity) {
+	return static_cast<T*>(
+		tryGetComponent(registry, entity, getComponentInfo<T>().id)
+	);
+}
+
+template <Component T>
+T& get(Registry& registry, Entity entity) {
+	T* component = tryGet<T>(registry, entity);
+	ASSERT(
+		component,
+		"Entity " << entity.index << " does not have the requested component"
+	);
+	return *component;
+}
+
+// Calls `function(entities, columns...)` once per chunk of every archetype that
+// has all of `Components`, where each argument is a span over the chunk's
+// contiguous column. Components may be const qualified for read-only access.
+// Structural changes during iteration must go through a CommandBuffer.
+template <typename... Components, typename Function>
+void forEachChunk(Registry& registry, Function&& function) {
+	constexpr size_t NUM_COMPONENTS = sizeof...(Components);
+	const std::array<int, NUM_COMPONENTS> componentIds = {
+		getComponentInfo<std::remove_const_t<Components>>().id...
+	};
+
+	for (const Archetype& archetype : registry.archetypes) {
+		if (archetype.count == 0) continue;
+
+		std::array<int, NUM_COMPONENTS> columns;
+		bool matches = true;
+		for (size_t i = 0; i < NUM_COMPONENTS && matches; i++) {
+			columns[i] = findColumn(archetype, componentIds[i]);
+			matches = columns[i] >= 0;
+		}
+		if (!matches) continue;
+
+		for (const Chunk& chunk : archetype.chunks) {
+			[&]<size_t... I>(std::index_sequence<I...>) {
+				function(
+					std::span<const Entity>(
+						getEntities(chunk), chunk.count
+					),
+					std::span<Components>(
+						reinterpret_cast<Components*>(
+							getColumn(archetype, chunk, columns[I])
+						),
+						chunk.count
+					)...
+				);
+			}(std::index_sequence_for<Components...>{});
+		}
+	}
+}
+
+// Calls `function(components...)` with references to the components of every
+// entity that has all of `Components`.
+template <typename... Components, typename Function>
+void forEach(Registry& registry, Function&& function) {
+	forEachChunk<Components...>(
+		registry,
+		[&](std::span<const Entity> entities,
+			std::span<Components>... columns) {
+			for (size_t i = 0; i < entities.size(); i++)
+				function(columns[i]...);
+		}
+	);
+}
+
+}  // namespace ecs
@@ -3,6 +3,8 @@
 #include <glm/glm.hpp>
 #include <vector>
 
+#include "core/math/bvh.h"
+#include "ecs/registry.h"
 #include "low_level_renderer/materials.h"
 #include "low_level_renderer/meshes.h"
 #include "low_level_renderer/pipeline_template.h"
@@ -15,10 +17,22 @@ struct StaticObjects {
 	std::vector<glm::mat4> transform;
 	std::vector<graphics::MaterialInstanceID> material;
 	std::vector<graphics::MeshID> mesh;
+	// World space, filled by buildStaticsIndex
+	std::vector<math::AABB> bounds;
+	// Filled by addToSceneGraph, for the statics added so far
+	std::vector<scene_graph::RenderObjectID> renderObject;
 };
 
 struct World {
 	StaticObjects statics;
+	// Answers frustum, overlap and ray queries over statics.bounds. Primitive
+	// indices are indices into statics.
+	math::BVH staticsIndex;
+	// Everything that moves or changes during play: enemies, projectiles, ...
+	ecs::Registry entities;
+
+   public:
+	static World create();
 };
 
 void emplaceStatics(
@@ -29,6 +43,21 @@ void emplaceStatics(
 	std::span<const graphics::MeshID> meshes
 );
 
-void addToSceneGraph(const World& world, scene_graph::Module& sceneGraph);
+// Computes the world bounds of every static and builds the index over them.
+// Call once all statics are emplaced.
+void buildStaticsIndex(World& world, const graphics::MeshStorage& meshes);
+
+// Moves statics, refits the index around their new bounds, and moves the
+// render objects of those already added to the scene graph.
+void moveStatics(
+	World& world,
+	std::span<const size_t> indices,
+	std::span<const glm::mat4> transforms,
+	const graphics::MeshStorage& meshes,
+	scene_graph::Module& sceneGraph
+);
+
+// Adds the statics emplaced since the last call.
+void addToSceneGraph(World& world, scene_graph::Module& sceneGraph);
 
 }  // namespace game_world
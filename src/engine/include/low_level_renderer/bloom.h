@@ -70,7 +70,7 @@ struct BloomGraphicsObjects {
 		static constexpr size_t NUM_BUFFERS = 2;
 
         std::array<vk::Image, NUM_BUFFERS> colorBuffer;
-        std::array<vk::DeviceMemory, NUM_BUFFERS> colorMemory;
+        std::array<DeviceAllocation, NUM_BUFFERS> colorMemory;
         std::array<std::array<vk::ImageView, NUM_BLOOM_MIPS>, NUM_BUFFERS> colorViews;
 		struct Descriptors {
 			std::array<vk::DescriptorSet, NUM_BLOOM_LAYERS> downsample;
@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.hpp>
 
 #include "low_level_renderer/descriptor_write_buffer.h"
+#include "low_level_renderer/device_memory.h"
 
 namespace graphics {
 enum class DataBufferType {
@@ -13,7 +14,7 @@ enum class DataBufferType {
 template <typename T, DataBufferType bufferType>
 struct DataBuffer {
     vk::Buffer buffer;
-    vk::DeviceMemory memory;
+    DeviceAllocation memory;
     void* mappedMemory;
     uint16_t dataCount;
 
@@ -36,4 +37,21 @@ using UniformBuffer = DataBuffer<T, DataBufferType::UNIFORM>;
 
 template <typename T>
 using StorageBuffer = DataBuffer<T, DataBufferType::STORAGE>;
+
+// Untyped host-visible buffer, mapped for its whole lifetime. For data that
+// is rewritten every frame and sized at runtime.
+struct MappedBuffer {
+    vk::Buffer buffer;
+    DeviceAllocation memory;
+    void* mappedMemory;
+
+   public:
+    static MappedBuffer create(
+        const vk::Device& device,
+        const vk::PhysicalDevice& physicalDevice,
+        vk::DeviceSize size,
+        vk::BufferUsageFlags usage
+    );
+    void destroyBy(const vk::Device& device) const;
+};
 }  // namespace Graphics
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "core/algo/range_allocator.h"
+
+namespace graphics {
+
+// How a block hands out its memory. Free list blocks take and return ranges
+// in any order. Linear blocks only move forward and start over once all of
+// their allocations are released, which suits short lived staging buffers.
+enum class AllocationStrategy { eFreeList, eLinear };
+
+// Optimal tiling images never share a block with buffers and linear images,
+// so neighbours never need to be bufferImageGranularity apart.
+enum class ResourceKind { eLinear, eOptimalImage };
+
+struct DeviceAllocation {
+	vk::DeviceMemory memory;
+	vk::DeviceSize offset;
+	vk::DeviceSize size;
+	// Into the memory's persistent mapping, null unless it is host visible
+	void* mapped;
+	// Index into the allocator's pools, or empty for memory of its own
+	std::optional<uint32_t> pool;
+};
+
+// Memory blocks of one memory type, resource kind and strategy
+struct DeviceMemoryPool {
+	struct Block {
+		vk::DeviceMemory memory;
+		void* mapped;
+		// Free ranges of free list blocks
+		algo::RangeAllocator ranges;
+		// Next offset of linear blocks
+		vk::DeviceSize head;
+		uint32_t allocationCount;
+	};
+
+	std::vector<Block> blocks;
+};
+
+struct DeviceMemoryStats {
+	// Calls to vkAllocateMemory that are still live
+	uint32_t blockCount;
+	uint32_t dedicatedCount;
+	uint32_t allocationCount;
+	vk::DeviceSize usedBytes;
+	vk::DeviceSize reservedBytes;
+};
+
+// Sub-allocates buffers and images from large blocks of device memory, so
+// that the driver sees a handful of allocations rather than one per
+// resource. Host visible blocks are mapped once, for their whole lifetime.
+// Safe to use from the game and render threads at once.
+struct DeviceMemoryAllocator {
+	static constexpr uint32_t POOLS_PER_MEMORY_TYPE = 4;
+
+	vk::Device device;
+	vk::PhysicalDeviceMemoryProperties memoryProperties;
+	// Per memory type, as the heap they are in may be small
+	std::array<vk::DeviceSize, VK_MAX_MEMORY_TYPES> blockSizes;
+	std::array<DeviceMemoryPool, VK_MAX_MEMORY_TYPES * POOLS_PER_MEMORY_TYPE>
+		pools;
+	DeviceMemoryStats stats;
+	std::unique_ptr<std::mutex> mutex;
+
+   public:
+	static DeviceMemoryAllocator create(
+		vk::Device device, vk::PhysicalDevice physicalDevice
+	);
+};
+
+// Created and destroyed with the graphics device
+extern std::optional<DeviceMemoryAllocator> deviceMemory;
+
+// `memoryType` is one of those allowed by `requirements`
+[[nodiscard]]
+DeviceAllocation allocate(
+	DeviceMemoryAllocator& allocator,
+	const vk::MemoryRequirements& requirements,
+	uint32_t memoryType,
+	ResourceKind kind,
+	AllocationStrategy strategy
+);
+void release(
+	DeviceMemoryAllocator& allocator, const DeviceAllocation& allocation
+);
+
+DeviceMemoryStats getStats(DeviceMemoryAllocator& allocator);
+// Logs the stats of every memory type in use
+void logStats(DeviceMemoryAllocator& allocator);
+
+// Frees every block, logging the allocations that were never released.
+void destroy(DeviceMemoryAllocator& allocator);
+
+}  // namespace graphics
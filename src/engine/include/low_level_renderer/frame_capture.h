@@ -0,0 +1,86 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "low_level_renderer/materials.h"
+#include "low_level_renderer/meshes.h"
+#include "low_level_renderer/render_submission.h"
+#include "low_level_renderer/shader_data.h"
+#include "low_level_renderer/texture.h"
+
+namespace graphics {
+
+struct TextureSource {
+	std::string filePath;
+	TextureFormatHint formatHint;
+};
+
+// How the renderer's textures and materials were created, so that a capture
+// can create them again. Meshes are read back from the GPU instead.
+struct AssetSources {
+	// Indexed by TextureID::index
+	std::vector<TextureSource> textures;
+	// Indexed by the material's index
+	std::vector<MaterialCreateInfo> materials;
+};
+
+struct CapturedMesh {
+	std::vector<Vertex> vertices;
+	std::vector<IndexType> indices;
+};
+
+struct CapturedFrame {
+	RenderSubmissionCopy submission;
+	GPUSceneData sceneData;
+};
+
+// Frames as data, with only the assets they reference. Mesh and material IDs
+// in the frames are positions in `meshes` and `materials`, with a generation
+// of 0, and the materials' texture IDs are positions in `textures`.
+struct FrameCapture {
+	std::vector<TextureSource> textures;
+	std::vector<MaterialCreateInfo> materials;
+	std::vector<CapturedMesh> meshes;
+	std::vector<CapturedFrame> frames;
+};
+
+// Collects frames on the render thread until the capture is finished.
+struct FrameRecorder {
+	std::vector<CapturedFrame> frames;
+	// Live IDs of what the frames reference, by position in the capture
+	std::vector<MeshID> meshes;
+	std::vector<MaterialInstanceID> materials;
+	// Positions in the capture, by live index
+	std::unordered_map<uint32_t, uint32_t> meshPositions;
+	std::unordered_map<uint32_t, uint32_t> materialPositions;
+};
+
+void record(
+	FrameRecorder& recorder,
+	const RenderSubmission& submission,
+	const GPUSceneData& sceneData
+);
+// Reads the referenced meshes back from the GPU, which waits for the copies,
+// and leaves the recorder empty.
+[[nodiscard]]
+FrameCapture finish(
+	FrameRecorder& recorder,
+	const AssetSources& sources,
+	const MeshStorage& meshes,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	vk::CommandPool commandPool,
+	vk::Queue graphicsQueue
+);
+
+// The file holds the structs as they are in memory, so it can only be read
+// back by a build for the same architecture.
+bool writeCapture(const FrameCapture& capture, std::string_view filePath);
+std::optional<FrameCapture> loadCapture(std::string_view filePath);
+
+}  // namespace graphics
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <vulkan/vulkan.hpp>
+
+#include "low_level_renderer/config.h"
+
+namespace graphics {
+
+// Measures how long the GPU spends on a frame's command buffer, with a pair
+// of timestamps per frame in flight. Results are read once the frame's fence
+// has been waited on, so reading them never stalls.
+struct GPUTimer {
+	std::array<vk::QueryPool, MAX_FRAMES_IN_FLIGHT> queryPools;
+	// Nanoseconds per timestamp tick
+	float timestampPeriod;
+	// Some devices can't write timestamps on the graphics queue
+	bool isSupported;
+	// Whether each frame's queries were written since they were last read
+	std::array<bool, MAX_FRAMES_IN_FLIGHT> isWritten;
+
+   public:
+	static GPUTimer create(vk::Device device, vk::PhysicalDevice physicalDevice);
+};
+
+// Around everything the frame's primary command buffer records.
+void recordBegin(
+	GPUTimer& timer, vk::CommandBuffer buffer, uint32_t currentFrame
+);
+void recordEnd(
+	const GPUTimer& timer, vk::CommandBuffer buffer, uint32_t currentFrame
+);
+
+// Of the last time this frame was recorded. Empty if timestamps are not
+// supported or the frame was never recorded.
+std::optional<std::chrono::duration<float, std::milli>> getElapsed(
+	GPUTimer& timer, vk::Device device, uint32_t currentFrame
+);
+
+void destroy(const GPUTimer& timer, vk::Device device);
+
+}  // namespace graphics
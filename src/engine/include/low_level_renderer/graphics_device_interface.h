@@ -12,9 +12,11 @@
 #include "low_level_renderer/queue_family.h"
 #include "low_level_renderer/radiance_cascade.h"
 #include "low_level_renderer/sampler.h"
+#include "low_level_renderer/secondary_commands.h"
 #include "low_level_renderer/shader_data.h"
 #include "low_level_renderer/shaders.h"
 #include "low_level_renderer/swapchain_data.h"
+#include "low_level_renderer/transfer.h"
 
 constexpr char APP_SHORT_NAME[] = "Game";
 constexpr char ENGINE_NAME[] = "Liebeskind";
@@ -28,6 +30,8 @@ struct GraphicsDeviceInterface {
 		vk::CommandBuffer drawCommandBuffer;
 		vk::Semaphore isImageAvailable;
 		vk::Fence isRenderingInFlight;
+		// One per chunk of the main pass recorded in parallel, grown on demand
+		std::vector<SecondaryCommands> secondaryCommands;
 	};
 	std::array<FrameData, MAX_FRAMES_IN_FLIGHT> frameDatas;
 
@@ -45,7 +49,6 @@ struct GraphicsDeviceInterface {
 	MaterialPipeline pipeline;
 	struct Shaders {
 		UncompiledShader vertex;
-		UncompiledShader vertexInstanced;
 		UncompiledShader fragment;
 	};
 	Shaders mainShaders;
@@ -54,6 +57,7 @@ struct GraphicsDeviceInterface {
     RadianceCascadeData radianceCascade;
 
 	vk::CommandPool commandPool;
+	TransferManager transfers;
 	Samplers samplers;
 
 	uint32_t currentFrame = 0;
@@ -1,36 +1,99 @@
 #pragma once
 
+#include <array>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
+#include <vector>
 
 #include "SDL3/SDL_events.h"
+#include "low_level_renderer/frame_capture.h"
+#include "low_level_renderer/gpu_timer.h"
 #include "low_level_renderer/graphics_device_interface.h"
 #include "low_level_renderer/graphics_user_interface.h"
+#include "low_level_renderer/indirect_drawing.h"
 #include "low_level_renderer/instance_rendering.h"
 #include "low_level_renderer/materials.h"
 #include "low_level_renderer/render_submission.h"
 #include "low_level_renderer/shaders.h"
+#include "low_level_renderer/submission_queue.h"
 #include "low_level_renderer/vertex_buffer.h"
 
 namespace graphics {
 struct Module {
 	GraphicsDeviceInterface device;
 	GraphicsUserInterface ui;
-	RenderInstanceManager instances;
+	ObjectDataBuffer objectData;
+	// Where this frame's submission went in the object data
+	ObjectDataLayout objectDataLayout;
+	IndirectDrawData indirect;
 	ShaderStorage shaders;
 	TextureStorage textures;
 	MaterialStorage materials;
 	MeshStorage meshes;
+	// Kept so that frame captures can create the same assets again
+	AssetSources assetSources;
+
+	// Frames are built on the game thread and drawn on the render thread,
+	// which only reads the snapshots handed to it through this queue.
+	std::unique_ptr<SubmissionQueue> submissions;
+	std::thread renderThread;
+	// Held by the render thread while it draws a snapshot, and by the game
+	// thread while it loads or changes assets. Drawing reads the asset
+	// storages and flushes the descriptor write buffer both threads write to,
+	// and loads may submit to the render thread's queue. On the heap, like
+	// the submission queue, so the module can move.
+	std::unique_ptr<std::mutex> renderMutex;
+
+	// Game thread state, copied into every snapshot
 	vk::Rect2D mainWindowExtent;
+	BloomGraphicsObjects::Config bloomConfig;
+	std::optional<BloomGraphicsObjects::Config> pendingBloomConfig;
+	// Caps how many chunks of opaque draws the main pass is recorded in. Set
+	// from the UI to compare recording time across thread counts.
+	uint32_t maxRecordingThreads;
+	std::vector<PipelineSpecializationConstants> pendingVariants;
+	std::optional<SDL_Event> pendingResize;
+	uint32_t framesToCapture;
+	// Counts down over the snapshots being captured
+	uint32_t capturedFramesLeft;
+	// Of the last frame the render thread finished
+	FrameStats stats;
+
+	// Render thread state
+	FrameStats renderStats;
+	GPUTimer gpuTimer;
+	FrameRecorder frameRecorder;
+	// Scratch for the secondary buffers the main pass executes
+	std::vector<vk::CommandBuffer> secondaryBuffers;
+	// Geometry buffers retired by the snapshots each frame in flight drew,
+	// destroyed once that frame is done. Those of a snapshot whose frame was
+	// never submitted wait for the next frame that is.
+	std::array<std::vector<RetiredBuffer>, MAX_FRAMES_IN_FLIGHT>
+		retiredGeometry;
+	std::vector<RetiredBuffer> pendingRetiredGeometry;
 
    public:
 	static Module create();
+	// Takes the module's address, so it must be in its final place
+	void startRenderThread();
+	// Drops snapshots not drawn yet. Must happen before the job scheduler
+	// stops, as the render thread records with jobs.
+	void stopRenderThread();
 	void destroy();
 
+	// Game thread
 	void beginFrame();
 	void handleEvent(const SDL_Event& event);
-	bool drawFrame(RenderSubmission& renderSubmission, GPUSceneData& sceneData);
-	void endFrame();
+	// Blocks while the render thread is the queue depth behind. Returns false
+	// once the render thread has stopped.
+	bool drawFrame(
+		const RenderSubmission& renderSubmission, const GPUSceneData& sceneData
+	);
 
+	// Loads wait for the render thread to finish drawing its current
+	// snapshot, so they are best kept to loading screens
 	[[nodiscard]] TextureID loadTexture(
 		std::string_view filePath, TextureFormatHint formatHint
 	);
@@ -42,19 +105,34 @@ struct Module {
 	[[nodiscard]] MaterialInstanceID loadMaterial(
 		const MaterialCreateInfo& createInfo
 	);
-	[[nodiscard]] RenderInstanceID registerInstance(uint16_t numberOfEntries);
+	// Waits for every queued snapshot to be drawn and for the device, as
+	// frames may still draw the mesh and later loads reuse its range. Meant
+	// for level transitions rather than for every frame.
+	void unloadMesh(MeshID mesh);
+	// Closes the gaps unloading left in the geometry. Waits like unloadMesh,
+	// as queued snapshots would draw the moved meshes from their old ranges.
+	void defragmentMeshes();
 
+	// Created by the render thread before it draws the next snapshot.
 	void createPipelineVariant(
 		const PipelineSpecializationConstants& specializationConstants
 	);
 
 	void updateMaterial(
 		MaterialInstanceID material, const MaterialProperties& properties
-	) const;
+	);
 
    private:
+	// Render thread
+	void renderLoop();
+	bool renderFrame(SubmissionSnapshot& snapshot);
+	void endFrame();
+	void buildPipelineVariant(
+		const PipelineSpecializationConstants& specializationConstants
+	);
 	void recordCommandBuffer(
 		RenderSubmission& renderSubmission,
+		const SubmissionSnapshot& snapshot,
 		vk::CommandBuffer buffer,
 		uint32_t image_index
 	);
@@ -17,9 +17,7 @@ struct GraphicsUserInterface {
 
    public:
     static GraphicsUserInterface create(GraphicsDeviceInterface& device);
-    void handleEvent(
-        const SDL_Event& event, const GraphicsDeviceInterface& device
-    );
+    void handleEvent(const SDL_Event& event);
     void recreateRenderpassAndFramebuffers(const GraphicsDeviceInterface& device
     );
     void destroy(GraphicsDeviceInterface& device);
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "low_level_renderer/config.h"
+#include "low_level_renderer/data_buffer.h"
+#include "low_level_renderer/descriptor_allocator.h"
+#include "low_level_renderer/descriptor_write_buffer.h"
+#include "low_level_renderer/material_pipeline.h"
+#include "low_level_renderer/render_submission.h"
+#include "low_level_renderer/shaders.h"
+#include "low_level_renderer/vertex_buffer.h"
+
+namespace graphics {
+
+struct IndirectCullingPushConstants {
+	std::array<glm::vec4, 6> planes;
+	glm::vec3 cameraPosition;
+	uint32_t objectCount;
+};
+
+// GPU-driven drawing of the submission's indirect objects. A compute pass
+// frustum culls every object, then each meshlet of the visible ones against
+// the frustum and its normal cone, and appends a draw command for each
+// visible meshlet to its bucket's range of the command buffer, counting them
+// per bucket. Each bucket is then drawn with one drawIndexedIndirectCount, so
+// recording costs the same however many objects there are. Needs nothing
+// past core compute, so it runs where mesh shaders do not.
+struct IndirectDrawData {
+	// Written every frame, so there is one set per frame in flight
+	struct FrameData {
+		MappedBuffer objects;
+		// InstanceData, read by the culling pass and the vertex shader
+		MappedBuffer transforms;
+		// Transforms the submissions since this frame's last upload changed,
+		// for the next upload to copy. Everything is copied instead while
+		// `isStale`.
+		std::vector<IndirectRange> changedTransforms;
+		bool isStale;
+		// One per meshlet of every object
+		MappedBuffer commands;
+		// One draw count per bucket. Host visible so the results of the
+		// frame can be read back once it is done.
+		MappedBuffer counts;
+		uint32_t objectCapacity;
+		uint32_t commandCapacity;
+		uint32_t bucketCapacity;
+		// Buckets culled the last time this frame was recorded
+		uint32_t numBuckets;
+
+		vk::DescriptorSet cullingSet;
+		// Binds the transforms in place of the object data
+		vk::DescriptorSet transformSet;
+		// The geometry's meshlet buffer as the culling set last bound it
+		vk::Buffer meshletBuffer;
+	};
+	std::array<FrameData, MAX_FRAMES_IN_FLIGHT> frameDatas;
+
+	ShaderID compute;
+	vk::DescriptorSetLayout setLayout;
+	vk::DescriptorPool pool;
+	vk::PipelineLayout pipelineLayout;
+	vk::Pipeline pipeline;
+
+   public:
+	static IndirectDrawData create(
+		vk::Device device,
+		vk::PhysicalDevice physicalDevice,
+		ShaderStorage& shaders,
+		PipelineDescriptorData& instanceRenderingDescriptor,
+		DescriptorWriteBuffer& writeBuffer
+	);
+};
+
+// Brings this frame's buffers up to date with the submission's indirect
+// objects, growing them if needed, and binds the meshlets of the geometry its
+// snapshot captured. Only the ranges changed since the frame last uploaded
+// are copied, unless the layout changed. Must be called for every submission,
+// in order, once the frame's previous use on the GPU has finished and before
+// recording it.
+void upload(
+	IndirectDrawData& indirect,
+	const RenderSubmission& renderSubmission,
+	const GeometryHandles& geometry,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	DescriptorWriteBuffer& writeBuffer,
+	uint32_t currentFrame
+);
+
+// Outside of any render pass, before the draws. Meshlets facing away from
+// `cameraPosition` are culled along with those outside the frustum.
+void recordCulling(
+	const IndirectDrawData& indirect,
+	const RenderSubmission& renderSubmission,
+	glm::vec3 cameraPosition,
+	vk::CommandBuffer buffer,
+	uint32_t currentFrame
+);
+
+// Binds the frame's transforms in place of the object data, which has to be
+// bound again for any draw after these. Expects the meshes to be bound, and
+// binds the index buffer for each bucket's index type.
+void recordIndirectDrawCalls(
+	const IndirectDrawData& indirect,
+	const RenderSubmission& renderSubmission,
+	vk::CommandBuffer buffer,
+	vk::PipelineLayout pipelineLayout,
+	const MaterialPipeline& pipelines,
+	const MaterialStorage& materials,
+	const GeometryHandles& geometry,
+	uint32_t currentFrame
+);
+
+// Meshlets the GPU found visible the last time this frame was culled. Only
+// valid once that frame has finished, so call it before `upload`.
+uint32_t getVisibleCount(
+	const IndirectDrawData& indirect, uint32_t currentFrame
+);
+
+void destroy(const IndirectDrawData& indirect, vk::Device device);
+
+}  // namespace graphics
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <glm/glm.hpp>
+#include <vector>
 
 #include "low_level_renderer/config.h"
 #include "low_level_renderer/data_buffer.h"
@@ -9,55 +10,55 @@
 #include "low_level_renderer/descriptor_write_buffer.h"
 
 namespace graphics {
+// Everything the vertex shader knows of one drawn object. Room for more, such
+// as the previous frame's transform.
 struct InstanceData {
     alignas(16) glm::mat4 transform;
 };
 
-struct RenderInstance {
-    StorageBuffer<InstanceData> storageBuffer;
-    vk::DescriptorSet descriptorSet;
-};
-
-struct RenderInstanceID {
-    uint16_t index;
-
-    bool operator==(const RenderInstanceID& other) const;
-};
-
-struct RenderInstanceIDHashFunction {
-    size_t operator()(const RenderInstanceID& pos) const;
-};
-
-struct RenderInstanceManager {
-    std::vector<std::array<RenderInstance, MAX_FRAMES_IN_FLIGHT>>
-        renderInstances;
+// Object data of every draw in the frame, one entry per instance, written in
+// a single linear pass before recording. It stays bound as the instance
+// rendering set for the whole main pass, and each draw finds its entries
+// through firstInstance, so regular draws are just draws of one instance.
+struct ObjectDataBuffer {
+    // Written every frame, so there is one per frame in flight
+    struct FrameData {
+        MappedBuffer buffer;
+        uint32_t capacity;
+        vk::DescriptorSet descriptorSet;
+    };
+    std::array<FrameData, MAX_FRAMES_IN_FLIGHT> frameDatas;
 
    public:
     [[nodiscard]]
-    RenderInstanceID create(
+    static ObjectDataBuffer create(
         vk::Device device,
         vk::PhysicalDevice physicalDevice,
         vk::DescriptorSetLayout setLayout,
         DescriptorAllocator& descriptorAllocator,
-        DescriptorWriteBuffer& writeBuffer,
-        uint16_t numberOfEntries
+        DescriptorWriteBuffer& writeBuffer
     );
+};
 
-    void bind(
-        vk::CommandBuffer commandBuffer,
-        vk::PipelineLayout layout,
-        RenderInstanceID id,
-        uint32_t currentFrame
-    ) const;
-
-    void update(
-        RenderInstanceID id,
-        uint32_t currentFrame,
-        std::span<const InstanceData> instanceData
-    ) const;
+// Makes room for `count` entries in the frame's buffer and returns where they
+// are mapped. Growing rewrites the frame's descriptor set, so it must only be
+// called once the frame's previous use on the GPU has finished.
+[[nodiscard]]
+InstanceData* reserve(
+    ObjectDataBuffer& objectData,
+    vk::Device device,
+    vk::PhysicalDevice physicalDevice,
+    DescriptorWriteBuffer& writeBuffer,
+    uint32_t currentFrame,
+    uint32_t count
+);
 
-    uint16_t getCapacity(RenderInstanceID id) const;
+void bind(
+    const ObjectDataBuffer& objectData,
+    vk::CommandBuffer commandBuffer,
+    vk::PipelineLayout layout,
+    uint32_t currentFrame
+);
 
-    void destroyBy(const vk::Device& device) const;
-};
+void destroy(const ObjectDataBuffer& objectData, vk::Device device);
 }  // namespace Graphics
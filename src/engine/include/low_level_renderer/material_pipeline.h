@@ -34,11 +34,12 @@ struct MaterialPipeline {
 		vk::Pipeline,
 		PipelineSpecializationConstantsHashFunction>;
 
-	PipelineTemplate pipelineTemplate;
-	VariantMap regularPipelineVariants;
-	VariantMap instanceRenderingPipelineVariants;
-	vk::PipelineLayout regularPipelineLayout;
-	vk::PipelineLayout instanceRenderingPipelineLayout;
+	// Indexed by RenderQueue
+	std::array<PipelineTemplate, RENDER_QUEUE_COUNT> pipelineTemplates;
+	// Every draw reads its transform from the object data, so one pipeline
+	// per variant serves single and instanced draws alike
+	VariantMap pipelineVariants;
+	vk::PipelineLayout pipelineLayout;
 	PipelineData postProcessingPipeline;
 	PipelineDescriptorData globalDescriptor;
 	PipelineDescriptorData instanceRenderingDescriptor;
@@ -54,7 +55,7 @@ struct MaterialPipeline {
 	);
 };
 
-std::array<vk::PipelineLayout, 2> createMainPipelinesLayouts(
+vk::PipelineLayout createMainPipelineLayout(
 	vk::Device device,
 	const PipelineDescriptorData& globalDescriptorData,
 	const PipelineDescriptorData& materialDescriptorData,
@@ -74,7 +75,6 @@ void createNewVariant(
 	vk::Device device,
 	vk::RenderPass renderPass,
 	vk::ShaderModule vertexShader,
-	vk::ShaderModule vertexShaderInstanced,
 	vk::ShaderModule fragmentShader
 );
 
@@ -83,12 +83,7 @@ bool hasPipeline(
 	const PipelineSpecializationConstants& specializationConstants
 );
 
-vk::Pipeline getRegularPipeline(
-	const MaterialPipeline& materialPipeline,
-	const PipelineSpecializationConstants& specializationConstants
-);
-
-vk::Pipeline getInstanceRenderingPipeline(
+vk::Pipeline getPipeline(
 	const MaterialPipeline& materialPipeline,
 	const PipelineSpecializationConstants& specializationConstants
 );
@@ -5,6 +5,7 @@
 #include <vulkan/vulkan.hpp>
 
 #include "core/algo/generation_index_array.h"
+#include "core/algo/paged_array.h"
 #include "low_level_renderer/data_buffer.h"
 #include "low_level_renderer/descriptor_allocator.h"
 #include "low_level_renderer/pipeline_template.h"
@@ -13,7 +14,6 @@
 
 namespace graphics {
 
-constexpr int MAX_MATERIAL_INSTANCES = 10000;
 constexpr std::array<vk::DescriptorSetLayoutBinding, 5> MATERIAL_BINDINGS = {
 	vk::DescriptorSetLayoutBinding{
 		0,	// binding
@@ -73,15 +73,15 @@ struct MaterialProperties {
 	alignas(16) glm::vec3 ambient = glm::vec3(1.0, 1.0, 1.0);
 	alignas(16) glm::vec3 emission = glm::vec3(0.0, 0.0, 0.0);
 	alignas(4) float shininess = 32;
+	// Only read by materials in the transparent queue
+	alignas(4) float opacity = 1;
 };
 
 struct MaterialStorage {
-	algo::GenerationIndexArray<MAX_MATERIAL_INSTANCES> indices;
-	std::array<vk::DescriptorSet, MAX_MATERIAL_INSTANCES> descriptors;
-	std::array<UniformBuffer<MaterialProperties>, MAX_MATERIAL_INSTANCES>
-		uniforms;
-	std::array<PipelineSpecializationConstants, MAX_MATERIAL_INSTANCES>
-		specializationConstant;
+	algo::GenerationIndexArray indices;
+	algo::PagedArray<vk::DescriptorSet> descriptors;
+	algo::PagedArray<UniformBuffer<MaterialProperties>> uniforms;
+	algo::PagedArray<PipelineSpecializationConstants> specializationConstant;
 
    public:
 	static MaterialStorage create();
@@ -94,6 +94,7 @@ struct MaterialCreateInfo {
 	std::optional<TextureID> emission;
 	MaterialProperties materialProperties;
 	SamplerType sampler;
+	RenderQueue queue = RenderQueue::eOpaque;
 };
 
 PipelineSpecializationConstants createSpecializationConstant(
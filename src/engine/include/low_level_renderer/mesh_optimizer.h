@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <glm/vec4.hpp>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "low_level_renderer/vertex.h"
+
+namespace graphics {
+
+// Entries of the FIFO post-transform cache that triangles are ordered for,
+// and that the statistics simulate
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+// How much worse than Tipsify's order the overdraw pass lets ACMR get
+constexpr float OVERDRAW_ACMR_THRESHOLD = 1.05f;
+// Meshlets stop growing at whichever limit they reach first
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+struct MeshOptimizationStats {
+	// Vertex shader invocations per triangle, from 0.5 at best to 3
+	float acmr;
+	// Vertex shader invocations per vertex, 1 at best
+	float atvr;
+	// Bytes of packed vertices fetched per byte of the vertex buffer, 1 at
+	// best. Simulates a small cache of 64 byte lines.
+	float overfetch;
+};
+
+// A run of a mesh's triangles that the culling pass draws or skips as a
+// whole, laid out for std430. Its indices stay relative to the mesh's first
+// vertex, so it needs no vertex buffer of its own.
+struct Meshlet {
+	// Object space center and radius
+	glm::vec4 boundingSphere;
+	// Unit axis of the cone holding every triangle normal, and the sine of
+	// its half angle. The meshlet faces away from a viewer at v when
+	// dot(c - v, axis) >= w * length(c - v) + radius, c being the center. A
+	// w of 1 never passes.
+	glm::vec4 cone;
+	// Relative to the mesh's first index
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	std::array<uint32_t, 2> padding;
+};
+static_assert(sizeof(Meshlet) == 48);
+
+MeshOptimizationStats analyze(
+	std::span<const IndexType> indices, size_t vertexCount
+);
+
+// Reorders triangles for the post-transform cache with Tipsify, from Sander
+// et al., "Fast Triangle Reordering for Vertex Locality and Reduced
+// Overdraw".
+void optimizeVertexCache(std::span<IndexType> indices, size_t vertexCount);
+// Splits the triangles into clusters wherever the cache order allows, and
+// draws the clusters facing away from the mesh's centre first, as they are
+// the likeliest to occlude the others. Expects the order of
+// optimizeVertexCache.
+void optimizeOverdraw(
+	std::span<IndexType> indices,
+	std::span<const Vertex> vertices,
+	float threshold = OVERDRAW_ACMR_THRESHOLD
+);
+// Orders vertices by first use, dropping those no triangle uses, so the
+// vertex shader reads the vertex buffer mostly in order.
+void optimizeVertexFetch(
+	std::vector<Vertex>& vertices, std::span<IndexType> indices
+);
+
+// Splits the triangles into meshlets in the order they are in, so their
+// indices need no reordering and the cache order is kept.
+std::vector<Meshlet> buildMeshlets(
+	std::span<const Vertex> vertices, std::span<const IndexType> indices
+);
+
+// Runs every pass in order, logging the stats before and after under `name`.
+void optimizeMesh(
+	std::vector<Vertex>& vertices,
+	std::vector<IndexType>& indices,
+	std::string_view name
+);
+
+}  // namespace graphics
@@ -1,16 +1,19 @@
 #pragma once
 
 #include "core/algo/generation_index_array.h"
+#include "core/algo/paged_array.h"
 #include "low_level_renderer/vertex_buffer.h"
 
 namespace graphics {
-constexpr size_t MAX_MESHES = 1000;
-
 using MeshID = algo::GenerationIndexPair;
 
 struct MeshStorage {
-	std::array<VertexBuffer, MAX_MESHES> meshes;
-	algo::GenerationIndexArray<MAX_MESHES> indices;
+	algo::PagedArray<MeshRange> meshes;
+	algo::GenerationIndexArray indices;
+	GeometryBuffer geometry;
+	// Bumped whenever loaded meshes move within the geometry, so that copies
+	// of their ranges know to refresh
+	uint32_t layoutVersion;
 
    public:
 	static MeshStorage create();
@@ -21,8 +24,7 @@ MeshID load(
 	MeshStorage& storage,
 	vk::Device device,
 	vk::PhysicalDevice physicalDevice,
-	vk::CommandPool commandPool,
-	vk::Queue graphicsQueue,
+	TransferManager& transfers,
     std::string_view meshFilePath
 );
 
@@ -33,25 +35,45 @@ MeshID load(
 	const std::vector<graphics::IndexType>& indices,
 	vk::Device device,
 	vk::PhysicalDevice physicalDevice,
-	vk::CommandPool commandPool,
-	vk::Queue graphicsQueue
+	TransferManager& transfers
 );
 
-void bind(
-	const MeshStorage& storage, vk::CommandBuffer commandBuffer, MeshID mesh
+// Object-space bounds of the mesh's vertices
+const math::Bounds& getBounds(const MeshStorage& storage, MeshID mesh);
+const MeshRange& getRange(const MeshStorage& storage, MeshID mesh);
+void readBack(
+	const MeshStorage& storage,
+	MeshID mesh,
+	std::vector<Vertex>& vertices,
+	std::vector<IndexType>& indices,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	vk::CommandPool commandPool,
+	vk::Queue graphicsQueue
 );
 
+// Draws from the geometry's buffers, which must already be bound: vertices
+// once, and indices for the mesh's index type
 void draw(
 	const MeshStorage& storage,
 	vk::CommandBuffer commandBuffer,
 	MeshID mesh,
-	uint16_t instanceCount = 1
+	uint16_t instanceCount = 1,
+	uint32_t firstInstance = 0
 );
 
 void unload(
 	MeshStorage& storage,
-	std::span<const algo::GenerationIndexPair> indices,
-	vk::Device device
+	std::span<const algo::GenerationIndexPair> indices
+);
+// Closes the gaps that unloading left in the geometry buffer. Moves the
+// meshes within it, so no snapshot captured before may still be waiting to
+// be drawn.
+void defragment(
+	MeshStorage& storage,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	TransferManager& transfers
 );
 
 void destroy(const MeshStorage& storage, vk::Device device);
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Which pipeline variant a draw uses, apart from the pipelines themselves so
+// that sort keys can be built without a device.
+
+namespace graphics {
+
+enum SamplerInclusionBits : uint32_t {
+	eNone = 0,
+	eAlbedo = 1,
+	eNormal = 2,
+	eDisplacement = 4,
+	eEmission = 8,
+};
+
+enum class ParallaxMappingMode : uint32_t {
+	eBasic = 0,
+	eSteep = 1,
+	eParallaxOcclusion = 2,
+	eDeluxe = 3
+};
+
+// Opaque objects are drawn first, front to back, and write depth. Transparent
+// ones are blended over them back to front and only test depth.
+enum class RenderQueue : uint32_t {
+	eOpaque = 0,
+	eTransparent = 1,
+};
+constexpr size_t RENDER_QUEUE_COUNT = 2;
+
+using SamplerInclusion = uint32_t;
+
+struct PipelineSpecializationConstants {
+	SamplerInclusion samplerInclusion;
+	ParallaxMappingMode parallaxMappingMode = ParallaxMappingMode::eDeluxe;
+	// Not a specialization constant, but picks the pipeline template
+	RenderQueue queue = RenderQueue::eOpaque;
+
+   public:
+	bool operator==(const PipelineSpecializationConstants& other) const {
+		return samplerInclusion == other.samplerInclusion &&
+			   parallaxMappingMode == other.parallaxMappingMode &&
+			   queue == other.queue;
+	}
+
+	bool operator<(const PipelineSpecializationConstants& other) const {
+		if (queue != other.queue) return queue < other.queue;
+		if (samplerInclusion == other.samplerInclusion)
+			return parallaxMappingMode < other.parallaxMappingMode;
+		return samplerInclusion < other.samplerInclusion;
+	}
+};
+
+struct PipelineSpecializationConstantsHashFunction {
+	inline size_t operator()(const PipelineSpecializationConstants& p) const {
+		return (static_cast<size_t>(p.queue) << 6) +
+			   (p.samplerInclusion << 2) +
+			   static_cast<size_t>(p.parallaxMappingMode);
+	}
+};
+
+}  // namespace graphics
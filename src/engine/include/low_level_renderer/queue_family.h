@@ -7,6 +7,9 @@ namespace graphics {
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsAndComputeFamily;
     std::optional<uint32_t> presentFamily;
+    // A family that only transfers, usually backed by the DMA engines. Empty
+    // on devices without one, where transfers go to the graphics family.
+    std::optional<uint32_t> transferFamily;
 
     bool isComplete();
 
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <span>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 
+#include "core/math/frustum.h"
 #include "low_level_renderer/instance_rendering.h"
 #include "low_level_renderer/material_pipeline.h"
 #include "low_level_renderer/materials.h"
 #include "low_level_renderer/meshes.h"
+#include "low_level_renderer/sort_key.h"
 
 namespace graphics {
 struct RenderObject {
@@ -18,59 +22,160 @@ struct RenderObject {
 
 struct InstancedRenderObject {
 	PipelineSpecializationConstants variant;
-	RenderInstanceID instance;
 	MaterialInstanceID material;
 	MeshID mesh;
 	uint16_t count;
 };
 
+// What the GPU culling pass reads of an object, laid out for std430. Its
+// transform is kept apart, as InstanceData, so that draws can read it the way
+// they read the object data.
+struct IndirectObject {
+	// Object space center and radius
+	glm::vec4 boundingSphere;
+	// The mesh's range in the geometry buffer, each of its meshlets drawn
+	// from firstIndex on
+	uint32_t firstMeshlet;
+	uint32_t meshletCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+	// The bucket's first command, and its entry in the draw counts
+	uint32_t firstCommand;
+	uint32_t bucket;
+	// Only read on the CPU, to find the range again once the meshes move or
+	// are loaded anew, as a replay does
+	MeshID mesh;
+
+   public:
+	// With the range and bounds `mesh` has in `meshes`
+	static IndirectObject create(
+		const MeshStorage& meshes,
+		MeshID mesh,
+		uint32_t firstCommand,
+		uint32_t bucket
+	);
+};
+
+// Objects that share variant, material and index type, drawn by a single
+// indirect draw whose count the culling pass writes. The culling pass writes
+// one command per visible meshlet, which carries the meshlet's own first
+// index and vertex offset, so the objects' meshes may differ.
+struct IndirectBucket {
+	PipelineSpecializationConstants variant;
+	MaterialInstanceID material;
+	vk::IndexType indexType;
+	uint32_t firstCommand;
+	// Meshlets of every object in the bucket, an upper bound on its draw
+	// count
+	uint32_t capacity;
+};
+
+// Entries [first, first + count) of a list
+struct IndirectRange {
+	uint32_t first;
+	uint32_t count;
+};
+
+SortKey getSortKey(const RenderObject& object, uint16_t depth);
+
+// What to draw this frame. The lists are owned by the scene graph, so
+// building a submission copies nothing.
 struct RenderSubmission {
-	std::vector<RenderObject> renderObjects;
-	std::vector<InstancedRenderObject> instances;
-	std::vector<std::vector<InstanceData>> instanceData;
+	// Drawn by the main pass after culling, opaque ones first and then the
+	// transparent ones over them. Both are in sort key order.
+	std::span<const RenderObject> renderObjects;
+	std::span<const RenderObject> transparentObjects;
+	// Every object in the scene, for passes the camera does not bound, such
+	// as the radiance cascade voxelization
+	std::span<const RenderObject> sceneObjects;
+	// Sorted by variant then material, and drawn with the opaque objects
+	std::span<const InstancedRenderObject> instances;
+	std::span<const std::vector<InstanceData>> instanceData;
+	// Regular objects the scene graph merged into instanced draws. Kept apart
+	// from `instances` so neither list has to be copied into the other.
+	std::span<const InstancedRenderObject> batches;
+	std::span<const std::vector<InstanceData>> batchData;
+	// Opaque objects culled and drawn by the GPU. Empty when the scene graph
+	// culls on the CPU. Objects of one bucket are contiguous.
+	std::span<const IndirectObject> indirectObjects;
+	std::span<const InstanceData> indirectTransforms;
+	std::span<const IndirectBucket> indirectBuckets;
+	// Set when the indirect lists were rebuilt since the previous
+	// submission. Otherwise they differ from it only in the transforms of
+	// `changedIndirectTransforms`, which are sorted and disjoint.
+	bool isIndirectLayoutChanged;
+	std::span<const IndirectRange> changedIndirectTransforms;
+	math::Frustum frustum;
 
    public:
 	static RenderSubmission create();
-	void clear();
 };
 
-void submit(
-	RenderSubmission& renderSubmission,
-	std::span<const InstancedRenderObject> instances,
-	std::span<const std::vector<InstanceData>> data
-);
+// Owns copies of a submission's lists, for when they must outlive the frame
+// that built them.
+struct RenderSubmissionCopy {
+	std::vector<RenderObject> renderObjects;
+	std::vector<RenderObject> transparentObjects;
+	std::vector<RenderObject> sceneObjects;
+	std::vector<InstancedRenderObject> instances;
+	std::vector<std::vector<InstanceData>> instanceData;
+	std::vector<InstancedRenderObject> batches;
+	std::vector<std::vector<InstanceData>> batchData;
+	std::vector<IndirectObject> indirectObjects;
+	std::vector<InstanceData> indirectTransforms;
+	std::vector<IndirectBucket> indirectBuckets;
+	bool isIndirectLayoutChanged;
+	std::vector<IndirectRange> changedIndirectTransforms;
+	math::Frustum frustum;
+};
 
-void submit(
-	RenderSubmission& renderSubmission,
-	std::span<const RenderObject> renderObjects
-);
+// Copying over a previous copy reuses its storage.
+void copy(RenderSubmissionCopy& copy, const RenderSubmission& submission);
+// Valid until the copy is copied over again.
+RenderSubmission getSubmission(const RenderSubmissionCopy& copy);
 
+// Where prepForRecording put each list of the submission in the object data.
+// The opaque render objects come first, from entry 0.
+struct ObjectDataLayout {
+	uint32_t firstTransparent;
+	// First entry of each of `instances`, then of each of `batches`
+	std::vector<uint32_t> firstInstances;
+};
+
+// Writes the object data of every draw of the submission, in one pass.
 void prepForRecording(
-	RenderSubmission& renderSubmission,
-	const RenderInstanceManager& instanceManager,
+	const RenderSubmission& renderSubmission,
+	ObjectDataBuffer& objectData,
+	ObjectDataLayout& layout,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	DescriptorWriteBuffer& writeBuffer,
 	uint32_t currentFrame
 );
 
+// Takes a list rather than the submission, so that the main pass can be
+// recorded in chunks, and the transparent objects after everything opaque.
+// objects[i] reads entry firstInstance + i of the object data.
 void recordRegularDrawCalls(
-	const RenderSubmission& renderSubmission,
+	std::span<const RenderObject> objects,
+	uint32_t firstInstance,
 	vk::CommandBuffer buffer,
 	vk::PipelineLayout pipelineLayout,
 	const MaterialPipeline& pipelines,
 	const MaterialStorage& materials,
-	const MeshStorage& meshes
+	const MeshStorage& meshes,
+	const GeometryHandles& geometry
 );
 
 void recordInstancedDrawCalls(
 	const RenderSubmission& renderSubmission,
+	const ObjectDataLayout& layout,
 	vk::CommandBuffer buffer,
 	vk::PipelineLayout pipelineLayout,
-	const RenderInstanceManager& instanceManager,
 	const MaterialPipeline& pipelines,
 	const MaterialStorage& materials,
 	const MeshStorage& meshes,
-    uint32_t currentFrame
+	const GeometryHandles& geometry
 );
 
-void clear(RenderSubmission& renderSubmission);
-
 }  // namespace graphics
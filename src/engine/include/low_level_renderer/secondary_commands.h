@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+namespace graphics {
+
+// A command pool with a single secondary command buffer. Command pools may
+// only be used by one thread at a time, so each chunk of a render pass that
+// is recorded in parallel gets its own. Kept per frame in flight, since the
+// buffer can only be reset once the frame that executed it is done.
+struct SecondaryCommands {
+	vk::CommandPool pool;
+	vk::CommandBuffer buffer;
+
+   public:
+	static SecondaryCommands create(vk::Device device, uint32_t queueFamily);
+};
+
+// Resets the pool and starts recording commands that continue the first
+// subpass of `renderPass`. Safe to call from any thread, as long as no other
+// thread uses the same SecondaryCommands.
+[[nodiscard]]
+vk::CommandBuffer begin(
+	const SecondaryCommands& commands,
+	vk::Device device,
+	vk::RenderPass renderPass,
+	vk::Framebuffer framebuffer
+);
+void end(const SecondaryCommands& commands);
+
+void destroy(const SecondaryCommands& commands, vk::Device device);
+
+}  // namespace graphics
@@ -3,11 +3,10 @@
 #include <vulkan/vulkan.hpp>
 
 #include "core/algo/generation_index_array.h"
+#include "core/algo/paged_array.h"
 
 namespace graphics {
 
-constexpr size_t MAX_SHADERS = 1000;
-
 using ShaderID = algo::GenerationIndexPair;
 
 struct UncompiledShader {
@@ -16,8 +15,8 @@ struct UncompiledShader {
 };
 
 struct ShaderStorage {
-	std::array<vk::ShaderModule, MAX_SHADERS> shaders;
-	algo::GenerationIndexArray<MAX_SHADERS> indices;
+	algo::PagedArray<vk::ShaderModule> shaders;
+	algo::GenerationIndexArray indices;
 
    public:
 	static ShaderStorage create();
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+#include "low_level_renderer/pipeline_variant.h"
+
+namespace graphics {
+
+// Packs the draw order into one integer so draws can be radix sorted instead
+// of compared field by field. The top bit is the queue, so every opaque draw
+// sorts before every transparent one. From the most significant bit down:
+// opaque      | 0 | variant 7 | material 20 | mesh 20 | depth 16 |
+// transparent | 1 | inverse depth 16 | variant 7 | material 20 | mesh 20 |
+// Opaque draws change the costliest state the least often and go front to
+// back within a state. Transparent draws go strictly back to front.
+using SortKey = uint64_t;
+
+// Maps view-space depth between the near and far planes onto 16 bits.
+uint16_t quantizeDepth(float viewDepth, float nearPlane, float farPlane);
+SortKey getSortKey(
+	const PipelineSpecializationConstants& variant,
+	uint32_t materialIndex,
+	uint32_t meshIndex,
+	uint16_t depth
+);
+bool isTransparent(SortKey key);
+
+}  // namespace graphics
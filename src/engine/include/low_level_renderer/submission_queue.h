@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "SDL3/SDL_events.h"
+#include "low_level_renderer/bloom.h"
+#include "low_level_renderer/render_submission.h"
+#include "low_level_renderer/shader_data.h"
+#include "low_level_renderer/transfer.h"
+#include "low_level_renderer/vertex_buffer.h"
+
+struct ImDrawData;
+
+namespace graphics {
+
+// Bounds on how many snapshots can be out of the queue at once. With two the
+// game thread builds a frame while the render thread draws the previous one.
+// A third lets the game run one more frame ahead, for a frame more latency.
+constexpr uint32_t MIN_SUBMISSION_QUEUE_DEPTH = 2;
+constexpr uint32_t MAX_SUBMISSION_QUEUE_DEPTH = 3;
+
+struct FrameStats {
+	std::chrono::duration<float, std::milli> mainPassRecordTime;
+	uint32_t mainPassRecordChunks;
+	// Meshlets of indirect objects the GPU found visible, as of the last
+	// finished frame
+	uint32_t indirectVisibleCount;
+	// Between the first and last command of the frame, as of the last
+	// finished frame. Zero where the device can't write timestamps.
+	std::chrono::duration<float, std::milli> gpuFrameTime;
+};
+
+// Everything the render thread reads of a frame, copied out of the scene
+// graph and ImGui so the game thread can build the next frame meanwhile. The
+// lists keep their capacity from one use of the slot to the next.
+struct SubmissionSnapshot {
+	RenderSubmissionCopy submission;
+	GPUSceneData sceneData;
+
+	vk::Rect2D mainWindowExtent;
+	uint32_t maxRecordingThreads;
+	// Set when changed from the UI since the previous snapshot
+	std::optional<BloomGraphicsObjects::Config> bloomConfig;
+	// Requested since the previous snapshot, and created before this one is
+	// recorded
+	std::vector<PipelineSpecializationConstants> newVariants;
+	// Latest resize since the previous snapshot
+	std::optional<SDL_Event> resize;
+	// Frames still to capture, this one included. The capture is written
+	// once the last of them is drawn.
+	uint32_t capturedFramesLeft;
+	// Uploads recorded up to this snapshot, waited on before drawing it
+	TransferToken transfers;
+	// The geometry's buffers as of this snapshot. Those replaced since the
+	// previous snapshot are only read by earlier frames and by the uploads
+	// this one waits on, so they are destroyed once its frame is done.
+	GeometryHandles geometry;
+	std::vector<RetiredBuffer> retiredGeometry;
+	// Owns clones of the frame's ImGui draw lists
+	ImDrawData* uiDrawData;
+
+   public:
+	static SubmissionSnapshot create();
+};
+
+// Frees the draw lists cloned for the previous use of the snapshot.
+void captureUI(SubmissionSnapshot& snapshot, const ImDrawData& drawData);
+void destroy(SubmissionSnapshot& snapshot);
+
+// Hands snapshots from the game thread to the render thread. A slot goes from
+// free, to written by the game thread, to ready, to drawn by the render
+// thread, and back to free. Ready slots are drawn in the order they were
+// published. At most `depth` slots are out of the free state, so the game
+// thread blocks rather than run more than depth - 1 frames ahead of the one
+// being drawn.
+struct SubmissionQueue {
+	enum class SlotState { eFree, eWriting, eReady, eRendering };
+
+	std::array<SubmissionSnapshot, MAX_SUBMISSION_QUEUE_DEPTH> slots;
+	std::array<SlotState, MAX_SUBMISSION_QUEUE_DEPTH> states;
+	// Publication order of the ready slots
+	std::array<uint64_t, MAX_SUBMISSION_QUEUE_DEPTH> sequence;
+	uint64_t nextSequence;
+	uint32_t depth;
+	// Set on shutdown, or by the render thread once it failed to draw
+	bool isClosed;
+	// Of the last snapshot the render thread finished
+	FrameStats stats;
+
+	std::mutex mutex;
+	// Notified whenever a slot is freed or published, and on close
+	std::condition_variable changed;
+
+   public:
+	// Kept on the heap, so its owner can move while the render thread runs
+	static std::unique_ptr<SubmissionQueue> create(uint32_t depth);
+};
+
+// Game thread. Blocks until a slot is free within the depth. Empty once the
+// queue is closed.
+std::optional<uint32_t> acquireForWriting(SubmissionQueue& queue);
+void publish(SubmissionQueue& queue, uint32_t slot);
+// Game thread, whether or not it holds a slot. Blocks until every published
+// snapshot has been drawn and the render thread waits for the next one.
+void waitIdle(SubmissionQueue& queue);
+// Takes effect for slots acquired from then on.
+void setDepth(SubmissionQueue& queue, uint32_t depth);
+FrameStats getStats(SubmissionQueue& queue);
+
+// Render thread. Blocks until a snapshot is ready. Empty once the queue is
+// closed, even if snapshots were still waiting.
+std::optional<uint32_t> acquireForRendering(SubmissionQueue& queue);
+void release(SubmissionQueue& queue, uint32_t slot, const FrameStats& stats);
+
+void close(SubmissionQueue& queue);
+void destroy(SubmissionQueue& queue);
+
+}  // namespace graphics
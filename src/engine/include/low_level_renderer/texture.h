@@ -3,6 +3,8 @@
 #include <vulkan/vulkan.hpp>
 
 #include "low_level_renderer/descriptor_write_buffer.h"
+#include "low_level_renderer/device_memory.h"
+#include "low_level_renderer/transfer.h"
 
 namespace graphics {
 
@@ -18,7 +20,7 @@ enum class TextureFormatHint {
 struct Texture {
     vk::Image image;
     vk::ImageView imageView;
-    vk::DeviceMemory memory;
+    DeviceAllocation memory;
     vk::Format format;
     uint32_t mipLevels;
 };
@@ -29,12 +31,14 @@ struct TextureStorage {
 
 vk::Format getIdealTextureFormat(int channels, const TextureFormatHint& hint);
 
+// Records the upload of every mip level, so the texture may only be sampled
+// once the transfers are submitted and done.
 Texture loadTextureFromFile(
     std::string_view filePath,
     vk::Device device,
     vk::PhysicalDevice physicalDevice,
-    vk::CommandPool commandPool,
-    vk::Queue graphicsQueue
+    TransferManager& transfers,
+    TextureFormatHint formatHint
 );
 
 Texture createTexture(
@@ -55,8 +59,7 @@ TextureID pushTextureFromFile(
     std::string_view filePath,
     vk::Device device,
     vk::PhysicalDevice physicalDevice,
-    vk::CommandPool commandPool,
-    vk::Queue graphicsQueue,
+    TransferManager& transfers,
     TextureFormatHint formatHint
 );
 
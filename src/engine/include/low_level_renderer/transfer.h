@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "low_level_renderer/device_memory.h"
+#include "low_level_renderer/queue_family.h"
+
+namespace graphics {
+
+// Value the transfer manager's timeline semaphore reaches once a submitted
+// batch is done, along with every batch before it.
+struct TransferToken {
+	uint64_t value;
+};
+
+// Records uploads into one command buffer until it is submitted, staging the
+// data through a ring buffer that stays mapped, so loading many assets takes
+// one submit rather than a queue wait per copy. Uses the device's dedicated
+// transfer queue when it has one. Queue ownership is never transferred, so
+// resources it writes then have to be shared by both queue families.
+// Only used by the game thread, but its queue is the render thread's when
+// there is no dedicated transfer queue, so submitting has to be serialized
+// with drawing.
+struct TransferManager {
+	static constexpr vk::DeviceSize STAGING_CAPACITY = 32 * 1024 * 1024;
+
+	struct Batch {
+		vk::CommandBuffer commandBuffer;
+		uint64_t value;
+		// Where the ring's head was once the batch was submitted
+		vk::DeviceSize stagingEnd;
+		// Buffers the batch reads from, destroyed once it is done
+		std::vector<std::tuple<vk::Buffer, DeviceAllocation>> garbage;
+	};
+
+	vk::Device device;
+	vk::PhysicalDevice physicalDevice;
+	vk::Queue queue;
+	// The transfer and graphics families when they differ, for buffers and
+	// images written by the transfer manager to be created with. Empty
+	// otherwise, as the resources can then stay exclusive.
+	std::vector<uint32_t> sharedQueueFamilies;
+	vk::CommandPool commandPool;
+	vk::Semaphore timeline;
+
+	vk::Buffer staging;
+	DeviceAllocation stagingMemory;
+	// Data from tail to head, wrapping around, is read by batches not yet
+	// done. Empty when both are equal.
+	vk::DeviceSize head;
+	vk::DeviceSize tail;
+
+	std::optional<Batch> recording;
+	// Oldest first
+	std::deque<Batch> submitted;
+	uint64_t lastSubmitted;
+
+   public:
+	static TransferManager create(
+		vk::Device device,
+		vk::PhysicalDevice physicalDevice,
+		const QueueFamilyIndices& queueFamily,
+		vk::Queue graphicsQueue
+	);
+};
+
+// Records copying `data` to `buffer` from `offset` bytes on.
+void stageBuffer(
+	TransferManager& transfers,
+	std::span<const std::byte> data,
+	vk::Buffer buffer,
+	vk::DeviceSize offset
+);
+// Records copying mip levels of `image` from `data`, which each region's
+// bufferOffset is relative to. Every mip level of the image goes from
+// undefined to eShaderReadOnlyOptimal, so every level needs a region.
+void stageImage(
+	TransferManager& transfers,
+	std::span<const std::byte> data,
+	std::span<const vk::BufferImageCopy> regions,
+	vk::Image image,
+	uint32_t mipLevels
+);
+// Records a copy between buffers, after the copies recorded before it.
+void copyBuffer(
+	TransferManager& transfers,
+	vk::Buffer source,
+	vk::Buffer destination,
+	std::span<const vk::BufferCopy> regions
+);
+
+// Submits what was recorded since the last submit, if anything. The token is
+// of the last batch submitted either way. Only touches the queue when
+// something was recorded.
+TransferToken submit(TransferManager& transfers);
+void wait(TransferManager& transfers, TransferToken token);
+
+// Waits for every batch, submitting the one being recorded.
+void destroy(TransferManager& transfers);
+
+}  // namespace graphics
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <glm/gtc/type_precision.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+// Vertex formats and their packing, kept apart from the geometry buffer so
+// that tools can use them without a device.
+namespace graphics {
+// Indices as meshes are built. They are stored in 16 bits whenever they fit.
+using IndexType = uint32_t;
+
+// Vertex as meshes are loaded and built. The GPU reads PackedVertex instead.
+struct Vertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec3 tangent;
+	glm::vec3 color;
+	glm::vec2 texCoord;
+
+   public:
+	bool operator==(const Vertex& other) const {
+		return position == other.position && color == other.color &&
+			   normal == other.normal && texCoord == other.texCoord &&
+			   tangent == other.tangent;
+	}
+};
+
+// Vertex as it is stored in the geometry buffer, in 24 bytes rather than 56.
+struct PackedVertex {
+	glm::vec3 position;
+	// Octahedral encoding of the unit normal, as snorm
+	glm::i16vec2 normal;
+	// The tangent's angle around the normal in the low 15 bits, from the
+	// basis the shaders build out of the normal. The top bit is set when the
+	// bitangent is the opposite of cross(normal, tangent).
+	uint16_t tangent;
+	// RGB565
+	uint16_t color;
+	// Half floats
+	glm::u16vec2 texCoord;
+};
+static_assert(sizeof(PackedVertex) == 24);
+
+// Each triangle of `indices` votes on the handedness of its vertices.
+std::vector<PackedVertex> pack(
+	std::span<const Vertex> vertices, std::span<const IndexType> indices
+);
+// Normals and tangents come back quantized, and colours to RGB565.
+Vertex unpack(const PackedVertex& vertex);
+
+glm::vec3 getTangent(
+	const graphics::Vertex& v0,
+	const graphics::Vertex& v1,
+	const graphics::Vertex& v2
+);
+
+}  // namespace graphics
+
+namespace std {
+template <>
+struct hash<graphics::Vertex> {
+	size_t operator()(graphics::Vertex const& vertex) const;
+};
+}  // namespace std
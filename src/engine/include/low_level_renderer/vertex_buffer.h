@@ -1,83 +1,157 @@
 #pragma once
 
 #include <array>
-#include <glm/vec2.hpp>
-#include <glm/vec3.hpp>
+#include <span>
+#include <string_view>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 
-namespace graphics {
-using IndexType = uint32_t;
+#include "core/algo/range_allocator.h"
+#include "core/math/bounds.h"
+#include "low_level_renderer/device_memory.h"
+#include "low_level_renderer/transfer.h"
+#include "low_level_renderer/vertex.h"
 
-struct Vertex {
-	glm::vec3 position;
-	glm::vec3 normal;
-	glm::vec3 tangent;
-	glm::vec3 color;
-	glm::vec2 texCoord;
+namespace graphics {
 
-   public:
-	constexpr static vk::VertexInputBindingDescription getBindingDescription() {
-		return vk::VertexInputBindingDescription(
-			0, sizeof(Vertex), vk::VertexInputRate::eVertex
-		);
-	}
+// Binding 0, one PackedVertex per vertex
+constexpr vk::VertexInputBindingDescription getPackedVertexBindingDescription(
+) {
+	return vk::VertexInputBindingDescription(
+		0, sizeof(PackedVertex), vk::VertexInputRate::eVertex
+	);
+}
+std::array<vk::VertexInputAttributeDescription, 5>
+getPackedVertexAttributeDescriptions();
 
-	static std::array<vk::VertexInputAttributeDescription, 5>
-	getAttributeDescriptions();
+// Where a mesh lives in the geometry buffer
+struct MeshRange {
+	uint32_t firstVertex;
+	uint32_t vertexCount;
+	// In indices of the range's index type
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	// 16 bit whenever the mesh has few enough vertices
+	vk::IndexType indexType;
+	// The mesh's meshlets, for the culling pass
+	uint32_t firstMeshlet;
+	uint32_t meshletCount;
+	// Object space, computed from the vertices at load
+	math::Bounds bounds;
+};
 
-	bool operator==(const Vertex& other) const {
-		return position == other.position && color == other.color &&
-			   normal == other.normal && texCoord == other.texCoord &&
-			   tangent == other.tangent;
-	}
+// A buffer replaced by growing or defragmenting, which frames recorded before
+// may still read
+struct RetiredBuffer {
+	vk::Buffer buffer;
+	DeviceAllocation memory;
 };
 
-glm::vec3 getTangent(
-	const graphics::Vertex& v0,
-	const graphics::Vertex& v1,
-	const graphics::Vertex& v2
-);
+// The buffers of the geometry as a snapshot captured them. The game thread
+// replaces the geometry's buffers as meshes load, so frames draw from the
+// handles of their own snapshot rather than from the geometry.
+struct GeometryHandles {
+	vk::Buffer vertexBuffer;
+	vk::Buffer indexBuffer;
+	vk::Buffer meshletBuffer;
+};
 
-struct VertexBuffer {
+// The vertices and indices of every mesh, in one vertex buffer and one index
+// buffer so that a command buffer binds them once for all of its draws.
+// Meshes take ranges of both and are drawn by vertex offset and first index,
+// so their indices stay relative to their first vertex. 16 and 32 bit indices
+// share the index buffer, with 32 bit ranges aligned to 4 bytes. A storage
+// buffer holds the meshlets of every mesh alike. The buffers double whenever
+// a mesh does not fit.
+struct GeometryBuffer {
 	vk::Buffer vertexBuffer;
-	vk::DeviceMemory vertexMemory;
+	DeviceAllocation vertexMemory;
 	vk::Buffer indexBuffer;
-	vk::DeviceMemory indexMemory;
-	uint32_t numberOfVertices;
-	uint32_t numberOfIndices;
+	DeviceAllocation indexMemory;
+	vk::Buffer meshletBuffer;
+	DeviceAllocation meshletMemory;
+	// In vertices, in 16 bit indices and in meshlets
+	algo::RangeAllocator vertexRanges;
+	algo::RangeAllocator indexRanges;
+	algo::RangeAllocator meshletRanges;
+	// Replaced since they were last taken, oldest first
+	std::vector<RetiredBuffer> retired;
 
    public:
-	static VertexBuffer create(
-		std::string_view filePath,
-		const vk::Device& device,
-		const vk::PhysicalDevice& physicalDevice,
-		const vk::CommandPool& commandPool,
-		const vk::Queue& graphicsQueue
-	);
-
-	static VertexBuffer create(
-		const std::vector<Vertex>& vertices,
-		const std::vector<IndexType>& indices,
-		vk::Device device,
-		vk::PhysicalDevice physicalDevice,
-		vk::CommandPool commandPool,
-		vk::Queue graphicsQueue
-	);
+	// The buffers are created along with the first mesh
+	static GeometryBuffer create();
 };
 
-void bind(vk::CommandBuffer commandBuffer, const VertexBuffer& vertexBuffer);
+// Packs the vertices, builds the meshlets, and records the copies with the
+// transfer manager rather than waiting for them. Growing the buffers replaces
+// them, retiring the old ones.
+[[nodiscard]]
+MeshRange upload(
+	GeometryBuffer& geometry,
+	const std::vector<Vertex>& vertices,
+	const std::vector<IndexType>& indices,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	TransferManager& transfers
+);
+void release(GeometryBuffer& geometry, const MeshRange& range);
+// Packs `ranges` at the start of new buffers and points them there, so that
+// the free space is in one piece again. Records the copies with the transfer
+// manager and retires the old buffers. Moves the ranges, so nothing recorded
+// from then on may draw from the old buffers.
+void defragment(
+	GeometryBuffer& geometry,
+	std::span<MeshRange* const> ranges,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	TransferManager& transfers
+);
+
+GeometryHandles getHandles(const GeometryBuffer& geometry);
+// Moves the buffers retired since the last call onto the end of `retired`.
+// They can be destroyed once every frame recorded before is done, along with
+// the transfers recorded so far, which copy out of them.
+void takeRetired(
+	GeometryBuffer& geometry, std::vector<RetiredBuffer>& retired
+);
+void destroy(std::span<const RetiredBuffer> retired, vk::Device device);
+
+// Binds the vertex buffer. Index buffers are bound per index type.
+void bind(vk::CommandBuffer commandBuffer, const GeometryHandles& geometry);
+void bindIndices(
+	vk::CommandBuffer commandBuffer,
+	const GeometryHandles& geometry,
+	vk::IndexType indexType
+);
+// Expects the index buffer to be bound for the range's index type, so that
+// draws of one type share a single bind.
 void drawVertices(
 	vk::CommandBuffer commandBuffer,
-	const VertexBuffer& vertexBuffer,
-	uint16_t instanceCount = 1
+	const MeshRange& range,
+	uint16_t instanceCount = 1,
+	uint32_t firstInstance = 0
+);
+// Copies the mesh back from the GPU, waiting for the copy to finish, and
+// unpacks it.
+void readBack(
+	const GeometryBuffer& geometry,
+	const MeshRange& range,
+	std::vector<Vertex>& vertices,
+	std::vector<IndexType>& indices,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	vk::CommandPool commandPool,
+	vk::Queue graphicsQueue
 );
-void destroy(std::span<const VertexBuffer> vertexBuffers, vk::Device device);
+// Along with the buffers retired but not taken
+void destroy(const GeometryBuffer& geometry, vk::Device device);
 
-};	// namespace graphics
+// Triangulated, with duplicate vertices merged and tangents computed, then
+// reordered by optimizeMesh.
+void loadFromObj(
+	std::string_view filePath,
+	std::vector<Vertex>& vertices,
+	std::vector<IndexType>& indices
+);
 
-namespace std {
-template <>
-struct hash<graphics::Vertex> {
-	size_t operator()(graphics::Vertex const& vertex) const;
-};
-}  // namespace std
+};	// namespace graphics
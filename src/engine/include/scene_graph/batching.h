@@ -0,0 +1,38 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "low_level_renderer/render_submission.h"
+
+namespace scene_graph {
+
+// Turns render objects that share variant, material and mesh into instanced
+// draws, whose instance data the renderer copies into its object data.
+struct Batcher {
+	// Outputs of the last build, each still in the order of the input
+	std::vector<graphics::RenderObject> singles;
+	std::vector<graphics::InstancedRenderObject> batches;
+	// First batches.size() entries are parallel to `batches`. Kept longer so
+	// the inner vectors hold on to their memory between frames.
+	std::vector<std::vector<graphics::InstanceData>> batchData;
+	uint32_t numObjects;
+
+   public:
+	// Fewer objects than this are cheaper to draw one by one
+	static constexpr uint32_t MIN_BATCH_SIZE = 2;
+	static constexpr uint32_t MAX_BATCH_SIZE = 1 << 14;
+
+	static Batcher create();
+};
+
+// `objects` must be sorted by graphics::getSortKey, so that objects sharing
+// variant, material and mesh are next to each other.
+void build(Batcher& batcher, std::span<const graphics::RenderObject> objects);
+
+std::span<const std::vector<graphics::InstanceData>> getBatchData(
+	const Batcher& batcher
+);
+uint32_t getDrawCallCount(const Batcher& batcher);
+
+}  // namespace scene_graph
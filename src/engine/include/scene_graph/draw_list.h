@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <limits>
+#include <vector>
+
+#include "core/algo/generation_index_array.h"
+#include "core/algo/paged_array.h"
+#include "low_level_renderer/render_submission.h"
+
+namespace scene_graph {
+
+using RenderObjectID = algo::GenerationIndexPair;
+
+struct DrawListSlot {
+	// Index into DrawList::objects, or into DrawList::pendingObjects while
+	// `isPending`
+	uint32_t position;
+	bool isPending;
+};
+
+// Render objects retained across frames, kept sorted by variant then material
+// so recording can skip redundant binds. Additions and changes of variant or
+// material are queued, and removals leave tombstones. `flush` merges both in
+// one pass. A frame where nothing changed costs nothing, and a frame with k
+// changes sorts only those k before a linear merge.
+struct DrawList {
+	std::vector<graphics::RenderObject> objects;
+	// ID index that owns each entry of `objects`, or REMOVED for tombstones
+	std::vector<uint32_t> owners;
+	algo::GenerationIndexArray ids;
+	algo::PagedArray<DrawListSlot> slots;
+
+	std::vector<graphics::RenderObject> pendingObjects;
+	std::vector<uint32_t> pendingOwners;
+	size_t numRemoved;
+	// Positions in `objects` whose transform was set since the last flush
+	// that moved objects, possibly repeated. Cleared by whoever reads them.
+	std::vector<uint32_t> changedTransforms;
+
+	// Reused by flush so merging does not allocate in steady state
+	std::vector<graphics::RenderObject> mergedObjects;
+	std::vector<uint32_t> mergedOwners;
+	std::vector<uint32_t> pendingOrder;
+
+   public:
+	static constexpr uint32_t REMOVED = std::numeric_limits<uint32_t>::max();
+
+	static DrawList create();
+};
+
+[[nodiscard]]
+RenderObjectID add(DrawList& drawList, const graphics::RenderObject& object);
+void remove(DrawList& drawList, RenderObjectID id);
+
+// Transforms do not affect the sort order, so they are patched in place.
+void setTransform(
+	DrawList& drawList, RenderObjectID id, const glm::mat4& transform
+);
+void setVariant(
+	DrawList& drawList,
+	RenderObjectID id,
+	const graphics::PipelineSpecializationConstants& variant
+);
+void setMaterial(
+	DrawList& drawList, RenderObjectID id, graphics::MaterialInstanceID material
+);
+
+// Applies everything queued since the last flush. Returns whether objects
+// were added, removed or moved in `objects`, in which case
+// `changedTransforms` no longer applies and is cleared.
+bool flush(DrawList& drawList);
+
+}  // namespace scene_graph
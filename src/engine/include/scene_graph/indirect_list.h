@@ -0,0 +1,78 @@
+#pragma once
+
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "low_level_renderer/meshes.h"
+#include "low_level_renderer/render_submission.h"
+
+namespace scene_graph {
+
+// Lays out the opaque objects of the draw list for GPU culling: objects that
+// share variant, material and index type are contiguous and form one bucket,
+// which the GPU draws with a single indirect draw, of one command per meshlet
+// of its objects. As every mesh lives in the same geometry buffer, a bucket
+// only needs the state its draw binds, whatever meshes its objects draw.
+// Transparent objects need sorting by depth, so they are left for the CPU.
+//
+// Retained across frames: only built again once the draw list adds, removes
+// or moves objects, or the meshes move. Otherwise changed transforms are
+// patched in place, and tracked so that only they are uploaded.
+struct IndirectList {
+	// Parallel to each other, grouped by bucket
+	std::vector<graphics::IndirectObject> objects;
+	std::vector<graphics::InstanceData> transforms;
+	std::vector<graphics::IndirectBucket> buckets;
+	// Draw list positions of the transparent objects
+	std::vector<uint32_t> transparentIndices;
+	// Position in `objects` of each draw list object, or NOT_INDIRECT for
+	// the transparent ones
+	std::vector<uint32_t> positions;
+
+	// Changes since the last submission, cleared by `clearChanges`. The
+	// changed positions are kept sorted and unique, and grouped into ranges.
+	bool isLayoutChanged;
+	std::vector<uint32_t> changedPositions;
+	std::vector<graphics::IndirectRange> changedTransforms;
+
+	bool isBuilt;
+	// Of the meshes the objects' ranges were read from
+	uint32_t meshLayoutVersion;
+
+	// Sort scratch reused every build
+	std::vector<graphics::SortKey> sortKeys;
+	std::vector<graphics::SortKey> sortKeyScratch;
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> orderScratch;
+
+   public:
+	static constexpr uint32_t NOT_INDIRECT =
+		std::numeric_limits<uint32_t>::max();
+
+	static IndirectList create();
+};
+
+// Whether the list must be built before transforms can be patched, as it was
+// cleared or the meshes moved since.
+bool needsBuild(
+	const IndirectList& list, const graphics::MeshStorage& meshes
+);
+void build(
+	IndirectList& list,
+	std::span<const graphics::RenderObject> objects,
+	const graphics::MeshStorage& meshes
+);
+// Copies the transforms of `objects` at the draw list positions
+// `changedPositions`, which must not have moved since the list was built.
+void updateTransforms(
+	IndirectList& list,
+	std::span<const graphics::RenderObject> objects,
+	std::span<const uint32_t> changedPositions
+);
+// Leaves nothing for the GPU to draw, until built again.
+void clear(IndirectList& list);
+// Once a submission has carried the changes to the renderer.
+void clearChanges(IndirectList& list);
+
+}  // namespace scene_graph
@@ -1,15 +1,41 @@
 #pragma once
 
+#include "core/math/bounds.h"
 #include "low_level_renderer/graphics_module.h"
 #include "low_level_renderer/render_submission.h"
+#include "scene_graph/batching.h"
+#include "scene_graph/draw_list.h"
+#include "scene_graph/indirect_list.h"
+#include "scene_graph/transform_graph.h"
 
 namespace scene_graph {
 struct Module {
     graphics::GPUSceneData sceneData;
 	graphics::RenderSubmission renderSubmission;
-	std::vector<graphics::RenderObject> renderObjects;
+	DrawList drawList;
+	TransformGraph transforms;
+	// Opaque objects are culled and drawn by the GPU instead of being
+	// culled, sorted and batched here. Toggled from the UI.
+	bool isGPUDriven;
+	IndirectList indirectList;
+	// Draw list positions culled on the CPU this frame
+	std::vector<uint32_t> cullCandidates;
+	// Per-frame culling scratch, parallel to cullCandidates
+	math::BoundingSpheres worldBounds;
+	// Draw list positions
+	std::vector<uint32_t> visibleIndices;
+	// Parallel to visibleIndices, which is sorted along with them
+	std::vector<graphics::SortKey> sortKeys;
+	std::vector<graphics::SortKey> sortKeyScratch;
+	std::vector<uint32_t> sortIndexScratch;
+	// Visible objects in sort key order, opaque then transparent
+	std::vector<graphics::RenderObject> visibleObjects;
+	Batcher batcher;
+	// Sorted by variant then material, parallel to each other
 	std::vector<graphics::InstancedRenderObject> instancedRenderObjects;
 	std::vector<std::vector<graphics::InstanceData>> instancedRenderData;
+	// Position in the sorted arrays of the i-th instanced object added
+	std::vector<size_t> instancedRenderPositions;
 
    public:
     static Module create();
@@ -24,8 +50,26 @@ struct Module {
         std::span<const size_t> indices,
         std::vector<std::span<const graphics::InstanceData>> data
     );
-    void addObjects(std::span<const graphics::RenderObject> renderObjects);
-    void updateObjects(std::vector<std::tuple<int, glm::mat4>>);
+    std::vector<RenderObjectID> addObjects(
+        std::span<const graphics::RenderObject> renderObjects
+    );
+    void removeObjects(std::span<const RenderObjectID> ids);
+    void updateObjects(
+        std::span<const std::tuple<RenderObjectID, glm::mat4>> updates
+    );
+
+    // World matrices of the hierarchy are resolved once per frame, in
+    // drawFrame, and pushed to the render objects attached to it.
+    [[nodiscard]]
+    TransformID addTransform(
+        const math::Transform& local,
+        std::optional<TransformID> parent = std::nullopt
+    );
+    // Also removes the descendants and every render object attached to them.
+    void removeTransform(TransformID id);
+    void setLocalTransform(TransformID id, const math::Transform& local);
+    void setTransformParent(TransformID id, std::optional<TransformID> parent);
+    void attachObject(TransformID id, RenderObjectID object);
 };
 
 extern std::optional<Module> module;
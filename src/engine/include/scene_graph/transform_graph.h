@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "core/algo/generation_index_array.h"
+#include "core/algo/paged_array.h"
+#include "core/math/transform.h"
+#include "scene_graph/draw_list.h"
+
+namespace scene_graph {
+
+using TransformID = algo::GenerationIndexPair;
+
+// Parent/child hierarchy of local TRS transforms. Nodes are stored breadth
+// first, so every parent precedes its children and one front-to-back pass
+// resolves all world matrices. The pass starts at the first dirty node and
+// only recomputes dirty nodes and their descendants. Adding, removing and
+// reparenting nodes only flags the layout; it is rebuilt at the next update.
+struct TransformGraph {
+	// Indexed by position in breadth-first order
+	std::vector<math::Transform> local;
+	std::vector<glm::mat4> world;
+	std::vector<uint32_t> parent;
+	std::vector<uint8_t> isDirty;
+	std::vector<TransformID> owners;
+	std::vector<std::optional<RenderObjectID>> renderObjects;
+
+	algo::GenerationIndexArray ids;
+	algo::PagedArray<uint32_t> positions;
+
+	uint32_t firstDirty;
+	bool isLayoutDirty;
+
+	// Filled by update and valid until the next one
+	std::vector<uint32_t> changed;
+	std::vector<RenderObjectID> removedRenderObjects;
+
+	// Scratch reused by layout rebuilds
+	std::vector<uint32_t> depths;
+	std::vector<uint32_t> chain;
+
+   public:
+	static constexpr uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+	static constexpr uint32_t NONE_DIRTY = std::numeric_limits<uint32_t>::max();
+
+	static TransformGraph create();
+};
+
+[[nodiscard]]
+TransformID addNode(
+	TransformGraph& graph,
+	const math::Transform& local,
+	std::optional<TransformID> parent = std::nullopt
+);
+// Removes the node and, at the next update, all of its descendants.
+void removeNode(TransformGraph& graph, TransformID id);
+void setParent(
+	TransformGraph& graph, TransformID id, std::optional<TransformID> parent
+);
+void setLocal(
+	TransformGraph& graph, TransformID id, const math::Transform& local
+);
+const math::Transform& getLocal(const TransformGraph& graph, TransformID id);
+// As of the last update.
+const glm::mat4& getWorld(const TransformGraph& graph, TransformID id);
+
+// The render object's transform follows the node's world matrix.
+void attachRenderObject(
+	TransformGraph& graph, TransformID id, RenderObjectID renderObject
+);
+
+// Rebuilds the layout if needed and recomputes world matrices. Afterwards
+// `changed` lists the positions whose world matrix changed, and
+// `removedRenderObjects` the render objects of nodes removed since the last
+// update.
+void update(TransformGraph& graph);
+
+}  // namespace scene_graph
@@ -0,0 +1,129 @@
+#version 450
+
+// one workgroup per object, its invocations striding over the meshlets
+layout (local_size_x = 64) in;
+
+struct IndirectObject {
+    // object space center and radius
+    vec4 boundingSphere;
+    uint firstMeshlet;
+    uint meshletCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstCommand;
+    uint bucket;
+    // the mesh handle, only read on the CPU
+    uint mesh[2];
+};
+
+struct Meshlet {
+    // object space center and radius
+    vec4 boundingSphere;
+    // axis of the normal cone, and the sine of its half angle
+    vec4 cone;
+    // relative to the mesh's first index
+    uint firstIndex;
+    uint indexCount;
+    uint padding[2];
+};
+
+struct InstanceData {
+    mat4 transform;
+};
+
+struct DrawIndexedIndirectCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, binding = 0, set = 0) readonly buffer ObjectBuffer {
+    IndirectObject objects[];
+};
+layout(std430, binding = 1, set = 0) readonly buffer TransformBuffer {
+    InstanceData transforms[];
+};
+layout(std430, binding = 2, set = 0) writeonly buffer CommandBuffer {
+    DrawIndexedIndirectCommand commands[];
+};
+layout(std430, binding = 3, set = 0) buffer CountBuffer {
+    uint counts[];
+};
+layout(std430, binding = 4, set = 0) readonly buffer MeshletBuffer {
+    Meshlet meshlets[];
+};
+
+layout(push_constant, std430) uniform PushConstants {
+    // facing inward, dot(xyz, p) + w is the signed distance of p
+    vec4 planes[6];
+    vec3 cameraPosition;
+    uint objectCount;
+};
+
+bool isInFrustum(vec3 center, float radius) {
+    for (int i = 0; i < 6; i++)
+        if (dot(planes[i].xyz, center) + planes[i].w < -radius) return false;
+    return true;
+}
+
+void main() {
+    // objects past the dispatch's width continue on the next row
+    uint index = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    if (index >= objectCount) return;
+
+    IndirectObject object = objects[index];
+    mat4 transform = transforms[index].transform;
+
+    // same as math::transform on the CPU, so both paths cull alike
+    vec3 scalesSquared = vec3(
+        dot(transform[0].xyz, transform[0].xyz),
+        dot(transform[1].xyz, transform[1].xyz),
+        dot(transform[2].xyz, transform[2].xyz)
+    );
+    float maxScaleSquared =
+        max(scalesSquared.x, max(scalesSquared.y, scalesSquared.z));
+    float minScaleSquared =
+        min(scalesSquared.x, min(scalesSquared.y, scalesSquared.z));
+    float scale = sqrt(maxScaleSquared);
+
+    // every invocation agrees, so the whole workgroup leaves at once
+    vec3 center = (transform * vec4(object.boundingSphere.xyz, 1)).xyz;
+    if (!isInFrustum(center, object.boundingSphere.w * scale)) return;
+
+    // cones only keep their angles under rotation and uniform scale, and
+    // mirroring turns the triangles around
+    bool canConeCull =
+        minScaleSquared >= 0.99 * maxScaleSquared &&
+        determinant(mat3(transform)) > 0;
+
+    for (uint i = gl_LocalInvocationID.x; i < object.meshletCount;
+         i += gl_WorkGroupSize.x) {
+        Meshlet meshlet = meshlets[object.firstMeshlet + i];
+        vec3 meshletCenter =
+            (transform * vec4(meshlet.boundingSphere.xyz, 1)).xyz;
+        float meshletRadius = meshlet.boundingSphere.w * scale;
+        if (!isInFrustum(meshletCenter, meshletRadius)) continue;
+
+        // a cutoff of 1 marks cones too wide to ever face away
+        if (canConeCull && meshlet.cone.w < 1) {
+            vec3 axis = normalize(mat3(transform) * meshlet.cone.xyz);
+            vec3 fromCamera = meshletCenter - cameraPosition;
+            // every triangle faces away from the camera
+            if (dot(fromCamera, axis) >=
+                meshlet.cone.w * length(fromCamera) + meshletRadius)
+                continue;
+        }
+
+        uint slot = atomicAdd(counts[object.bucket], 1u);
+        // the vertex shader finds the transform by instance index
+        commands[object.firstCommand + slot] = DrawIndexedIndirectCommand(
+            meshlet.indexCount,
+            1u,
+            object.firstIndex + meshlet.firstIndex,
+            object.vertexOffset,
+            index
+        );
+    }
+}
@@ -1,10 +1,7 @@
 #version 450
 
+// The position of graphics::PackedVertex, the rest goes unused
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec3 inTangent;
-layout(location = 3) in vec3 inColor;
-layout(location = 4) in vec2 inTexCoord;
 
 layout(location = 0) out vec3 outPositionWS;
 
@@ -7,7 +7,8 @@ layout(location = 2) in vec2 inFragTexCoord;
 // (1) unit vectors
 // (2) orthogonal
 layout(location = 3) in vec3 inNormalWorld; 
-layout(location = 4) in vec3 inTangentWorld;
+// w is the bitangent's sign
+layout(location = 4) in vec4 inTangentWorld;
 
 layout(location = 0) out vec4 outColor;
 
@@ -27,6 +28,7 @@ layout(set = 1, binding = 0) uniform MaterialProperties {
     vec3 ambient;
     vec3 emission;
     float shininess;
+    float opacity;
 } materialProperties;
 
 layout(set = 1, binding = 1) uniform sampler2D texSampler;
@@ -54,8 +56,10 @@ struct TangentSpace {
 TangentSpace calculateTangentSpace() {
     TangentSpace tangentSpace;
     tangentSpace.normalWorld = normalize(inNormalWorld);
-    tangentSpace.tangentWorld = normalize(inTangentWorld - dot(inTangentWorld, tangentSpace.normalWorld) * tangentSpace.normalWorld);
-    tangentSpace.bitangentWorld = cross(tangentSpace.normalWorld, tangentSpace.tangentWorld);
+    vec3 tangentWorld = inTangentWorld.xyz;
+    tangentSpace.tangentWorld = normalize(tangentWorld - dot(tangentWorld, tangentSpace.normalWorld) * tangentSpace.normalWorld);
+    float bitangentSign = inTangentWorld.w < 0.0 ? -1.0 : 1.0;
+    tangentSpace.bitangentWorld = bitangentSign * cross(tangentSpace.normalWorld, tangentSpace.tangentWorld);
 
     tangentSpace.tangentToWorld = mat3(tangentSpace.tangentWorld, tangentSpace.bitangentWorld, tangentSpace.normalWorld);
     // we can use transpose instead of inverse since the matrix is orthogonal
@@ -183,5 +187,9 @@ void main() {
     color += materialProperties.emission;
 #endif
 
+#ifdef IS_TRANSPARENT
+    outColor = vec4(color, texColor.a * materialProperties.opacity);
+#else
     outColor = vec4(color, 1);
+#endif
 }
@@ -1,16 +1,22 @@
 #version 450
 
+// Laid out as graphics::PackedVertex
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec3 inTangent;
-layout(location = 3) in vec3 inColor;
+// Octahedral encoding of the normal
+layout(location = 1) in vec2 inNormal;
+// Angle of the tangent around the normal in the low 15 bits. The top bit is
+// set when the bitangent is the opposite of cross(normal, tangent).
+layout(location = 2) in uint inTangent;
+// RGB565
+layout(location = 3) in uint inColor;
 layout(location = 4) in vec2 inTexCoord;
 
 layout(location = 0) out vec3 positionWorld;
 layout(location = 1) out vec3 fragColor;
 layout(location = 2) out vec2 fragTexCoord;
 layout(location = 3) out vec3 normalWorld;
-layout(location = 4) out vec3 tangentWorld;
+// w is the bitangent's sign
+layout(location = 4) out vec4 tangentWorld;
 
 layout(binding = 0, set = 0) uniform GPUSceneData {
     mat4 view;
@@ -22,19 +28,59 @@ layout(binding = 0, set = 0) uniform GPUSceneData {
     vec3 mainLightColor;
 } gpuScene;
 
-layout(push_constant) uniform PushConstants {
-    mat4 model;
-} objData;
+struct InstanceData {
+    mat4 transform;
+};
+
+// Data of every object drawn this frame. Draws point at their entries with
+// firstInstance, which gl_InstanceIndex includes.
+layout(std140, binding = 0, set = 2) readonly buffer ObjectDataBuffer {
+    InstanceData instances[];
+} objectBuffer;
+
+const float PI = 3.14159265358979;
+const uint TANGENT_ANGLE_MASK = 0x7FFFu;
+const uint TANGENT_FLIPPED_BIT = 0x8000u;
+
+vec3 decodeOctahedral(vec2 encoded) {
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.0);
+    direction.x += direction.x >= 0.0 ? -fold : fold;
+    direction.y += direction.y >= 0.0 ? -fold : fold;
+    return normalize(direction);
+}
+
+// Same basis as the one tangents were encoded in, from Duff et al.,
+// "Building an Orthonormal Basis, Revisited"
+vec3 decodeTangent(vec3 normal, uint tangent) {
+    float sign = normal.z >= 0.0 ? 1.0 : -1.0;
+    float a = -1.0 / (sign + normal.z);
+    float b = normal.x * normal.y * a;
+    vec3 tangentBasis = vec3(1.0 + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+    vec3 bitangentBasis = vec3(b, sign + normal.y * normal.y * a, -normal.y);
+    float angle = (float(tangent & TANGENT_ANGLE_MASK) / float(TANGENT_ANGLE_MASK) * 2.0 - 1.0) * PI;
+    return cos(angle) * tangentBasis + sin(angle) * bitangentBasis;
+}
+
+vec3 decodeColor(uint color) {
+    return vec3(
+        float(color >> 11) / 31.0,
+        float((color >> 5) & 63u) / 63.0,
+        float(color & 31u) / 31.0
+    );
+}
 
 void main() {
-    mat4 transform = objData.model;
+    mat4 transform = objectBuffer.instances[gl_InstanceIndex].transform;
 
     mat4 mvp = gpuScene.projection * gpuScene.view * transform;
-    normalWorld = normalize(vec3(transpose(inverse(transform)) * vec4(inNormal, 0.0)));
-    tangentWorld = normalize(vec3(transform * vec4(inTangent, 0.0)));
+    vec3 normal = decodeOctahedral(inNormal);
+    vec3 tangent = decodeTangent(normal, inTangent);
+    float bitangentSign = (inTangent & TANGENT_FLIPPED_BIT) != 0u ? -1.0 : 1.0;
+    normalWorld = normalize(vec3(transpose(inverse(transform)) * vec4(normal, 0.0)));
+    tangentWorld = vec4(normalize(vec3(transform * vec4(tangent, 0.0))), bitangentSign);
+    gl_Position = mvp * vec4(inPosition, 1.0);
     positionWorld = (transform * vec4(inPosition, 1.0)).xyz;
-    fragColor = inColor;
+    fragColor = decodeColor(inColor);
     fragTexCoord = inTexCoord;
-
-    gl_Position = mvp * vec4(inPosition, 1.0);
 }
@@ -0,0 +1,125 @@
+#include "core/algo/generation_index_array.h"
+
+#include <limits>
+
+namespace algo {
+
+namespace {
+
+// Spreads threads over the shards round robin in the order they first touch
+// any generation index array.
+uint8_t getThreadShard() {
+	static std::atomic<uint32_t> nextShard = 0;
+	thread_local const uint8_t shard = static_cast<uint8_t>(
+		nextShard.fetch_add(1, std::memory_order_relaxed) %
+		GenerationIndexArray::SHARD_COUNT
+	);
+	return shard;
+}
+
+bool tryPopFree(GenerationIndexShard& shard, uint32_t& index) {
+	if (shard.free.empty()) return false;
+	index = shard.free.back();
+	shard.free.pop_back();
+	return true;
+}
+
+// Makes a slot live and records it in its shard's dense list. The shard's
+// mutex must be held.
+GenerationIndexPair activate(
+	GenerationIndexArray& array, GenerationIndexShard& shard, uint32_t index
+) {
+	const uint32_t generation =
+		array.generation[index].fetch_add(1, std::memory_order_acq_rel) + 1;
+	array.denseIndex[index] = static_cast<uint32_t>(shard.dense.size());
+	shard.dense.push_back(index);
+	return {
+		.index = index,
+		.generation = generation,
+	};
+}
+
+}  // namespace
+
+GenerationIndexArray GenerationIndexArray::create() {
+	return GenerationIndexArray{
+		.generation = {},
+		.denseIndex = {},
+		.shard = {},
+		.size = std::make_unique<std::atomic<uint32_t>>(0),
+		.shards = std::make_unique<GenerationIndexShard[]>(SHARD_COUNT),
+	};
+}
+
+GenerationIndexPair reserveIndex(GenerationIndexArray& array) {
+	const uint8_t shardIndex = getThreadShard();
+	GenerationIndexShard& shard = array.shards[shardIndex];
+	uint32_t index;
+
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (tryPopFree(shard, index)) return activate(array, shard, index);
+	}
+
+	// Before growing, recycle from any other shard that is not busy
+	for (size_t i = 1; i < GenerationIndexArray::SHARD_COUNT; i++) {
+		GenerationIndexShard& other =
+			array.shards[(shardIndex + i) % GenerationIndexArray::SHARD_COUNT];
+		std::unique_lock<std::mutex> lock(other.mutex, std::try_to_lock);
+		if (lock.owns_lock() && tryPopFree(other, index))
+			return activate(array, other, index);
+	}
+
+	// The pages behind a slot exist before the size that reaches it is
+	// published, so readers bounded by getCapacity never see a missing page
+	index = array.size->load(std::memory_order_acquire);
+	do {
+		ASSERT(
+			index < std::numeric_limits<uint32_t>::max(),
+			"Exceeding the capacity of the generation index array"
+		);
+		array.generation.ensureCapacity(index + 1);
+		array.denseIndex.ensureCapacity(index + 1);
+		array.shard.ensureCapacity(index + 1);
+	} while (!array.size->compare_exchange_weak(
+		index, index + 1, std::memory_order_acq_rel
+	));
+	array.shard[index] = shardIndex;
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	return activate(array, shard, index);
+}
+
+size_t getLiveCount(const GenerationIndexArray& array) {
+	size_t count = 0;
+	for (size_t i = 0; i < GenerationIndexArray::SHARD_COUNT; i++) {
+		GenerationIndexShard& shard = array.shards[i];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		count += shard.dense.size();
+	}
+	return count;
+}
+
+void destroy(
+	GenerationIndexArray& array, std::span<const GenerationIndexPair> indices
+) {
+	for (const GenerationIndexPair& index : indices) {
+		GenerationIndexShard& shard = array.shards[array.shard[index.index]];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		uint32_t expected = index.generation;
+		if (!array.generation[index.index].compare_exchange_strong(
+				expected, index.generation + 1, std::memory_order_acq_rel
+			))
+			continue;
+		shard.free.push_back(index.index);
+
+		const uint32_t hole = array.denseIndex[index.index];
+		const uint32_t last = shard.dense.back();
+		shard.dense[hole] = last;
+		array.denseIndex[last] = hole;
+		shard.dense.pop_back();
+	}
+}
+
+}  // namespace algo
@@ -0,0 +1,61 @@
+#include "core/algo/radix_sort.h"
+
+#include <array>
+
+#include "core/logger/assert.h"
+
+namespace algo {
+
+namespace {
+constexpr uint32_t DIGIT_BITS = 8;
+constexpr uint32_t DIGIT_COUNT = 64 / DIGIT_BITS;
+constexpr uint32_t BUCKET_COUNT = 1 << DIGIT_BITS;
+}  // namespace
+
+void radixSort(
+	std::vector<uint64_t>& keys,
+	std::vector<uint32_t>& values,
+	std::vector<uint64_t>& keyScratch,
+	std::vector<uint32_t>& valueScratch
+) {
+	ASSERT(
+		keys.size() == values.size(),
+		"Sorting " << keys.size() << " keys with " << values.size()
+				   << " values"
+	);
+	const size_t count = keys.size();
+	if (count < 2) return;
+	keyScratch.resize(count);
+	valueScratch.resize(count);
+
+	std::array<std::array<uint32_t, BUCKET_COUNT>, DIGIT_COUNT> histograms{};
+	for (uint64_t key : keys)
+		for (uint32_t digit = 0; digit < DIGIT_COUNT; digit++)
+			histograms[digit][(key >> (digit * DIGIT_BITS)) & 0xFF]++;
+
+	for (uint32_t digit = 0; digit < DIGIT_COUNT; digit++) {
+		std::array<uint32_t, BUCKET_COUNT>& histogram = histograms[digit];
+		const uint32_t firstKeyBucket =
+			(keys[0] >> (digit * DIGIT_BITS)) & 0xFF;
+		if (histogram[firstKeyBucket] == count) continue;
+
+		// Bucket counts become the offset each bucket starts at
+		uint32_t offset = 0;
+		for (uint32_t& bucket : histogram) {
+			const uint32_t bucketCount = bucket;
+			bucket = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			const uint32_t bucket = (keys[i] >> (digit * DIGIT_BITS)) & 0xFF;
+			const uint32_t destination = histogram[bucket]++;
+			keyScratch[destination] = keys[i];
+			valueScratch[destination] = values[i];
+		}
+		std::swap(keys, keyScratch);
+		std::swap(values, valueScratch);
+	}
+}
+
+}  // namespace algo
@@ -0,0 +1,128 @@
+#include "core/algo/range_allocator.h"
+
+#include <algorithm>
+
+#include "core/logger/assert.h"
+
+namespace algo {
+
+namespace {
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+RangeAllocator RangeAllocator::create(uint64_t capacity) {
+	RangeAllocator allocator{.free = {}, .capacity = capacity};
+	reset(allocator);
+	return allocator;
+}
+
+std::optional<uint64_t> allocate(
+	RangeAllocator& allocator, uint64_t size, uint64_t alignment
+) {
+	ASSERT(size > 0, "Allocating an empty range");
+	ASSERT(alignment > 0, "Alignment has to be positive");
+
+	std::optional<size_t> best;
+	for (size_t i = 0; i < allocator.free.size(); i++) {
+		const Range& range = allocator.free[i];
+		const uint64_t padding =
+			alignUp(range.offset, alignment) - range.offset;
+		if (range.size < padding + size) continue;
+		if (!best || range.size < allocator.free[*best].size) best = i;
+	}
+	if (!best) return std::nullopt;
+
+	const Range range = allocator.free[*best];
+	const uint64_t offset = alignUp(range.offset, alignment);
+	const Range before{.offset = range.offset, .size = offset - range.offset};
+	const Range after{
+		.offset = offset + size,
+		.size = range.offset + range.size - (offset + size),
+	};
+	const auto position =
+		allocator.free.begin() + static_cast<std::ptrdiff_t>(*best);
+	if (before.size > 0 && after.size > 0) {
+		*position = after;
+		allocator.free.insert(position, before);
+	} else if (before.size > 0) {
+		*position = before;
+	} else if (after.size > 0) {
+		*position = after;
+	} else {
+		allocator.free.erase(position);
+	}
+	return offset;
+}
+
+void release(RangeAllocator& allocator, Range range) {
+	ASSERT(
+		range.offset + range.size <= allocator.capacity,
+		"Releasing [" << range.offset << ", " << range.offset + range.size
+					  << ") past the capacity of " << allocator.capacity
+	);
+	if (range.size == 0) return;
+
+	auto next = std::lower_bound(
+		allocator.free.begin(),
+		allocator.free.end(),
+		range.offset,
+		[](const Range& free, uint64_t offset) { return free.offset < offset; }
+	);
+	ASSERT(
+		next == allocator.free.end() ||
+			next->offset >= range.offset + range.size,
+		"Releasing a range that overlaps a free one at " << next->offset
+	);
+
+	const bool mergesPrevious =
+		next != allocator.free.begin() &&
+		std::prev(next)->offset + std::prev(next)->size == range.offset;
+	const bool mergesNext = next != allocator.free.end() &&
+							range.offset + range.size == next->offset;
+	if (mergesPrevious && mergesNext) {
+		std::prev(next)->size += range.size + next->size;
+		allocator.free.erase(next);
+	} else if (mergesPrevious) {
+		std::prev(next)->size += range.size;
+	} else if (mergesNext) {
+		next->offset = range.offset;
+		next->size += range.size;
+	} else {
+		allocator.free.insert(next, range);
+	}
+}
+
+void grow(RangeAllocator& allocator, uint64_t newCapacity) {
+	ASSERT(
+		newCapacity >= allocator.capacity,
+		"Shrinking a range allocator from " << allocator.capacity << " to "
+											<< newCapacity
+	);
+	const uint64_t oldCapacity = allocator.capacity;
+	allocator.capacity = newCapacity;
+	release(
+		allocator, {.offset = oldCapacity, .size = newCapacity - oldCapacity}
+	);
+}
+
+void reset(RangeAllocator& allocator) {
+	allocator.free.clear();
+	if (allocator.capacity > 0)
+		allocator.free.push_back({.offset = 0, .size = allocator.capacity});
+}
+
+uint64_t getFreeSize(const RangeAllocator& allocator) {
+	uint64_t size = 0;
+	for (const Range& range : allocator.free) size += range.size;
+	return size;
+}
+
+uint64_t getLargestFreeSize(const RangeAllocator& allocator) {
+	uint64_t size = 0;
+	for (const Range& range : allocator.free) size = std::max(size, range.size);
+	return size;
+}
+
+}  // namespace algo
@@ -0,0 +1,229 @@
+#include "core/jobs/scheduler.h"
+
+#include <algorithm>
+
+#include "core/logger/assert.h"
+#include "core/logger/logger.h"
+
+namespace jobs {
+std::optional<Scheduler> scheduler;
+
+namespace {
+
+// Queue that jobs submitted from this thread go to. Threads the scheduler
+// does not own share the main thread's queue.
+thread_local uint32_t currentQueue = 0;
+
+void wakeWorker(SchedulerState& state) {
+	if (state.numSleeping.load() == 0) return;
+	// Taking the lock orders this against a worker about to sleep
+	{ std::lock_guard lock(state.sleepMutex); }
+	state.wake.notify_one();
+}
+
+void enqueue(SchedulerState& state, Job job) {
+	if (job.affinity == Affinity::eMainThread) {
+		std::lock_guard lock(state.mainThreadMutex);
+		state.mainThreadJobs.push_back(std::move(job));
+		return;
+	}
+
+	WorkerQueue& queue = state.queues[currentQueue];
+	{
+		std::lock_guard lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+	state.numQueued.fetch_add(1);
+	wakeWorker(state);
+}
+
+std::optional<Job> popBack(SchedulerState& state, WorkerQueue& queue) {
+	std::lock_guard lock(queue.mutex);
+	if (queue.jobs.empty()) return std::nullopt;
+	Job job = std::move(queue.jobs.back());
+	queue.jobs.pop_back();
+	state.numQueued.fetch_sub(1);
+	return job;
+}
+
+std::optional<Job> steal(SchedulerState& state, WorkerQueue& queue) {
+	// A busy victim is skipped rather than waited on
+	std::unique_lock lock(queue.mutex, std::try_to_lock);
+	if (!lock.owns_lock() || queue.jobs.empty()) return std::nullopt;
+	Job job = std::move(queue.jobs.front());
+	queue.jobs.pop_front();
+	state.numQueued.fetch_sub(1);
+	return job;
+}
+
+std::optional<Job> popMainThreadJob(SchedulerState& state) {
+	std::lock_guard lock(state.mainThreadMutex);
+	if (state.mainThreadJobs.empty()) return std::nullopt;
+	Job job = std::move(state.mainThreadJobs.front());
+	state.mainThreadJobs.pop_front();
+	return job;
+}
+
+std::optional<Job> takeJob(SchedulerState& state) {
+	if (std::optional<Job> job = popBack(state, state.queues[currentQueue]))
+		return job;
+	if (std::this_thread::get_id() == state.mainThread)
+		if (std::optional<Job> job = popMainThreadJob(state)) return job;
+	for (uint32_t offset = 1; offset < state.numQueues; offset++) {
+		const uint32_t victim = (currentQueue + offset) % state.numQueues;
+		if (std::optional<Job> job = steal(state, state.queues[victim]))
+			return job;
+	}
+	return std::nullopt;
+}
+
+void run(SchedulerState& state, Job& job) {
+	job.function();
+	if (!job.counter) return;
+
+	std::vector<Job> released;
+	{
+		// Held across the decrement so a waiter cannot destroy the counter
+		// while this thread still uses it
+		std::lock_guard lock(job.counter->waitersMutex);
+		if (job.counter->pending.fetch_sub(1) == 1)
+			released = std::move(job.counter->waiters);
+	}
+	for (Job& waiter : released) enqueue(state, std::move(waiter));
+}
+
+void workerLoop(SchedulerState& state, uint32_t queue) {
+	currentQueue = queue;
+	while (true) {
+		if (std::optional<Job> job = takeJob(state)) {
+			run(state, job.value());
+			continue;
+		}
+
+		std::unique_lock lock(state.sleepMutex);
+		state.numSleeping.fetch_add(1);
+		state.wake.wait(lock, [&]() {
+			return state.numQueued.load() > 0 || state.isStopping.load();
+		});
+		state.numSleeping.fetch_sub(1);
+		if (state.isStopping.load() && state.numQueued.load() == 0) return;
+	}
+}
+
+}  // namespace
+
+Scheduler Scheduler::create(std::optional<uint32_t> numWorkers) {
+	const uint32_t workerCount = numWorkers.value_or(
+		std::max(std::thread::hardware_concurrency(), 1u) - 1
+	);
+
+	Scheduler scheduler{
+		.state = std::make_unique<SchedulerState>(),
+		.workers = {},
+	};
+	SchedulerState& state = *scheduler.state;
+	state.numQueues = workerCount + 1;
+	state.queues = std::make_unique<WorkerQueue[]>(state.numQueues);
+	state.numQueued = 0;
+	state.numSleeping = 0;
+	state.isStopping = false;
+	state.mainThread = std::this_thread::get_id();
+	currentQueue = 0;
+
+	scheduler.workers.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; i++)
+		scheduler.workers.emplace_back(workerLoop, std::ref(state), i + 1);
+	LLOG_INFO << "Job scheduler started with " << workerCount << " workers";
+	return scheduler;
+}
+
+void Scheduler::destroy() {
+	ASSERT(
+		std::this_thread::get_id() == state->mainThread,
+		"Job scheduler must be destroyed from the thread that created it"
+	);
+	runMainThreadJobs(*this);
+	// The main thread's queue is drained by workers, or by nobody without any
+	while (std::optional<Job> job = popBack(*state, state->queues[0]))
+		run(*state, job.value());
+
+	{
+		std::lock_guard lock(state->sleepMutex);
+		state->isStopping = true;
+	}
+	state->wake.notify_all();
+	for (std::thread& worker : workers) worker.join();
+	workers.clear();
+}
+
+void submit(
+	Scheduler& scheduler,
+	JobFunction function,
+	Counter* counter,
+	Affinity affinity
+) {
+	if (counter) counter->pending.fetch_add(1);
+	enqueue(
+		*scheduler.state,
+		Job{
+			.function = std::move(function),
+			.counter = counter,
+			.affinity = affinity,
+		}
+	);
+}
+
+void submitAfter(
+	Scheduler& scheduler,
+	Counter& dependency,
+	JobFunction function,
+	Counter* counter,
+	Affinity affinity
+) {
+	if (counter) counter->pending.fetch_add(1);
+	Job job{
+		.function = std::move(function),
+		.counter = counter,
+		.affinity = affinity,
+	};
+	{
+		std::lock_guard lock(dependency.waitersMutex);
+		if (dependency.pending.load() > 0) {
+			dependency.waiters.push_back(std::move(job));
+			return;
+		}
+	}
+	enqueue(*scheduler.state, std::move(job));
+}
+
+void wait(Scheduler& scheduler, Counter& counter) {
+	while (counter.pending.load() > 0) {
+		if (std::optional<Job> job = takeJob(*scheduler.state))
+			run(*scheduler.state, job.value());
+		else
+			std::this_thread::yield();
+	}
+	// Wait out the thread that brought the counter to zero
+	std::lock_guard lock(counter.waitersMutex);
+}
+
+void runMainThreadJobs(Scheduler& scheduler) {
+	ASSERT(
+		std::this_thread::get_id() == scheduler.state->mainThread,
+		"Main thread jobs run from another thread"
+	);
+	// Jobs queued by these jobs wait for the next call, so a job that
+	// resubmits itself cannot stall the frame
+	std::deque<Job> jobs;
+	{
+		std::lock_guard lock(scheduler.state->mainThreadMutex);
+		std::swap(jobs, scheduler.state->mainThreadJobs);
+	}
+	for (Job& job : jobs) run(*scheduler.state, job);
+}
+
+uint32_t getThreadCount(const Scheduler& scheduler) {
+	return static_cast<uint32_t>(scheduler.workers.size()) + 1;
+}
+
+}  // namespace jobs
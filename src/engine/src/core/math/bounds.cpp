@@ -0,0 +1,108 @@
+#include "core/math/bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace math {
+
+Bounds computeBounds(std::span<const glm::vec3> points) {
+	if (points.empty())
+		return {
+			.box = {.min = glm::vec3(0), .max = glm::vec3(0)},
+			.sphere = {.center = glm::vec3(0), .radius = 0},
+		};
+
+	AABB box{
+		.min = glm::vec3(std::numeric_limits<float>::max()),
+		.max = glm::vec3(std::numeric_limits<float>::lowest()),
+	};
+	for (const glm::vec3& point : points) {
+		box.min = glm::min(box.min, point);
+		box.max = glm::max(box.max, point);
+	}
+
+	const glm::vec3 center = (box.min + box.max) * 0.5f;
+	float radiusSquared = 0;
+	for (const glm::vec3& point : points) {
+		const glm::vec3 offset = point - center;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+	return {
+		.box = box,
+		.sphere = {.center = center, .radius = std::sqrt(radiusSquared)},
+	};
+}
+
+AABB transform(const AABB& box, const glm::mat4& localToWorld) {
+	// Arvo: each output axis is the translation plus, per input axis, the
+	// smaller and larger of the two scaled extents
+	const glm::vec3 translation(localToWorld[3]);
+	AABB result{.min = translation, .max = translation};
+	for (int column = 0; column < 3; column++) {
+		for (int row = 0; row < 3; row++) {
+			const float a = localToWorld[column][row] * box.min[column];
+			const float b = localToWorld[column][row] * box.max[column];
+			result.min[row] += std::min(a, b);
+			result.max[row] += std::max(a, b);
+		}
+	}
+	return result;
+}
+
+AABB merge(const AABB& a, const AABB& b) {
+	return {.min = glm::min(a.min, b.min), .max = glm::max(a.max, b.max)};
+}
+
+bool overlaps(const AABB& a, const AABB& b) {
+	return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y &&
+		   b.min.y <= a.max.y && a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
+
+float getSurfaceArea(const AABB& box) {
+	const glm::vec3 extent = box.max - box.min;
+	return 2 * (extent.x * extent.y + extent.y * extent.z +
+				extent.z * extent.x);
+}
+
+Sphere transform(const Sphere& sphere, const glm::mat4& localToWorld) {
+	const float maxScaleSquared = std::max(
+		{glm::dot(glm::vec3(localToWorld[0]), glm::vec3(localToWorld[0])),
+		 glm::dot(glm::vec3(localToWorld[1]), glm::vec3(localToWorld[1])),
+		 glm::dot(glm::vec3(localToWorld[2]), glm::vec3(localToWorld[2]))}
+	);
+	return {
+		.center = glm::vec3(localToWorld * glm::vec4(sphere.center, 1)),
+		.radius = sphere.radius * std::sqrt(maxScaleSquared),
+	};
+}
+
+void clear(BoundingSpheres& spheres) {
+	spheres.centerX.clear();
+	spheres.centerY.clear();
+	spheres.centerZ.clear();
+	spheres.radius.clear();
+}
+
+void resize(BoundingSpheres& spheres, size_t size) {
+	spheres.centerX.resize(size);
+	spheres.centerY.resize(size);
+	spheres.centerZ.resize(size);
+	spheres.radius.resize(size);
+}
+
+void append(BoundingSpheres& spheres, const Sphere& sphere) {
+	spheres.centerX.push_back(sphere.center.x);
+	spheres.centerY.push_back(sphere.center.y);
+	spheres.centerZ.push_back(sphere.center.z);
+	spheres.radius.push_back(sphere.radius);
+}
+
+void set(BoundingSpheres& spheres, size_t index, const Sphere& sphere) {
+	spheres.centerX[index] = sphere.center.x;
+	spheres.centerY[index] = sphere.center.y;
+	spheres.centerZ[index] = sphere.center.z;
+	spheres.radius[index] = sphere.radius;
+}
+
+}  // namespace math
@@ -0,0 +1,357 @@
+#include "core/math/bvh.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace math {
+
+namespace {
+
+constexpr uint32_t BIN_COUNT = 16;
+// Cost of visiting a node relative to testing one primitive
+constexpr float TRAVERSAL_COST = 1.0f;
+
+// A tree of MAX_DEPTH levels never holds more than one pending node per
+// level plus the one being visited
+using TraversalStack = std::array<uint32_t, BVH::MAX_DEPTH + 2>;
+
+const AABB EMPTY_BOX{
+	.min = glm::vec3(std::numeric_limits<float>::max()),
+	.max = glm::vec3(std::numeric_limits<float>::lowest()),
+};
+
+glm::vec3 getCentroid(const AABB& box) { return (box.min + box.max) * 0.5f; }
+
+struct Split {
+	int axis;
+	uint32_t bin;
+	float cost;
+};
+
+uint32_t getBin(float centroid, float minimum, float scale) {
+	return std::min(
+		BIN_COUNT - 1, static_cast<uint32_t>((centroid - minimum) * scale)
+	);
+}
+
+std::optional<Split> findBestSplit(
+	std::span<const AABB> primitiveBounds, const AABB& centroidBounds
+) {
+	std::optional<Split> best = std::nullopt;
+	for (int axis = 0; axis < 3; axis++) {
+		const float extent =
+			centroidBounds.max[axis] - centroidBounds.min[axis];
+		if (extent <= 0) continue;
+		const float scale = BIN_COUNT / extent;
+
+		std::array<AABB, BIN_COUNT> binBounds;
+		std::array<uint32_t, BIN_COUNT> binCounts{};
+		binBounds.fill(EMPTY_BOX);
+		for (const AABB& box : primitiveBounds) {
+			const uint32_t bin =
+				getBin(getCentroid(box)[axis], centroidBounds.min[axis], scale);
+			binBounds[bin] = merge(binBounds[bin], box);
+			binCounts[bin]++;
+		}
+
+		// Splitting after bin i puts bins [0, i] on the left
+		std::array<float, BIN_COUNT - 1> leftCosts;
+		AABB left = EMPTY_BOX;
+		uint32_t leftCount = 0;
+		for (uint32_t i = 0; i + 1 < BIN_COUNT; i++) {
+			left = merge(left, binBounds[i]);
+			leftCount += binCounts[i];
+			leftCosts[i] = leftCount ? leftCount * getSurfaceArea(left) : 0;
+		}
+		AABB right = EMPTY_BOX;
+		uint32_t rightCount = 0;
+		for (uint32_t i = BIN_COUNT - 1; i > 0; i--) {
+			right = merge(right, binBounds[i]);
+			rightCount += binCounts[i];
+			if (rightCount == 0 || rightCount == primitiveBounds.size())
+				continue;
+			const float cost =
+				leftCosts[i - 1] + rightCount * getSurfaceArea(right);
+			if (!best || cost < best->cost)
+				best = Split{.axis = axis, .bin = i - 1, .cost = cost};
+		}
+	}
+	return best;
+}
+
+// Fully inside is reported separately so a query can take a whole subtree
+// without testing it further.
+enum class Containment { eOutside, eIntersecting, eInside };
+
+Containment classify(const Frustum& frustum, const AABB& box) {
+	Containment result = Containment::eInside;
+	for (const glm::vec4& plane : frustum.planes) {
+		const glm::vec3 normal(plane);
+		const glm::vec3 farthest = glm::vec3(
+			normal.x >= 0 ? box.max.x : box.min.x,
+			normal.y >= 0 ? box.max.y : box.min.y,
+			normal.z >= 0 ? box.max.z : box.min.z
+		);
+		if (glm::dot(normal, farthest) + plane.w < 0)
+			return Containment::eOutside;
+		const glm::vec3 nearest = glm::vec3(
+			normal.x >= 0 ? box.min.x : box.max.x,
+			normal.y >= 0 ? box.min.y : box.max.y,
+			normal.z >= 0 ? box.min.z : box.max.z
+		);
+		if (glm::dot(normal, nearest) + plane.w < 0)
+			result = Containment::eIntersecting;
+	}
+	return result;
+}
+
+// Distance at which the ray enters the box, if it does before `maxDistance`
+std::optional<float> intersect(
+	const AABB& box,
+	const glm::vec3& origin,
+	const glm::vec3& inverseDirection,
+	float maxDistance
+) {
+	const glm::vec3 t0 = (box.min - origin) * inverseDirection;
+	const glm::vec3 t1 = (box.max - origin) * inverseDirection;
+	const glm::vec3 tNear = glm::min(t0, t1);
+	const glm::vec3 tFar = glm::max(t0, t1);
+	const float enter = std::max({tNear.x, tNear.y, tNear.z, 0.0f});
+	const float exit = std::min({tFar.x, tFar.y, tFar.z, maxDistance});
+	if (enter > exit) return std::nullopt;
+	return enter;
+}
+
+}  // namespace
+
+BVH BVH::create(std::span<const AABB> bounds) {
+	BVH bvh{
+		.nodes = {},
+		.primitives = std::vector<uint32_t>(bounds.size()),
+		.primitiveBounds = std::vector<AABB>(bounds.begin(), bounds.end()),
+	};
+	if (bounds.empty()) return bvh;
+	for (uint32_t i = 0; i < bounds.size(); i++) bvh.primitives[i] = i;
+
+	// Each split adds two nodes and a tree has at most one leaf per primitive
+	bvh.nodes.reserve(2 * bounds.size() - 1);
+	bvh.nodes.push_back({
+		.bounds = EMPTY_BOX,
+		.primitiveBegin = 0,
+		.primitiveCount = static_cast<uint32_t>(bounds.size()),
+		.children = 0,
+	});
+
+	struct Task {
+		uint32_t node;
+		uint32_t depth;
+	};
+	std::vector<Task> tasks = {{.node = 0, .depth = 0}};
+	while (!tasks.empty()) {
+		const Task task = tasks.back();
+		tasks.pop_back();
+
+		BVHNode& node = bvh.nodes[task.node];
+		const std::span<AABB> nodeBounds = std::span(bvh.primitiveBounds)
+											   .subspan(
+												   node.primitiveBegin,
+												   node.primitiveCount
+											   );
+		AABB centroidBounds = EMPTY_BOX;
+		node.bounds = EMPTY_BOX;
+		for (const AABB& box : nodeBounds) {
+			node.bounds = merge(node.bounds, box);
+			const glm::vec3 centroid = getCentroid(box);
+			centroidBounds = merge(centroidBounds, {centroid, centroid});
+		}
+
+		const bool mustBeLeaf = node.primitiveCount <= MAX_LEAF_SIZE ||
+								task.depth >= MAX_DEPTH;
+		if (mustBeLeaf) continue;
+		const std::optional<Split> split =
+			findBestSplit(nodeBounds, centroidBounds);
+		if (!split) continue;
+		const float splitCost =
+			TRAVERSAL_COST + split->cost / getSurfaceArea(node.bounds);
+		if (splitCost >= node.primitiveCount) continue;
+
+		// Partition primitives and their bounds together
+		const float scale = BIN_COUNT / (centroidBounds.max[split->axis] -
+										 centroidBounds.min[split->axis]);
+		const auto isLeft = [&](const AABB& box) {
+			return getBin(
+					   getCentroid(box)[split->axis],
+					   centroidBounds.min[split->axis],
+					   scale
+				   ) <= split->bin;
+		};
+		uint32_t leftCount = 0;
+		for (uint32_t i = 0; i < node.primitiveCount; i++) {
+			if (!isLeft(nodeBounds[i])) continue;
+			std::swap(nodeBounds[i], nodeBounds[leftCount]);
+			std::swap(
+				bvh.primitives[node.primitiveBegin + i],
+				bvh.primitives[node.primitiveBegin + leftCount]
+			);
+			leftCount++;
+		}
+
+		const uint32_t children = static_cast<uint32_t>(bvh.nodes.size());
+		const uint32_t begin = node.primitiveBegin;
+		const uint32_t count = node.primitiveCount;
+		node.children = children;
+		// `node` dangles once the vector grows
+		bvh.nodes.push_back({
+			.bounds = EMPTY_BOX,
+			.primitiveBegin = begin,
+			.primitiveCount = leftCount,
+			.children = 0,
+		});
+		bvh.nodes.push_back({
+			.bounds = EMPTY_BOX,
+			.primitiveBegin = begin + leftCount,
+			.primitiveCount = count - leftCount,
+			.children = 0,
+		});
+		tasks.push_back({.node = children, .depth = task.depth + 1});
+		tasks.push_back({.node = children + 1, .depth = task.depth + 1});
+	}
+	return bvh;
+}
+
+void refit(BVH& bvh, std::span<const AABB> bounds) {
+	for (size_t i = 0; i < bvh.primitives.size(); i++)
+		bvh.primitiveBounds[i] = bounds[bvh.primitives[i]];
+
+	for (size_t i = bvh.nodes.size(); i-- > 0;) {
+		BVHNode& node = bvh.nodes[i];
+		if (node.children) {
+			node.bounds = merge(
+				bvh.nodes[node.children].bounds,
+				bvh.nodes[node.children + 1].bounds
+			);
+			continue;
+		}
+		node.bounds = EMPTY_BOX;
+		for (uint32_t j = 0; j < node.primitiveCount; j++)
+			node.bounds = merge(
+				node.bounds, bvh.primitiveBounds[node.primitiveBegin + j]
+			);
+	}
+}
+
+void query(
+	const BVH& bvh, const Frustum& frustum, std::vector<uint32_t>& result
+) {
+	if (bvh.nodes.empty()) return;
+	TraversalStack stack;
+	size_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const BVHNode& node = bvh.nodes[stack[--stackSize]];
+		const Containment containment = classify(frustum, node.bounds);
+		if (containment == Containment::eOutside) continue;
+
+		const auto begin = bvh.primitives.begin() + node.primitiveBegin;
+		if (containment == Containment::eInside) {
+			result.insert(result.end(), begin, begin + node.primitiveCount);
+		} else if (node.children) {
+			stack[stackSize++] = node.children;
+			stack[stackSize++] = node.children + 1;
+		} else {
+			for (uint32_t i = 0; i < node.primitiveCount; i++) {
+				const AABB& box =
+					bvh.primitiveBounds[node.primitiveBegin + i];
+				if (classify(frustum, box) != Containment::eOutside)
+					result.push_back(begin[i]);
+			}
+		}
+	}
+}
+
+void query(const BVH& bvh, const AABB& box, std::vector<uint32_t>& result) {
+	if (bvh.nodes.empty()) return;
+	TraversalStack stack;
+	size_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const BVHNode& node = bvh.nodes[stack[--stackSize]];
+		if (!overlaps(node.bounds, box)) continue;
+
+		if (node.children) {
+			stack[stackSize++] = node.children;
+			stack[stackSize++] = node.children + 1;
+			continue;
+		}
+		for (uint32_t i = node.primitiveBegin;
+			 i < node.primitiveBegin + node.primitiveCount;
+			 i++)
+			if (overlaps(bvh.primitiveBounds[i], box))
+				result.push_back(bvh.primitives[i]);
+	}
+}
+
+std::optional<RayHit> raycast(
+	const BVH& bvh, const Ray& ray, float maxDistance
+) {
+	if (bvh.nodes.empty()) return std::nullopt;
+	// Division by a zero component gives infinities, which the slab test
+	// handles
+	const glm::vec3 inverseDirection = 1.0f / ray.direction;
+
+	std::optional<RayHit> closest = std::nullopt;
+	TraversalStack stack;
+	size_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const BVHNode& node = bvh.nodes[stack[--stackSize]];
+		const float limit = closest ? closest->distance : maxDistance;
+		if (!intersect(node.bounds, ray.origin, inverseDirection, limit))
+			continue;
+
+		if (node.children) {
+			// Visit the nearer child first so it can shorten the ray
+			const std::optional<float> left = intersect(
+				bvh.nodes[node.children].bounds,
+				ray.origin,
+				inverseDirection,
+				limit
+			);
+			const std::optional<float> right = intersect(
+				bvh.nodes[node.children + 1].bounds,
+				ray.origin,
+				inverseDirection,
+				limit
+			);
+			const bool isRightNearer =
+				right && (!left || right.value() < left.value());
+			if (left && right) {
+				stack[stackSize++] = node.children + (isRightNearer ? 0 : 1);
+				stack[stackSize++] = node.children + (isRightNearer ? 1 : 0);
+			} else if (left || right) {
+				stack[stackSize++] = node.children + (right ? 1 : 0);
+			}
+			continue;
+		}
+
+		for (uint32_t i = node.primitiveBegin;
+			 i < node.primitiveBegin + node.primitiveCount;
+			 i++) {
+			const std::optional<float> distance = intersect(
+				bvh.primitiveBounds[i],
+				ray.origin,
+				inverseDirection,
+				closest ? closest->distance : maxDistance
+			);
+			if (distance && (!closest || distance.value() < closest->distance))
+				closest = RayHit{
+					.primitive = bvh.primitives[i],
+					.distance = distance.value()
+				};
+		}
+	}
+	return closest;
+}
+
+}  // namespace math
@@ -0,0 +1,142 @@
+#include "core/math/frustum.h"
+
+#include <bit>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace math {
+
+namespace {
+
+bool isInside(const glm::vec4& plane, glm::vec3 center, float radius) {
+	const float distance = plane.x * center.x + plane.y * center.y +
+						   plane.z * center.z + plane.w;
+	return distance >= -radius;
+}
+
+void pushVisible(std::vector<uint32_t>& visible, uint32_t first, int mask) {
+	for (uint32_t bits = static_cast<uint32_t>(mask); bits != 0;
+		 bits &= bits - 1)
+		visible.push_back(first + std::countr_zero(bits));
+}
+
+void cullRange(
+	const Frustum& frustum,
+	const BoundingSpheres& spheres,
+	uint32_t begin,
+	uint32_t end,
+	std::vector<uint32_t>& visible
+) {
+	for (uint32_t i = begin; i < end; i++) {
+		const glm::vec3 center{
+			spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]
+		};
+		bool isVisible = true;
+		for (const glm::vec4& plane : frustum.planes)
+			isVisible = isVisible && isInside(plane, center, spheres.radius[i]);
+		if (isVisible) visible.push_back(i);
+	}
+}
+
+}  // namespace
+
+Frustum Frustum::create(const glm::mat4& viewProjection) {
+	// Gribb-Hartmann: each clip plane is a sum or difference of matrix rows
+	const glm::mat4 rows = glm::transpose(viewProjection);
+	Frustum frustum{
+		.planes = {
+			rows[3] + rows[0],
+			rows[3] - rows[0],
+			rows[3] + rows[1],
+			rows[3] - rows[1],
+			rows[2],
+			rows[3] - rows[2],
+		}
+	};
+	for (glm::vec4& plane : frustum.planes)
+		plane /= glm::length(glm::vec3(plane));
+	return frustum;
+}
+
+bool intersects(const Frustum& frustum, const Sphere& sphere) {
+	for (const glm::vec4& plane : frustum.planes)
+		if (!isInside(plane, sphere.center, sphere.radius)) return false;
+	return true;
+}
+
+void cullScalar(
+	const Frustum& frustum,
+	const BoundingSpheres& spheres,
+	std::vector<uint32_t>& visible
+) {
+	cullRange(
+		frustum,
+		spheres,
+		0,
+		static_cast<uint32_t>(spheres.radius.size()),
+		visible
+	);
+}
+
+void cull(
+	const Frustum& frustum,
+	const BoundingSpheres& spheres,
+	std::vector<uint32_t>& visible
+) {
+	const uint32_t count = static_cast<uint32_t>(spheres.radius.size());
+	uint32_t i = 0;
+
+#if defined(__AVX__)
+	constexpr uint32_t WIDTH = 8;
+	for (; i + WIDTH <= count; i += WIDTH) {
+		const __m256 x = _mm256_loadu_ps(spheres.centerX.data() + i);
+		const __m256 y = _mm256_loadu_ps(spheres.centerY.data() + i);
+		const __m256 z = _mm256_loadu_ps(spheres.centerZ.data() + i);
+		const __m256 negativeRadius = _mm256_sub_ps(
+			_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius.data() + i)
+		);
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const glm::vec4& plane : frustum.planes) {
+			__m256 distance = _mm256_mul_ps(_mm256_set1_ps(plane.x), x);
+			distance = _mm256_add_ps(
+				distance, _mm256_mul_ps(_mm256_set1_ps(plane.y), y)
+			);
+			distance = _mm256_add_ps(
+				distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), z)
+			);
+			distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+			inside = _mm256_and_ps(
+				inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ)
+			);
+		}
+		pushVisible(visible, i, _mm256_movemask_ps(inside));
+	}
+#elif defined(__SSE2__) || defined(_M_X64)
+	constexpr uint32_t WIDTH = 4;
+	for (; i + WIDTH <= count; i += WIDTH) {
+		const __m128 x = _mm_loadu_ps(spheres.centerX.data() + i);
+		const __m128 y = _mm_loadu_ps(spheres.centerY.data() + i);
+		const __m128 z = _mm_loadu_ps(spheres.centerZ.data() + i);
+		const __m128 negativeRadius = _mm_sub_ps(
+			_mm_setzero_ps(), _mm_loadu_ps(spheres.radius.data() + i)
+		);
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const glm::vec4& plane : frustum.planes) {
+			__m128 distance = _mm_mul_ps(_mm_set1_ps(plane.x), x);
+			distance =
+				_mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.y), y));
+			distance =
+				_mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), z));
+			distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+		pushVisible(visible, i, _mm_movemask_ps(inside));
+	}
+#endif
+
+	cullRange(frustum, spheres, i, count, visible);
+}
+
+}  // namespace math
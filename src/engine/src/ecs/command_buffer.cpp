@@ -0,0 +1,92 @@
+#include "ecs/command_buffer.h"
+
+#include <array>
+
+namespace ecs {
+
+CommandBuffer CommandBuffer::create() {
+	return CommandBuffer{
+		.commands = {},
+		.values = {},
+		.payload = {},
+	};
+}
+
+void recordValue(
+	CommandBuffer& buffer, const ComponentInfo& component, const void* value
+) {
+	const size_t offset = buffer.payload.size();
+	buffer.payload.resize(offset + component.size);
+	std::memcpy(buffer.payload.data() + offset, value, component.size);
+	buffer.values.push_back(
+		{.component = &component, .offset = static_cast<uint32_t>(offset)}
+	);
+}
+
+void destroyEntity(CommandBuffer& buffer, Entity entity) {
+	buffer.commands.push_back(
+		{.type = CommandType::Destroy,
+		 .entity = entity,
+		 .firstValue = 0,
+		 .valueCount = 0}
+	);
+}
+
+void apply(CommandBuffer& buffer, Registry& registry) {
+	constexpr size_t MAX_INLINE_COMPONENTS = 16;
+	std::array<const ComponentInfo*, MAX_INLINE_COMPONENTS> components;
+	std::array<const void*, MAX_INLINE_COMPONENTS> values;
+
+	for (const Command& command : buffer.commands) {
+		if (!isAlive(registry, command.entity)) continue;
+
+		switch (command.type) {
+			case CommandType::Create: {
+				ASSERT(
+					command.valueCount <= MAX_INLINE_COMPONENTS,
+					"Entities are created with at most "
+						<< MAX_INLINE_COMPONENTS << " components"
+				);
+				for (uint32_t i = 0; i < command.valueCount; i++) {
+					const ComponentValue& value =
+						buffer.values[command.firstValue + i];
+					components[i] = value.component;
+					values[i] = buffer.payload.data() + value.offset;
+				}
+				placeEntity(
+					registry,
+					command.entity,
+					std::span(components.data(), command.valueCount),
+					std::span(values.data(), command.valueCount)
+				);
+				break;
+			}
+			case CommandType::Destroy:
+				destroyEntity(registry, command.entity);
+				break;
+			case CommandType::Set: {
+				const ComponentValue& value = buffer.values[command.firstValue];
+				setComponent(
+					registry,
+					command.entity,
+					*value.component,
+					buffer.payload.data() + value.offset
+				);
+				break;
+			}
+			case CommandType::Remove:
+				removeComponent(
+					registry,
+					command.entity,
+					*buffer.values[command.firstValue].component
+				);
+				break;
+		}
+	}
+
+	buffer.commands.clear();
+	buffer.values.clear();
+	buffer.payload.clear();
+}
+
+}  // namespace ecs
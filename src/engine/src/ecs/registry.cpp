@@ -0,0 +1,369 @@
+#include "ecs/registry.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace ecs {
+
+namespace {
+
+size_t alignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+std::vector<int> getSignature(std::span<const ComponentInfo* const> components
+) {
+	std::vector<int> signature;
+	signature.reserve(components.size());
+	for (const ComponentInfo* component : components)
+		signature.push_back(component->id);
+	return signature;
+}
+
+uint32_t getOrCreateArchetype(
+	Registry& registry, std::span<const ComponentInfo* const> sortedComponents
+) {
+	std::vector<int> signature = getSignature(sortedComponents);
+	const auto existing = registry.archetypeLookup.find(signature);
+	if (existing != registry.archetypeLookup.end()) return existing->second;
+
+	const uint32_t index = static_cast<uint32_t>(registry.archetypes.size());
+	registry.archetypes.push_back(Archetype::create(sortedComponents));
+	registry.archetypeLookup.emplace(std::move(signature), index);
+	return index;
+}
+
+// Archetype with `component` added to or removed from `source`, following the
+// cached edge when there is one.
+uint32_t getNeighbour(
+	Registry& registry,
+	uint32_t source,
+	const ComponentInfo& component,
+	bool add
+) {
+	{
+		const Archetype& archetype = registry.archetypes[source];
+		const std::vector<std::pair<int, uint32_t>>& edges =
+			add ? archetype.addEdges : archetype.removeEdges;
+		for (const auto& [componentId, target] : edges)
+			if (componentId == component.id) return target;
+	}
+
+	std::vector<const ComponentInfo*> components =
+		registry.archetypes[source].components;
+	if (add) {
+		components.insert(
+			std::upper_bound(
+				components.begin(),
+				components.end(),
+				&component,
+				[](const ComponentInfo* a, const ComponentInfo* b) {
+					return a->id < b->id;
+				}
+			),
+			&component
+		);
+	} else {
+		std::erase(components, &component);
+	}
+
+	// May reallocate the archetypes, so look the source up again afterwards
+	const uint32_t target = getOrCreateArchetype(registry, components);
+	Archetype& archetype = registry.archetypes[source];
+	(add ? archetype.addEdges : archetype.removeEdges)
+		.emplace_back(component.id, target);
+	return target;
+}
+
+uint32_t allocateRow(Archetype& archetype) {
+	const uint32_t row = static_cast<uint32_t>(archetype.count);
+	if (row == archetype.chunks.size() * archetype.chunkCapacity) {
+		archetype.chunks.push_back(
+			{.data = std::unique_ptr<std::byte[], ChunkDeleter>(
+				 static_cast<std::byte*>(::operator new(
+					 CHUNK_SIZE, std::align_val_t{CACHE_LINE_SIZE}
+				 ))
+			 ),
+			 .count = 0}
+		);
+	}
+	archetype.chunks.back().count++;
+	archetype.count++;
+	return row;
+}
+
+std::pair<Chunk*, uint32_t> locateRow(Archetype& archetype, uint32_t row) {
+	return {
+		&archetype.chunks[row / archetype.chunkCapacity],
+		row % archetype.chunkCapacity
+	};
+}
+
+void* getComponentAddress(Archetype& archetype, int column, uint32_t row) {
+	const auto [chunk, offset] = locateRow(archetype, row);
+	return getColumn(archetype, *chunk, column) +
+		   size_t{offset} * archetype.components[column]->size;
+}
+
+// Moves the last row into `row` so that rows stay packed.
+void removeRow(Registry& registry, uint32_t archetypeIndex, uint32_t row) {
+	Archetype& archetype = registry.archetypes[archetypeIndex];
+	const uint32_t last = static_cast<uint32_t>(archetype.count - 1);
+
+	if (row != last) {
+		const auto [chunk, offset] = locateRow(archetype, row);
+		const auto [lastChunk, lastOffset] = locateRow(archetype, last);
+		const Entity moved = getEntities(*lastChunk)[lastOffset];
+		getEntities(*chunk)[offset] = moved;
+		for (size_t column = 0; column < archetype.components.size(); column++) {
+			const int columnIndex = static_cast<int>(column);
+			std::memcpy(
+				getComponentAddress(archetype, columnIndex, row),
+				getComponentAddress(archetype, columnIndex, last),
+				archetype.components[column]->size
+			);
+		}
+		registry.locations[moved.index].row = row;
+	}
+
+	archetype.chunks.back().count--;
+	archetype.count--;
+	if (archetype.chunks.back().count == 0) archetype.chunks.pop_back();
+}
+
+// Moves an entity to another archetype, carrying over the components both
+// have in common. Components only the target has are left uninitialized.
+void moveEntity(Registry& registry, Entity entity, uint32_t targetIndex) {
+	EntityLocation& location = registry.locations[entity.index];
+	const uint32_t sourceIndex = location.archetype;
+	const uint32_t sourceRow = location.row;
+
+	Archetype& target = registry.archetypes[targetIndex];
+	const uint32_t targetRow = allocateRow(target);
+	{
+		const auto [chunk, offset] = locateRow(target, targetRow);
+		getEntities(*chunk)[offset] = entity;
+	}
+
+	Archetype& source = registry.archetypes[sourceIndex];
+	for (size_t column = 0; column < source.components.size(); column++) {
+		const int targetColumn =
+			findColumn(target, source.components[column]->id);
+		if (targetColumn < 0) continue;
+		std::memcpy(
+			getComponentAddress(target, targetColumn, targetRow),
+			getComponentAddress(source, static_cast<int>(column), sourceRow),
+			source.components[column]->size
+		);
+	}
+
+	removeRow(registry, sourceIndex, sourceRow);
+	location = {.archetype = targetIndex, .row = targetRow};
+}
+
+}  // namespace
+
+void ChunkDeleter::operator()(std::byte* data) const {
+	::operator delete(data, std::align_val_t{CACHE_LINE_SIZE});
+}
+
+Archetype Archetype::create(std::span<const ComponentInfo* const> components
+) {
+	size_t rowSize = sizeof(Entity);
+	for (const ComponentInfo* component : components) {
+		ASSERT(
+			component->alignment <= CACHE_LINE_SIZE,
+			"Component " << component->id << " is over-aligned"
+		);
+		rowSize += component->size;
+	}
+
+	// Leave room for padding every column up to the next cache line
+	const size_t paddingBudget = CACHE_LINE_SIZE * components.size();
+	ASSERT(
+		CHUNK_SIZE > paddingBudget + rowSize,
+		"Archetype with " << components.size() << " components and "
+						  << rowSize << " bytes per row does not fit a chunk"
+	);
+	const uint32_t chunkCapacity =
+		static_cast<uint32_t>((CHUNK_SIZE - paddingBudget) / rowSize);
+
+	std::vector<uint32_t> columnOffsets;
+	columnOffsets.reserve(components.size());
+	size_t offset = ENTITY_COLUMN_OFFSET + sizeof(Entity) * chunkCapacity;
+	for (const ComponentInfo* component : components) {
+		offset = alignUp(offset, CACHE_LINE_SIZE);
+		columnOffsets.push_back(static_cast<uint32_t>(offset));
+		offset += size_t{component->size} * chunkCapacity;
+	}
+	ASSERT(offset <= CHUNK_SIZE, "Chunk layout overflows the chunk");
+
+	return Archetype{
+		.components = {components.begin(), components.end()},
+		.columnOffsets = std::move(columnOffsets),
+		.chunkCapacity = chunkCapacity,
+		.chunks = {},
+		.count = 0,
+		.addEdges = {},
+		.removeEdges = {},
+	};
+}
+
+int findColumn(const Archetype& archetype, int componentId) {
+	for (size_t i = 0; i < archetype.components.size(); i++)
+		if (archetype.components[i]->id == componentId)
+			return static_cast<int>(i);
+	return -1;
+}
+
+Registry Registry::create() {
+	Registry registry = {
+		.entities = algo::GenerationIndexArray::create(),
+		.locations = {},
+		.archetypes = {},
+		.archetypeLookup = {},
+	};
+	getOrCreateArchetype(registry, {});
+	return registry;
+}
+
+size_t getEntityCount(const Registry& registry) {
+	return algo::getLiveCount(registry.entities);
+}
+
+Entity reserveEntity(Registry& registry) {
+	const Entity entity = algo::reserveIndex(registry.entities);
+	registry.locations.ensureCapacity(entity.index + 1);
+	registry.locations[entity.index] = {.archetype = NO_ARCHETYPE, .row = 0};
+	return entity;
+}
+
+void placeEntity(
+	Registry& registry,
+	Entity entity,
+	std::span<const ComponentInfo* const> components,
+	std::span<const void* const> values
+) {
+	ASSERT(isAlive(registry, entity), "Placing a destroyed entity");
+	ASSERT(
+		registry.locations[entity.index].archetype == NO_ARCHETYPE,
+		"Entity " << entity.index << " has already been placed"
+	);
+	ASSERT(
+		components.size() == values.size(),
+		components.size() << " components but " << values.size() << " values"
+	);
+
+	// Sort the components into archetype order, keeping values alongside
+	constexpr size_t MAX_INLINE_COMPONENTS = 16;
+	std::array<size_t, MAX_INLINE_COMPONENTS> order;
+	std::array<const ComponentInfo*, MAX_INLINE_COMPONENTS> sorted;
+	ASSERT(
+		components.size() <= MAX_INLINE_COMPONENTS,
+		"Entities are created with at most " << MAX_INLINE_COMPONENTS
+											 << " components"
+	);
+	for (size_t i = 0; i < components.size(); i++) order[i] = i;
+	std::sort(
+		order.begin(),
+		order.begin() + components.size(),
+		[&](size_t a, size_t b) { return components[a]->id < components[b]->id; }
+	);
+	for (size_t i = 0; i < components.size(); i++) {
+		sorted[i] = components[order[i]];
+		ASSERT(
+			i == 0 || sorted[i - 1]->id != sorted[i]->id,
+			"Component " << sorted[i]->id << " given twice"
+		);
+	}
+
+	const uint32_t archetypeIndex = getOrCreateArchetype(
+		registry, std::span(sorted.data(), components.size())
+	);
+	Archetype& archetype = registry.archetypes[archetypeIndex];
+	const uint32_t row = allocateRow(archetype);
+	{
+		const auto [chunk, offset] = locateRow(archetype, row);
+		getEntities(*chunk)[offset] = entity;
+	}
+	for (size_t i = 0; i < components.size(); i++) {
+		std::memcpy(
+			getComponentAddress(archetype, static_cast<int>(i), row),
+			values[order[i]],
+			sorted[i]->size
+		);
+	}
+	registry.locations[entity.index] = {
+		.archetype = archetypeIndex, .row = row
+	};
+}
+
+void destroyEntity(Registry& registry, Entity entity) {
+	ASSERT(isAlive(registry, entity), "Destroying a destroyed entity");
+	const EntityLocation location = registry.locations[entity.index];
+	if (location.archetype != NO_ARCHETYPE)
+		removeRow(registry, location.archetype, location.row);
+	algo::destroy(registry.entities, {&entity, 1});
+}
+
+void setComponent(
+	Registry& registry,
+	Entity entity,
+	const ComponentInfo& component,
+	const void* value
+) {
+	ASSERT(isAlive(registry, entity), "Setting a component of a dead entity");
+	EntityLocation& location = registry.locations[entity.index];
+	if (location.archetype == NO_ARCHETYPE) {
+		const std::array<const ComponentInfo*, 1> components = {&component};
+		const std::array<const void*, 1> values = {value};
+		placeEntity(registry, entity, components, values);
+		return;
+	}
+
+	int column = findColumn(registry.archetypes[location.archetype], component.id);
+	if (column < 0) {
+		moveEntity(
+			registry,
+			entity,
+			getNeighbour(registry, location.archetype, component, true)
+		);
+		column = findColumn(registry.archetypes[location.archetype], component.id);
+	}
+	std::memcpy(
+		getComponentAddress(
+			registry.archetypes[location.archetype], column, location.row
+		),
+		value,
+		component.size
+	);
+}
+
+void removeComponent(
+	Registry& registry, Entity entity, const ComponentInfo& component
+) {
+	ASSERT(isAlive(registry, entity), "Removing a component of a dead entity");
+	const EntityLocation location = registry.locations[entity.index];
+	if (location.archetype == NO_ARCHETYPE) return;
+	if (findColumn(registry.archetypes[location.archetype], component.id) < 0)
+		return;
+	moveEntity(
+		registry,
+		entity,
+		getNeighbour(registry, location.archetype, component, false)
+	);
+}
+
+void* tryGetComponent(Registry& registry, Entity entity, int componentId) {
+	if (!isAlive(registry, entity)) return nullptr;
+	const EntityLocation location = registry.locations[entity.index];
+	if (location.archetype == NO_ARCHETYPE) return nullptr;
+
+	Archetype& archetype = registry.archetypes[location.archetype];
+	const int column = findColumn(archetype, componentId);
+	if (column < 0) return nullptr;
+	return getComponentAddress(archetype, column, location.row);
+}
+
+}  // namespace ecs
@@ -1,17 +1,27 @@
 #include "engine.h"
 
+#include "core/jobs/scheduler.h"
 #include "game_specific/cameras/module.h"
 #include "low_level_renderer/graphics_module.h"
 #include "scene_graph/module.h"
 
 namespace engine {
 void init() {
+	jobs::scheduler = jobs::Scheduler::create();
 	graphics::module = graphics::Module::create();
+	graphics::module->startRenderThread();
 	cameras::module = cameras::Module::create();
 	scene_graph::module = scene_graph::Module::create();
 }
 
 void destroy() {
+	// The render thread records with jobs, so it stops first
+	if (graphics::module.has_value()) graphics::module->stopRenderThread();
+	// Jobs may still reference the modules below
+	if (jobs::scheduler.has_value()) {
+		jobs::scheduler->destroy();
+		jobs::scheduler = std::nullopt;
+	}
 	if (cameras::module.has_value()) {
 		cameras::module->destroy();
 		cameras::module = std::nullopt;
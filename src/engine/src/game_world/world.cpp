@@ -1,9 +1,20 @@
 #include "game_world/world.h"
 
+#include <tuple>
+
 #include "core/logger/assert.h"
+#include "core/logger/logger.h"
 
 namespace game_world {
 
+World World::create() {
+	return World{
+		.statics = {},
+		.staticsIndex = {},
+		.entities = ecs::Registry::create(),
+	};
+}
+
 void emplaceStatics(
 	World& world,
 	std::span<const graphics::PipelineSpecializationConstants> variants,
@@ -35,12 +46,68 @@ void emplaceStatics(
 	);
 }
 
-void addToSceneGraph(const World& world, scene_graph::Module& sceneGraph) {
+namespace {
+
+math::AABB getWorldBounds(
+	const World& world, size_t index, const graphics::MeshStorage& meshes
+) {
+	return math::transform(
+		graphics::getBounds(meshes, world.statics.mesh[index]).box,
+		world.statics.transform[index]
+	);
+}
+
+}  // namespace
+
+void buildStaticsIndex(World& world, const graphics::MeshStorage& meshes) {
+	const size_t numStatics = world.statics.transform.size();
+	world.statics.bounds.clear();
+	world.statics.bounds.reserve(numStatics);
+	for (size_t i = 0; i < numStatics; i++)
+		world.statics.bounds.push_back(getWorldBounds(world, i, meshes));
+	world.staticsIndex = math::BVH::create(world.statics.bounds);
+	LLOG_INFO << "Built statics index of " << world.staticsIndex.nodes.size()
+			  << " nodes over " << numStatics << " statics";
+}
+
+void moveStatics(
+	World& world,
+	std::span<const size_t> indices,
+	std::span<const glm::mat4> transforms,
+	const graphics::MeshStorage& meshes,
+	scene_graph::Module& sceneGraph
+) {
+	ASSERT(
+		indices.size() == transforms.size(),
+		"Moving " << indices.size() << " statics but given "
+				  << transforms.size() << " transforms"
+	);
+	ASSERT(
+		world.statics.bounds.size() == world.statics.transform.size(),
+		"Moving statics before the statics index is built"
+	);
+	// Statics not added yet take their transform along once they are
+	std::vector<std::tuple<scene_graph::RenderObjectID, glm::mat4>> updates;
+	for (size_t i = 0; i < indices.size(); i++) {
+		world.statics.transform[indices[i]] = transforms[i];
+		world.statics.bounds[indices[i]] =
+			getWorldBounds(world, indices[i], meshes);
+		if (indices[i] < world.statics.renderObject.size())
+			updates.emplace_back(
+				world.statics.renderObject[indices[i]], transforms[i]
+			);
+	}
+	math::refit(world.staticsIndex, world.statics.bounds);
+	if (!updates.empty()) sceneGraph.updateObjects(updates);
+}
+
+void addToSceneGraph(World& world, scene_graph::Module& sceneGraph) {
 	const std::vector<graphics::RenderObject> renderObjects = [&]() {
 		std::vector<graphics::RenderObject> result;
 		const size_t numStatics = world.statics.transform.size();
-		result.reserve(numStatics);
-		for (size_t i = 0; i < numStatics; i++) {
+		const size_t numAdded = world.statics.renderObject.size();
+		result.reserve(numStatics - numAdded);
+		for (size_t i = numAdded; i < numStatics; i++) {
 			result.emplace_back(
 				world.statics.variant[i],
 				world.statics.transform[i],
@@ -50,7 +117,11 @@ void addToSceneGraph(const World& world, scene_graph::Module& sceneGraph) {
 		}
 		return result;
 	}();
-	sceneGraph.addObjects(renderObjects);
+	const std::vector<scene_graph::RenderObjectID> ids =
+		sceneGraph.addObjects(renderObjects);
+	world.statics.renderObject.insert(
+		world.statics.renderObject.end(), ids.begin(), ids.end()
+	);
 }
 
 }  // namespace game_world
@@ -21,11 +21,7 @@ DataBuffer<T, E> DataBuffer<T, E>::create(
             vk::MemoryPropertyFlagBits::eHostCoherent
     );
 
-    const vk::ResultValue<void*> mappedMemory =
-        device.mapMemory(memory, 0, bufferSize, {});
-    VULKAN_ENSURE_SUCCESS(mappedMemory.result, "Can't map buffer memory");
-
-    return DataBuffer{buffer, memory, mappedMemory.value, dataCount};
+    return DataBuffer{buffer, memory, memory.mapped, dataCount};
 }
 
 template <typename T, DataBufferType E>
@@ -57,9 +53,29 @@ void DataBuffer<T, E>::update(std::span<const T> data) const {
 
 template <typename T, DataBufferType E>
 void DataBuffer<T, E>::destroyBy(const vk::Device& device) const {
-    device.unmapMemory(memory);
-    device.destroyBuffer(buffer);
-    device.freeMemory(memory);
+    Buffer::destroy(device, buffer, memory);
+}
+
+MappedBuffer MappedBuffer::create(
+    const vk::Device& device,
+    const vk::PhysicalDevice& physicalDevice,
+    vk::DeviceSize size,
+    vk::BufferUsageFlags usage
+) {
+    auto [buffer, memory] = Buffer::create(
+        device,
+        physicalDevice,
+        size,
+        usage,
+        vk::MemoryPropertyFlagBits::eHostVisible |
+            vk::MemoryPropertyFlagBits::eHostCoherent
+    );
+
+    return MappedBuffer{buffer, memory, memory.mapped};
+}
+
+void MappedBuffer::destroyBy(const vk::Device& device) const {
+    Buffer::destroy(device, buffer, memory);
 }
 
 }  // namespace Graphics
@@ -74,9 +90,6 @@ template struct graphics::DataBuffer<graphics::GPUSceneData, graphics::DataBuffe
 #include "low_level_renderer/materials.h"
 template struct graphics::DataBuffer<graphics::MaterialProperties, graphics::DataBufferType::UNIFORM>;
 
-#include "low_level_renderer/instance_rendering.h"
-template struct graphics::DataBuffer<graphics::InstanceData, graphics::DataBufferType::STORAGE>;
-
 #include "low_level_renderer/bloom.h"
 template struct graphics::DataBuffer<graphics::BloomSharedBuffer, graphics::DataBufferType::UNIFORM>;
 template struct graphics::DataBuffer<graphics::BloomUpsampleBuffer, graphics::DataBufferType::UNIFORM>;
@@ -0,0 +1,294 @@
+#include "low_level_renderer/device_memory.h"
+
+#include <algorithm>
+
+#include "core/logger/assert.h"
+#include "core/logger/logger.h"
+#include "core/logger/vulkan_ensures.h"
+
+namespace graphics {
+std::optional<DeviceMemoryAllocator> deviceMemory = std::nullopt;
+
+namespace {
+constexpr vk::DeviceSize MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+// Heaps are split into at least this many blocks
+constexpr vk::DeviceSize MIN_BLOCKS_PER_HEAP = 8;
+constexpr uint32_t STRATEGY_COUNT = 2;
+
+uint32_t getPoolIndex(
+	uint32_t memoryType, ResourceKind kind, AllocationStrategy strategy
+) {
+	return memoryType * DeviceMemoryAllocator::POOLS_PER_MEMORY_TYPE +
+		   static_cast<uint32_t>(kind) * STRATEGY_COUNT +
+		   static_cast<uint32_t>(strategy);
+}
+
+uint32_t getMemoryType(uint32_t poolIndex) {
+	return poolIndex / DeviceMemoryAllocator::POOLS_PER_MEMORY_TYPE;
+}
+
+AllocationStrategy getStrategy(uint32_t poolIndex) {
+	return static_cast<AllocationStrategy>(poolIndex % STRATEGY_COUNT);
+}
+
+// Maps host visible memory for as long as it lives
+std::tuple<vk::DeviceMemory, void*> allocateMemory(
+	const DeviceMemoryAllocator& allocator,
+	vk::DeviceSize size,
+	uint32_t memoryType
+) {
+	const vk::MemoryAllocateInfo allocateInfo(size, memoryType);
+	const vk::ResultValue<vk::DeviceMemory> memoryAllocation =
+		allocator.device.allocateMemory(allocateInfo);
+	VULKAN_ENSURE_SUCCESS(
+		memoryAllocation.result, "Can't allocate device memory:"
+	);
+	const vk::DeviceMemory memory = memoryAllocation.value;
+
+	const bool isHostVisible =
+		static_cast<bool>(
+			allocator.memoryProperties.memoryTypes[memoryType].propertyFlags &
+			vk::MemoryPropertyFlagBits::eHostVisible
+		);
+	if (!isHostVisible) return {memory, nullptr};
+	const vk::ResultValue<void*> mappedMemory =
+		allocator.device.mapMemory(memory, 0, VK_WHOLE_SIZE, {});
+	VULKAN_ENSURE_SUCCESS(mappedMemory.result, "Can't map device memory:");
+	return {memory, mappedMemory.value};
+}
+
+vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+std::optional<vk::DeviceSize> allocateFromBlock(
+	DeviceMemoryPool::Block& block,
+	const vk::MemoryRequirements& requirements,
+	AllocationStrategy strategy,
+	vk::DeviceSize blockSize
+) {
+	switch (strategy) {
+		case AllocationStrategy::eFreeList:
+			return algo::allocate(
+				block.ranges, requirements.size, requirements.alignment
+			);
+		case AllocationStrategy::eLinear: {
+			const vk::DeviceSize offset =
+				alignUp(block.head, requirements.alignment);
+			if (offset + requirements.size > blockSize) return std::nullopt;
+			block.head = offset + requirements.size;
+			return offset;
+		}
+	}
+	return std::nullopt;
+}
+
+vk::DeviceSize getUsedBytes(
+	const DeviceMemoryPool::Block& block,
+	AllocationStrategy strategy,
+	vk::DeviceSize blockSize
+) {
+	switch (strategy) {
+		case AllocationStrategy::eFreeList:
+			return blockSize - algo::getFreeSize(block.ranges);
+		case AllocationStrategy::eLinear: return block.head;
+	}
+	return 0;
+}
+}  // namespace
+
+DeviceMemoryAllocator DeviceMemoryAllocator::create(
+	vk::Device device, vk::PhysicalDevice physicalDevice
+) {
+	DeviceMemoryAllocator allocator{
+		.device = device,
+		.memoryProperties = physicalDevice.getMemoryProperties(),
+		.blockSizes = {},
+		.pools = {},
+		.stats = {},
+		.mutex = std::make_unique<std::mutex>(),
+	};
+	for (uint32_t i = 0; i < allocator.memoryProperties.memoryTypeCount; i++) {
+		const vk::MemoryHeap& heap = allocator.memoryProperties.memoryHeaps
+			[allocator.memoryProperties.memoryTypes[i].heapIndex];
+		allocator.blockSizes[i] =
+			std::min(MAX_BLOCK_SIZE, heap.size / MIN_BLOCKS_PER_HEAP);
+	}
+	return allocator;
+}
+
+DeviceAllocation allocate(
+	DeviceMemoryAllocator& allocator,
+	const vk::MemoryRequirements& requirements,
+	uint32_t memoryType,
+	ResourceKind kind,
+	AllocationStrategy strategy
+) {
+	ASSERT(
+		requirements.memoryTypeBits & (1 << memoryType),
+		"Memory type " << memoryType << " is not allowed by the requirements"
+	);
+	std::lock_guard lock(*allocator.mutex);
+	const vk::DeviceSize blockSize = allocator.blockSizes[memoryType];
+
+	allocator.stats.allocationCount++;
+	allocator.stats.usedBytes += requirements.size;
+
+	// Would take most of a block, so it gets memory of its own instead
+	if (requirements.size > blockSize / 2) {
+		const auto [memory, mapped] =
+			allocateMemory(allocator, requirements.size, memoryType);
+		allocator.stats.dedicatedCount++;
+		allocator.stats.reservedBytes += requirements.size;
+		return DeviceAllocation{
+			.memory = memory,
+			.offset = 0,
+			.size = requirements.size,
+			.mapped = mapped,
+			.pool = std::nullopt,
+		};
+	}
+
+	const uint32_t poolIndex = getPoolIndex(memoryType, kind, strategy);
+	DeviceMemoryPool& pool = allocator.pools[poolIndex];
+	for (DeviceMemoryPool::Block& block : pool.blocks) {
+		const std::optional<vk::DeviceSize> offset =
+			allocateFromBlock(block, requirements, strategy, blockSize);
+		if (!offset) continue;
+		block.allocationCount++;
+		return DeviceAllocation{
+			.memory = block.memory,
+			.offset = *offset,
+			.size = requirements.size,
+			.mapped = block.mapped
+						  ? static_cast<char*>(block.mapped) + *offset
+						  : nullptr,
+			.pool = poolIndex,
+		};
+	}
+
+	const auto [memory, mapped] =
+		allocateMemory(allocator, blockSize, memoryType);
+	allocator.stats.blockCount++;
+	allocator.stats.reservedBytes += blockSize;
+	DeviceMemoryPool::Block& block = pool.blocks.emplace_back(
+		DeviceMemoryPool::Block{
+			.memory = memory,
+			.mapped = mapped,
+			.ranges = algo::RangeAllocator::create(blockSize),
+			.head = 0,
+			.allocationCount = 1,
+		}
+	);
+	// Fits, as blocks are at least twice as large as what they hold
+	const vk::DeviceSize offset =
+		allocateFromBlock(block, requirements, strategy, blockSize).value();
+	return DeviceAllocation{
+		.memory = block.memory,
+		.offset = offset,
+		.size = requirements.size,
+		.mapped = mapped ? static_cast<char*>(mapped) + offset : nullptr,
+		.pool = poolIndex,
+	};
+}
+
+void release(
+	DeviceMemoryAllocator& allocator, const DeviceAllocation& allocation
+) {
+	std::lock_guard lock(*allocator.mutex);
+	allocator.stats.allocationCount--;
+	allocator.stats.usedBytes -= allocation.size;
+
+	if (!allocation.pool) {
+		allocator.device.freeMemory(allocation.memory);
+		allocator.stats.dedicatedCount--;
+		allocator.stats.reservedBytes -= allocation.size;
+		return;
+	}
+
+	DeviceMemoryPool& pool = allocator.pools[*allocation.pool];
+	const auto block = std::find_if(
+		pool.blocks.begin(),
+		pool.blocks.end(),
+		[&](const DeviceMemoryPool::Block& candidate) {
+			return candidate.memory == allocation.memory;
+		}
+	);
+	ASSERT(
+		block != pool.blocks.end(),
+		"Releasing an allocation of a block that does not exist"
+	);
+	const AllocationStrategy strategy = getStrategy(*allocation.pool);
+	if (strategy == AllocationStrategy::eFreeList)
+		algo::release(
+			block->ranges, {.offset = allocation.offset, .size = allocation.size}
+		);
+	if (--block->allocationCount > 0) return;
+
+	block->head = 0;
+	// One empty block is kept per pool, so that a resource created and
+	// destroyed over and over does not allocate each time
+	if (pool.blocks.size() > 1) {
+		allocator.device.freeMemory(block->memory);
+		allocator.stats.blockCount--;
+		allocator.stats.reservedBytes -=
+			allocator.blockSizes[getMemoryType(*allocation.pool)];
+		pool.blocks.erase(block);
+	}
+}
+
+DeviceMemoryStats getStats(DeviceMemoryAllocator& allocator) {
+	std::lock_guard lock(*allocator.mutex);
+	return allocator.stats;
+}
+
+void logStats(DeviceMemoryAllocator& allocator) {
+	std::lock_guard lock(*allocator.mutex);
+	const DeviceMemoryStats& stats = allocator.stats;
+	LLOG_INFO << "Device memory: " << stats.allocationCount
+			  << " allocations in " << stats.blockCount << " blocks and "
+			  << stats.dedicatedCount << " dedicated allocations, "
+			  << stats.usedBytes << " of " << stats.reservedBytes
+			  << " bytes used";
+	for (uint32_t i = 0; i < allocator.pools.size(); i++) {
+		const DeviceMemoryPool& pool = allocator.pools[i];
+		if (pool.blocks.empty()) continue;
+		const uint32_t memoryType = getMemoryType(i);
+		const AllocationStrategy strategy = getStrategy(i);
+		const vk::DeviceSize blockSize = allocator.blockSizes[memoryType];
+		vk::DeviceSize usedBytes = 0;
+		uint32_t allocationCount = 0;
+		for (const DeviceMemoryPool::Block& block : pool.blocks) {
+			usedBytes += getUsedBytes(block, strategy, blockSize);
+			allocationCount += block.allocationCount;
+		}
+		const bool isOptimalImage =
+			i % DeviceMemoryAllocator::POOLS_PER_MEMORY_TYPE >= STRATEGY_COUNT;
+		LLOG_INFO << "  Memory type " << memoryType << " ("
+				  << vk::to_string(
+						 allocator.memoryProperties.memoryTypes[memoryType]
+							 .propertyFlags
+					 )
+				  << "), " << (isOptimalImage ? "images" : "buffers") << ", "
+				  << (strategy == AllocationStrategy::eLinear ? "linear"
+															  : "free list")
+				  << ": " << allocationCount << " allocations in "
+				  << pool.blocks.size() << " blocks, " << usedBytes << " of "
+				  << blockSize * pool.blocks.size() << " bytes used";
+	}
+}
+
+void destroy(DeviceMemoryAllocator& allocator) {
+	logStats(allocator);
+	std::lock_guard lock(*allocator.mutex);
+	if (allocator.stats.allocationCount > 0)
+		LLOG_WARNING << allocator.stats.allocationCount
+					 << " device allocations were never released";
+	for (DeviceMemoryPool& pool : allocator.pools) {
+		for (const DeviceMemoryPool::Block& block : pool.blocks)
+			allocator.device.freeMemory(block.memory);
+		pool.blocks.clear();
+	}
+}
+
+}  // namespace graphics
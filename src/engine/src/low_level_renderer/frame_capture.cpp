@@ -0,0 +1,333 @@
+#include "low_level_renderer/frame_capture.h"
+
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <type_traits>
+
+#include "core/file_system/file.h"
+#include "core/logger/assert.h"
+#include "core/logger/logger.h"
+
+namespace graphics {
+
+namespace {
+// "LBFC" read as a little-endian integer
+constexpr uint32_t CAPTURE_MAGIC = 0x4346424C;
+// Bumped whenever the layout of the file or of a struct in it changes
+constexpr uint32_t CAPTURE_VERSION = 5;
+
+uint32_t getPosition(
+	std::vector<algo::GenerationIndexPair>& ids,
+	std::unordered_map<uint32_t, uint32_t>& positions,
+	algo::GenerationIndexPair id
+) {
+	const auto [position, isNew] =
+		positions.try_emplace(id.index, static_cast<uint32_t>(ids.size()));
+	if (isNew) ids.push_back(id);
+	return position->second;
+}
+
+// Points the IDs of every list of the submission at `meshPosition` and
+// `materialPosition` of them
+template <typename MeshMap, typename MaterialMap>
+void remap(
+	RenderSubmissionCopy& submission,
+	const MeshMap& meshPosition,
+	const MaterialMap& materialPosition
+) {
+	const auto remapObject = [&](auto& object) {
+		object.mesh = meshPosition(object.mesh);
+		object.material = materialPosition(object.material);
+	};
+	for (RenderObject& object : submission.renderObjects) remapObject(object);
+	for (RenderObject& object : submission.transparentObjects)
+		remapObject(object);
+	for (RenderObject& object : submission.sceneObjects) remapObject(object);
+	for (InstancedRenderObject& object : submission.instances)
+		remapObject(object);
+	for (InstancedRenderObject& object : submission.batches)
+		remapObject(object);
+	for (IndirectBucket& bucket : submission.indirectBuckets)
+		bucket.material = materialPosition(bucket.material);
+	// Their ranges are only valid in the captured geometry, so a replay
+	// rebuilds them from the mesh
+	for (IndirectObject& object : submission.indirectObjects)
+		object.mesh = meshPosition(object.mesh);
+}
+
+template <typename T>
+void writeValue(std::ofstream& file, const T& value) {
+	static_assert(std::is_trivially_copyable_v<T>);
+	file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void writeList(std::ofstream& file, const std::vector<T>& list) {
+	static_assert(std::is_trivially_copyable_v<T>);
+	writeValue(file, static_cast<uint32_t>(list.size()));
+	file.write(
+		reinterpret_cast<const char*>(list.data()),
+		static_cast<std::streamsize>(sizeof(T) * list.size())
+	);
+}
+
+template <typename T>
+void writeNestedList(
+	std::ofstream& file, const std::vector<std::vector<T>>& lists
+) {
+	writeValue(file, static_cast<uint32_t>(lists.size()));
+	for (const std::vector<T>& list : lists) writeList(file, list);
+}
+
+// Reads from a file loaded whole. Reading past the end marks the reader
+// invalid and yields zeroes, so a truncated file is caught once at the end.
+struct Reader {
+	std::span<const char> data;
+	size_t offset;
+	bool isValid;
+};
+
+void readBytes(Reader& reader, void* destination, size_t size) {
+	if (!reader.isValid || reader.data.size() - reader.offset < size) {
+		reader.isValid = false;
+		std::memset(destination, 0, size);
+		return;
+	}
+	std::memcpy(destination, reader.data.data() + reader.offset, size);
+	reader.offset += size;
+}
+
+template <typename T>
+T readValue(Reader& reader) {
+	static_assert(std::is_trivially_copyable_v<T>);
+	T value;
+	readBytes(reader, &value, sizeof(T));
+	return value;
+}
+
+template <typename T>
+void readList(Reader& reader, std::vector<T>& list) {
+	static_assert(std::is_trivially_copyable_v<T>);
+	const uint32_t size = readValue<uint32_t>(reader);
+	// Checked before allocating, as a corrupt size could be anything
+	if (reader.data.size() - reader.offset < sizeof(T) * size) {
+		reader.isValid = false;
+		return;
+	}
+	list.resize(size);
+	readBytes(reader, list.data(), sizeof(T) * size);
+}
+
+template <typename T>
+void readNestedList(Reader& reader, std::vector<std::vector<T>>& lists) {
+	const uint32_t size = readValue<uint32_t>(reader);
+	// Every list takes at least its size
+	if (reader.data.size() - reader.offset < sizeof(uint32_t) * size) {
+		reader.isValid = false;
+		return;
+	}
+	lists.resize(size);
+	for (std::vector<T>& list : lists) readList(reader, list);
+}
+}  // namespace
+
+void record(
+	FrameRecorder& recorder,
+	const RenderSubmission& submission,
+	const GPUSceneData& sceneData
+) {
+	CapturedFrame& frame = recorder.frames.emplace_back();
+	copy(frame.submission, submission);
+	frame.sceneData = sceneData;
+	remap(
+		frame.submission,
+		[&](MeshID mesh) {
+			return MeshID{
+				getPosition(recorder.meshes, recorder.meshPositions, mesh), 0
+			};
+		},
+		[&](MaterialInstanceID material) {
+			return MaterialInstanceID{
+				getPosition(
+					recorder.materials, recorder.materialPositions, material
+				),
+				0
+			};
+		}
+	);
+}
+
+FrameCapture finish(
+	FrameRecorder& recorder,
+	const AssetSources& sources,
+	const MeshStorage& meshes,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	vk::CommandPool commandPool,
+	vk::Queue graphicsQueue
+) {
+	FrameCapture capture{
+		.textures = {},
+		.materials = {},
+		.meshes = {},
+		.frames = std::move(recorder.frames),
+	};
+
+	std::unordered_map<uint32_t, uint32_t> texturePositions;
+	const auto remapTexture = [&](std::optional<TextureID>& texture) {
+		if (!texture) return;
+		const auto [position, isNew] = texturePositions.try_emplace(
+			texture->index, static_cast<uint32_t>(capture.textures.size())
+		);
+		if (isNew)
+			capture.textures.push_back(sources.textures[texture->index]);
+		texture = TextureID{.index = position->second};
+	};
+	capture.materials.reserve(recorder.materials.size());
+	for (MaterialInstanceID material : recorder.materials) {
+		ASSERT(
+			material.index < sources.materials.size(),
+			"Material " << material.index << " was not created by the module"
+		);
+		MaterialCreateInfo& createInfo =
+			capture.materials.emplace_back(sources.materials[material.index]);
+		remapTexture(createInfo.albedo);
+		remapTexture(createInfo.normal);
+		remapTexture(createInfo.displacement);
+		remapTexture(createInfo.emission);
+	}
+
+	capture.meshes.resize(recorder.meshes.size());
+	for (size_t i = 0; i < recorder.meshes.size(); i++) {
+		readBack(
+			meshes,
+			recorder.meshes[i],
+			capture.meshes[i].vertices,
+			capture.meshes[i].indices,
+			device,
+			physicalDevice,
+			commandPool,
+			graphicsQueue
+		);
+	}
+
+	recorder.frames.clear();
+	recorder.meshes.clear();
+	recorder.materials.clear();
+	recorder.meshPositions.clear();
+	recorder.materialPositions.clear();
+	return capture;
+}
+
+bool writeCapture(const FrameCapture& capture, std::string_view filePath) {
+	std::ofstream file(filePath.data(), std::ios::binary);
+	if (!file.is_open()) {
+		LLOG_ERROR << "Can't open capture file " << filePath;
+		return false;
+	}
+
+	writeValue(file, CAPTURE_MAGIC);
+	writeValue(file, CAPTURE_VERSION);
+
+	writeValue(file, static_cast<uint32_t>(capture.textures.size()));
+	for (const TextureSource& texture : capture.textures) {
+		writeValue(file, texture.formatHint);
+		writeList(
+			file,
+			std::vector<char>(texture.filePath.begin(), texture.filePath.end())
+		);
+	}
+	writeList(file, capture.materials);
+	writeValue(file, static_cast<uint32_t>(capture.meshes.size()));
+	for (const CapturedMesh& mesh : capture.meshes) {
+		writeList(file, mesh.vertices);
+		writeList(file, mesh.indices);
+	}
+
+	writeValue(file, static_cast<uint32_t>(capture.frames.size()));
+	for (const CapturedFrame& frame : capture.frames) {
+		const RenderSubmissionCopy& submission = frame.submission;
+		writeValue(file, frame.sceneData);
+		writeValue(file, submission.frustum);
+		writeList(file, submission.renderObjects);
+		writeList(file, submission.transparentObjects);
+		writeList(file, submission.sceneObjects);
+		writeList(file, submission.instances);
+		writeNestedList(file, submission.instanceData);
+		writeList(file, submission.batches);
+		writeNestedList(file, submission.batchData);
+		writeList(file, submission.indirectObjects);
+		writeList(file, submission.indirectTransforms);
+		writeList(file, submission.indirectBuckets);
+	}
+
+	if (!file) {
+		LLOG_ERROR << "Can't write capture file " << filePath;
+		return false;
+	}
+	LLOG_INFO << "Captured " << capture.frames.size() << " frames, "
+			  << capture.meshes.size() << " meshes, "
+			  << capture.materials.size() << " materials and "
+			  << capture.textures.size() << " textures to " << filePath;
+	return true;
+}
+
+std::optional<FrameCapture> loadCapture(std::string_view filePath) {
+	const std::optional<std::vector<char>> data =
+		file_system::readFile(filePath);
+	if (!data) return std::nullopt;
+	Reader reader{.data = *data, .offset = 0, .isValid = true};
+
+	const uint32_t magic = readValue<uint32_t>(reader);
+	const uint32_t version = readValue<uint32_t>(reader);
+	if (magic != CAPTURE_MAGIC || version != CAPTURE_VERSION) {
+		LLOG_ERROR << filePath << " is not a version " << CAPTURE_VERSION
+				   << " frame capture";
+		return std::nullopt;
+	}
+
+	FrameCapture capture;
+	capture.textures.resize(readValue<uint32_t>(reader));
+	for (TextureSource& texture : capture.textures) {
+		texture.formatHint = readValue<TextureFormatHint>(reader);
+		std::vector<char> path;
+		readList(reader, path);
+		texture.filePath.assign(path.begin(), path.end());
+	}
+	readList(reader, capture.materials);
+	capture.meshes.resize(readValue<uint32_t>(reader));
+	for (CapturedMesh& mesh : capture.meshes) {
+		readList(reader, mesh.vertices);
+		readList(reader, mesh.indices);
+	}
+
+	capture.frames.resize(readValue<uint32_t>(reader));
+	for (CapturedFrame& frame : capture.frames) {
+		RenderSubmissionCopy& submission = frame.submission;
+		frame.sceneData = readValue<GPUSceneData>(reader);
+		submission.frustum = readValue<math::Frustum>(reader);
+		readList(reader, submission.renderObjects);
+		readList(reader, submission.transparentObjects);
+		readList(reader, submission.sceneObjects);
+		readList(reader, submission.instances);
+		readNestedList(reader, submission.instanceData);
+		readList(reader, submission.batches);
+		readNestedList(reader, submission.batchData);
+		readList(reader, submission.indirectObjects);
+		readList(reader, submission.indirectTransforms);
+		readList(reader, submission.indirectBuckets);
+		// Replayed frames don't follow from each other, so each uploads its
+		// indirect lists whole
+		submission.isIndirectLayoutChanged = true;
+		if (!reader.isValid) break;
+	}
+
+	if (!reader.isValid) {
+		LLOG_ERROR << "Frame capture " << filePath << " is truncated";
+		return std::nullopt;
+	}
+	return capture;
+}
+
+}  // namespace graphics
@@ -0,0 +1,97 @@
+#include "low_level_renderer/gpu_timer.h"
+
+#include "core/logger/logger.h"
+#include "core/logger/vulkan_ensures.h"
+
+namespace graphics {
+
+namespace {
+constexpr uint32_t TIMESTAMPS_PER_FRAME = 2;
+}  // namespace
+
+GPUTimer GPUTimer::create(
+	vk::Device device, vk::PhysicalDevice physicalDevice
+) {
+	const vk::PhysicalDeviceLimits limits =
+		physicalDevice.getProperties().limits;
+
+	GPUTimer timer{
+		.queryPools = {},
+		.timestampPeriod = limits.timestampPeriod,
+		.isSupported = limits.timestampComputeAndGraphics == vk::True,
+		.isWritten = {},
+	};
+	if (!timer.isSupported) {
+		LLOG_WARNING << "Device can't write timestamps, GPU frame times are "
+						"not measured";
+		return timer;
+	}
+
+	const vk::QueryPoolCreateInfo createInfo(
+		{}, vk::QueryType::eTimestamp, TIMESTAMPS_PER_FRAME
+	);
+	for (vk::QueryPool& queryPool : timer.queryPools) {
+		const vk::ResultValue<vk::QueryPool> queryPoolCreation =
+			device.createQueryPool(createInfo);
+		VULKAN_ENSURE_SUCCESS(
+			queryPoolCreation.result, "Can't create timestamp query pool:"
+		);
+		queryPool = queryPoolCreation.value;
+	}
+	return timer;
+}
+
+void recordBegin(
+	GPUTimer& timer, vk::CommandBuffer buffer, uint32_t currentFrame
+) {
+	if (!timer.isSupported) return;
+	const vk::QueryPool queryPool = timer.queryPools[currentFrame];
+	buffer.resetQueryPool(queryPool, 0, TIMESTAMPS_PER_FRAME);
+	buffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, queryPool, 0);
+	timer.isWritten[currentFrame] = true;
+}
+
+void recordEnd(
+	const GPUTimer& timer, vk::CommandBuffer buffer, uint32_t currentFrame
+) {
+	if (!timer.isSupported) return;
+	buffer.writeTimestamp(
+		vk::PipelineStageFlagBits::eBottomOfPipe,
+		timer.queryPools[currentFrame],
+		1
+	);
+}
+
+std::optional<std::chrono::duration<float, std::milli>> getElapsed(
+	GPUTimer& timer, vk::Device device, uint32_t currentFrame
+) {
+	if (!timer.isSupported || !timer.isWritten[currentFrame])
+		return std::nullopt;
+
+	std::array<uint64_t, TIMESTAMPS_PER_FRAME> timestamps;
+	const vk::Result result = device.getQueryPoolResults(
+		timer.queryPools[currentFrame],
+		0,
+		TIMESTAMPS_PER_FRAME,
+		sizeof(timestamps),
+		timestamps.data(),
+		sizeof(uint64_t),
+		vk::QueryResultFlagBits::e64
+	);
+	// eNotReady means the frame was recorded but never submitted
+	if (result != vk::Result::eSuccess) return std::nullopt;
+	timer.isWritten[currentFrame] = false;
+
+	const float nanoseconds =
+		static_cast<float>(timestamps[1] - timestamps[0]) *
+		timer.timestampPeriod;
+	return std::chrono::duration<float, std::nano>(nanoseconds);
+}
+
+void destroy(const GPUTimer& timer, vk::Device device) {
+	if (!timer.isSupported) return;
+	for (vk::QueryPool queryPool : timer.queryPools)
+		device.destroyQueryPool(queryPool);
+}
+
+}  // namespace graphics
@@ -3,11 +3,13 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "core/logger/assert.h"
 #include "core/logger/vulkan_ensures.h"
 #include "low_level_renderer/descriptor_write_buffer.h"
+#include "low_level_renderer/device_memory.h"
 #include "low_level_renderer/material_pipeline.h"
 #include "low_level_renderer/queue_family.h"
 #include "private/bloom.h"
@@ -93,9 +95,11 @@ vk::Device init_createLogicalDevice(
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME
 	};
 	float queuePriority = 1.0f;
-	const std::set<uint32_t> uniqueQueueFamilies = {
+	std::set<uint32_t> uniqueQueueFamilies = {
 		queueFamily.graphicsAndComputeFamily.value(), queueFamily.presentFamily.value()
 	};
+	if (queueFamily.transferFamily)
+		uniqueQueueFamilies.insert(queueFamily.transferFamily.value());
 	std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
 
 	for (uint32_t queueFamilyIndex : uniqueQueueFamilies) {
@@ -112,22 +116,17 @@ vk::Device init_createLogicalDevice(
 	deviceFeatures.shaderInt64 = vk::True;
 	deviceFeatures.samplerAnisotropy = vk::True;
 	deviceFeatures.sampleRateShading = vk::True;
-
-	// we are using semaphores
-	vk::PhysicalDevice8BitStorageFeaturesKHR storageFeatures(
-            vk::True, 
-            {},
-            {}
-    );
-	vk::PhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddress(
-		vk::True,
-        vk::False,
-        vk::False,
-        std::addressof(storageFeatures)
-	);
-	vk::PhysicalDeviceTimelineSemaphoreFeatures semaphoreFeatures(
-		vk::True, std::addressof(bufferDeviceAddress)
-	);
+	// The culling pass writes each command's object index as its
+	// firstInstance
+	deviceFeatures.drawIndirectFirstInstance = vk::True;
+
+	// 8 bit storage, buffer device addresses, timeline semaphores and count
+	// buffers for GPU-driven indirect draws
+	vk::PhysicalDeviceVulkan12Features vulkan12Features;
+	vulkan12Features.storageBuffer8BitAccess = vk::True;
+	vulkan12Features.bufferDeviceAddress = vk::True;
+	vulkan12Features.timelineSemaphore = vk::True;
+	vulkan12Features.drawIndirectCount = vk::True;
 
 	const vk::DeviceCreateInfo deviceCreateInfo(
 		{},
@@ -142,7 +141,7 @@ vk::Device init_createLogicalDevice(
 		static_cast<uint32_t>(deviceExtensions.size()),
 		deviceExtensions.data(),
 		&deviceFeatures,
-		&semaphoreFeatures
+		&vulkan12Features
 	);
 	vk::Device device;
 	vk::Result result =
@@ -262,26 +261,26 @@ GraphicsDeviceInterface GraphicsDeviceInterface::createGraphicsDevice(
 		QueueFamilyIndices::findQueueFamilies(physicalDevice, surface);
 	const vk::Device device =
 		init_createLogicalDevice(physicalDevice, queueFamily);
+	// Before anything that creates a buffer or an image
+	deviceMemory.emplace(DeviceMemoryAllocator::create(device, physicalDevice));
 	const vk::Queue graphicsQueue =
 		device.getQueue(queueFamily.graphicsAndComputeFamily.value(), 0);
 	const vk::Queue presentQueue =
 		device.getQueue(queueFamily.presentFamily.value(), 0);
 	const vk::CommandPool commandPool =
 		init_createCommandPool(device, queueFamily);
+	TransferManager transfers = TransferManager::create(
+		device, physicalDevice, queueFamily, graphicsQueue
+	);
 
 	const UncompiledShader vertexShader = loadUncompiledShaderFromFile(
 		"shaders/test_triangle.vert.glsl", vk::ShaderStageFlagBits::eVertex
 	);
-	const UncompiledShader instancedVertexShader = loadUncompiledShaderFromFile(
-		"shaders/test_triangle_instanced.vert.glsl",
-		vk::ShaderStageFlagBits::eVertex
-	);
 	const UncompiledShader fragmentShader = loadUncompiledShaderFromFile(
 		"shaders/test_triangle.frag.glsl", vk::ShaderStageFlagBits::eFragment
 	);
 	const Shaders mainShaders{
 		.vertex = vertexShader,
-		.vertexInstanced = instancedVertexShader,
 		.fragment = fragmentShader
 	};
 
@@ -375,7 +374,8 @@ GraphicsDeviceInterface GraphicsDeviceInterface::createGraphicsDevice(
 			uniformBuffers[i],
 			commandBuffers[i],
 			isImageAvailable[i],
-			isRenderingInFlight[i]
+			isRenderingInFlight[i],
+			{}
 		};
 	}
 
@@ -416,6 +416,7 @@ GraphicsDeviceInterface GraphicsDeviceInterface::createGraphicsDevice(
 		.bloom = bloomObjects,
         .radianceCascade = radianceCascade,
 		.commandPool = commandPool,
+		.transfers = std::move(transfers),
 		.samplers = allSamplers,
 		.currentFrame = 0,
 		.writeBuffer = writeBuffer
@@ -433,6 +434,8 @@ void GraphicsDeviceInterface::destroy() {
 		device.destroySemaphore(frameData.isImageAvailable);
 		device.destroyFence(frameData.isRenderingInFlight);
 		frameData.sceneDataBuffer.destroyBy(device);
+		for (const SecondaryCommands& commands : frameData.secondaryCommands)
+			graphics::destroy(commands, device);
 	}
 
 	LLOG_INFO << "Destroyed semaphore and fences";
@@ -450,6 +453,11 @@ void GraphicsDeviceInterface::destroy() {
 	LLOG_INFO << "Destroyed bloom object";
     graphics::destroy(radianceCascade, device);
 	LLOG_INFO << "Destroyed radiance cascade data";
+	graphics::destroy(transfers);
+	LLOG_INFO << "Destroyed transfer manager";
+	graphics::destroy(deviceMemory.value());
+	deviceMemory.reset();
+	LLOG_INFO << "Destroyed device memory";
 
 	device.destroy();
 	LLOG_INFO << "Destroyed device";
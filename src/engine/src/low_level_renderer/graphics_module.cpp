@@ -1,8 +1,13 @@
 #include "low_level_renderer/graphics_module.h"
 
+#include <algorithm>
+#include <array>
+#include <utility>
 #include <glslang/Public/ShaderLang.h>
 
+#include "core/jobs/scheduler.h"
 #include "game_specific/cameras/module.h"
+#include "low_level_renderer/device_memory.h"
 #include "low_level_renderer/pipeline_template.h"
 #include "low_level_renderer/render_submission.h"
 #include "private/bloom.h"
@@ -22,6 +27,14 @@
 namespace graphics {
 std::optional<Module> module = std::nullopt;
 
+namespace {
+// Fewer draws than this are not worth a secondary command buffer of their own
+constexpr uint32_t MIN_DRAWS_PER_CHUNK = 256;
+// Relative to the working directory, like the assets
+constexpr std::string_view FRAME_CAPTURE_PATH = "frame_capture.lfc";
+constexpr uint32_t MAX_FRAMES_TO_CAPTURE = 600;
+}  // namespace
+
 Module Module::create() {
 	glslang::InitializeProcess();
 	LLOG_INFO << "glslang initialized with version: "
@@ -31,27 +44,83 @@ Module Module::create() {
 	GraphicsDeviceInterface device =
 		GraphicsDeviceInterface::createGraphicsDevice(shaders);
 	GraphicsUserInterface ui = GraphicsUserInterface::create(device);
+	ObjectDataBuffer objectData = ObjectDataBuffer::create(
+		device.device,
+		device.physicalDevice,
+		device.pipeline.instanceRenderingDescriptor.setLayout,
+		device.pipeline.instanceRenderingDescriptor.allocator,
+		device.writeBuffer
+	);
+	IndirectDrawData indirect = IndirectDrawData::create(
+		device.device,
+		device.physicalDevice,
+		shaders,
+		device.pipeline.instanceRenderingDescriptor,
+		device.writeBuffer
+	);
+	const BloomGraphicsObjects::Config bloomConfig = device.bloom.config;
+	const GPUTimer gpuTimer =
+		GPUTimer::create(device.device, device.physicalDevice);
 
 	LLOG_INFO << "Graphics Module Initialized";
 	return Module{
 		.device = std::move(device),
 		.ui = ui,
-		.instances = {},
-		.shaders = shaders,
+		.objectData = objectData,
+		.objectDataLayout = {},
+		.indirect = indirect,
+		.shaders = std::move(shaders),
 		.textures = {},
 		.materials = MaterialStorage::create(),
 		.meshes = MeshStorage::create(),
+		.assetSources = {},
+		.submissions = SubmissionQueue::create(MIN_SUBMISSION_QUEUE_DEPTH),
+		.renderThread = {},
+		.renderMutex = std::make_unique<std::mutex>(),
 		.mainWindowExtent = {},
+		.bloomConfig = bloomConfig,
+		.pendingBloomConfig = std::nullopt,
+		.maxRecordingThreads = jobs::getThreadCount(jobs::scheduler.value()),
+		.pendingVariants = {},
+		.pendingResize = std::nullopt,
+		.framesToCapture = 60,
+		.capturedFramesLeft = 0,
+		.stats = {},
+		.renderStats = {},
+		.gpuTimer = gpuTimer,
+		.frameRecorder = {},
+		.secondaryBuffers = {},
+		.retiredGeometry = {},
+		.pendingRetiredGeometry = {},
 	};
 }
 
+void Module::startRenderThread() {
+	ASSERT(!renderThread.joinable(), "Render thread started twice");
+	renderThread = std::thread(&Module::renderLoop, this);
+}
+
+void Module::stopRenderThread() {
+	close(*submissions);
+	if (renderThread.joinable()) renderThread.join();
+}
+
 void Module::destroy() {
+	stopRenderThread();
     device.waitCompleteIdle();
+	for (const SubmissionSnapshot& snapshot : submissions->slots)
+		graphics::destroy(snapshot.retiredGeometry, device.device);
+	for (const std::vector<RetiredBuffer>& retired : retiredGeometry)
+		graphics::destroy(retired, device.device);
+	graphics::destroy(pendingRetiredGeometry, device.device);
+	graphics::destroy(*submissions);
+	graphics::destroy(gpuTimer, device.device);
+	graphics::destroy(indirect, device.device);
 	graphics::destroy(meshes, device.device);
 	graphics::destroy(materials, device.device);
 	graphics::destroy(textures, device.device);
 	graphics::destroy(shaders, device.device);
-	instances.destroyBy(device.device);
+	graphics::destroy(objectData, device.device);
 	ui.destroy(device);
 	device.destroy();
 	LLOG_INFO << "Graphics Module Destroyed";
@@ -87,24 +156,106 @@ void Module::beginFrame() {
 }
 
 void Module::handleEvent(const SDL_Event& event) {
-	device.handleEvent(event);
-	ui.handleEvent(event, device);
+	ui.handleEvent(event);
+	// The swapchain belongs to the render thread, which recreates it before
+	// drawing the next snapshot
+	if (event.type == SDL_EVENT_WINDOW_RESIZED) pendingResize = event;
 }
 
 bool Module::drawFrame(
-	RenderSubmission& renderSubmission, GPUSceneData& sceneData
+	const RenderSubmission& renderSubmission, const GPUSceneData& sceneData
 ) {
-	ASSERT(device.swapchain, "Attempt to draw frame without a swapchain");
+	const std::optional<uint32_t> slot = acquireForWriting(*submissions);
+	if (!slot) return false;
+	stats = getStats(*submissions);
 
 	{
 	    ImGui::Begin("Graphics");
 		const bool intensityChanged =
-			ImGui::SliderFloat("Bloom Intensity", &device.bloom.config.intensity, 0.0, 2.0);
+			ImGui::SliderFloat("Bloom Intensity", &bloomConfig.intensity, 0.0, 2.0);
 		const bool blurRadiusChanged =
-			ImGui::SliderFloat("Bloom Pixel Radius", &device.bloom.config.blurRadius, 0.0, 10.0);
+			ImGui::SliderFloat("Bloom Pixel Radius", &bloomConfig.blurRadius, 0.0, 10.0);
 
 		const bool anyChanged = blurRadiusChanged || intensityChanged;
-		if (anyChanged) graphics::updateConfigOnGPU(device.bloom);
+		if (anyChanged) pendingBloomConfig = bloomConfig;
+
+		const uint32_t minRecordingThreads = 1;
+		const uint32_t threadCount =
+			jobs::getThreadCount(jobs::scheduler.value());
+		ImGui::SliderScalar(
+			"Recording Threads",
+			ImGuiDataType_U32,
+			&maxRecordingThreads,
+			&minRecordingThreads,
+			&threadCount
+		);
+		uint32_t queueDepth = submissions->depth;
+		const uint32_t minQueueDepth = MIN_SUBMISSION_QUEUE_DEPTH;
+		const uint32_t maxQueueDepth = MAX_SUBMISSION_QUEUE_DEPTH;
+		if (ImGui::SliderScalar(
+				"Frames Buffered",
+				ImGuiDataType_U32,
+				&queueDepth,
+				&minQueueDepth,
+				&maxQueueDepth
+			))
+			setDepth(*submissions, queueDepth);
+		ImGui::Text(
+			"Main pass recorded in %.3f ms, %u chunks",
+			stats.mainPassRecordTime.count(),
+			stats.mainPassRecordChunks
+		);
+		ImGui::Text("GPU frame time: %.3f ms", stats.gpuFrameTime.count());
+		const algo::RangeAllocator& vertexRanges = meshes.geometry.vertexRanges;
+		const algo::RangeAllocator& indexRanges = meshes.geometry.indexRanges;
+		const algo::RangeAllocator& meshletRanges =
+			meshes.geometry.meshletRanges;
+		ImGui::Text(
+			"Geometry: %llu / %llu vertices, %llu / %llu indices",
+			static_cast<unsigned long long>(
+				vertexRanges.capacity - algo::getFreeSize(vertexRanges)
+			),
+			static_cast<unsigned long long>(vertexRanges.capacity),
+			static_cast<unsigned long long>(
+				indexRanges.capacity - algo::getFreeSize(indexRanges)
+			),
+			static_cast<unsigned long long>(indexRanges.capacity)
+		);
+		ImGui::Text(
+			"Meshlets: %llu / %llu",
+			static_cast<unsigned long long>(
+				meshletRanges.capacity - algo::getFreeSize(meshletRanges)
+			),
+			static_cast<unsigned long long>(meshletRanges.capacity)
+		);
+		const DeviceMemoryStats memoryStats = getStats(deviceMemory.value());
+		const float bytesPerMiB = 1024.0f * 1024.0f;
+		ImGui::Text(
+			"Device memory: %u allocations in %u blocks and %u dedicated",
+			memoryStats.allocationCount,
+			memoryStats.blockCount,
+			memoryStats.dedicatedCount
+		);
+		ImGui::Text(
+			"Device memory used: %.1f / %.1f MiB",
+			static_cast<float>(memoryStats.usedBytes) / bytesPerMiB,
+			static_cast<float>(memoryStats.reservedBytes) / bytesPerMiB
+		);
+		if (ImGui::Button("Log Device Memory")) logStats(deviceMemory.value());
+
+		const uint32_t minFramesToCapture = 1;
+		ImGui::SliderScalar(
+			"Frames To Capture",
+			ImGuiDataType_U32,
+			&framesToCapture,
+			&minFramesToCapture,
+			&MAX_FRAMES_TO_CAPTURE
+		);
+		if (capturedFramesLeft > 0) {
+			ImGui::Text("Capturing, %u frames left", capturedFramesLeft);
+		} else if (ImGui::Button("Capture Frames")) {
+			capturedFramesLeft = framesToCapture;
+		}
 	    ImGui::End();
 	}
 
@@ -113,20 +264,151 @@ bool Module::drawFrame(
 	// move this to another spot
 	ImGui::Render();
 
-	device.writeBuffer.flush(device.device);
+	// ImGui's textures are shared with the snapshots already queued, so they
+	// are only touched once the render thread and the GPU are done with
+	// those. This happens when the font atlas changes, not every frame.
+	ImDrawData* drawData = ImGui::GetDrawData();
+	const bool hasTextureUpdates =
+		drawData->Textures &&
+		std::any_of(
+			drawData->Textures->begin(),
+			drawData->Textures->end(),
+			[](const ImTextureData* texture) {
+				return texture->Status != ImTextureStatus_OK;
+			}
+		);
+	if (hasTextureUpdates) {
+		waitIdle(*submissions);
+		device.waitCompleteIdle();
+		for (ImTextureData* texture : *drawData->Textures)
+			if (texture->Status != ImTextureStatus_OK)
+				ImGui_ImplVulkan_UpdateTexture(texture);
+	}
 
-	GraphicsDeviceInterface::FrameData& currentFrame =
-		device.frameDatas[device.currentFrame];
+#ifdef IMGUI_MULTIVIEW
+	ImGuiIO& io = ImGui::GetIO();
+	// Update and Render additional Platform Windows. They submit to the
+	// graphics queue themselves, so the render thread has to be idle.
+	if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
+		waitIdle(*submissions);
+		ImGui::UpdatePlatformWindows();
+		ImGui::RenderPlatformWindowsDefault();
+	}
+#endif
 
-	const vk::Device device = this->device.device;
+	SubmissionSnapshot& snapshot = submissions->slots[*slot];
+	copy(snapshot.submission, renderSubmission);
+	captureUI(snapshot, *drawData);
+	snapshot.sceneData = sceneData;
+	snapshot.mainWindowExtent = mainWindowExtent;
+	snapshot.bloomConfig = std::exchange(pendingBloomConfig, std::nullopt);
+	snapshot.maxRecordingThreads = maxRecordingThreads;
+	// Swapped rather than copied, so both lists keep their capacity
+	snapshot.newVariants.swap(pendingVariants);
+	pendingVariants.clear();
+	snapshot.resize = std::exchange(pendingResize, std::nullopt);
+	snapshot.capturedFramesLeft = capturedFramesLeft;
+	if (capturedFramesLeft > 0) capturedFramesLeft--;
+	snapshot.geometry = getHandles(meshes.geometry);
+	takeRetired(meshes.geometry, snapshot.retiredGeometry);
+	{
+		// Submitting a batch uses the queue, which may be the render
+		// thread's. Most frames have nothing to submit, and don't wait.
+		std::unique_lock lock(*renderMutex, std::defer_lock);
+		if (device.transfers.recording) lock.lock();
+		snapshot.transfers = submit(device.transfers);
+	}
+	publish(*submissions, *slot);
+	return true;
+}
 
+void Module::renderLoop() {
+	while (const std::optional<uint32_t> slot =
+			   acquireForRendering(*submissions)) {
+		const bool isDrawn = renderFrame(submissions->slots[*slot]);
+		endFrame();
+		release(*submissions, *slot, renderStats);
+		if (!isDrawn) {
+			LLOG_ERROR << "Render thread stopped after failing to draw";
+			close(*submissions);
+		}
+	}
+}
+
+bool Module::renderFrame(SubmissionSnapshot& snapshot) {
+	GraphicsDeviceInterface::FrameData& currentFrame =
+		device.frameDatas[device.currentFrame];
 	const uint64_t no_time_limit = std::numeric_limits<uint64_t>::max();
+	// Waited on before locking, so that the game thread can load meanwhile
 	VULKAN_ENSURE_SUCCESS_EXPR(
-		this->device.device.waitForFences(
+		device.device.waitForFences(
 			1, &currentFrame.isRenderingInFlight, vk::True, no_time_limit
 		),
 		"Can't wait for previous frame rendering:"
 	);
+	const std::lock_guard lock(*renderMutex);
+
+	// The fence signals once every frame submitted before it is done too
+	graphics::destroy(retiredGeometry[device.currentFrame], device.device);
+	retiredGeometry[device.currentFrame].clear();
+	pendingRetiredGeometry.insert(
+		pendingRetiredGeometry.end(),
+		snapshot.retiredGeometry.begin(),
+		snapshot.retiredGeometry.end()
+	);
+	snapshot.retiredGeometry.clear();
+
+	if (snapshot.resize) {
+		device.handleEvent(*snapshot.resize);
+		ui.recreateRenderpassAndFramebuffers(device);
+	}
+	ASSERT(device.swapchain, "Attempt to draw frame without a swapchain");
+
+	for (const PipelineSpecializationConstants& variant : snapshot.newVariants)
+		buildPipelineVariant(variant);
+
+	if (snapshot.bloomConfig) {
+		device.bloom.config = *snapshot.bloomConfig;
+		graphics::updateConfigOnGPU(device.bloom);
+	}
+
+	RenderSubmission renderSubmission = getSubmission(snapshot.submission);
+
+	if (snapshot.capturedFramesLeft > 0)
+		record(frameRecorder, renderSubmission, snapshot.sceneData);
+	if (snapshot.capturedFramesLeft == 1) {
+		const FrameCapture capture = finish(
+			frameRecorder,
+			assetSources,
+			meshes,
+			device.device,
+			device.physicalDevice,
+			device.commandPool,
+			device.graphicsAndComputeQueue
+		);
+		writeCapture(capture, FRAME_CAPTURE_PATH);
+	}
+
+	device.writeBuffer.flush(device.device);
+
+	const vk::Device device = this->device.device;
+
+	// The frame's indirect buffers are free again now that it is done
+	renderStats.indirectVisibleCount =
+		getVisibleCount(indirect, this->device.currentFrame);
+	renderStats.gpuFrameTime =
+		getElapsed(gpuTimer, device, this->device.currentFrame).value_or(
+			std::chrono::duration<float, std::milli>::zero()
+		);
+	upload(
+		indirect,
+		renderSubmission,
+		snapshot.geometry,
+		device,
+		this->device.physicalDevice,
+		this->device.writeBuffer,
+		this->device.currentFrame
+	);
 
 	const vk::ResultValue<uint32_t> imageIndex = device.acquireNextImageKHR(
 		this->device.swapchain->swapchain,
@@ -160,22 +442,36 @@ bool Module::drawFrame(
 	vk::CommandBuffer commandBuffer = currentFrame.drawCommandBuffer;
 	commandBuffer.reset();
 
-	currentFrame.sceneDataBuffer.update(sceneData);
+	currentFrame.sceneDataBuffer.update(snapshot.sceneData);
 
     const vk::Semaphore submitSemaphore = this->device.swapchain->submitSemaphores[imageIndex.value];
 
-	recordCommandBuffer(renderSubmission, commandBuffer, imageIndex.value);
+	recordCommandBuffer(
+		renderSubmission, snapshot, commandBuffer, imageIndex.value
+	);
 
-	const vk::PipelineStageFlags waitStage =
-		vk::PipelineStageFlagBits::eColorAttachmentOutput;
+	// Anything the frame reads may have been uploaded by the transfer queue
+	const std::array<vk::Semaphore, 2> waitSemaphores = {
+		currentFrame.isImageAvailable, this->device.transfers.timeline
+	};
+	const std::array<vk::PipelineStageFlags, 2> waitStages = {
+		vk::PipelineStageFlagBits::eColorAttachmentOutput,
+		vk::PipelineStageFlagBits::eAllCommands
+	};
+	// The binary semaphore's value is ignored
+	const std::array<uint64_t, 2> waitValues = {0, snapshot.transfers.value};
+	const vk::TimelineSemaphoreSubmitInfo timelineInfo(
+		static_cast<uint32_t>(waitValues.size()), waitValues.data(), 0, nullptr
+	);
 	const vk::SubmitInfo submitInfo(
-		1,
-		&currentFrame.isImageAvailable,
-		&waitStage,
+		static_cast<uint32_t>(waitSemaphores.size()),
+		waitSemaphores.data(),
+		waitStages.data(),
 		1,
 		&currentFrame.drawCommandBuffer,
 		1,
-        &submitSemaphore
+        &submitSemaphore,
+		&timelineInfo
 	);
 	VULKAN_ENSURE_SUCCESS_EXPR(
 		this->device.graphicsAndComputeQueue.submit(
@@ -183,15 +479,7 @@ bool Module::drawFrame(
 		),
 		"Can't submit graphics queue:"
 	);
-
-#ifdef IMGUI_MULTIVIEW
-	ImGuiIO& io = ImGui::GetIO();
-	// Update and Render additional Platform Windows
-	if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
-		ImGui::UpdatePlatformWindows();
-		ImGui::RenderPlatformWindowsDefault();
-	}
-#endif
+	retiredGeometry[this->device.currentFrame].swap(pendingRetiredGeometry);
 
 	const vk::PresentInfoKHR presentInfo(
 		1,
@@ -227,6 +515,7 @@ void Module::endFrame() {
 
 void Module::recordCommandBuffer(
 	RenderSubmission& renderSubmission,
+	const SubmissionSnapshot& snapshot,
 	vk::CommandBuffer buffer,
 	uint32_t imageIndex
 ) {
@@ -235,17 +524,25 @@ void Module::recordCommandBuffer(
 	VULKAN_ENSURE_SUCCESS_EXPR(
 		buffer.begin(beginInfo), "Can't begin recording command buffer:"
 	);
+	recordBegin(gpuTimer, buffer, device.currentFrame);
 
     graphics::recordDraw(
         device.radianceCascade, 
         renderSubmission, 
         buffer, 
-        instances,
         device.pipeline,
         materials,
         meshes,
+        snapshot.geometry,
         device.currentFrame
     );
+	recordCulling(
+		indirect,
+		renderSubmission,
+		glm::vec3(snapshot.sceneData.inverseView[3]),
+		buffer,
+		device.currentFrame
+	);
 
 	const vk::Rect2D screenExtent = {
 		vk::Offset2D{},
@@ -255,14 +552,14 @@ void Module::recordCommandBuffer(
 		}
 	};
 	const vk::Viewport viewport(
-		mainWindowExtent.offset.x,
-		mainWindowExtent.offset.y,
-		mainWindowExtent.extent.width,
-		mainWindowExtent.extent.height,
+		snapshot.mainWindowExtent.offset.x,
+		snapshot.mainWindowExtent.offset.y,
+		snapshot.mainWindowExtent.extent.width,
+		snapshot.mainWindowExtent.extent.height,
 		0.0f,
 		1.0f
 	);
-	const vk::Rect2D scissor = mainWindowExtent;
+	const vk::Rect2D scissor = snapshot.mainWindowExtent;
 	buffer.setViewport(0, 1, &viewport);
 	buffer.setScissor(0, 1, &scissor);
 
@@ -279,53 +576,156 @@ void Module::recordCommandBuffer(
 		const vk::RenderPassBeginInfo renderPassInfo(
 			device.renderPasses.mainPass,
 			device.swapchain->mainFramebuffer,
-			mainWindowExtent,
+			snapshot.mainWindowExtent,
 			static_cast<uint32_t>(clearColors.size()),
 			clearColors.data()
 		);
-		buffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-		prepForRecording(renderSubmission, instances, device.currentFrame);
-
-		buffer.bindDescriptorSets(
-			vk::PipelineBindPoint::eGraphics,
-			device.pipeline.regularPipelineLayout,
-			static_cast<int>(MainPipelineDescriptorSetBindingPoint::eGlobal),
-			1,
-			&device.frameDatas[device.currentFrame].globalDescriptor,
-			0,
-			nullptr
+		prepForRecording(
+			renderSubmission,
+			objectData,
+			objectDataLayout,
+			device.device,
+			device.physicalDevice,
+			device.writeBuffer,
+			device.currentFrame
 		);
 
-		recordRegularDrawCalls(
-			renderSubmission,
-			buffer,
-			device.pipeline.regularPipelineLayout,
-			device.pipeline,
-			materials,
-			meshes
+		// Opaque regular objects are split into chunks recorded in parallel.
+		// One more chunk records the instanced, indirect and transparent
+		// draws, which have to come after them.
+		GraphicsDeviceInterface::FrameData& frameData =
+			device.frameDatas[device.currentFrame];
+		const uint32_t numOpaqueObjects =
+			static_cast<uint32_t>(renderSubmission.renderObjects.size());
+		const uint32_t numOpaqueChunks = std::clamp(
+			(numOpaqueObjects + MIN_DRAWS_PER_CHUNK - 1) / MIN_DRAWS_PER_CHUNK,
+			1u,
+			snapshot.maxRecordingThreads
 		);
+		const uint32_t chunkSize =
+			(numOpaqueObjects + numOpaqueChunks - 1) / numOpaqueChunks;
+		const uint32_t numChunks = numOpaqueChunks + 1;
+		while (frameData.secondaryCommands.size() < numChunks)
+			frameData.secondaryCommands.push_back(SecondaryCommands::create(
+				device.device, device.queueFamily.graphicsAndComputeFamily.value()
+			));
+
+		const vk::PipelineLayout pipelineLayout = device.pipeline.pipelineLayout;
+		const auto bindGlobalDescriptor = [&](vk::CommandBuffer commands) {
+			commands.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics,
+				pipelineLayout,
+				static_cast<int>(MainPipelineDescriptorSetBindingPoint::eGlobal),
+				1,
+				&frameData.globalDescriptor,
+				0,
+				nullptr
+			);
+		};
 
-		buffer.bindDescriptorSets(
-			vk::PipelineBindPoint::eGraphics,
-			device.pipeline.instanceRenderingPipelineLayout,
-			static_cast<int>(MainPipelineDescriptorSetBindingPoint::eGlobal),
+		// Only touches the chunk's own command pool and reads everything
+		// else, so chunks can be recorded concurrently
+		const auto recordChunk = [&](uint32_t chunk) {
+			const SecondaryCommands& commands =
+				frameData.secondaryCommands[chunk];
+			const vk::CommandBuffer secondary = graphics::begin(
+				commands,
+				device.device,
+				device.renderPasses.mainPass,
+				device.swapchain->mainFramebuffer
+			);
+			// Dynamic state is not inherited from the primary buffer
+			secondary.setViewport(0, 1, &viewport);
+			secondary.setScissor(0, 1, &scissor);
+
+			bindGlobalDescriptor(secondary);
+			bind(objectData, secondary, pipelineLayout, device.currentFrame);
+			bind(secondary, snapshot.geometry);
+
+			if (chunk < numOpaqueChunks) {
+				const uint32_t chunkBegin =
+					std::min(chunk * chunkSize, numOpaqueObjects);
+				const uint32_t chunkEnd =
+					std::min(chunkBegin + chunkSize, numOpaqueObjects);
+				recordRegularDrawCalls(
+					renderSubmission.renderObjects.subspan(
+						chunkBegin, chunkEnd - chunkBegin
+					),
+					chunkBegin,
+					secondary,
+					pipelineLayout,
+					device.pipeline,
+					materials,
+					meshes,
+					snapshot.geometry
+				);
+			} else {
+				recordInstancedDrawCalls(
+					renderSubmission,
+					objectDataLayout,
+					secondary,
+					pipelineLayout,
+					device.pipeline,
+					materials,
+					meshes,
+					snapshot.geometry
+				);
+				recordIndirectDrawCalls(
+					indirect,
+					renderSubmission,
+					secondary,
+					pipelineLayout,
+					device.pipeline,
+					materials,
+					snapshot.geometry,
+					device.currentFrame
+				);
+
+				// Indirect draws bind their own transforms in its place
+				bind(objectData, secondary, pipelineLayout, device.currentFrame);
+				recordRegularDrawCalls(
+					renderSubmission.transparentObjects,
+					objectDataLayout.firstTransparent,
+					secondary,
+					pipelineLayout,
+					device.pipeline,
+					materials,
+					meshes,
+					snapshot.geometry
+				);
+			}
+			graphics::end(commands);
+		};
+
+		const std::chrono::steady_clock::time_point recordStart =
+			std::chrono::steady_clock::now();
+		jobs::parallelFor(
+			jobs::scheduler.value(),
+			numChunks,
 			1,
-			&device.frameDatas[device.currentFrame].globalDescriptor,
-			0,
-			nullptr
+			[&](uint32_t chunkBegin, uint32_t chunkEnd) {
+				for (uint32_t chunk = chunkBegin; chunk < chunkEnd; chunk++)
+					recordChunk(chunk);
+			}
 		);
+		renderStats.mainPassRecordTime =
+			std::chrono::steady_clock::now() - recordStart;
+		renderStats.mainPassRecordChunks = numChunks;
+
+		secondaryBuffers.clear();
+		for (uint32_t chunk = 0; chunk < numChunks; chunk++) {
+			const SecondaryCommands& commands =
+				frameData.secondaryCommands[chunk];
+			secondaryBuffers.push_back(commands.buffer);
+		}
 
-		recordInstancedDrawCalls(
-			renderSubmission,
-			buffer,
-			device.pipeline.instanceRenderingPipelineLayout,
-			instances,
-			device.pipeline,
-			materials,
-			meshes,
-			device.currentFrame
+		buffer.beginRenderPass(
+			renderPassInfo, vk::SubpassContents::eSecondaryCommandBuffers
+		);
+		buffer.executeCommands(
+			static_cast<uint32_t>(secondaryBuffers.size()),
+			secondaryBuffers.data()
 		);
-
 		buffer.endRenderPass();
 	}
 
@@ -348,7 +748,7 @@ void Module::recordCommandBuffer(
 		const vk::RenderPassBeginInfo renderPassInfo(
 			device.renderPasses.postProcessingPass,
 			device.swapchain->postProcessingFramebuffers[imageIndex],
-			mainWindowExtent,
+			snapshot.mainWindowExtent,
 			clearColors.size(),
 			clearColors.data()
 		);
@@ -392,11 +792,12 @@ void Module::recordCommandBuffer(
 
 		buffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
 
-		ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), buffer);
+		ImGui_ImplVulkan_RenderDrawData(snapshot.uiDrawData, buffer);
 
 		buffer.endRenderPass();
 	}
 
+	recordEnd(gpuTimer, buffer, device.currentFrame);
 	VULKAN_ENSURE_SUCCESS_EXPR(
 		buffer.end(), "Can't end recording command buffer:"
 	);
@@ -405,48 +806,68 @@ void Module::recordCommandBuffer(
 TextureID Module::loadTexture(
 	std::string_view filePath, TextureFormatHint formatHint
 ) {
-	return pushTextureFromFile(
+	const std::lock_guard lock(*renderMutex);
+	const TextureID texture = pushTextureFromFile(
 		textures,
 		filePath,
 		device.device,
 		device.physicalDevice,
-		device.commandPool,
-		device.graphicsAndComputeQueue,
+		device.transfers,
 		formatHint
 	);
+	if (assetSources.textures.size() <= texture.index)
+		assetSources.textures.resize(texture.index + 1);
+	assetSources.textures[texture.index] = {
+		.filePath = std::string(filePath),
+		.formatHint = formatHint,
+	};
+	return texture;
 }
 
 MeshID Module::loadMesh(
 	const std::vector<graphics::Vertex>& vertices,
 	const std::vector<graphics::IndexType>& indices
 ) {
+	const std::lock_guard lock(*renderMutex);
 	return load(
 		meshes,
 		vertices,
 		indices,
 		device.device,
 		device.physicalDevice,
-		device.commandPool,
-		device.graphicsAndComputeQueue
+		device.transfers
 	);
 }
 
 MeshID Module::loadMesh(std::string_view filePath) {
-	return load(
-		meshes,
-		device.device,
-		device.physicalDevice,
-		device.commandPool,
-		device.graphicsAndComputeQueue,
-		filePath
-	);
+	// Parsed and optimized before locking, as that is most of the work
+	std::vector<Vertex> vertices;
+	std::vector<IndexType> indices;
+	loadFromObj(filePath, vertices, indices);
+	return loadMesh(vertices, indices);
+}
+
+void Module::unloadMesh(MeshID mesh) {
+	// The render thread takes the lock to draw what is queued
+	waitIdle(*submissions);
+	const std::lock_guard lock(*renderMutex);
+	device.waitCompleteIdle();
+	unload(meshes, {&mesh, 1});
+}
+
+void Module::defragmentMeshes() {
+	waitIdle(*submissions);
+	const std::lock_guard lock(*renderMutex);
+	device.waitCompleteIdle();
+	defragment(meshes, device.device, device.physicalDevice, device.transfers);
 }
 
 MaterialInstanceID Module::loadMaterial(const MaterialCreateInfo& createInfo) {
+	const std::lock_guard lock(*renderMutex);
 	vk::Sampler sampler = createInfo.sampler == SamplerType::eLinear
 							  ? device.samplers.linear
 							  : device.samplers.point;
-	return ::graphics::create(
+	const MaterialInstanceID material = ::graphics::create(
 		materials,
 		textures,
 		createInfo,
@@ -457,26 +878,29 @@ MaterialInstanceID Module::loadMaterial(const MaterialCreateInfo& createInfo) {
 		device.pipeline.materialDescriptor.allocator,
 		device.writeBuffer
 	);
+	if (assetSources.materials.size() <= material.index)
+		assetSources.materials.resize(material.index + 1);
+	assetSources.materials[material.index] = createInfo;
+	return material;
 }
 
-RenderInstanceID Module::registerInstance(uint16_t numberOfEntries) {
-	return instances.create(
-		device.device,
-		device.physicalDevice,
-		device.pipeline.instanceRenderingDescriptor.setLayout,
-		device.pipeline.instanceRenderingDescriptor.allocator,
-		device.writeBuffer,
-		numberOfEntries
-	);
+void Module::createPipelineVariant(
+	const PipelineSpecializationConstants& specializationConstants
+) {
+	const bool isPending =
+		std::find(
+			pendingVariants.begin(),
+			pendingVariants.end(),
+			specializationConstants
+		) != pendingVariants.end();
+	if (!isPending) pendingVariants.push_back(specializationConstants);
 }
 
-void Module::createPipelineVariant(
+void Module::buildPipelineVariant(
 	const PipelineSpecializationConstants& specializationConstants
 ) {
 	const bool isPipelineMissing =
-		!device.pipeline.regularPipelineVariants.contains(
-			specializationConstants
-		);
+		!hasPipeline(device.pipeline, specializationConstants);
 	if (isPipelineMissing) {
 		const std::vector<uint32_t> vertexShaderSPIRV =
 			compileFromGLSLToSPIRV(device.mainShaders.vertex, {});
@@ -487,15 +911,6 @@ void Module::createPipelineVariant(
 			vertexShaderSPIRV.size() * 4
 		);
 
-		const std::vector<uint32_t> vertexInstancedShaderSPIRV =
-			compileFromGLSLToSPIRV(device.mainShaders.vertexInstanced, {});
-		const ShaderID vertexInstancedShaderID = loadFromBytecode(
-			shaders,
-			device.device,
-			vertexInstancedShaderSPIRV.data(),
-			vertexInstancedShaderSPIRV.size() * 4
-		);
-
 		const std::vector<uint32_t> fragmentShaderSPIRV =
 			compileFromGLSLToSPIRV(
 				device.mainShaders.fragment,
@@ -515,7 +930,6 @@ void Module::createPipelineVariant(
 			device.device,
 			device.renderPasses.mainPass,
 			getModule(shaders, vertexShaderID),
-			getModule(shaders, vertexInstancedShaderID),
 			getModule(shaders, fragmentShaderID)
 		);
 	}
@@ -523,8 +937,10 @@ void Module::createPipelineVariant(
 
 void Module::updateMaterial(
 	MaterialInstanceID material, const MaterialProperties& properties
-) const {
+) {
+	const std::lock_guard lock(*renderMutex);
 	update(materials, properties, material);
+	assetSources.materials[material.index].materialProperties = properties;
 }
 
 }  // namespace graphics
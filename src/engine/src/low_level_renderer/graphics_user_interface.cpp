@@ -219,15 +219,8 @@ GraphicsUserInterface GraphicsUserInterface::create(
 	};
 }
 
-void GraphicsUserInterface::handleEvent(
-	const SDL_Event& event, const GraphicsDeviceInterface& device
-) {
+void GraphicsUserInterface::handleEvent(const SDL_Event& event) {
 	ImGui_ImplSDL3_ProcessEvent(&event);
-	switch (event.type) {
-		case SDL_EVENT_WINDOW_RESIZED:
-			recreateRenderpassAndFramebuffers(device);
-			break;
-	}
 }
 
 void GraphicsUserInterface::recreateRenderpassAndFramebuffers(
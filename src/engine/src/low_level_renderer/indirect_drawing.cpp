@@ -0,0 +1,506 @@
+#include "low_level_renderer/indirect_drawing.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <optional>
+
+#include "core/logger/assert.h"
+#include "core/logger/vulkan_ensures.h"
+#include "private/descriptor.h"
+
+namespace graphics {
+
+namespace {
+// Workgroups, each culling one object, per row of the dispatch. The least
+// maxComputeWorkGroupCount allowed in any dimension.
+constexpr uint32_t CULLING_GROUPS_PER_ROW = 65535;
+// Capacities before any object is uploaded, as buffers can't be empty
+constexpr uint32_t INITIAL_OBJECT_CAPACITY = 64;
+constexpr uint32_t INITIAL_COMMAND_CAPACITY = 1024;
+constexpr uint32_t INITIAL_BUCKET_CAPACITY = 16;
+
+void createObjectBuffers(
+	IndirectDrawData::FrameData& frameData,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	uint32_t capacity
+) {
+	frameData.objects = MappedBuffer::create(
+		device,
+		physicalDevice,
+		sizeof(IndirectObject) * capacity,
+		vk::BufferUsageFlagBits::eStorageBuffer
+	);
+	frameData.transforms = MappedBuffer::create(
+		device,
+		physicalDevice,
+		sizeof(InstanceData) * capacity,
+		vk::BufferUsageFlagBits::eStorageBuffer
+	);
+	frameData.objectCapacity = capacity;
+}
+
+void createCommandBuffer(
+	IndirectDrawData::FrameData& frameData,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	uint32_t capacity
+) {
+	frameData.commands = MappedBuffer::create(
+		device,
+		physicalDevice,
+		sizeof(vk::DrawIndexedIndirectCommand) * capacity,
+		vk::BufferUsageFlagBits::eStorageBuffer |
+			vk::BufferUsageFlagBits::eIndirectBuffer
+	);
+	frameData.commandCapacity = capacity;
+}
+
+void createCountBuffer(
+	IndirectDrawData::FrameData& frameData,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	uint32_t capacity
+) {
+	frameData.counts = MappedBuffer::create(
+		device,
+		physicalDevice,
+		sizeof(uint32_t) * capacity,
+		vk::BufferUsageFlagBits::eStorageBuffer |
+			vk::BufferUsageFlagBits::eIndirectBuffer |
+			vk::BufferUsageFlagBits::eTransferDst
+	);
+	// Read back before the first culling pass writes to it
+	std::memset(frameData.counts.mappedMemory, 0, sizeof(uint32_t) * capacity);
+	frameData.bucketCapacity = capacity;
+}
+
+// The meshlet buffer is bound whole, as it belongs to the geometry
+void writeDescriptors(
+	const IndirectDrawData::FrameData& frameData,
+	DescriptorWriteBuffer& writeBuffer
+) {
+	const std::array<std::tuple<vk::Buffer, size_t>, 5> cullingBuffers = {
+		std::make_tuple(
+			frameData.objects.buffer,
+			sizeof(IndirectObject) * frameData.objectCapacity
+		),
+		std::make_tuple(
+			frameData.transforms.buffer,
+			sizeof(InstanceData) * frameData.objectCapacity
+		),
+		std::make_tuple(
+			frameData.commands.buffer,
+			sizeof(vk::DrawIndexedIndirectCommand) * frameData.commandCapacity
+		),
+		std::make_tuple(
+			frameData.counts.buffer,
+			sizeof(uint32_t) * frameData.bucketCapacity
+		),
+		std::make_tuple(
+			frameData.meshletBuffer, static_cast<size_t>(VK_WHOLE_SIZE)
+		),
+	};
+	for (size_t binding = 0; binding < cullingBuffers.size(); binding++) {
+		const auto [buffer, range] = cullingBuffers[binding];
+		// Nothing is culled before the first mesh creates the meshlets
+		if (!buffer) continue;
+		writeBuffer.writeBuffer(
+			frameData.cullingSet,
+			static_cast<int>(binding),
+			buffer,
+			vk::DescriptorType::eStorageBuffer,
+			0,
+			range
+		);
+	}
+	writeBuffer.writeBuffer(
+		frameData.transformSet,
+		0,
+		frameData.transforms.buffer,
+		vk::DescriptorType::eStorageBuffer,
+		0,
+		sizeof(InstanceData) * frameData.objectCapacity
+	);
+}
+}  // namespace
+
+IndirectDrawData IndirectDrawData::create(
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	ShaderStorage& shaders,
+	PipelineDescriptorData& instanceRenderingDescriptor,
+	DescriptorWriteBuffer& writeBuffer
+) {
+	std::array<vk::DescriptorSetLayoutBinding, 5> bindings;
+	for (uint32_t binding = 0; binding < bindings.size(); binding++)
+		bindings[binding] = vk::DescriptorSetLayoutBinding(
+			binding,
+			vk::DescriptorType::eStorageBuffer,
+			1,
+			vk::ShaderStageFlagBits::eCompute
+		);
+	const vk::DescriptorSetLayout setLayout =
+		createDescriptorLayout(device, bindings);
+
+	const std::array<vk::DescriptorPoolSize, 1> poolSizes = {
+		vk::DescriptorPoolSize(
+			vk::DescriptorType::eStorageBuffer,
+			static_cast<uint32_t>(bindings.size()) * MAX_FRAMES_IN_FLIGHT
+		),
+	};
+	const vk::DescriptorPool pool =
+		createDescriptorPool(device, MAX_FRAMES_IN_FLIGHT, poolSizes);
+	const std::vector<vk::DescriptorSet> cullingSets =
+		createDescriptorSets(device, pool, setLayout, MAX_FRAMES_IN_FLIGHT);
+	const std::vector<vk::DescriptorSet> transformSets =
+		instanceRenderingDescriptor.allocator.allocate(
+			device, instanceRenderingDescriptor.setLayout, MAX_FRAMES_IN_FLIGHT
+		);
+
+	std::array<FrameData, MAX_FRAMES_IN_FLIGHT> frameDatas;
+	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		FrameData& frameData = frameDatas[i];
+		frameData.isStale = true;
+		frameData.numBuckets = 0;
+		frameData.cullingSet = cullingSets[i];
+		frameData.transformSet = transformSets[i];
+		frameData.meshletBuffer = nullptr;
+		createObjectBuffers(
+			frameData, device, physicalDevice, INITIAL_OBJECT_CAPACITY
+		);
+		createCommandBuffer(
+			frameData, device, physicalDevice, INITIAL_COMMAND_CAPACITY
+		);
+		createCountBuffer(
+			frameData, device, physicalDevice, INITIAL_BUCKET_CAPACITY
+		);
+		writeDescriptors(frameData, writeBuffer);
+	}
+
+	const ShaderID compute = loadShaderFromFile(
+		shaders, device, "shaders/indirect_culling.comp.glsl.spv"
+	);
+
+	const vk::PushConstantRange pushConstantRange(
+		vk::ShaderStageFlagBits::eCompute,
+		0,
+		sizeof(IndirectCullingPushConstants)
+	);
+	const vk::PipelineLayoutCreateInfo pipelineLayoutInfo(
+		{}, 1, &setLayout, 1, &pushConstantRange
+	);
+	const vk::ResultValue<vk::PipelineLayout> pipelineLayoutCreation =
+		device.createPipelineLayout(pipelineLayoutInfo);
+	VULKAN_ENSURE_SUCCESS(
+		pipelineLayoutCreation.result, "Can't create pipeline layout:"
+	);
+
+	const vk::ResultValue<vk::Pipeline> pipelineCreation =
+		device.createComputePipeline(
+			nullptr,
+			vk::ComputePipelineCreateInfo(
+				{},
+				vk::PipelineShaderStageCreateInfo(
+					{},
+					vk::ShaderStageFlagBits::eCompute,
+					getModule(shaders, compute),
+					"main"
+				),
+				pipelineLayoutCreation.value
+			)
+		);
+	VULKAN_ENSURE_SUCCESS(
+		pipelineCreation.result, "Can't create indirect culling pipeline:"
+	);
+
+	return IndirectDrawData{
+		.frameDatas = frameDatas,
+		.compute = compute,
+		.setLayout = setLayout,
+		.pool = pool,
+		.pipelineLayout = pipelineLayoutCreation.value,
+		.pipeline = pipelineCreation.value,
+	};
+}
+
+void upload(
+	IndirectDrawData& indirect,
+	const RenderSubmission& renderSubmission,
+	const GeometryHandles& geometry,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	DescriptorWriteBuffer& writeBuffer,
+	uint32_t currentFrame
+) {
+	ASSERT(
+		renderSubmission.indirectObjects.size() ==
+			renderSubmission.indirectTransforms.size(),
+		"Indirect objects size (" << renderSubmission.indirectObjects.size()
+								  << ") and transforms size ("
+								  << renderSubmission.indirectTransforms.size()
+								  << ") mismatched"
+	);
+	IndirectDrawData::FrameData& frameData =
+		indirect.frameDatas[currentFrame];
+	const uint32_t numObjects =
+		static_cast<uint32_t>(renderSubmission.indirectObjects.size());
+	const uint32_t numBuckets =
+		static_cast<uint32_t>(renderSubmission.indirectBuckets.size());
+	// Buckets lay their commands out in order
+	const uint32_t numCommands =
+		renderSubmission.indirectBuckets.empty()
+			? 0
+			: renderSubmission.indirectBuckets.back().firstCommand +
+				  renderSubmission.indirectBuckets.back().capacity;
+
+	// Other frames upload later, so they queue this submission's changes on
+	// top of those of the submissions they missed
+	for (IndirectDrawData::FrameData& other : indirect.frameDatas) {
+		if (renderSubmission.isIndirectLayoutChanged) {
+			other.isStale = true;
+			other.changedTransforms.clear();
+		} else if (!other.isStale) {
+			other.changedTransforms.insert(
+				other.changedTransforms.end(),
+				renderSubmission.changedIndirectTransforms.begin(),
+				renderSubmission.changedIndirectTransforms.end()
+			);
+		}
+	}
+
+	bool areDescriptorsStale = false;
+	if (numObjects > frameData.objectCapacity) {
+		frameData.objects.destroyBy(device);
+		frameData.transforms.destroyBy(device);
+		createObjectBuffers(
+			frameData, device, physicalDevice, std::bit_ceil(numObjects)
+		);
+		frameData.isStale = true;
+		areDescriptorsStale = true;
+	}
+	if (numCommands > frameData.commandCapacity) {
+		frameData.commands.destroyBy(device);
+		createCommandBuffer(
+			frameData, device, physicalDevice, std::bit_ceil(numCommands)
+		);
+		areDescriptorsStale = true;
+	}
+	// Replaced whenever the geometry grows or is defragmented. The old one
+	// stays alive until frames that bound it are done.
+	if (geometry.meshletBuffer != frameData.meshletBuffer) {
+		frameData.meshletBuffer = geometry.meshletBuffer;
+		areDescriptorsStale = true;
+	}
+	if (numBuckets > frameData.bucketCapacity) {
+		frameData.counts.destroyBy(device);
+		createCountBuffer(
+			frameData, device, physicalDevice, std::bit_ceil(numBuckets)
+		);
+		areDescriptorsStale = true;
+	}
+	// The frame's sets are no longer in use, but the write buffer was already
+	// flushed this frame
+	if (areDescriptorsStale) {
+		writeDescriptors(frameData, writeBuffer);
+		writeBuffer.flush(device);
+	}
+
+	if (frameData.isStale) {
+		std::memcpy(
+			frameData.objects.mappedMemory,
+			renderSubmission.indirectObjects.data(),
+			renderSubmission.indirectObjects.size_bytes()
+		);
+		std::memcpy(
+			frameData.transforms.mappedMemory,
+			renderSubmission.indirectTransforms.data(),
+			renderSubmission.indirectTransforms.size_bytes()
+		);
+	} else {
+		InstanceData* transforms =
+			static_cast<InstanceData*>(frameData.transforms.mappedMemory);
+		for (const IndirectRange& range : frameData.changedTransforms) {
+			ASSERT(
+				range.first + range.count <= numObjects,
+				"Changed transforms [" << range.first << ", "
+									   << range.first + range.count
+									   << ") are past the " << numObjects
+									   << " indirect objects"
+			);
+			std::memcpy(
+				transforms + range.first,
+				renderSubmission.indirectTransforms.data() + range.first,
+				sizeof(InstanceData) * range.count
+			);
+		}
+	}
+	frameData.changedTransforms.clear();
+	frameData.isStale = false;
+	frameData.numBuckets = numBuckets;
+}
+
+void recordCulling(
+	const IndirectDrawData& indirect,
+	const RenderSubmission& renderSubmission,
+	glm::vec3 cameraPosition,
+	vk::CommandBuffer buffer,
+	uint32_t currentFrame
+) {
+	if (renderSubmission.indirectObjects.empty()) return;
+	const IndirectDrawData::FrameData& frameData =
+		indirect.frameDatas[currentFrame];
+
+	buffer.fillBuffer(
+		frameData.counts.buffer, 0, sizeof(uint32_t) * frameData.numBuckets, 0
+	);
+	const vk::MemoryBarrier clearBarrier(
+		vk::AccessFlagBits::eTransferWrite,
+		vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+	);
+	buffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer,
+		vk::PipelineStageFlagBits::eComputeShader,
+		{},
+		clearBarrier,
+		{},
+		{}
+	);
+
+	IndirectCullingPushConstants pushConstants = {
+		.planes = renderSubmission.frustum.planes,
+		.cameraPosition = cameraPosition,
+		.objectCount =
+			static_cast<uint32_t>(renderSubmission.indirectObjects.size()),
+	};
+	buffer.bindPipeline(vk::PipelineBindPoint::eCompute, indirect.pipeline);
+	buffer.bindDescriptorSets(
+		vk::PipelineBindPoint::eCompute,
+		indirect.pipelineLayout,
+		0,
+		1,
+		&frameData.cullingSet,
+		0,
+		nullptr
+	);
+	buffer.pushConstants(
+		indirect.pipelineLayout,
+		vk::ShaderStageFlagBits::eCompute,
+		0,
+		sizeof(IndirectCullingPushConstants),
+		&pushConstants
+	);
+	// One workgroup per object, wrapping onto more rows past the limit
+	const uint32_t groupsPerRow =
+		std::min(pushConstants.objectCount, CULLING_GROUPS_PER_ROW);
+	buffer.dispatch(
+		groupsPerRow,
+		(pushConstants.objectCount + groupsPerRow - 1) / groupsPerRow,
+		1
+	);
+
+	// The counts are also read back by the host once the frame is done
+	const vk::MemoryBarrier cullingBarrier(
+		vk::AccessFlagBits::eShaderWrite,
+		vk::AccessFlagBits::eIndirectCommandRead |
+			vk::AccessFlagBits::eHostRead
+	);
+	buffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eComputeShader,
+		vk::PipelineStageFlagBits::eDrawIndirect |
+			vk::PipelineStageFlagBits::eHost,
+		{},
+		cullingBarrier,
+		{},
+		{}
+	);
+}
+
+void recordIndirectDrawCalls(
+	const IndirectDrawData& indirect,
+	const RenderSubmission& renderSubmission,
+	vk::CommandBuffer buffer,
+	vk::PipelineLayout pipelineLayout,
+	const MaterialPipeline& pipelines,
+	const MaterialStorage& materials,
+	const GeometryHandles& geometry,
+	uint32_t currentFrame
+) {
+	if (renderSubmission.indirectBuckets.empty()) return;
+	const IndirectDrawData::FrameData& frameData =
+		indirect.frameDatas[currentFrame];
+
+	buffer.bindDescriptorSets(
+		vk::PipelineBindPoint::eGraphics,
+		pipelineLayout,
+		static_cast<int>(MainPipelineDescriptorSetBindingPoint::eInstanceRendering),
+		1,
+		&frameData.transformSet,
+		0,
+		nullptr
+	);
+
+	std::optional<PipelineSpecializationConstants> boundVariant = std::nullopt;
+	std::optional<MaterialInstanceID> boundMaterial = std::nullopt;
+	std::optional<vk::IndexType> boundIndexType = std::nullopt;
+	for (uint32_t i = 0; i < renderSubmission.indirectBuckets.size(); i++) {
+		const IndirectBucket& bucket = renderSubmission.indirectBuckets[i];
+		const bool shouldBindPipeline =
+			!boundVariant.has_value() || boundVariant.value() != bucket.variant;
+		if (shouldBindPipeline) {
+			const vk::Pipeline pipeline = getPipeline(pipelines, bucket.variant);
+			buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+			boundVariant = bucket.variant;
+		}
+
+		const bool shouldBindMaterial = !boundMaterial.has_value() ||
+										boundMaterial.value() != bucket.material;
+		if (shouldBindMaterial) {
+			bind(materials, bucket.material, buffer, pipelineLayout);
+			boundMaterial = bucket.material;
+		}
+
+		if (boundIndexType != bucket.indexType) {
+			bindIndices(buffer, geometry, bucket.indexType);
+			boundIndexType = bucket.indexType;
+		}
+
+		buffer.drawIndexedIndirectCount(
+			frameData.commands.buffer,
+			sizeof(vk::DrawIndexedIndirectCommand) * bucket.firstCommand,
+			frameData.counts.buffer,
+			sizeof(uint32_t) * i,
+			bucket.capacity,
+			sizeof(vk::DrawIndexedIndirectCommand)
+		);
+	}
+}
+
+uint32_t getVisibleCount(
+	const IndirectDrawData& indirect, uint32_t currentFrame
+) {
+	const IndirectDrawData::FrameData& frameData =
+		indirect.frameDatas[currentFrame];
+	const uint32_t* counts =
+		static_cast<const uint32_t*>(frameData.counts.mappedMemory);
+	uint32_t visibleCount = 0;
+	for (uint32_t i = 0; i < frameData.numBuckets; i++)
+		visibleCount += counts[i];
+	return visibleCount;
+}
+
+void destroy(const IndirectDrawData& indirect, vk::Device device) {
+	for (const IndirectDrawData::FrameData& frameData : indirect.frameDatas) {
+		frameData.objects.destroyBy(device);
+		frameData.transforms.destroyBy(device);
+		frameData.commands.destroyBy(device);
+		frameData.counts.destroyBy(device);
+	}
+	device.destroyPipeline(indirect.pipeline);
+	device.destroyPipelineLayout(indirect.pipelineLayout);
+	device.destroyDescriptorPool(indirect.pool);
+	device.destroyDescriptorSetLayout(indirect.setLayout);
+}
+
+}  // namespace graphics
@@ -1,100 +1,108 @@
 #include "low_level_renderer/instance_rendering.h"
 
+#include <bit>
+
 #include "core/logger/assert.h"
 #include "low_level_renderer/material_pipeline.h"
 
 namespace graphics {
-RenderInstanceID RenderInstanceManager::create(
+namespace {
+// Buffers can't be empty, so they start with room for this many objects
+constexpr uint32_t INITIAL_CAPACITY = 256;
+
+void createBuffer(
+    ObjectDataBuffer::FrameData& frameData,
+    vk::Device device,
+    vk::PhysicalDevice physicalDevice,
+    DescriptorWriteBuffer& writeBuffer,
+    uint32_t capacity
+) {
+    frameData.buffer = MappedBuffer::create(
+        device,
+        physicalDevice,
+        sizeof(InstanceData) * capacity,
+        vk::BufferUsageFlagBits::eStorageBuffer
+    );
+    frameData.capacity = capacity;
+    writeBuffer.writeBuffer(
+        frameData.descriptorSet,
+        0,
+        frameData.buffer.buffer,
+        vk::DescriptorType::eStorageBuffer,
+        0,
+        sizeof(InstanceData) * capacity
+    );
+}
+}  // namespace
+
+ObjectDataBuffer ObjectDataBuffer::create(
     vk::Device device,
     vk::PhysicalDevice physicalDevice,
     vk::DescriptorSetLayout setLayout,
     DescriptorAllocator& descriptorAllocator,
-    DescriptorWriteBuffer& writeBuffer,
-    uint16_t numberOfEntries
+    DescriptorWriteBuffer& writeBuffer
 ) {
-    uint16_t index = renderInstances.size();
-    std::array<RenderInstance, MAX_FRAMES_IN_FLIGHT> instance;
-    auto descriptorSets =
+    const std::vector<vk::DescriptorSet> descriptorSets =
         descriptorAllocator.allocate(device, setLayout, MAX_FRAMES_IN_FLIGHT);
+    std::array<ObjectDataBuffer::FrameData, MAX_FRAMES_IN_FLIGHT> frameDatas;
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        StorageBuffer<InstanceData> storageBuffer =
-            StorageBuffer<InstanceData>::create(
-                device, physicalDevice, numberOfEntries
-            );
-        storageBuffer.update(InstanceData{.transform = glm::mat4(1)});
-        storageBuffer.bind(writeBuffer, descriptorSets[i], 0);
-        instance[i] = {
-            .storageBuffer = storageBuffer,
-            .descriptorSet = descriptorSets[i],
-        };
+        frameDatas[i].descriptorSet = descriptorSets[i];
+        createBuffer(
+            frameDatas[i], device, physicalDevice, writeBuffer, INITIAL_CAPACITY
+        );
     }
-    renderInstances.push_back(instance);
-    return {index};
+    return ObjectDataBuffer{.frameDatas = frameDatas};
 }
 
-void RenderInstanceManager::bind(
+InstanceData* reserve(
+    ObjectDataBuffer& objectData,
+    vk::Device device,
+    vk::PhysicalDevice physicalDevice,
+    DescriptorWriteBuffer& writeBuffer,
+    uint32_t currentFrame,
+    uint32_t count
+) {
+    ASSERT(
+        currentFrame < MAX_FRAMES_IN_FLIGHT,
+        "Reserving object data for frame " << currentFrame << " which is >= "
+                                           << MAX_FRAMES_IN_FLIGHT
+    );
+    ObjectDataBuffer::FrameData& frameData =
+        objectData.frameDatas[currentFrame];
+    if (count > frameData.capacity) {
+        frameData.buffer.destroyBy(device);
+        createBuffer(
+            frameData,
+            device,
+            physicalDevice,
+            writeBuffer,
+            std::bit_ceil(count)
+        );
+        // The write buffer was already flushed this frame
+        writeBuffer.flush(device);
+    }
+    return static_cast<InstanceData*>(frameData.buffer.mappedMemory);
+}
+
+void bind(
+    const ObjectDataBuffer& objectData,
     vk::CommandBuffer commandBuffer,
     vk::PipelineLayout layout,
-    RenderInstanceID id,
     uint32_t currentFrame
-) const {
+) {
     commandBuffer.bindDescriptorSets(
         vk::PipelineBindPoint::eGraphics,
         layout,
         static_cast<int>(MainPipelineDescriptorSetBindingPoint::eInstanceRendering),
         1,
-        &renderInstances.at(id.index).at(currentFrame).descriptorSet,
+        &objectData.frameDatas.at(currentFrame).descriptorSet,
         0,
         nullptr
     );
 }
 
-void RenderInstanceManager::update(
-    RenderInstanceID id,
-    uint32_t currentFrame,
-    std::span<const InstanceData> instanceData
-) const {
-    ASSERT(
-        currentFrame < MAX_FRAMES_IN_FLIGHT,
-        "Updating instance with frame "
-            << currentFrame << " which is >= " << MAX_FRAMES_IN_FLIGHT
-    );
-    ASSERT(
-        getCapacity(id) >= instanceData.size(),
-        "Provided " << instanceData.size()
-                    << " instances which exceeds the capacity of "
-                    << getCapacity(id) << " for instance " << id.index
-    );
-    renderInstances.at(id.index)
-        .at(currentFrame)
-        .storageBuffer.update(instanceData);
-}
-
-uint16_t RenderInstanceManager::getCapacity(RenderInstanceID id) const {
-    ASSERT(
-        renderInstances.size() > id.index,
-        "Expect a valid render instance containing a valid index that is < "
-            << renderInstances.size() << " but got " << id.index
-    );
-    ASSERT(
-        renderInstances[id.index].size() > 0,
-        "Expects render instance to own at least one storage buffer"
-    );
-    return renderInstances[id.index][0].storageBuffer.dataCount;
-}
-
-void RenderInstanceManager::destroyBy(const vk::Device& device) const {
-    for (const auto& instance : renderInstances)
-        for (const RenderInstance& frameInstance : instance)
-            frameInstance.storageBuffer.destroyBy(device);
-}
-
-bool RenderInstanceID::operator==(const RenderInstanceID& other) const {
-    return index == other.index;
-}
-
-size_t RenderInstanceIDHashFunction::operator()(const RenderInstanceID& id
-) const {
-    return id.index;
+void destroy(const ObjectDataBuffer& objectData, vk::Device device) {
+    for (const ObjectDataBuffer::FrameData& frameData : objectData.frameDatas)
+        frameData.buffer.destroyBy(device);
 }
 }  // namespace Graphics
@@ -123,26 +123,27 @@ MaterialPipeline MaterialPipeline::create(
 		};
 	}
 
-	const PipelineTemplate pipelineTemplate =
-		PipelineTemplate::createDefault(renderPasses);
-	const auto [regularPipelineLayout, instanceRenderingPipelineLayout] =
-		createMainPipelinesLayouts(
-			device,
-			globalDescriptorData,
-			materialDescriptorData,
-			instanceRenderingDescriptorData
-		);
+	const std::array<PipelineTemplate, RENDER_QUEUE_COUNT> pipelineTemplates = {
+		PipelineTemplate::createDefault(renderPasses, RenderQueue::eOpaque),
+		PipelineTemplate::createDefault(
+			renderPasses, RenderQueue::eTransparent
+		),
+	};
+	const vk::PipelineLayout pipelineLayout = createMainPipelineLayout(
+		device,
+		globalDescriptorData,
+		materialDescriptorData,
+		instanceRenderingDescriptorData
+	);
 
 	const auto [postProcessingPipeline] = createPostProcessingPipelines(
 		shaders, device, renderPasses, postProcessingDescriptorData
 	);
 
 	return {
-		.pipelineTemplate = pipelineTemplate,
-		.regularPipelineVariants = {},
-		.instanceRenderingPipelineVariants = {},
-		.regularPipelineLayout = regularPipelineLayout,
-		.instanceRenderingPipelineLayout = instanceRenderingPipelineLayout,
+		.pipelineTemplates = pipelineTemplates,
+		.pipelineVariants = {},
+		.pipelineLayout = pipelineLayout,
 		.postProcessingPipeline = postProcessingPipeline,
 		.globalDescriptor = globalDescriptorData,
 		.instanceRenderingDescriptor = instanceRenderingDescriptorData,
@@ -151,60 +152,27 @@ MaterialPipeline MaterialPipeline::create(
 	};
 }
 
-std::array<vk::PipelineLayout, 2> createMainPipelinesLayouts(
+vk::PipelineLayout createMainPipelineLayout(
 	vk::Device device,
 	const PipelineDescriptorData& globalDescriptorData,
 	const PipelineDescriptorData& materialDescriptorData,
 	const PipelineDescriptorData& instanceRenderingDescriptorData
 ) {
-	const std::vector<vk::DescriptorSetLayout> instanceRenderingSetLayouts = {
+	const std::vector<vk::DescriptorSetLayout> setLayouts = {
 		globalDescriptorData.setLayout,
 		materialDescriptorData.setLayout,
 		instanceRenderingDescriptorData.setLayout,
 	};
 
-	const std::vector<vk::DescriptorSetLayout> regularSetLayouts = {
-		globalDescriptorData.setLayout,
-		materialDescriptorData.setLayout,
-	};
-
-	const vk::PushConstantRange pushConstantRange(
-		vk::ShaderStageFlagBits::eVertex, 0, sizeof(GPUPushConstants)
+	const vk::PipelineLayoutCreateInfo pipelineLayoutInfo(
+		{}, setLayouts.size(), setLayouts.data(), 0, nullptr
 	);
-
-	const vk::PipelineLayout regularPipelineLayout = [&]() {
-		const vk::PipelineLayoutCreateInfo pipelineLayoutInfo(
-			{},
-			regularSetLayouts.size(),
-			regularSetLayouts.data(),
-			1,
-			&pushConstantRange
-		);
-		const vk::ResultValue<vk::PipelineLayout> pipelineLayoutCreation =
-			device.createPipelineLayout(pipelineLayoutInfo);
-		VULKAN_ENSURE_SUCCESS(
-			pipelineLayoutCreation.result, "Can't create pipeline layout:"
-		);
-		return pipelineLayoutCreation.value;
-	}();
-
-	const vk::PipelineLayout instanceRenderingPipelineLayout = [&]() {
-		const vk::PipelineLayoutCreateInfo pipelineLayoutInfo(
-			{},
-			instanceRenderingSetLayouts.size(),
-			instanceRenderingSetLayouts.data(),
-			0,
-			nullptr
-		);
-		const vk::ResultValue<vk::PipelineLayout> pipelineLayoutCreation =
-			device.createPipelineLayout(pipelineLayoutInfo);
-		VULKAN_ENSURE_SUCCESS(
-			pipelineLayoutCreation.result, "Can't create pipeline layout:"
-		);
-		return pipelineLayoutCreation.value;
-	}();
-
-	return {regularPipelineLayout, instanceRenderingPipelineLayout};
+	const vk::ResultValue<vk::PipelineLayout> pipelineLayoutCreation =
+		device.createPipelineLayout(pipelineLayoutInfo);
+	VULKAN_ENSURE_SUCCESS(
+		pipelineLayoutCreation.result, "Can't create pipeline layout:"
+	);
+	return pipelineLayoutCreation.value;
 }
 
 std::array<PipelineData, 1> createPostProcessingPipelines(
@@ -360,86 +328,49 @@ void createNewVariant(
 	vk::Device device,
 	vk::RenderPass renderPass,
 	vk::ShaderModule vertexShader,
-	vk::ShaderModule vertexShaderInstanced,
 	vk::ShaderModule fragmentShader
 ) {
-	const vk::Pipeline regularPipeline = createVariant(
-		materialPipeline.pipelineTemplate,
+	const PipelineTemplate& pipelineTemplate =
+		materialPipeline.pipelineTemplates[static_cast<size_t>(
+			specializationConstants.queue
+		)];
+	materialPipeline.pipelineVariants[specializationConstants] = createVariant(
+		pipelineTemplate,
 		specializationConstants,
 		device,
 		renderPass,
-		materialPipeline.regularPipelineLayout,
+		materialPipeline.pipelineLayout,
 		vertexShader,
 		fragmentShader
 	);
-
-	const vk::Pipeline instancedPipeline = createVariant(
-		materialPipeline.pipelineTemplate,
-		specializationConstants,
-		device,
-		renderPass,
-		materialPipeline.instanceRenderingPipelineLayout,
-		vertexShaderInstanced,
-		fragmentShader
-	);
-
-	materialPipeline.regularPipelineVariants[specializationConstants] =
-		regularPipeline;
-	materialPipeline
-		.instanceRenderingPipelineVariants[specializationConstants] =
-		instancedPipeline;
 }
 
 bool hasPipeline(
 	const MaterialPipeline& materialPipeline,
 	const PipelineSpecializationConstants& specializationConstants
 ) {
-	return materialPipeline.regularPipelineVariants.contains(
-		specializationConstants
-	);
+	return materialPipeline.pipelineVariants.contains(specializationConstants);
 }
 
-vk::Pipeline getRegularPipeline(
+vk::Pipeline getPipeline(
 	const MaterialPipeline& materialPipeline,
 	const PipelineSpecializationConstants& specializationConstants
 ) {
 	ASSERT(
-		materialPipeline.regularPipelineVariants.contains(
-			specializationConstants
-		),
+		materialPipeline.pipelineVariants.contains(specializationConstants),
 		"Material pipeline has no entry for specialization constant: "
 			<< specializationConstants.samplerInclusion
 	);
-	return materialPipeline.regularPipelineVariants.at(specializationConstants);
-}
-
-vk::Pipeline getInstanceRenderingPipeline(
-	const MaterialPipeline& materialPipeline,
-	const PipelineSpecializationConstants& specializationConstants
-) {
-	ASSERT(
-		materialPipeline.instanceRenderingPipelineVariants.contains(
-			specializationConstants
-		),
-		"Material pipeline has no entry for specialization constant: "
-			<< specializationConstants.samplerInclusion
-	);
-	return materialPipeline.instanceRenderingPipelineVariants.at(
-		specializationConstants
-	);
+	return materialPipeline.pipelineVariants.at(specializationConstants);
 }
 
 void destroy(const MaterialPipeline& pipeline, vk::Device device) {
 	destroy(pipeline.globalDescriptor, device);
 	destroy(pipeline.instanceRenderingDescriptor, device);
 	destroy(pipeline.materialDescriptor, device);
-	for (const auto& [constants, pipeline] : pipeline.regularPipelineVariants)
-		device.destroyPipeline(pipeline);
-	for (const auto& [constants, pipeline] :
-		 pipeline.instanceRenderingPipelineVariants)
+	for (const auto& [constants, pipeline] : pipeline.pipelineVariants)
 		device.destroyPipeline(pipeline);
-	device.destroyPipelineLayout(pipeline.regularPipelineLayout);
-	device.destroyPipelineLayout(pipeline.instanceRenderingPipelineLayout);
+	device.destroyPipelineLayout(pipeline.pipelineLayout);
 	destroy(pipeline.postProcessingDescriptor, device);
 	destroy(pipeline.postProcessingPipeline, device);
 }
@@ -19,12 +19,12 @@ PipelineSpecializationConstants createSpecializationConstant(
 		(info.emission.has_value() ? SamplerInclusionBits::eEmission
 								   : SamplerInclusionBits::eNone)
 	);
-	return {.samplerInclusion = samplerInclusion};
+	return {.samplerInclusion = samplerInclusion, .queue = info.queue};
 }
 
 MaterialStorage MaterialStorage::create() {
 	return {
-		.indices = algo::GenerationIndexArray<MAX_MATERIAL_INSTANCES>::create(),
+		.indices = algo::GenerationIndexArray::create(),
 		.descriptors = {},
 		.uniforms = {},
 		.specializationConstant = {}
@@ -43,6 +43,10 @@ MaterialInstanceID create(
 	DescriptorWriteBuffer& writeBuffer
 ) {
 	const MaterialInstanceID id = algo::reserveIndex(materials.indices);
+	const size_t capacity = algo::getCapacity(materials.indices);
+	materials.descriptors.ensureCapacity(capacity);
+	materials.uniforms.ensureCapacity(capacity);
+	materials.specializationConstant.ensureCapacity(capacity);
 
 	const UniformBuffer<MaterialProperties> uniformBuffer =
 		UniformBuffer<MaterialProperties>::create(device, physicalDevice);
@@ -151,7 +155,8 @@ void bind(
 }
 
 void destroy(MaterialStorage& materials, vk::Device device) {
-	for (size_t index : algo::getLiveIndices(materials.indices))
+	algo::forEachLiveIndex(materials.indices, [&](uint32_t index) {
 		materials.uniforms[index].destroyBy(device);
+	});
 }
 }  // namespace graphics
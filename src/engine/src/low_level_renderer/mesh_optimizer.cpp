@@ -0,0 +1,452 @@
+#include "low_level_renderer/mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "core/logger/assert.h"
+#include "core/logger/logger.h"
+#include "core/math/bounds.h"
+
+namespace graphics {
+
+namespace {
+constexpr size_t NUM_OF_VERTS_PER_TRIANGLE = 3;
+constexpr size_t CACHE_LINE_SIZE = 64;
+// Lines of the vertex fetch cache the stats simulate, 16 KiB of them
+constexpr uint32_t FETCH_CACHE_LINES = 256;
+// Normal cones wider than this, in cosine of the half angle, face away from
+// too few viewpoints to be worth testing
+constexpr float MIN_CONE_COSINE = 0.1f;
+
+// FIFO cache of a fixed number of entries. An entry is cached when it was
+// loaded fewer than `size` loads ago.
+struct FifoCache {
+	std::vector<uint32_t> loadedAt;
+	uint32_t time;
+	uint32_t size;
+
+   public:
+	static FifoCache create(size_t entryCount, uint32_t size) {
+		return FifoCache{
+			.loadedAt = std::vector<uint32_t>(entryCount, 0),
+			.time = size + 1,
+			.size = size,
+		};
+	}
+};
+
+// Whether the entry missed
+bool touch(FifoCache& cache, uint32_t entry) {
+	if (cache.time - cache.loadedAt[entry] <= cache.size) return false;
+	cache.loadedAt[entry] = cache.time++;
+	return true;
+}
+
+uint32_t touchTriangle(
+	FifoCache& cache, std::span<const IndexType> indices, size_t triangle
+) {
+	const size_t first = triangle * NUM_OF_VERTS_PER_TRIANGLE;
+	uint32_t misses = 0;
+	for (size_t k = 0; k < NUM_OF_VERTS_PER_TRIANGLE; k++)
+		misses += touch(cache, indices[first + k]);
+	return misses;
+}
+
+// Ages every entry out of the cache
+void flush(FifoCache& cache) { cache.time += cache.size + 1; }
+
+size_t getTriangleCount(std::span<const IndexType> indices) {
+	ASSERT(
+		indices.size() % NUM_OF_VERTS_PER_TRIANGLE == 0,
+		"Mesh of " << indices.size() << " indices is not made of triangles"
+	);
+	return indices.size() / NUM_OF_VERTS_PER_TRIANGLE;
+}
+}  // namespace
+
+MeshOptimizationStats analyze(
+	std::span<const IndexType> indices, size_t vertexCount
+) {
+	const size_t triangleCount = getTriangleCount(indices);
+	if (triangleCount == 0)
+		return MeshOptimizationStats{.acmr = 0, .atvr = 0, .overfetch = 0};
+
+	const size_t stride = sizeof(PackedVertex);
+	const size_t lineCount =
+		(stride * vertexCount + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE;
+	FifoCache vertexCache = FifoCache::create(vertexCount, VERTEX_CACHE_SIZE);
+	FifoCache lineCache = FifoCache::create(lineCount, FETCH_CACHE_LINES);
+	std::vector<bool> isUsed(vertexCount, false);
+	size_t usedCount = 0;
+	size_t invocations = 0;
+	size_t fetchedLines = 0;
+	for (const IndexType index : indices) {
+		if (!isUsed[index]) {
+			isUsed[index] = true;
+			usedCount++;
+		}
+		// Only vertices that miss the post-transform cache are fetched
+		if (!touch(vertexCache, index)) continue;
+		invocations++;
+		const size_t firstLine = stride * index / CACHE_LINE_SIZE;
+		const size_t lastLine = (stride * (index + 1) - 1) / CACHE_LINE_SIZE;
+		for (size_t line = firstLine; line <= lastLine; line++)
+			fetchedLines += touch(lineCache, static_cast<uint32_t>(line));
+	}
+
+	return MeshOptimizationStats{
+		.acmr = static_cast<float>(invocations) /
+				static_cast<float>(triangleCount),
+		.atvr = static_cast<float>(invocations) / static_cast<float>(usedCount),
+		.overfetch = static_cast<float>(CACHE_LINE_SIZE * fetchedLines) /
+					 static_cast<float>(stride * usedCount),
+	};
+}
+
+void optimizeVertexCache(std::span<IndexType> indices, size_t vertexCount) {
+	const size_t triangleCount = getTriangleCount(indices);
+	if (triangleCount == 0) return;
+
+	// Triangles not yet emitted around each vertex
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (const IndexType index : indices) liveTriangles[index]++;
+	// Triangles around each vertex, in compressed rows
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		adjacencyOffsets[vertex + 1] =
+			adjacencyOffsets[vertex] + liveTriangles[vertex];
+	std::vector<uint32_t> adjacency(adjacencyOffsets.back());
+	{
+		std::vector<uint32_t> filled(
+			adjacencyOffsets.begin(), adjacencyOffsets.end() - 1
+		);
+		for (size_t i = 0; i < indices.size(); i++)
+			adjacency[filled[indices[i]]++] =
+				static_cast<uint32_t>(i / NUM_OF_VERTS_PER_TRIANGLE);
+	}
+
+	FifoCache cache = FifoCache::create(vertexCount, VERTEX_CACHE_SIZE);
+	std::vector<bool> isEmitted(triangleCount, false);
+	// Vertices of emitted triangles, most recent last, to resume from once
+	// fanning runs out of neighbours
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<IndexType> ordered;
+	ordered.reserve(indices.size());
+	// Every vertex before it has no live triangles left
+	uint32_t cursor = 0;
+
+	const auto getNextVertex = [&]() -> std::optional<uint32_t> {
+		// The candidate that has been in the cache the longest, provided
+		// fanning around it would not push its own vertices out. Any other
+		// candidate with triangles left comes after those.
+		std::optional<uint32_t> best = std::nullopt;
+		int64_t bestPriority = -1;
+		for (const uint32_t candidate : candidates) {
+			if (liveTriangles[candidate] == 0) continue;
+			const uint32_t age = cache.time - cache.loadedAt[candidate];
+			const int64_t priority =
+				age + 2 * liveTriangles[candidate] <= VERTEX_CACHE_SIZE
+					? age
+					: 0;
+			if (priority > bestPriority) {
+				best = candidate;
+				bestPriority = priority;
+			}
+		}
+		if (best) return best;
+
+		while (!deadEnds.empty()) {
+			const uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveTriangles[vertex] > 0) return vertex;
+		}
+		for (; cursor < vertexCount; cursor++)
+			if (liveTriangles[cursor] > 0) return cursor;
+		return std::nullopt;
+	};
+
+	std::optional<uint32_t> fanning = getNextVertex();
+	while (fanning) {
+		candidates.clear();
+		for (uint32_t i = adjacencyOffsets[*fanning];
+			 i < adjacencyOffsets[*fanning + 1];
+			 i++) {
+			const uint32_t triangle = adjacency[i];
+			if (isEmitted[triangle]) continue;
+			isEmitted[triangle] = true;
+			for (size_t k = 0; k < NUM_OF_VERTS_PER_TRIANGLE; k++) {
+				const IndexType vertex =
+					indices[triangle * NUM_OF_VERTS_PER_TRIANGLE + k];
+				ordered.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				touch(cache, vertex);
+			}
+		}
+		fanning = getNextVertex();
+	}
+
+	ASSERT(
+		ordered.size() == indices.size(),
+		"Reordered " << ordered.size() << " of " << indices.size() << " indices"
+	);
+	std::copy(ordered.begin(), ordered.end(), indices.begin());
+}
+
+void optimizeOverdraw(
+	std::span<IndexType> indices,
+	std::span<const Vertex> vertices,
+	float threshold
+) {
+	const size_t triangleCount = getTriangleCount(indices);
+	if (triangleCount < 2) return;
+
+	FifoCache cache = FifoCache::create(vertices.size(), VERTEX_CACHE_SIZE);
+	// Tipsify starts a new patch of the mesh wherever all three vertices of
+	// a triangle miss, and reordering there costs nothing
+	std::vector<size_t> hardBoundaries;
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		if (touchTriangle(cache, indices, triangle) == 3 || triangle == 0)
+			hardBoundaries.push_back(triangle);
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	// Patches are split further wherever the ACMR so far is within the
+	// threshold of the patch's own, flushing the cache as a new cluster would
+	std::vector<size_t> clusterStarts;
+	for (size_t i = 0; i + 1 < hardBoundaries.size(); i++) {
+		const size_t start = hardBoundaries[i];
+		const size_t end = hardBoundaries[i + 1];
+		flush(cache);
+		uint32_t misses = 0;
+		for (size_t triangle = start; triangle < end; triangle++)
+			misses += touchTriangle(cache, indices, triangle);
+		const float targetAcmr = threshold * static_cast<float>(misses) /
+								 static_cast<float>(end - start);
+
+		clusterStarts.push_back(start);
+		flush(cache);
+		uint32_t runningMisses = 0;
+		uint32_t runningTriangles = 0;
+		for (size_t triangle = start; triangle + 1 < end; triangle++) {
+			runningMisses += touchTriangle(cache, indices, triangle);
+			runningTriangles++;
+			if (static_cast<float>(runningMisses) /
+					static_cast<float>(runningTriangles) <=
+				targetAcmr) {
+				clusterStarts.push_back(triangle + 1);
+				flush(cache);
+				runningMisses = 0;
+				runningTriangles = 0;
+			}
+		}
+	}
+	clusterStarts.push_back(triangleCount);
+
+	const auto getCorners = [&](size_t triangle) {
+		const size_t first = triangle * NUM_OF_VERTS_PER_TRIANGLE;
+		return std::array<glm::vec3, 3>{
+			vertices[indices[first]].position,
+			vertices[indices[first + 1]].position,
+			vertices[indices[first + 2]].position,
+		};
+	};
+	// Area weighted centroid and normal of a range of triangles. The normal's
+	// length is twice the area.
+	const auto getCentroidAndNormal = [&](size_t start, size_t end) {
+		glm::vec3 weightedCentroid(0.0f);
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+		for (size_t triangle = start; triangle < end; triangle++) {
+			const auto [a, b, c] = getCorners(triangle);
+			const glm::vec3 faceNormal = glm::cross(b - a, c - a);
+			const float faceArea = glm::length(faceNormal);
+			weightedCentroid += faceArea * (a + b + c) / 3.0f;
+			centroid += (a + b + c) / 3.0f;
+			normal += faceNormal;
+			area += faceArea;
+		}
+		// Degenerate clusters fall back to an unweighted centroid
+		if (area > 0.0f) return std::make_pair(weightedCentroid / area, normal);
+		return std::make_pair(
+			centroid / static_cast<float>(end - start), normal
+		);
+	};
+
+	struct Cluster {
+		size_t start;
+		size_t end;
+		// How far out of the mesh the cluster faces
+		float facing;
+	};
+	const glm::vec3 meshCentroid =
+		getCentroidAndNormal(0, triangleCount).first;
+	std::vector<Cluster> clusters;
+	clusters.reserve(clusterStarts.size() - 1);
+	for (size_t i = 0; i + 1 < clusterStarts.size(); i++) {
+		const size_t start = clusterStarts[i];
+		const size_t end = clusterStarts[i + 1];
+		const auto [centroid, normal] = getCentroidAndNormal(start, end);
+		const float normalLength = glm::length(normal);
+		const float facing =
+			normalLength > 0.0f
+				? glm::dot(centroid - meshCentroid, normal) / normalLength
+				: 0.0f;
+		clusters.push_back(Cluster{
+			.start = start,
+			.end = end,
+			.facing = std::isfinite(facing) ? facing : 0.0f,
+		});
+	}
+	std::stable_sort(
+		clusters.begin(),
+		clusters.end(),
+		[](const Cluster& left, const Cluster& right) {
+			return left.facing > right.facing;
+		}
+	);
+
+	std::vector<IndexType> ordered;
+	ordered.reserve(indices.size());
+	for (const Cluster& cluster : clusters)
+		ordered.insert(
+			ordered.end(),
+			indices.begin() + cluster.start * NUM_OF_VERTS_PER_TRIANGLE,
+			indices.begin() + cluster.end * NUM_OF_VERTS_PER_TRIANGLE
+		);
+	std::copy(ordered.begin(), ordered.end(), indices.begin());
+}
+
+void optimizeVertexFetch(
+	std::vector<Vertex>& vertices, std::span<IndexType> indices
+) {
+	constexpr IndexType UNUSED = std::numeric_limits<IndexType>::max();
+	std::vector<IndexType> remap(vertices.size(), UNUSED);
+	std::vector<Vertex> ordered;
+	ordered.reserve(vertices.size());
+	for (IndexType& index : indices) {
+		if (remap[index] == UNUSED) {
+			remap[index] = static_cast<IndexType>(ordered.size());
+			ordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices = std::move(ordered);
+}
+
+std::vector<Meshlet> buildMeshlets(
+	std::span<const Vertex> vertices, std::span<const IndexType> indices
+) {
+	const size_t triangleCount = getTriangleCount(indices);
+
+	// Meshlet each vertex was last counted in
+	constexpr uint32_t UNSEEN = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> seenIn(vertices.size(), UNSEEN);
+	std::vector<size_t> starts;
+	uint32_t meshletVertices = 0;
+	uint32_t meshletTriangles = 0;
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		const size_t first = triangle * NUM_OF_VERTS_PER_TRIANGLE;
+		const uint32_t current = static_cast<uint32_t>(starts.size()) - 1;
+		uint32_t newVertices = 0;
+		for (size_t k = 0; k < NUM_OF_VERTS_PER_TRIANGLE; k++)
+			newVertices += seenIn[indices[first + k]] != current;
+		const bool isFull =
+			starts.empty() || meshletTriangles == MESHLET_MAX_TRIANGLES ||
+			meshletVertices + newVertices > MESHLET_MAX_VERTICES;
+		if (isFull) {
+			starts.push_back(triangle);
+			meshletVertices = 0;
+			meshletTriangles = 0;
+		}
+		const uint32_t meshlet = static_cast<uint32_t>(starts.size()) - 1;
+		for (size_t k = 0; k < NUM_OF_VERTS_PER_TRIANGLE; k++) {
+			const IndexType index = indices[first + k];
+			if (seenIn[index] == meshlet) continue;
+			seenIn[index] = meshlet;
+			meshletVertices++;
+		}
+		meshletTriangles++;
+	}
+	starts.push_back(triangleCount);
+
+	std::vector<Meshlet> meshlets;
+	meshlets.reserve(starts.size() - 1);
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	for (size_t i = 0; i + 1 < starts.size(); i++) {
+		const size_t start = starts[i];
+		const size_t end = starts[i + 1];
+		positions.clear();
+		normals.clear();
+		for (size_t triangle = start; triangle < end; triangle++) {
+			const size_t first = triangle * NUM_OF_VERTS_PER_TRIANGLE;
+			const glm::vec3 a = vertices[indices[first]].position;
+			const glm::vec3 b = vertices[indices[first + 1]].position;
+			const glm::vec3 c = vertices[indices[first + 2]].position;
+			positions.insert(positions.end(), {a, b, c});
+			// Front faces wind counter-clockwise, and degenerate triangles
+			// are never drawn so they do not widen the cone
+			const glm::vec3 normal = glm::cross(b - a, c - a);
+			const float length = glm::length(normal);
+			if (length > 0.0f && std::isfinite(length))
+				normals.push_back(normal / length);
+		}
+		const math::Sphere sphere = math::computeBounds(positions).sphere;
+
+		glm::vec3 axis(0.0f);
+		for (const glm::vec3& normal : normals) axis += normal;
+		const float axisLength = glm::length(axis);
+		float minCosine = -1.0f;
+		if (axisLength > 0.0f) {
+			axis /= axisLength;
+			minCosine = 1.0f;
+			for (const glm::vec3& normal : normals)
+				minCosine = std::min(minCosine, glm::dot(axis, normal));
+		}
+		const float cutoff =
+			minCosine > MIN_CONE_COSINE
+				? std::sqrt(1.0f - minCosine * minCosine)
+				: 1.0f;
+
+		meshlets.push_back(Meshlet{
+			.boundingSphere = glm::vec4(sphere.center, sphere.radius),
+			.cone = glm::vec4(axis, cutoff),
+			.firstIndex =
+				static_cast<uint32_t>(start * NUM_OF_VERTS_PER_TRIANGLE),
+			.indexCount = static_cast<uint32_t>(
+				(end - start) * NUM_OF_VERTS_PER_TRIANGLE
+			),
+			.padding = {},
+		});
+	}
+	return meshlets;
+}
+
+void optimizeMesh(
+	std::vector<Vertex>& vertices,
+	std::vector<IndexType>& indices,
+	std::string_view name
+) {
+	const MeshOptimizationStats before = analyze(indices, vertices.size());
+	optimizeVertexCache(indices, vertices.size());
+	optimizeOverdraw(indices, vertices);
+	optimizeVertexFetch(vertices, indices);
+	const MeshOptimizationStats after = analyze(indices, vertices.size());
+
+	LLOG_INFO << "Optimized " << name << " (" << indices.size() / 3
+			  << " triangles): ACMR " << before.acmr << " -> " << after.acmr
+			  << ", ATVR " << before.atvr << " -> " << after.atvr
+			  << ", overfetch " << before.overfetch << " -> "
+			  << after.overfetch;
+}
+
+}  // namespace graphics
@@ -5,7 +5,9 @@ namespace graphics {
 MeshStorage MeshStorage::create() {
 	return {
 		.meshes = {},
-		.indices = algo::GenerationIndexArray<MAX_MESHES>::create()
+		.indices = algo::GenerationIndexArray::create(),
+		.geometry = GeometryBuffer::create(),
+		.layoutVersion = 0
 	};
 }
 
@@ -13,16 +15,20 @@ MeshID load(
 	MeshStorage &storage,
 	vk::Device device,
 	vk::PhysicalDevice physicalDevice,
-	vk::CommandPool commandPool,
-	vk::Queue graphicsQueue,
+	TransferManager &transfers,
     std::string_view meshFilePath
 ) {
-	const algo::GenerationIndexPair index = algo::reserveIndex(storage.indices);
-	const graphics::VertexBuffer vertexBuffer = graphics::VertexBuffer::create(
-		meshFilePath, device, physicalDevice, commandPool, graphicsQueue
+	std::vector<Vertex> vertices;
+	std::vector<IndexType> indices;
+	loadFromObj(meshFilePath, vertices, indices);
+	return load(
+		storage,
+		vertices,
+		indices,
+		device,
+		physicalDevice,
+		transfers
 	);
-	storage.meshes[index.index] = vertexBuffer;
-	return {index};
 }
 
 MeshID load(
@@ -31,81 +37,125 @@ MeshID load(
 	const std::vector<graphics::IndexType>& indices,
 	vk::Device device,
 	vk::PhysicalDevice physicalDevice,
-	vk::CommandPool commandPool,
-	vk::Queue graphicsQueue
+	TransferManager &transfers
 ) {
 	const algo::GenerationIndexPair index = algo::reserveIndex(storage.indices);
-	const graphics::VertexBuffer vertexBuffer = graphics::VertexBuffer::create(
-		vertices, indices, device, physicalDevice, commandPool, graphicsQueue
+	storage.meshes.ensureCapacity(algo::getCapacity(storage.indices));
+	storage.meshes[index.index] = upload(
+		storage.geometry,
+		vertices,
+		indices,
+		device,
+		physicalDevice,
+		transfers
 	);
-	storage.meshes[index.index] = vertexBuffer;
 	return {index};
 }
 
-void bind(
-	const MeshStorage &storage, vk::CommandBuffer commandBuffer, MeshID mesh
-) {
+const math::Bounds &getBounds(const MeshStorage &storage, MeshID mesh) {
 	ASSERT(
-		mesh.index < storage.meshes.size(),
-		"Mesh id is invalid: index (" << mesh.index << ") out of range [0, "
-									  << storage.meshes.size() << ")"
+		algo::isIndexValid(storage.indices, mesh),
+		"Getting the bounds of a mesh with invalid mesh ID. Either this mesh "
+		"has been deleted or the ID is ill-formed"
 	);
+	return storage.meshes[mesh.index].bounds;
+}
+
+const MeshRange &getRange(const MeshStorage &storage, MeshID mesh) {
 	ASSERT(
 		algo::isIndexValid(storage.indices, mesh),
-		"Binding a mesh with invalid mesh ID. Either this mesh has been "
+		"Getting the range of a mesh with invalid mesh ID. Either this mesh "
+		"has been deleted or the ID is ill-formed"
+	);
+	return storage.meshes[mesh.index];
+}
+
+void readBack(
+	const MeshStorage &storage,
+	MeshID mesh,
+	std::vector<Vertex> &vertices,
+	std::vector<IndexType> &indices,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	vk::CommandPool commandPool,
+	vk::Queue graphicsQueue
+) {
+	ASSERT(
+		algo::isIndexValid(storage.indices, mesh),
+		"Reading back a mesh with invalid mesh ID. Either this mesh has been "
 		"deleted or the ID is ill-formed"
 	);
-	graphics::bind(commandBuffer, storage.meshes[mesh.index]);
+	readBack(
+		storage.geometry,
+		storage.meshes[mesh.index],
+		vertices,
+		indices,
+		device,
+		physicalDevice,
+		commandPool,
+		graphicsQueue
+	);
 }
 
 void draw(
 	const MeshStorage &storage,
 	vk::CommandBuffer commandBuffer,
 	MeshID mesh,
-	uint16_t instanceCount
+	uint16_t instanceCount,
+	uint32_t firstInstance
 ) {
 	ASSERT(
-		mesh.index < storage.meshes.size(),
+		mesh.index < algo::getCapacity(storage.indices),
 		"Mesh id is invalid: index (" << mesh.index << ") out of range [0, "
-									  << storage.meshes.size() << ")"
+									  << algo::getCapacity(storage.indices)
+									  << ")"
 	);
 	ASSERT(
 		algo::isIndexValid(storage.indices, mesh),
-		"Binding a mesh with invalid mesh ID. Either this mesh has been "
+		"Drawing a mesh with invalid mesh ID. Either this mesh has been "
 		"deleted or the ID is ill-formed"
 	);
 	graphics::drawVertices(
-		commandBuffer, storage.meshes[mesh.index], instanceCount
+		commandBuffer,
+		storage.meshes[mesh.index],
+		instanceCount,
+		firstInstance
 	);
 }
 
 void unload(
-	MeshStorage &storage,
-	std::span<const algo::GenerationIndexPair> indices,
-	vk::Device device
+	MeshStorage &storage, std::span<const algo::GenerationIndexPair> indices
 ) {
 	for (const algo::GenerationIndexPair &index : indices) {
-		if (algo::isIndexValid(storage.indices, index)) {
-			destroy({std::addressof(storage.meshes[index.index]), 1}, device);
-		}
+		if (algo::isIndexValid(storage.indices, index))
+			release(storage.geometry, storage.meshes[index.index]);
 	}
 	destroy(storage.indices, indices);
 }
 
-void destroy(const MeshStorage &storage, vk::Device device) {
-	const std::vector<uint16_t> liveIndices =
-		algo::getLiveIndices(storage.indices);
-
-	const std::vector<VertexBuffer> liveVertices = [&]() {
-		std::vector<VertexBuffer> result;
-		result.reserve(liveIndices.size());
-		for (uint16_t liveIndex : liveIndices) {
-			result.push_back(storage.meshes[liveIndex]);
-		}
-		return result;
-	}();
+void defragment(
+	MeshStorage &storage,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	TransferManager &transfers
+) {
+	std::vector<MeshRange *> liveRanges;
+	liveRanges.reserve(algo::getLiveCount(storage.indices));
+	algo::forEachLiveIndex(storage.indices, [&](uint32_t liveIndex) {
+		liveRanges.push_back(&storage.meshes[liveIndex]);
+	});
+	defragment(
+		storage.geometry,
+		liveRanges,
+		device,
+		physicalDevice,
+		transfers
+	);
+	storage.layoutVersion++;
+}
 
-	destroy(liveVertices, device);
+void destroy(const MeshStorage &storage, vk::Device device) {
+	destroy(storage.geometry, device);
 }
 
 }  // namespace graphics
@@ -6,15 +6,17 @@
 namespace graphics {
 
 PipelineTemplate PipelineTemplate::createDefault(
-	const RenderPassData& renderPasses
+	const RenderPassData& renderPasses, RenderQueue queue
 ) {
+	const bool isTransparent = queue == RenderQueue::eTransparent;
+
 	const std::vector<vk::DynamicState> dynamicStates = {
 		vk::DynamicState::eViewport,
 		vk::DynamicState::eScissor,
 	};
 
-	const auto vertexInputBinding = Vertex::getBindingDescription();
-	const auto vertexInputAttributes = Vertex::getAttributeDescriptions();
+	const auto vertexInputBinding = getPackedVertexBindingDescription();
+	const auto vertexInputAttributes = getPackedVertexAttributeDescriptions();
 	const std::vector<vk::VertexInputAttributeDescription>
 		vertexInputAttributesVector = [&]() {
 			std::vector<vk::VertexInputAttributeDescription> result;
@@ -57,7 +59,7 @@ PipelineTemplate PipelineTemplate::createDefault(
 		vk::False
 	);
 	const vk::PipelineColorBlendAttachmentState colorBlendAttachment(
-		vk::True,  // enable blend
+		isTransparent ? vk::True : vk::False,  // enable blend
 		vk::BlendFactor::eSrcAlpha,
 		vk::BlendFactor::eOneMinusSrcAlpha,
 		vk::BlendOp::eAdd,
@@ -72,8 +74,8 @@ PipelineTemplate PipelineTemplate::createDefault(
 	};
 	const vk::PipelineDepthStencilStateCreateInfo depthStencilState(
 		{},
-		vk::True,	// enable depth test
-		vk::True,	// enable depth write
+		vk::True,							   // enable depth test
+		isTransparent ? vk::False : vk::True,  // enable depth write
 		vk::CompareOp::eLess,
 		vk::False,	// disable depth bounds test
 		vk::False,	// disable stencil test
@@ -201,6 +203,9 @@ std::vector<std::string> getGLSLDefinesFragment(
         if (variant.samplerInclusion & samplerInclusionBit[i])
             glslDefines.push_back(glslDefineForSampleInclusion[i]);
 
+    if (variant.queue == RenderQueue::eTransparent)
+        glslDefines.push_back("IS_TRANSPARENT");
+
     return glslDefines;
 }
 
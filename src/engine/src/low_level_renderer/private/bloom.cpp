@@ -545,7 +545,7 @@ BloomGraphicsObjects::SwapchainObject createBloomSwapchainObject(
     constexpr size_t NUM_BUFFERS = BloomGraphicsObjects::SwapchainObject::NUM_BUFFERS;
 
     std::array<vk::Image, NUM_BUFFERS> images;
-    std::array<vk::DeviceMemory, NUM_BUFFERS> memory;
+    std::array<DeviceAllocation, NUM_BUFFERS> memory;
     std::array<std::array<vk::ImageView, NUM_BLOOM_MIPS>, NUM_BUFFERS> colorViews;
     for (size_t image_index = 0; image_index < 2; image_index++) {
         std::tie(images[image_index], memory[image_index]) = Image::create(
@@ -720,8 +720,11 @@ void destroyBloomSwapchainObject(BloomGraphicsObjects& graphicsObjects, vk::Devi
     for (int image_index = 0; image_index < BloomGraphicsObjects::SwapchainObject::NUM_BUFFERS; image_index++) {
         for (const vk::ImageView& imageView : swapchainObject.colorViews[image_index])
             device.destroyImageView(imageView);
-        device.destroyImage(swapchainObject.colorBuffer[image_index]);
-        device.freeMemory(swapchainObject.colorMemory[image_index]);
+        Image::destroy(
+            device,
+            swapchainObject.colorBuffer[image_index],
+            swapchainObject.colorMemory[image_index]
+        );
     }
 
 	graphicsObjects.swapchainObject = {};
@@ -5,15 +5,23 @@
 
 namespace Buffer {
 
-std::tuple<vk::Buffer, vk::DeviceMemory> create(
+std::tuple<vk::Buffer, graphics::DeviceAllocation> create(
     const vk::Device& device,
     const vk::PhysicalDevice& physicalDevice,
     const vk::DeviceSize size,
     const vk::BufferUsageFlags usage,
-    const vk::MemoryPropertyFlags properties
+    const vk::MemoryPropertyFlags properties,
+    graphics::AllocationStrategy strategy,
+    std::span<const uint32_t> queueFamilies
 ) {
+    const bool isShared = queueFamilies.size() > 1;
     const vk::BufferCreateInfo bufferInfo(
-        {}, size, usage, vk::SharingMode::eExclusive
+        {},
+        size,
+        usage,
+        isShared ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+        isShared ? static_cast<uint32_t>(queueFamilies.size()) : 0,
+        isShared ? queueFamilies.data() : nullptr
     );
     const vk::ResultValue<vk::Buffer> bufferCreation =
         device.createBuffer(bufferInfo);
@@ -26,20 +34,27 @@ std::tuple<vk::Buffer, vk::DeviceMemory> create(
         memoryRequirements.memoryTypeBits,
         properties
     );
-    const vk::MemoryAllocateInfo allocateInfo(
-        memoryRequirements.size, memoryTypeIndex.value()
-    );
-    const vk::ResultValue<vk::DeviceMemory> deviceMemoryAllocation =
-        device.allocateMemory(allocateInfo);
-    VULKAN_ENSURE_SUCCESS(
-        deviceMemoryAllocation.result, "Failed to allocate vertex buffer memory"
+    const graphics::DeviceAllocation memory = graphics::allocate(
+        graphics::deviceMemory.value(),
+        memoryRequirements,
+        memoryTypeIndex.value(),
+        graphics::ResourceKind::eLinear,
+        strategy
     );
-    const vk::DeviceMemory deviceMemory = deviceMemoryAllocation.value;
     VULKAN_ENSURE_SUCCESS_EXPR(
-        device.bindBufferMemory(buffer, deviceMemory, 0),
+        device.bindBufferMemory(buffer, memory.memory, memory.offset),
         "Failed to bind buffer memory"
     );
-    return std::make_tuple(buffer, deviceMemory);
+    return std::make_tuple(buffer, memory);
+}
+
+void destroy(
+    const vk::Device& device,
+    vk::Buffer buffer,
+    const graphics::DeviceAllocation& memory
+) {
+    device.destroyBuffer(buffer);
+    graphics::release(graphics::deviceMemory.value(), memory);
 }
 
 std::optional<uint32_t> findSuitableMemoryType(
@@ -67,16 +82,33 @@ void copyBuffer(
     const vk::Buffer dstBuffer,
     const vk::DeviceSize size
 ) {
-    const vk::CommandBuffer commandBuffer =
-        Command::beginSingleCommand(device, commandPool);
-
-    vk::BufferCopy copyRegion(
+    const vk::BufferCopy copyRegion(
         0,    // srcOffset
         0,    // dstOffset
         size  // size
     );
+    copyBuffer(
+        device, commandPool, submitQueue, srcBuffer, dstBuffer, {&copyRegion, 1}
+    );
+}
 
-    commandBuffer.copyBuffer(srcBuffer, dstBuffer, 1, &copyRegion);
+void copyBuffer(
+    const vk::Device& device,
+    const vk::CommandPool& commandPool,
+    const vk::Queue& submitQueue,
+    const vk::Buffer srcBuffer,
+    const vk::Buffer dstBuffer,
+    std::span<const vk::BufferCopy> regions
+) {
+    const vk::CommandBuffer commandBuffer =
+        Command::beginSingleCommand(device, commandPool);
+
+    commandBuffer.copyBuffer(
+        srcBuffer,
+        dstBuffer,
+        static_cast<uint32_t>(regions.size()),
+        regions.data()
+    );
 
     Command::submitSingleCommand(
         device, submitQueue, commandPool, commandBuffer
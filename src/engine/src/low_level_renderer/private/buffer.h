@@ -1,16 +1,29 @@
 #pragma once
 
 #include <optional>
+#include <span>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 
+#include "low_level_renderer/device_memory.h"
+
 namespace Buffer {
-std::tuple<vk::Buffer, vk::DeviceMemory> create(
+// Memory comes from graphics::deviceMemory, mapped if it is host visible.
+// Shared concurrently by `queueFamilies` when there are several of them.
+std::tuple<vk::Buffer, graphics::DeviceAllocation> create(
     const vk::Device& device,
     const vk::PhysicalDevice& physicalDevice,
     const vk::DeviceSize size,
     const vk::BufferUsageFlags usage,
-    const vk::MemoryPropertyFlags properties
+    const vk::MemoryPropertyFlags properties,
+    graphics::AllocationStrategy strategy =
+        graphics::AllocationStrategy::eFreeList,
+    std::span<const uint32_t> queueFamilies = {}
+);
+void destroy(
+    const vk::Device& device,
+    vk::Buffer buffer,
+    const graphics::DeviceAllocation& memory
 );
 
 std::optional<uint32_t> findSuitableMemoryType(
@@ -27,14 +40,50 @@ void copyBuffer(
     const vk::Buffer dstBuffer,
     const vk::DeviceSize size
 );
+void copyBuffer(
+    const vk::Device& device,
+    const vk::CommandPool& commandPool,
+    const vk::Queue& submitQueue,
+    const vk::Buffer srcBuffer,
+    const vk::Buffer dstBuffer,
+    std::span<const vk::BufferCopy> regions
+);
+
+// Copies `data` into `buffer` from its element `first` on, through a staging
+// buffer, and waits for the copy. `buffer` needs to have been created with
+// eTransferDst.
+template <typename T>
+void uploadToBuffer(
+    const vk::Device& device,
+    const vk::PhysicalDevice& physicalDevice,
+    const vk::CommandPool& commandPool,
+    const vk::Queue& graphicsQueue,
+    const std::vector<T>& data,
+    vk::Buffer buffer,
+    size_t first
+);
+
+template <typename T>
+std::tuple<vk::Buffer, graphics::DeviceAllocation> loadToBuffer(
+    const vk::Device& device,
+    const vk::PhysicalDevice& physicalDevice,
+    const vk::CommandPool& commandPool,
+    const vk::Queue& graphicsQueue,
+    const std::vector<T>& data,
+    vk::BufferUsageFlags usage
+);
 
+// Waits for the copy, so only for data that is read rarely, like captures.
+// `buffer` needs to have been created with eTransferSrc.
 template <typename T>
-std::tuple<vk::Buffer, vk::DeviceMemory> loadToBuffer(
+std::vector<T> readFromBuffer(
     const vk::Device& device,
     const vk::PhysicalDevice& physicalDevice,
     const vk::CommandPool& commandPool,
     const vk::Queue& graphicsQueue,
-    const std::vector<T>& data
+    vk::Buffer buffer,
+    size_t first,
+    size_t count
 );
 }  // namespace Buffer
 
@@ -9,15 +9,17 @@
 
 namespace Buffer {
 template <typename T>
-std::tuple<vk::Buffer, vk::DeviceMemory> loadToBuffer(
+void uploadToBuffer(
     const vk::Device& device,
     const vk::PhysicalDevice& physicalDevice,
     const vk::CommandPool& commandPool,
     const vk::Queue& graphicsQueue,
     const std::vector<T>& data,
-    vk::BufferUsageFlagBits usage
+    vk::Buffer buffer,
+    size_t first
 ) {
-    const uint32_t bufferSize = sizeof(T) * data.size();
+    const vk::DeviceSize bufferSize = sizeof(T) * data.size();
+    if (data.empty()) return;
 
     const auto [stagingBuffer, stagingBufferMemory] = Buffer::create(
         device,
@@ -25,22 +27,44 @@ std::tuple<vk::Buffer, vk::DeviceMemory> loadToBuffer(
         bufferSize,
         vk::BufferUsageFlagBits::eTransferSrc,
         vk::MemoryPropertyFlagBits::eHostVisible |
-            vk::MemoryPropertyFlagBits::eHostCoherent
+            vk::MemoryPropertyFlagBits::eHostCoherent,
+        graphics::AllocationStrategy::eLinear
+    );
+    memcpy(
+        stagingBufferMemory.mapped,
+        data.data(),
+        static_cast<size_t>(bufferSize)
+    );
+
+    const vk::BufferCopy copyRegion(
+        0,                   // srcOffset
+        sizeof(T) * first,   // dstOffset
+        bufferSize           // size
     );
+    Buffer::copyBuffer(
+        device,
+        commandPool,
+        graphicsQueue,
+        stagingBuffer,
+        buffer,
+        {&copyRegion, 1}
+    );
+
+    Buffer::destroy(device, stagingBuffer, stagingBufferMemory);
+}
+
+template <typename T>
+std::tuple<vk::Buffer, graphics::DeviceAllocation> loadToBuffer(
+    const vk::Device& device,
+    const vk::PhysicalDevice& physicalDevice,
+    const vk::CommandPool& commandPool,
+    const vk::Queue& graphicsQueue,
+    const std::vector<T>& data,
+    vk::BufferUsageFlags usage
+) {
+    const uint32_t bufferSize = sizeof(T) * data.size();
 
-    {  // memcpy the data onto staging buffer
-        const vk::ResultValue<void*> mappedMemory =
-            device.mapMemory(stagingBufferMemory, 0, bufferSize, {});
-        VULKAN_ENSURE_SUCCESS(
-            mappedMemory.result, "Can't map staging buffer memory"
-        );
-        memcpy(
-            mappedMemory.value, data.data(), static_cast<size_t>(bufferSize)
-        );
-        device.unmapMemory(stagingBufferMemory);
-    }
-
-    const auto [resultBuffer, deviceMemory] = Buffer::create(
+    const auto [resultBuffer, memory] = Buffer::create(
         device,
         physicalDevice,
         bufferSize,
@@ -48,18 +72,59 @@ std::tuple<vk::Buffer, vk::DeviceMemory> loadToBuffer(
         vk::MemoryPropertyFlagBits::eDeviceLocal
     );
 
+    uploadToBuffer(
+        device, physicalDevice, commandPool, graphicsQueue, data, resultBuffer, 0
+    );
+
+    return std::make_tuple(resultBuffer, memory);
+}
+
+template <typename T>
+std::vector<T> readFromBuffer(
+    const vk::Device& device,
+    const vk::PhysicalDevice& physicalDevice,
+    const vk::CommandPool& commandPool,
+    const vk::Queue& graphicsQueue,
+    vk::Buffer buffer,
+    size_t first,
+    size_t count
+) {
+    const vk::DeviceSize bufferSize = sizeof(T) * count;
+    std::vector<T> data(count);
+    if (count == 0) return data;
+
+    const auto [stagingBuffer, stagingBufferMemory] = Buffer::create(
+        device,
+        physicalDevice,
+        bufferSize,
+        vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eHostVisible |
+            vk::MemoryPropertyFlagBits::eHostCoherent,
+        graphics::AllocationStrategy::eLinear
+    );
+
+    const vk::BufferCopy copyRegion(
+        sizeof(T) * first,  // srcOffset
+        0,                  // dstOffset
+        bufferSize          // size
+    );
     Buffer::copyBuffer(
         device,
         commandPool,
         graphicsQueue,
+        buffer,
         stagingBuffer,
-        resultBuffer,
-        bufferSize
+        {&copyRegion, 1}
+    );
+
+    memcpy(
+        data.data(),
+        stagingBufferMemory.mapped,
+        static_cast<size_t>(bufferSize)
     );
 
-    device.destroyBuffer(stagingBuffer);
-    device.freeMemory(stagingBufferMemory);
+    Buffer::destroy(device, stagingBuffer, stagingBufferMemory);
 
-    return std::make_tuple(resultBuffer, deviceMemory);
+    return data;
 }
 }  // namespace Buffer
@@ -26,6 +26,18 @@ bool isInstanceExtensionSupported(const char* extension) {
 			return true;
 	return false;
 }
+
+// Lower is preferred. Every type is accepted, so that the renderer also runs
+// on integrated GPUs and on software implementations.
+uint32_t getDeviceTypeRank(vk::PhysicalDeviceType type) {
+	switch (type) {
+		case vk::PhysicalDeviceType::eDiscreteGpu: return 0;
+		case vk::PhysicalDeviceType::eIntegratedGpu: return 1;
+		case vk::PhysicalDeviceType::eVirtualGpu: return 2;
+		case vk::PhysicalDeviceType::eCpu: return 3;
+		default: return 4;
+	}
+}
 }  // namespace
 
 namespace graphics {
@@ -96,9 +108,21 @@ std::optional<vk::PhysicalDevice> getBestPhysicalDevice(
 	VULKAN_ENSURE_SUCCESS(
 		allPhysicalDevices.result, "Can't enumerate all physical devices:"
 	);
-	for (const vk::PhysicalDevice& device : allPhysicalDevices.value)
-		if (isDeviceSuitable(device, surface)) return device;
-	return {};
+	std::optional<vk::PhysicalDevice> bestDevice;
+	uint32_t bestRank = 0;
+	for (const vk::PhysicalDevice& device : allPhysicalDevices.value) {
+		if (!isDeviceSuitable(device, surface)) continue;
+		const uint32_t rank =
+			getDeviceTypeRank(device.getProperties().deviceType);
+		if (!bestDevice || rank < bestRank) {
+			bestDevice = device;
+			bestRank = rank;
+		}
+	}
+	if (bestDevice)
+		LLOG_INFO << "Using device "
+				  << bestDevice->getProperties().deviceName.data();
+	return bestDevice;
 }
 
 vk::Format getBestFloatingPointColorAttachmentFormat(
@@ -159,13 +183,34 @@ bool isDeviceSuitable(
     const bool isGeometryShaderSupported =
         deviceFeatures.geometryShader == vk::True;
 
-	return deviceProperties.deviceType ==
-			   vk::PhysicalDeviceType::eDiscreteGpu &&
-		   deviceFeatures.geometryShader && isImageCountSupported &&
+	// Everything init_createLogicalDevice enables, as the device would fail
+	// to create without it
+	bool areVulkan12FeaturesSupported = false;
+	if (deviceProperties.apiVersion >= VK_API_VERSION_1_2) {
+		const auto features = physicalDevice.getFeatures2<
+			vk::PhysicalDeviceFeatures2,
+			vk::PhysicalDeviceVulkan12Features>();
+		const vk::PhysicalDeviceVulkan12Features& vulkan12Features =
+			features.get<vk::PhysicalDeviceVulkan12Features>();
+		areVulkan12FeaturesSupported =
+			vulkan12Features.drawIndirectCount == vk::True &&
+			vulkan12Features.bufferDeviceAddress == vk::True &&
+			vulkan12Features.storageBuffer8BitAccess == vk::True &&
+			vulkan12Features.timelineSemaphore == vk::True;
+	}
+	const bool areStorageFeaturesSupported =
+		deviceFeatures.fragmentStoresAndAtomics == vk::True &&
+		deviceFeatures.vertexPipelineStoresAndAtomics == vk::True &&
+		deviceFeatures.shaderInt64 == vk::True &&
+		deviceFeatures.sampleRateShading == vk::True &&
+		deviceFeatures.drawIndirectFirstInstance == vk::True;
+
+	return deviceFeatures.geometryShader && isImageCountSupported &&
 		   QueueFamilyIndices::findQueueFamilies(physicalDevice, surface)
 			   .isComplete() &&
 		   areRequiredExtensionsSupported && isSwapchainAdequate &&
-		   isAnisotropicFilteringSupported && isGeometryShaderSupported;
+		   isAnisotropicFilteringSupported && isGeometryShaderSupported &&
+		   areVulkan12FeaturesSupported && areStorageFeaturesSupported;
 }
 
 bool areRequiredDeviceExtensionsSupported(const vk::PhysicalDevice& device) {
@@ -4,9 +4,10 @@
 #include "command.h"
 #include "core/logger/vulkan_ensures.h"
 
-std::tuple<vk::Image, vk::DeviceMemory> Image::create(const Image::CreateInfo& info) {
+std::tuple<vk::Image, graphics::DeviceAllocation> Image::create(const Image::CreateInfo& info) {
     const bool isImage3D = info.size.depth > 1;
     const bool shouldGenerateMips = info.mipLevels > 1;
+    const bool isShared = info.queueFamilies.size() > 1;
     const vk::ImageUsageFlags usage = info.usage 
         | (shouldGenerateMips ? 
             vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc : vk::ImageUsageFlags());
@@ -20,9 +21,9 @@ std::tuple<vk::Image, vk::DeviceMemory> Image::create(const Image::CreateInfo& i
         info.sampleCount,
         info.tiling,
         usage,
-        vk::SharingMode::eExclusive,
-        0,
-        nullptr,
+        isShared ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+        isShared ? static_cast<uint32_t>(info.queueFamilies.size()) : 0,
+        isShared ? info.queueFamilies.data() : nullptr,
         vk::ImageLayout::eUndefined
     );
     const vk::ResultValue<vk::Image> imageCreation =
@@ -44,20 +45,30 @@ std::tuple<vk::Image, vk::DeviceMemory> Image::create(const Image::CreateInfo& i
             << memoryRequirements.memoryTypeBits << " with property: "
             << vk::to_string(info.properties)
     );
-    const vk::MemoryAllocateInfo memoryAllocateInfo(
-        memoryRequirements.size, suitableMemoryType.value()
-    );
-    const vk::ResultValue<vk::DeviceMemory> memoryAllocation =
-        info.device.allocateMemory(memoryAllocateInfo);
-    VULKAN_ENSURE_SUCCESS(
-        memoryAllocation.result, "Can't allocate memory for image"
+    // Linear tiling images are laid out like buffers, so they share blocks
+    const graphics::DeviceAllocation memory = graphics::allocate(
+        graphics::deviceMemory.value(),
+        memoryRequirements,
+        suitableMemoryType.value(),
+        info.tiling == vk::ImageTiling::eOptimal
+            ? graphics::ResourceKind::eOptimalImage
+            : graphics::ResourceKind::eLinear,
+        graphics::AllocationStrategy::eFreeList
     );
-    const vk::DeviceMemory deviceMemory = memoryAllocation.value;
     VULKAN_ENSURE_SUCCESS_EXPR(
-        info.device.bindImageMemory(image, deviceMemory, 0),
+        info.device.bindImageMemory(image, memory.memory, memory.offset),
         "Can't bind image and image memory"
     );
-    return std::make_tuple(image, deviceMemory);
+    return std::make_tuple(image, memory);
+}
+
+void Image::destroy(
+    const vk::Device& device,
+    vk::Image image,
+    const graphics::DeviceAllocation& memory
+) {
+    device.destroyImage(image);
+    graphics::release(graphics::deviceMemory.value(), memory);
 }
 
 void Image::transitionImageLayout(
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <optional>
+#include <span>
 #include <vulkan/vulkan.hpp>
 
+#include "low_level_renderer/device_memory.h"
+
 namespace Image {
 struct CreateInfo {
     const vk::Device& device;
@@ -14,8 +17,16 @@ struct CreateInfo {
     vk::MemoryPropertyFlags properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
     vk::SampleCountFlagBits sampleCount = vk::SampleCountFlagBits::e1;
     uint32_t mipLevels = 1;
+    // Shared concurrently by these when there are several of them
+    std::span<const uint32_t> queueFamilies = {};
 };
-std::tuple<vk::Image, vk::DeviceMemory> create(const CreateInfo& info);
+// Memory comes from graphics::deviceMemory
+std::tuple<vk::Image, graphics::DeviceAllocation> create(const CreateInfo& info);
+void destroy(
+    const vk::Device& device,
+    vk::Image image,
+    const graphics::DeviceAllocation& memory
+);
 
 void generateMipMaps(
     vk::Device device,
@@ -231,8 +231,8 @@ graphics::RadianceCascadeData graphics::create(const RadianceCascadeCreateInfo&
                 vk::False  // primitive restart
             );
 
-            const auto vertexInputBinding = Vertex::getBindingDescription();
-            const auto vertexInputAttributes = Vertex::getAttributeDescriptions();
+            const auto vertexInputBinding = getPackedVertexBindingDescription();
+            const auto vertexInputAttributes = getPackedVertexAttributeDescriptions();
             const std::vector<vk::VertexInputAttributeDescription>
                 vertexInputAttributesVector = [&]() {
                     std::vector<vk::VertexInputAttributeDescription> result;
@@ -512,10 +512,10 @@ void graphics::recordDraw(
     RadianceCascadeData& cascadeData,
     const RenderSubmission& renderSubmission,
     vk::CommandBuffer buffer,
-	const RenderInstanceManager& instanceManager,
 	const MaterialPipeline& pipelines,
 	const MaterialStorage& materials,
 	const MeshStorage& meshes,
+	const GeometryHandles& geometry,
 	uint32_t currentFrame
 ) {
     const vk::ImageSubresourceRange sdfTextureSubresourceRange = 
@@ -570,8 +570,10 @@ void graphics::recordDraw(
         nullptr
     );
 
+    bind(buffer, geometry);
     std::optional<MaterialInstanceID> boundMaterial = std::nullopt;
-    for (const auto& [variant, transform, materialID, mesh] : renderSubmission.renderObjects) {
+    std::optional<vk::IndexType> boundIndexType = std::nullopt;
+    for (const auto& [variant, transform, materialID, mesh] : renderSubmission.sceneObjects) {
         const bool shouldBindMaterial =
             !boundMaterial.has_value() || boundMaterial.value() != materialID;
         if (shouldBindMaterial) {
@@ -586,7 +588,11 @@ void graphics::recordDraw(
             sizeof(GPUPushConstants),
             &pushConstants
         );
-        bind(meshes, buffer, mesh);
+        const vk::IndexType indexType = getRange(meshes, mesh).indexType;
+        if (boundIndexType != indexType) {
+            bindIndices(buffer, geometry, indexType);
+            boundIndexType = indexType;
+        }
         draw(meshes, buffer, mesh);
     }
 
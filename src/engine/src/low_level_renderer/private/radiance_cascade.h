@@ -21,10 +21,10 @@ void recordDraw(
     RadianceCascadeData& cascadeData,
     const RenderSubmission& renderSubmission,
     vk::CommandBuffer buffer,
-	const RenderInstanceManager& instanceManager,
 	const MaterialPipeline& pipelines,
 	const MaterialStorage& materials,
 	const MeshStorage& meshes,
+	const GeometryHandles& geometry,
 	uint32_t currentFrame
 );
 
@@ -24,6 +24,13 @@ QueueFamilyIndices QueueFamilyIndices::findQueueFamilies(
         if (isGraphicsAndComputeFamily)
             indices.graphicsAndComputeFamily = i;
 
+        const bool isTransferOnlyFamily = queueFamily.queueCount > 0 &&
+            (queueFamily.queueFlags & vk::QueueFlagBits::eTransfer) &&
+            !(queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) &&
+            !(queueFamily.queueFlags & vk::QueueFlagBits::eCompute);
+        if (isTransferOnlyFamily && !indices.transferFamily)
+            indices.transferFamily = i;
+
         const vk::ResultValue<vk::Bool32> doesSurfaceSupportDevice =
             device.getSurfaceSupportKHR(i, surface);
         VULKAN_ENSURE_SUCCESS(
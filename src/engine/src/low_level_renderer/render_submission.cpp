@@ -5,92 +5,252 @@
 #include <optional>
 
 #include "core/logger/assert.h"
-#include "low_level_renderer/shader_data.h"
 
 namespace graphics {
-RenderSubmission RenderSubmission::create() { return RenderSubmission(); }
 
-void submit(
-	RenderSubmission& renderSubmission,
+namespace {
+
+InstanceData* writeInstances(
+	std::span<const std::vector<InstanceData>> instanceData,
+	InstanceData* entries,
+	InstanceData* firstEntry,
+	std::vector<uint32_t>& firstInstances
+) {
+	for (const std::vector<InstanceData>& data : instanceData) {
+		firstInstances.push_back(static_cast<uint32_t>(entries - firstEntry));
+		entries = std::copy(data.begin(), data.end(), entries);
+	}
+	return entries;
+}
+
+void recordInstances(
 	std::span<const InstancedRenderObject> instances,
-	std::span<const std::vector<InstanceData>> data
+	std::span<const uint32_t> firstInstances,
+	vk::CommandBuffer buffer,
+	vk::PipelineLayout pipelineLayout,
+	const MaterialPipeline& pipelines,
+	const MaterialStorage& materials,
+	const MeshStorage& meshes,
+	const GeometryHandles& geometry
 ) {
-	ASSERT(
-		instances.size() == data.size(),
-		"Input number of instances "
-			<< instances.size() << " is not the number of data" << data.size()
-	);
-	renderSubmission.instances.insert(
-		renderSubmission.instances.end(), instances.begin(), instances.end()
-	);
-	renderSubmission.instanceData.insert(
-		renderSubmission.instanceData.end(), data.begin(), data.end()
+	std::optional<PipelineSpecializationConstants> boundVariant = std::nullopt;
+	std::optional<MaterialInstanceID> boundMaterial = std::nullopt;
+	std::optional<vk::IndexType> boundIndexType = std::nullopt;
+	for (size_t i = 0; i < instances.size(); i++) {
+		const InstancedRenderObject& instance = instances[i];
+		const bool shouldBindPipeline =
+			!boundVariant.has_value() ||
+			boundVariant.value() != instance.variant;
+		if (shouldBindPipeline) {
+			const vk::Pipeline pipeline =
+				getPipeline(pipelines, instance.variant);
+			buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+			boundVariant = instance.variant;
+		}
+
+		const bool shouldBindMaterial =
+			!boundMaterial.has_value() ||
+			boundMaterial.value() != instance.material;
+		if (shouldBindMaterial) {
+			bind(materials, instance.material, buffer, pipelineLayout);
+			boundMaterial = instance.material;
+		}
+
+		const vk::IndexType indexType =
+			getRange(meshes, instance.mesh).indexType;
+		if (boundIndexType != indexType) {
+			bindIndices(buffer, geometry, indexType);
+			boundIndexType = indexType;
+		}
+
+		draw(
+			meshes,
+			buffer,
+			instance.mesh,
+			instance.count,
+			firstInstances[i]
+		);
+	}
+}
+
+}  // namespace
+
+SortKey getSortKey(const RenderObject& object, uint16_t depth) {
+	return getSortKey(
+		object.variant, object.material.index, object.mesh.index, depth
 	);
 }
 
-void submit(
-	RenderSubmission& renderSubmission,
-	std::span<const RenderObject> renderObjects
+IndirectObject IndirectObject::create(
+	const MeshStorage& meshes,
+	MeshID mesh,
+	uint32_t firstCommand,
+	uint32_t bucket
 ) {
-	renderSubmission.renderObjects.insert(
-		end(renderSubmission.renderObjects),
-		begin(renderObjects),
-		end(renderObjects)
+	const MeshRange& range = getRange(meshes, mesh);
+	const math::Sphere& bounds = range.bounds.sphere;
+	return IndirectObject{
+		.boundingSphere = glm::vec4(bounds.center, bounds.radius),
+		.firstMeshlet = range.firstMeshlet,
+		.meshletCount = range.meshletCount,
+		.firstIndex = range.firstIndex,
+		.vertexOffset = static_cast<int32_t>(range.firstVertex),
+		.firstCommand = firstCommand,
+		.bucket = bucket,
+		.mesh = mesh,
+	};
+}
+
+RenderSubmission RenderSubmission::create() {
+	return RenderSubmission{
+		.renderObjects = {},
+		.transparentObjects = {},
+		.sceneObjects = {},
+		.instances = {},
+		.instanceData = {},
+		.batches = {},
+		.batchData = {},
+		.indirectObjects = {},
+		.indirectTransforms = {},
+		.indirectBuckets = {},
+		.isIndirectLayoutChanged = true,
+		.changedIndirectTransforms = {},
+		.frustum = {},
+	};
+}
+
+void copy(RenderSubmissionCopy& copy, const RenderSubmission& submission) {
+	copy.renderObjects.assign(
+		submission.renderObjects.begin(), submission.renderObjects.end()
+	);
+	copy.transparentObjects.assign(
+		submission.transparentObjects.begin(),
+		submission.transparentObjects.end()
+	);
+	copy.sceneObjects.assign(
+		submission.sceneObjects.begin(), submission.sceneObjects.end()
+	);
+	copy.instances.assign(
+		submission.instances.begin(), submission.instances.end()
+	);
+	// Assigning over the previous lists reuses their storage
+	copy.instanceData.assign(
+		submission.instanceData.begin(), submission.instanceData.end()
 	);
+	copy.batches.assign(
+		submission.batches.begin(), submission.batches.end()
+	);
+	copy.batchData.assign(
+		submission.batchData.begin(), submission.batchData.end()
+	);
+	copy.indirectObjects.assign(
+		submission.indirectObjects.begin(), submission.indirectObjects.end()
+	);
+	copy.indirectTransforms.assign(
+		submission.indirectTransforms.begin(),
+		submission.indirectTransforms.end()
+	);
+	copy.indirectBuckets.assign(
+		submission.indirectBuckets.begin(), submission.indirectBuckets.end()
+	);
+	copy.isIndirectLayoutChanged = submission.isIndirectLayoutChanged;
+	copy.changedIndirectTransforms.assign(
+		submission.changedIndirectTransforms.begin(),
+		submission.changedIndirectTransforms.end()
+	);
+	copy.frustum = submission.frustum;
+}
+
+RenderSubmission getSubmission(const RenderSubmissionCopy& copy) {
+	return RenderSubmission{
+		.renderObjects = copy.renderObjects,
+		.transparentObjects = copy.transparentObjects,
+		.sceneObjects = copy.sceneObjects,
+		.instances = copy.instances,
+		.instanceData = copy.instanceData,
+		.batches = copy.batches,
+		.batchData = copy.batchData,
+		.indirectObjects = copy.indirectObjects,
+		.indirectTransforms = copy.indirectTransforms,
+		.indirectBuckets = copy.indirectBuckets,
+		.isIndirectLayoutChanged = copy.isIndirectLayoutChanged,
+		.changedIndirectTransforms = copy.changedIndirectTransforms,
+		.frustum = copy.frustum,
+	};
 }
 
 void prepForRecording(
-	RenderSubmission& renderSubmission,
-	const RenderInstanceManager& instanceManager,
+	const RenderSubmission& renderSubmission,
+	ObjectDataBuffer& objectData,
+	ObjectDataLayout& layout,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	DescriptorWriteBuffer& writeBuffer,
 	uint32_t currentFrame
 ) {
-	// update instance data
-	for (size_t i = 0; i < renderSubmission.instances.size(); i++) {
-		instanceManager.update(
-			renderSubmission.instances[i].instance,
-			currentFrame,
-			renderSubmission.instanceData[i]
-		);
-	}
+	ASSERT(
+		renderSubmission.instances.size() ==
+				renderSubmission.instanceData.size() &&
+			renderSubmission.batches.size() ==
+				renderSubmission.batchData.size(),
+		"Number of instances " << renderSubmission.instances.size()
+							   << " or batches "
+							   << renderSubmission.batches.size()
+							   << " is not the number of their data"
+	);
+	size_t count = renderSubmission.renderObjects.size() +
+				   renderSubmission.transparentObjects.size();
+	for (const std::span<const std::vector<InstanceData>> instanceData :
+		 {renderSubmission.instanceData, renderSubmission.batchData})
+		for (const std::vector<InstanceData>& data : instanceData)
+			count += data.size();
 
-	std::sort(
-		begin(renderSubmission.renderObjects),
-		end(renderSubmission.renderObjects),
-		[](const RenderObject& r0, const RenderObject& r1) -> bool {
-			if (r0.variant == r1.variant) return r0.material < r1.material;
-			return r0.variant < r1.variant;
-		}
+	InstanceData* const firstEntry = reserve(
+		objectData,
+		device,
+		physicalDevice,
+		writeBuffer,
+		currentFrame,
+		static_cast<uint32_t>(count)
 	);
+	InstanceData* entries = firstEntry;
+	for (const RenderObject& object : renderSubmission.renderObjects)
+		*entries++ = {.transform = object.transform};
+	layout.firstTransparent = static_cast<uint32_t>(entries - firstEntry);
+	for (const RenderObject& object : renderSubmission.transparentObjects)
+		*entries++ = {.transform = object.transform};
 
-	std::sort(
-		renderSubmission.instances.begin(),
-		renderSubmission.instances.end(),
-		[](const InstancedRenderObject& r0,
-		   const InstancedRenderObject& r1) -> bool {
-			if (r0.variant == r1.variant) return r0.material < r1.material;
-			return r0.variant < r1.variant;
-		}
+	layout.firstInstances.clear();
+	entries = writeInstances(
+		renderSubmission.instanceData,
+		entries,
+		firstEntry,
+		layout.firstInstances
+	);
+	writeInstances(
+		renderSubmission.batchData, entries, firstEntry, layout.firstInstances
 	);
 }
 
 void recordRegularDrawCalls(
-	const RenderSubmission& renderSubmission,
+	std::span<const RenderObject> objects,
+	uint32_t firstInstance,
 	vk::CommandBuffer buffer,
 	vk::PipelineLayout pipelineLayout,
 	const MaterialPipeline& pipelines,
 	const MaterialStorage& materials,
-	const MeshStorage& meshes
+	const MeshStorage& meshes,
+	const GeometryHandles& geometry
 ) {
 	std::optional<PipelineSpecializationConstants> boundVariant = std::nullopt;
 	std::optional<MaterialInstanceID> boundMaterial = std::nullopt;
+	std::optional<vk::IndexType> boundIndexType = std::nullopt;
 
-	for (const auto& [variant, transform, materialID, mesh] :
-		 renderSubmission.renderObjects) {
+	for (const auto& [variant, transform, materialID, mesh] : objects) {
 		const bool shouldBindPipeline =
 			!boundVariant.has_value() || boundVariant.value() != variant;
 		if (shouldBindPipeline) {
-			const vk::Pipeline pipeline =
-				getRegularPipeline(pipelines, variant);
+			const vk::Pipeline pipeline = getPipeline(pipelines, variant);
 			buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
 			boundVariant = variant;
 		}
@@ -102,61 +262,47 @@ void recordRegularDrawCalls(
 			boundMaterial = materialID;
 		}
 
-		GPUPushConstants pushConstants = {.model = transform};
-		buffer.pushConstants(
-			pipelineLayout,
-			vk::ShaderStageFlagBits::eVertex,
-			0,
-			sizeof(GPUPushConstants),
-			&pushConstants
-		);
-		bind(meshes, buffer, mesh);
-		draw(meshes, buffer, mesh);
+		const vk::IndexType indexType = getRange(meshes, mesh).indexType;
+		if (boundIndexType != indexType) {
+			bindIndices(buffer, geometry, indexType);
+			boundIndexType = indexType;
+		}
+
+		draw(meshes, buffer, mesh, 1, firstInstance++);
 	}
 }
 
 void recordInstancedDrawCalls(
 	const RenderSubmission& renderSubmission,
+	const ObjectDataLayout& layout,
 	vk::CommandBuffer buffer,
 	vk::PipelineLayout pipelineLayout,
-	const RenderInstanceManager& instanceManager,
 	const MaterialPipeline& pipelines,
 	const MaterialStorage& materials,
 	const MeshStorage& meshes,
-	uint32_t currentFrame
+	const GeometryHandles& geometry
 ) {
-	std::optional<PipelineSpecializationConstants> boundVariant = std::nullopt;
-	std::optional<MaterialInstanceID> boundMaterial = std::nullopt;
-	for (const InstancedRenderObject& instance : renderSubmission.instances) {
-		const bool shouldBindPipeline =
-			!boundVariant.has_value() ||
-			boundVariant.value() != instance.variant;
-		if (shouldBindPipeline) {
-			const vk::Pipeline pipeline =
-				getInstanceRenderingPipeline(pipelines, instance.variant);
-			buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
-			boundVariant = instance.variant;
-		}
-
-		const bool shouldBindMaterial =
-			!boundMaterial.has_value() ||
-			boundMaterial.value() != instance.material;
-		if (shouldBindMaterial) {
-			bind(materials, instance.material, buffer, pipelineLayout);
-			boundMaterial = instance.material;
-		}
-
-		instanceManager.bind(
-			buffer, pipelineLayout, instance.instance, currentFrame
-		);
-		bind(meshes, buffer, instance.mesh);
-		draw(meshes, buffer, instance.mesh, instance.count);
-	}
+	const std::span<const uint32_t> firstInstances = layout.firstInstances;
+	recordInstances(
+		renderSubmission.instances,
+		firstInstances.first(renderSubmission.instances.size()),
+		buffer,
+		pipelineLayout,
+		pipelines,
+		materials,
+		meshes,
+		geometry
+	);
+	recordInstances(
+		renderSubmission.batches,
+		firstInstances.subspan(renderSubmission.instances.size()),
+		buffer,
+		pipelineLayout,
+		pipelines,
+		materials,
+		meshes,
+		geometry
+	);
 }
 
-void clear(RenderSubmission& renderSubmission) {
-	renderSubmission.instances.clear();
-	renderSubmission.instanceData.clear();
-	renderSubmission.renderObjects.clear();
-}
 }  // namespace graphics
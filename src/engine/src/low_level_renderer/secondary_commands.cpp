@@ -0,0 +1,75 @@
+#include "low_level_renderer/secondary_commands.h"
+
+#include "core/logger/vulkan_ensures.h"
+
+namespace graphics {
+
+SecondaryCommands SecondaryCommands::create(
+	vk::Device device, uint32_t queueFamily
+) {
+	// Pools are reset as a whole each frame, so the buffer needs no
+	// individual reset flag
+	const vk::CommandPoolCreateInfo poolInfo(
+		vk::CommandPoolCreateFlagBits::eTransient, queueFamily
+	);
+	const vk::ResultValue<vk::CommandPool> commandPoolCreation =
+		device.createCommandPool(poolInfo);
+	VULKAN_ENSURE_SUCCESS(
+		commandPoolCreation.result, "Can't create secondary command pool:"
+	);
+
+	const vk::CommandBufferAllocateInfo allocateInfo(
+		commandPoolCreation.value, vk::CommandBufferLevel::eSecondary, 1
+	);
+	const vk::ResultValue<std::vector<vk::CommandBuffer>>
+		commandBuffersAllocation = device.allocateCommandBuffers(allocateInfo);
+	VULKAN_ENSURE_SUCCESS(
+		commandBuffersAllocation.result,
+		"Can't allocate secondary command buffer:"
+	);
+
+	return SecondaryCommands{
+		.pool = commandPoolCreation.value,
+		.buffer = commandBuffersAllocation.value.at(0),
+	};
+}
+
+vk::CommandBuffer begin(
+	const SecondaryCommands& commands,
+	vk::Device device,
+	vk::RenderPass renderPass,
+	vk::Framebuffer framebuffer
+) {
+	VULKAN_ENSURE_SUCCESS_EXPR(
+		device.resetCommandPool(commands.pool),
+		"Can't reset secondary command pool:"
+	);
+
+	const vk::CommandBufferInheritanceInfo inheritanceInfo(
+		renderPass,
+		0,	// subpass
+		framebuffer
+	);
+	const vk::CommandBufferBeginInfo beginInfo(
+		vk::CommandBufferUsageFlagBits::eOneTimeSubmit |
+			vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+		&inheritanceInfo
+	);
+	VULKAN_ENSURE_SUCCESS_EXPR(
+		commands.buffer.begin(beginInfo),
+		"Can't begin recording secondary command buffer:"
+	);
+	return commands.buffer;
+}
+
+void end(const SecondaryCommands& commands) {
+	VULKAN_ENSURE_SUCCESS_EXPR(
+		commands.buffer.end(), "Can't end secondary command buffer:"
+	);
+}
+
+void destroy(const SecondaryCommands& commands, vk::Device device) {
+	device.destroyCommandPool(commands.pool);
+}
+
+}  // namespace graphics
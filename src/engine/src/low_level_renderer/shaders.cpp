@@ -7,7 +7,7 @@ namespace graphics {
 ShaderStorage ShaderStorage::create() {
 	return {
 		.shaders = {},
-		.indices = algo::GenerationIndexArray<MAX_SHADERS>::create()
+		.indices = algo::GenerationIndexArray::create()
 	};
 }
 
@@ -18,6 +18,7 @@ ShaderID loadFromBytecode(
 	size_t sizeInBytes
 ) {
 	const algo::GenerationIndexPair index = algo::reserveIndex(shaders.indices);
+	shaders.shaders.ensureCapacity(algo::getCapacity(shaders.indices));
 	const vk::ResultValue<vk::ShaderModule> shaderModuleCreation =
 		device.createShaderModule({{}, sizeInBytes, code});
 	VULKAN_ENSURE_SUCCESS(
@@ -53,9 +54,10 @@ ShaderID loadShaderFromFile(
 
 vk::ShaderModule getModule(const ShaderStorage& shaders, ShaderID id) {
 	ASSERT(
-		id.index < shaders.shaders.size(),
+		id.index < algo::getCapacity(shaders.indices),
 		"Mesh id is invalid: index (" << id.index << ") out of range [0, "
-									  << shaders.shaders.size() << ")"
+									  << algo::getCapacity(shaders.indices)
+									  << ")"
 	);
 	ASSERT(
 		algo::isIndexValid(shaders.indices, id),
@@ -66,7 +68,8 @@ vk::ShaderModule getModule(const ShaderStorage& shaders, ShaderID id) {
 }
 
 void destroy(const ShaderStorage& shaders, vk::Device device) {
-	for (auto index : algo::getLiveIndices(shaders.indices))
+	algo::forEachLiveIndex(shaders.indices, [&](uint32_t index) {
 		device.destroyShaderModule(shaders.shaders[index]);
+	});
 }
 }  // namespace graphics
@@ -0,0 +1,47 @@
+#include "low_level_renderer/sort_key.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "core/logger/assert.h"
+
+namespace graphics {
+
+uint16_t quantizeDepth(float viewDepth, float nearPlane, float farPlane) {
+	const float normalized = std::clamp(
+		(viewDepth - nearPlane) / (farPlane - nearPlane), 0.0f, 1.0f
+	);
+	return static_cast<uint16_t>(
+		normalized * std::numeric_limits<uint16_t>::max()
+	);
+}
+
+SortKey getSortKey(
+	const PipelineSpecializationConstants& variant,
+	uint32_t materialIndex,
+	uint32_t meshIndex,
+	uint16_t depth
+) {
+	constexpr uint32_t INDEX_BITS = 20;
+	constexpr uint32_t DEPTH_BITS = 16;
+	ASSERT(
+		materialIndex < (1u << INDEX_BITS) && meshIndex < (1u << INDEX_BITS),
+		"Material " << materialIndex << " or mesh " << meshIndex
+					<< " does not fit in a sort key"
+	);
+	const uint64_t variantBits =
+		(static_cast<uint64_t>(variant.samplerInclusion) << 2) |
+		static_cast<uint64_t>(variant.parallaxMappingMode);
+	const uint64_t state = (variantBits << (2 * INDEX_BITS)) |
+						   (static_cast<uint64_t>(materialIndex) << INDEX_BITS) |
+						   meshIndex;
+
+	if (variant.queue == RenderQueue::eOpaque)
+		return (state << DEPTH_BITS) | depth;
+	const uint64_t inverseDepth = std::numeric_limits<uint16_t>::max() - depth;
+	return (uint64_t{1} << 63) | (inverseDepth << (63 - DEPTH_BITS)) | state;
+}
+
+bool isTransparent(SortKey key) { return key >> 63; }
+
+}  // namespace graphics
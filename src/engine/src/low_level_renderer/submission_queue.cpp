@@ -0,0 +1,197 @@
+#include "low_level_renderer/submission_queue.h"
+
+#include <algorithm>
+
+#include "core/logger/assert.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#include "imgui.h"
+#pragma GCC diagnostic pop
+
+namespace graphics {
+
+namespace {
+uint32_t countTaken(const SubmissionQueue& queue) {
+	return static_cast<uint32_t>(std::count_if(
+		queue.states.begin(),
+		queue.states.end(),
+		[](SubmissionQueue::SlotState state) {
+			return state != SubmissionQueue::SlotState::eFree;
+		}
+	));
+}
+
+void freeClones(ImDrawData& drawData) {
+	for (ImDrawList* list : drawData.CmdLists) IM_DELETE(list);
+	drawData.CmdLists.clear();
+}
+}  // namespace
+
+SubmissionSnapshot SubmissionSnapshot::create() {
+	return SubmissionSnapshot{
+		.submission = {},
+		.sceneData = {},
+		.mainWindowExtent = {},
+		.maxRecordingThreads = 1,
+		.bloomConfig = std::nullopt,
+		.newVariants = {},
+		.resize = std::nullopt,
+		.capturedFramesLeft = 0,
+		.transfers = {},
+		.geometry = {},
+		.retiredGeometry = {},
+		.uiDrawData = IM_NEW(ImDrawData)(),
+	};
+}
+
+void captureUI(SubmissionSnapshot& snapshot, const ImDrawData& drawData) {
+	ImDrawData& uiDrawData = *snapshot.uiDrawData;
+	freeClones(uiDrawData);
+	uiDrawData = drawData;
+	// ImGui reuses its draw lists in the next frame, so the render thread
+	// draws from copies of them
+	for (ImDrawList*& list : uiDrawData.CmdLists) list = list->CloneOutput();
+	// Textures are brought up to date on the game thread before the snapshot
+	// is taken, so drawing it only reads them
+	uiDrawData.Textures = nullptr;
+}
+
+void destroy(SubmissionSnapshot& snapshot) {
+	freeClones(*snapshot.uiDrawData);
+	IM_DELETE(snapshot.uiDrawData);
+	snapshot.uiDrawData = nullptr;
+}
+
+std::unique_ptr<SubmissionQueue> SubmissionQueue::create(uint32_t depth) {
+	ASSERT(
+		depth >= MIN_SUBMISSION_QUEUE_DEPTH &&
+			depth <= MAX_SUBMISSION_QUEUE_DEPTH,
+		"Submission queue depth " << depth << " is out of the range ["
+								  << MIN_SUBMISSION_QUEUE_DEPTH << ", "
+								  << MAX_SUBMISSION_QUEUE_DEPTH << "]"
+	);
+	std::unique_ptr<SubmissionQueue> queue =
+		std::make_unique<SubmissionQueue>();
+	for (SubmissionSnapshot& slot : queue->slots)
+		slot = SubmissionSnapshot::create();
+	queue->states.fill(SlotState::eFree);
+	queue->sequence.fill(0);
+	queue->nextSequence = 0;
+	queue->depth = depth;
+	queue->isClosed = false;
+	queue->stats = {};
+	return queue;
+}
+
+std::optional<uint32_t> acquireForWriting(SubmissionQueue& queue) {
+	std::unique_lock lock(queue.mutex);
+	queue.changed.wait(lock, [&]() {
+		return queue.isClosed || countTaken(queue) < queue.depth;
+	});
+	if (queue.isClosed) return std::nullopt;
+
+	const auto slot = std::find(
+		queue.states.begin(),
+		queue.states.end(),
+		SubmissionQueue::SlotState::eFree
+	);
+	*slot = SubmissionQueue::SlotState::eWriting;
+	return static_cast<uint32_t>(std::distance(queue.states.begin(), slot));
+}
+
+void publish(SubmissionQueue& queue, uint32_t slot) {
+	{
+		std::lock_guard lock(queue.mutex);
+		ASSERT(
+			queue.states[slot] == SubmissionQueue::SlotState::eWriting,
+			"Publishing slot " << slot << " that was not being written"
+		);
+		queue.states[slot] = SubmissionQueue::SlotState::eReady;
+		queue.sequence[slot] = queue.nextSequence++;
+	}
+	queue.changed.notify_all();
+}
+
+void waitIdle(SubmissionQueue& queue) {
+	std::unique_lock lock(queue.mutex);
+	queue.changed.wait(lock, [&]() {
+		return queue.isClosed ||
+			   std::none_of(
+				   queue.states.begin(),
+				   queue.states.end(),
+				   [](SubmissionQueue::SlotState state) {
+					   return state == SubmissionQueue::SlotState::eReady ||
+							  state == SubmissionQueue::SlotState::eRendering;
+				   }
+			   );
+	});
+}
+
+void setDepth(SubmissionQueue& queue, uint32_t depth) {
+	ASSERT(
+		depth >= MIN_SUBMISSION_QUEUE_DEPTH &&
+			depth <= MAX_SUBMISSION_QUEUE_DEPTH,
+		"Submission queue depth " << depth << " is out of the range ["
+								  << MIN_SUBMISSION_QUEUE_DEPTH << ", "
+								  << MAX_SUBMISSION_QUEUE_DEPTH << "]"
+	);
+	{
+		std::lock_guard lock(queue.mutex);
+		queue.depth = depth;
+	}
+	queue.changed.notify_all();
+}
+
+FrameStats getStats(SubmissionQueue& queue) {
+	std::lock_guard lock(queue.mutex);
+	return queue.stats;
+}
+
+std::optional<uint32_t> acquireForRendering(SubmissionQueue& queue) {
+	std::unique_lock lock(queue.mutex);
+	const auto isReady = [](SubmissionQueue::SlotState state) {
+		return state == SubmissionQueue::SlotState::eReady;
+	};
+	queue.changed.wait(lock, [&]() {
+		return queue.isClosed ||
+			   std::any_of(queue.states.begin(), queue.states.end(), isReady);
+	});
+	if (queue.isClosed) return std::nullopt;
+
+	std::optional<uint32_t> oldest;
+	for (uint32_t slot = 0; slot < MAX_SUBMISSION_QUEUE_DEPTH; slot++) {
+		if (!isReady(queue.states[slot])) continue;
+		if (!oldest || queue.sequence[slot] < queue.sequence[*oldest])
+			oldest = slot;
+	}
+	queue.states[*oldest] = SubmissionQueue::SlotState::eRendering;
+	return oldest;
+}
+
+void release(SubmissionQueue& queue, uint32_t slot, const FrameStats& stats) {
+	{
+		std::lock_guard lock(queue.mutex);
+		ASSERT(
+			queue.states[slot] == SubmissionQueue::SlotState::eRendering,
+			"Releasing slot " << slot << " that was not being rendered"
+		);
+		queue.states[slot] = SubmissionQueue::SlotState::eFree;
+		queue.stats = stats;
+	}
+	queue.changed.notify_all();
+}
+
+void close(SubmissionQueue& queue) {
+	{
+		std::lock_guard lock(queue.mutex);
+		queue.isClosed = true;
+	}
+	queue.changed.notify_all();
+}
+
+void destroy(SubmissionQueue& queue) {
+	for (SubmissionSnapshot& slot : queue.slots) destroy(slot);
+}
+
+}  // namespace graphics
@@ -2,9 +2,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <numeric>
+#include <span>
 
 #include "core/logger/assert.h"
-#include "private/buffer.h"
 #include "private/image.h"
 #include "stb_image.h"
 
@@ -39,12 +41,82 @@ vk::Format getIdealTextureFormat(int channels, const TextureFormatHint& hint) {
 	__builtin_unreachable();
 }
 
+namespace {
+bool isSrgb(vk::Format format) {
+	switch (format) {
+		case vk::Format::eR8Srgb:
+		case vk::Format::eR8G8Srgb:
+		case vk::Format::eR8G8B8Srgb:
+		case vk::Format::eR8G8B8A8Srgb: return true;
+		default:                        return false;
+	}
+}
+
+float toLinear(stbi_uc value) {
+	static const std::array<float, 256> decoded = [] {
+		std::array<float, 256> table;
+		for (size_t i = 0; i < table.size(); i++) {
+			const float encoded = static_cast<float>(i) / 255.0f;
+			table[i] = encoded <= 0.04045f
+						   ? encoded / 12.92f
+						   : std::pow((encoded + 0.055f) / 1.055f, 2.4f);
+		}
+		return table;
+	}();
+	return decoded[value];
+}
+
+stbi_uc fromLinear(float value) {
+	const float encoded = value <= 0.0031308f
+							  ? value * 12.92f
+							  : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	return static_cast<stbi_uc>(
+		std::lround(std::clamp(encoded, 0.0f, 1.0f) * 255.0f)
+	);
+}
+
+// Halves the level in both dimensions, averaging each 2x2 block. Colour
+// channels of gamma encoded formats are averaged in linear space.
+std::vector<stbi_uc> downsample(
+	std::span<const stbi_uc> level,
+	uint32_t width,
+	uint32_t height,
+	int bytesPerPixel,
+	bool isGammaEncoded
+) {
+	const uint32_t nextWidth = std::max(width / 2, 1u);
+	const uint32_t nextHeight = std::max(height / 2, 1u);
+	const size_t stride = static_cast<size_t>(bytesPerPixel);
+	std::vector<stbi_uc> next(nextWidth * nextHeight * stride);
+	for (uint32_t y = 0; y < nextHeight; y++)
+		for (uint32_t x = 0; x < nextWidth; x++)
+			for (size_t channel = 0; channel < stride; channel++) {
+				const bool isColour = isGammaEncoded && channel < 3;
+				float sum = 0.0f;
+				for (uint32_t dy = 0; dy < 2; dy++)
+					for (uint32_t dx = 0; dx < 2; dx++) {
+						const uint32_t sourceX = std::min(2 * x + dx, width - 1);
+						const uint32_t sourceY =
+							std::min(2 * y + dy, height - 1);
+						const stbi_uc value =
+							level[(sourceY * width + sourceX) * stride + channel];
+						sum += isColour ? toLinear(value)
+										: static_cast<float>(value) / 255.0f;
+					}
+				const float average = sum / 4.0f;
+				next[(y * nextWidth + x) * stride + channel] =
+					isColour ? fromLinear(average)
+							 : static_cast<stbi_uc>(std::lround(average * 255.0f));
+			}
+	return next;
+}
+}  // namespace
+
 Texture loadTextureFromFile(
 	std::string_view filePath,
 	vk::Device device,
 	vk::PhysicalDevice physicalDevice,
-	vk::CommandPool commandPool,
-	vk::Queue graphicsQueue,
+	TransferManager& transfers,
 	TextureFormatHint formatHint
 ) {
 	LLOG_INFO << "Try loading texture at: " << filePath;
@@ -56,7 +128,6 @@ Texture loadTextureFromFile(
 
 	const vk::FormatFeatureFlags requiredImageFormatFeatures =
 		vk::FormatFeatureFlagBits::eSampledImage |
-		vk::FormatFeatureFlagBits::eTransferSrc |
 		vk::FormatFeatureFlagBits::eTransferDst;
 
 	const vk::Format idealFormat = getIdealTextureFormat(channels, formatHint);
@@ -87,48 +158,60 @@ Texture loadTextureFromFile(
 	LLOG_INFO << "Format chosen: " << vk::to_string(imageFormat);
 
 	const int bytesPerPixel = (isIdealFormatChosen ? channels : STBI_rgb_alpha);
-	const vk::DeviceSize size(width * height * bytesPerPixel);
-
-	const auto [stagingBuffer, stagingBufferMemory] = Buffer::create(
-		device,
-		physicalDevice,
-		size,
-		vk::BufferUsageFlagBits::eTransferSrc,
-		vk::MemoryPropertyFlagBits::eHostVisible |
-			vk::MemoryPropertyFlagBits::eHostCoherent
-	);
-
-	void* data;
-	vkMapMemory(device, stagingBufferMemory, 0, size, 0, &data);
+	const size_t numPixels = static_cast<size_t>(width * height);
 
+	std::vector<stbi_uc> level;
 	if (isIdealFormatChosen) {
-		memcpy(data, pixels, static_cast<size_t>(size));
+		level.assign(pixels, pixels + numPixels * bytesPerPixel);
 	} else {
-		const size_t numPixels = static_cast<size_t>(width * height);
-		const size_t numBytes = numPixels * bytesPerPixel;
-
-		std::vector<stbi_uc> pixelsPadded;
-		pixelsPadded.reserve(numBytes);
+		level.reserve(numPixels * bytesPerPixel);
 
 		for (size_t i = 0; i < numPixels; i++) {
 			for (int j = 0; j < channels; j++)
-				pixelsPadded.push_back(pixels[i * channels + j]);
+				level.push_back(pixels[i * channels + j]);
 			for (int j = channels; j < STBI_rgb_alpha; j++)
-				pixelsPadded.push_back(std::numeric_limits<unsigned char>::max()
-				);
+				level.push_back(std::numeric_limits<unsigned char>::max());
 		}
-
-		memcpy(data, pixelsPadded.data(), static_cast<size_t>(size));
 	}
 
-	vkUnmapMemory(device, stagingBufferMemory);
-
 	stbi_image_free(pixels);
 
 	const uint32_t mipLevels =
 		static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) +
 		1;
 
+	// The mip chain is filtered here rather than blitted on the GPU, as
+	// blits need a graphics queue and the whole upload can then go through
+	// the transfer queue
+	const bool isGammaEncoded = isSrgb(imageFormat);
+	const size_t texelAlignment = std::lcm(4, bytesPerPixel);
+	std::vector<std::byte> data;
+	std::vector<vk::BufferImageCopy> regions;
+	regions.reserve(mipLevels);
+	uint32_t levelWidth = static_cast<uint32_t>(width);
+	uint32_t levelHeight = static_cast<uint32_t>(height);
+	for (uint32_t mip = 0; mip < mipLevels; mip++) {
+		if (mip > 0) {
+			level = downsample(
+				level, levelWidth, levelHeight, bytesPerPixel, isGammaEncoded
+			);
+			levelWidth = std::max(levelWidth / 2, 1u);
+			levelHeight = std::max(levelHeight / 2, 1u);
+		}
+		const size_t offset =
+			(data.size() + texelAlignment - 1) / texelAlignment * texelAlignment;
+		data.resize(offset + level.size());
+		std::memcpy(data.data() + offset, level.data(), level.size());
+		regions.emplace_back(
+			offset,
+			0,
+			0,
+			vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mip, 0, 1),
+			vk::Offset3D(0, 0, 0),
+			vk::Extent3D(levelWidth, levelHeight, 1)
+		);
+	}
+
 	const auto [textureImage, textureMemory] = Image::create(
         Image::CreateInfo {
             device: device,
@@ -136,43 +219,12 @@ Texture loadTextureFromFile(
             size: vk::Extent3D(width, height, 1),
             format: imageFormat,
             usage: vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
-            mipLevels: mipLevels
+            mipLevels: mipLevels,
+            queueFamilies: transfers.sharedQueueFamilies
         }
 	);
 
-	Image::transitionImageLayout(
-		device,
-		commandPool,
-		graphicsQueue,
-		textureImage,
-		imageFormat,
-		vk::ImageLayout::eUndefined,
-		vk::ImageLayout::eTransferDstOptimal,
-		mipLevels
-	);
-
-	Image::copyBufferToImage(
-		device,
-		commandPool,
-		graphicsQueue,
-		stagingBuffer,
-		textureImage,
-		static_cast<uint32_t>(width),
-		static_cast<uint32_t>(height)
-	);
-
-	Image::generateMipMaps(
-		device,
-		commandPool,
-		graphicsQueue,
-		textureImage,
-		width,
-		height,
-		mipLevels
-	);
-
-	device.destroyBuffer(stagingBuffer);
-	device.freeMemory(stagingBufferMemory);
+	stageImage(transfers, data, regions, textureImage, mipLevels);
 
     constexpr uint32_t mipLevelBase = 0;
 	const vk::ImageView imageView = Image::createImageView(
@@ -187,7 +239,9 @@ Texture loadTextureFromFile(
 
 	LLOG_INFO << "Finished loading texture at " << filePath;
 
-	return Texture{textureImage, imageView, textureMemory, imageFormat, 1};
+	return Texture{
+		textureImage, imageView, textureMemory, imageFormat, mipLevels
+	};
 }
 
 Texture createTexture(
@@ -225,13 +279,12 @@ TextureID pushTextureFromFile(
 	std::string_view filePath,
 	vk::Device device,
 	vk::PhysicalDevice physicalDevice,
-	vk::CommandPool commandPool,
-	vk::Queue graphicsQueue,
+	TransferManager& transfers,
 	TextureFormatHint formatHint
 ) {
 	TextureID id{.index = static_cast<uint32_t>(textureStorage.data.size())};
 	textureStorage.data.push_back(loadTextureFromFile(
-		filePath, device, physicalDevice, commandPool, graphicsQueue, formatHint
+		filePath, device, physicalDevice, transfers, formatHint
 	));
 	return id;
 }
@@ -299,8 +352,7 @@ void destroy(TextureStorage& textures, vk::Device device) {
 void destroy(std::span<const Texture> textures, vk::Device device) {
 	for (const auto [image, imageView, memory, _, __] : textures) {
 		device.destroyImageView(imageView);
-		device.destroyImage(image);
-		device.freeMemory(memory);
+		Image::destroy(device, image, memory);
 	}
 }
 }  // namespace graphics
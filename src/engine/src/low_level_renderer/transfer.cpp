@@ -0,0 +1,385 @@
+#include "low_level_renderer/transfer.h"
+
+#include <cstring>
+#include <limits>
+
+#include "core/logger/assert.h"
+#include "core/logger/logger.h"
+#include "core/logger/vulkan_ensures.h"
+#include "private/buffer.h"
+#include "private/command.h"
+
+namespace graphics {
+
+namespace {
+// Larger data gets a staging buffer of its own, rather than waiting for most
+// of the ring to be free
+constexpr vk::DeviceSize MAX_RING_STAGING_SIZE =
+	TransferManager::STAGING_CAPACITY / 4;
+// A multiple of 4 and of every texel size textures are loaded with, as
+// buffer to image copies need their offset to be
+constexpr vk::DeviceSize STAGING_ALIGNMENT = 48;
+
+vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// Frees what the batches that are done held on to
+void collect(TransferManager& transfers) {
+	const vk::ResultValue<uint64_t> counter =
+		transfers.device.getSemaphoreCounterValue(transfers.timeline);
+	VULKAN_ENSURE_SUCCESS(counter.result, "Can't read transfer semaphore:");
+	while (!transfers.submitted.empty() &&
+		   transfers.submitted.front().value <= counter.value) {
+		TransferManager::Batch& batch = transfers.submitted.front();
+		transfers.device.freeCommandBuffers(
+			transfers.commandPool, 1, &batch.commandBuffer
+		);
+		for (const auto& [buffer, memory] : batch.garbage)
+			Buffer::destroy(transfers.device, buffer, memory);
+		transfers.tail = batch.stagingEnd;
+		transfers.submitted.pop_front();
+	}
+}
+
+// The batch being recorded, begun if there is none
+TransferManager::Batch& getRecording(TransferManager& transfers) {
+	if (transfers.recording) return *transfers.recording;
+	const vk::CommandBuffer commandBuffer =
+		Command::beginSingleCommand(transfers.device, transfers.commandPool);
+	// Earlier batches on the queue may write what this one reads or writes
+	const vk::MemoryBarrier barrier(
+		vk::AccessFlagBits::eTransferWrite,
+		vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite
+	);
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer,
+		vk::PipelineStageFlagBits::eTransfer,
+		{},
+		1,
+		&barrier,
+		0,
+		nullptr,
+		0,
+		nullptr
+	);
+	return transfers.recording.emplace(TransferManager::Batch{
+		.commandBuffer = commandBuffer,
+		.value = 0,
+		.stagingEnd = 0,
+		.garbage = {},
+	});
+}
+
+// Space for `size` bytes in the ring, if it has that much free in one piece
+std::optional<vk::DeviceSize> allocateStaging(
+	TransferManager& transfers, vk::DeviceSize size
+) {
+	if (transfers.head == transfers.tail) transfers.head = transfers.tail = 0;
+	const vk::DeviceSize offset = alignUp(transfers.head, STAGING_ALIGNMENT);
+	// Free from the head to the end and from the start to the tail
+	if (transfers.head >= transfers.tail) {
+		if (offset + size <= TransferManager::STAGING_CAPACITY) {
+			transfers.head = offset + size;
+			return offset;
+		}
+		// Wraps around, stopping short of the tail so that a full ring is
+		// never taken for an empty one
+		if (size < transfers.tail) {
+			transfers.head = size;
+			return 0;
+		}
+		return std::nullopt;
+	}
+	if (offset + size < transfers.tail) {
+		transfers.head = offset + size;
+		return offset;
+	}
+	return std::nullopt;
+}
+
+// Copies `data` to where the batch being recorded can read it from
+std::tuple<vk::Buffer, vk::DeviceSize> stage(
+	TransferManager& transfers, std::span<const std::byte> data
+) {
+	if (data.size() > MAX_RING_STAGING_SIZE) {
+		const auto [buffer, memory] = Buffer::create(
+			transfers.device,
+			transfers.physicalDevice,
+			data.size(),
+			vk::BufferUsageFlagBits::eTransferSrc,
+			vk::MemoryPropertyFlagBits::eHostVisible |
+				vk::MemoryPropertyFlagBits::eHostCoherent,
+			AllocationStrategy::eLinear
+		);
+		std::memcpy(memory.mapped, data.data(), data.size());
+		getRecording(transfers).garbage.emplace_back(buffer, memory);
+		return {buffer, 0};
+	}
+
+	std::optional<vk::DeviceSize> offset =
+		allocateStaging(transfers, data.size());
+	while (!offset) {
+		// The ring is taken by batches that are not done yet
+		submit(transfers);
+		ASSERT(
+			!transfers.submitted.empty(),
+			"Staging ring is full with no batch to wait for"
+		);
+		wait(
+			transfers,
+			TransferToken{.value = transfers.submitted.front().value}
+		);
+		offset = allocateStaging(transfers, data.size());
+	}
+	std::memcpy(
+		static_cast<std::byte*>(transfers.stagingMemory.mapped) + *offset,
+		data.data(),
+		data.size()
+	);
+	return {transfers.staging, *offset};
+}
+}  // namespace
+
+TransferManager TransferManager::create(
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	const QueueFamilyIndices& queueFamily,
+	vk::Queue graphicsQueue
+) {
+	const uint32_t graphicsFamily =
+		queueFamily.graphicsAndComputeFamily.value();
+	const uint32_t transferFamily =
+		queueFamily.transferFamily.value_or(graphicsFamily);
+	const bool isDedicated = transferFamily != graphicsFamily;
+	LLOG_INFO << "Transfers use "
+			  << (isDedicated ? "the dedicated transfer" : "the graphics")
+			  << " queue family " << transferFamily;
+
+	const vk::CommandPoolCreateInfo poolInfo(
+		vk::CommandPoolCreateFlagBits::eTransient, transferFamily
+	);
+	const vk::ResultValue<vk::CommandPool> commandPoolCreation =
+		device.createCommandPool(poolInfo);
+	VULKAN_ENSURE_SUCCESS(
+		commandPoolCreation.result, "Can't create transfer command pool:"
+	);
+
+	const vk::SemaphoreTypeCreateInfo semaphoreTypeInfo(
+		vk::SemaphoreType::eTimeline, 0
+	);
+	const vk::SemaphoreCreateInfo semaphoreInfo({}, &semaphoreTypeInfo);
+	const vk::ResultValue<vk::Semaphore> semaphoreCreation =
+		device.createSemaphore(semaphoreInfo);
+	VULKAN_ENSURE_SUCCESS(
+		semaphoreCreation.result, "Can't create transfer semaphore:"
+	);
+
+	const auto [staging, stagingMemory] = Buffer::create(
+		device,
+		physicalDevice,
+		STAGING_CAPACITY,
+		vk::BufferUsageFlagBits::eTransferSrc,
+		vk::MemoryPropertyFlagBits::eHostVisible |
+			vk::MemoryPropertyFlagBits::eHostCoherent
+	);
+
+	return TransferManager{
+		.device = device,
+		.physicalDevice = physicalDevice,
+		.queue =
+			isDedicated ? device.getQueue(transferFamily, 0) : graphicsQueue,
+		.sharedQueueFamilies =
+			isDedicated ? std::vector<uint32_t>{graphicsFamily, transferFamily}
+						: std::vector<uint32_t>{},
+		.commandPool = commandPoolCreation.value,
+		.timeline = semaphoreCreation.value,
+		.staging = staging,
+		.stagingMemory = stagingMemory,
+		.head = 0,
+		.tail = 0,
+		.recording = std::nullopt,
+		.submitted = {},
+		.lastSubmitted = 0,
+	};
+}
+
+void stageBuffer(
+	TransferManager& transfers,
+	std::span<const std::byte> data,
+	vk::Buffer buffer,
+	vk::DeviceSize offset
+) {
+	if (data.empty()) return;
+	const auto [staging, stagingOffset] = stage(transfers, data);
+	const vk::BufferCopy region(stagingOffset, offset, data.size());
+	getRecording(transfers).commandBuffer.copyBuffer(
+		staging, buffer, 1, &region
+	);
+}
+
+void stageImage(
+	TransferManager& transfers,
+	std::span<const std::byte> data,
+	std::span<const vk::BufferImageCopy> regions,
+	vk::Image image,
+	uint32_t mipLevels
+) {
+	const auto [staging, stagingOffset] = stage(transfers, data);
+	std::vector<vk::BufferImageCopy> stagedRegions(
+		regions.begin(), regions.end()
+	);
+	for (vk::BufferImageCopy& region : stagedRegions)
+		region.bufferOffset += stagingOffset;
+
+	const vk::CommandBuffer commandBuffer =
+		getRecording(transfers).commandBuffer;
+	const vk::ImageSubresourceRange subresourceRange(
+		vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1
+	);
+	const vk::ImageMemoryBarrier toTransferDestination(
+		{},
+		vk::AccessFlagBits::eTransferWrite,
+		vk::ImageLayout::eUndefined,
+		vk::ImageLayout::eTransferDstOptimal,
+		VK_QUEUE_FAMILY_IGNORED,
+		VK_QUEUE_FAMILY_IGNORED,
+		image,
+		subresourceRange
+	);
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTopOfPipe,
+		vk::PipelineStageFlagBits::eTransfer,
+		{},
+		0,
+		nullptr,
+		0,
+		nullptr,
+		1,
+		&toTransferDestination
+	);
+	commandBuffer.copyBufferToImage(
+		staging,
+		image,
+		vk::ImageLayout::eTransferDstOptimal,
+		static_cast<uint32_t>(stagedRegions.size()),
+		stagedRegions.data()
+	);
+	// The graphics queue waits for the batch's semaphore value before
+	// sampling it, which makes the copy visible there
+	const vk::ImageMemoryBarrier toShaderRead(
+		vk::AccessFlagBits::eTransferWrite,
+		{},
+		vk::ImageLayout::eTransferDstOptimal,
+		vk::ImageLayout::eShaderReadOnlyOptimal,
+		VK_QUEUE_FAMILY_IGNORED,
+		VK_QUEUE_FAMILY_IGNORED,
+		image,
+		subresourceRange
+	);
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer,
+		vk::PipelineStageFlagBits::eBottomOfPipe,
+		{},
+		0,
+		nullptr,
+		0,
+		nullptr,
+		1,
+		&toShaderRead
+	);
+}
+
+void copyBuffer(
+	TransferManager& transfers,
+	vk::Buffer source,
+	vk::Buffer destination,
+	std::span<const vk::BufferCopy> regions
+) {
+	if (regions.empty()) return;
+	const vk::CommandBuffer commandBuffer =
+		getRecording(transfers).commandBuffer;
+	// The source may have been written earlier in the batch
+	const vk::MemoryBarrier barrier(
+		vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead
+	);
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer,
+		vk::PipelineStageFlagBits::eTransfer,
+		{},
+		1,
+		&barrier,
+		0,
+		nullptr,
+		0,
+		nullptr
+	);
+	commandBuffer.copyBuffer(
+		source,
+		destination,
+		static_cast<uint32_t>(regions.size()),
+		regions.data()
+	);
+}
+
+TransferToken submit(TransferManager& transfers) {
+	collect(transfers);
+	if (!transfers.recording)
+		return TransferToken{.value = transfers.lastSubmitted};
+
+	TransferManager::Batch batch = std::move(*transfers.recording);
+	transfers.recording.reset();
+	VULKAN_ENSURE_SUCCESS_EXPR(
+		batch.commandBuffer.end(), "Can't end transfer command buffer:"
+	);
+	batch.value = ++transfers.lastSubmitted;
+	batch.stagingEnd = transfers.head;
+
+	const vk::TimelineSemaphoreSubmitInfo timelineInfo(
+		0, nullptr, 1, &batch.value
+	);
+	const vk::SubmitInfo submitInfo(
+		0,
+		nullptr,
+		nullptr,
+		1,
+		&batch.commandBuffer,
+		1,
+		&transfers.timeline,
+		&timelineInfo
+	);
+	VULKAN_ENSURE_SUCCESS_EXPR(
+		transfers.queue.submit(1, &submitInfo, nullptr),
+		"Can't submit transfers:"
+	);
+	transfers.submitted.push_back(std::move(batch));
+	return TransferToken{.value = transfers.lastSubmitted};
+}
+
+void wait(TransferManager& transfers, TransferToken token) {
+	ASSERT(
+		token.value <= transfers.lastSubmitted,
+		"Waiting for transfer " << token.value << " that was never submitted"
+	);
+	const vk::SemaphoreWaitInfo waitInfo(
+		{}, 1, &transfers.timeline, &token.value
+	);
+	VULKAN_ENSURE_SUCCESS_EXPR(
+		transfers.device.waitSemaphores(
+			waitInfo, std::numeric_limits<uint64_t>::max()
+		),
+		"Can't wait for transfers:"
+	);
+	collect(transfers);
+}
+
+void destroy(TransferManager& transfers) {
+	wait(transfers, submit(transfers));
+	Buffer::destroy(
+		transfers.device, transfers.staging, transfers.stagingMemory
+	);
+	transfers.device.destroySemaphore(transfers.timeline);
+	transfers.device.destroyCommandPool(transfers.commandPool);
+}
+
+}  // namespace graphics
@@ -0,0 +1,217 @@
+#include "low_level_renderer/vertex.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtx/hash.hpp>
+
+namespace {
+int16_t toSnorm16(float value) {
+	return static_cast<int16_t>(
+		std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f)
+	);
+}
+
+float fromSnorm16(int16_t value) {
+	return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+}
+
+// Projects the unit sphere onto an octahedron, unfolded onto [-1, 1]^2
+glm::vec2 encodeOctahedral(glm::vec3 direction) {
+	const float length =
+		std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+	if (!(length > 0.0f)) return glm::vec2(0.0f);
+	direction /= length;
+	if (direction.z >= 0.0f) return glm::vec2(direction.x, direction.y);
+	return glm::vec2(
+		(1.0f - std::abs(direction.y)) * (direction.x >= 0.0f ? 1.0f : -1.0f),
+		(1.0f - std::abs(direction.x)) * (direction.y >= 0.0f ? 1.0f : -1.0f)
+	);
+}
+
+// Same as decodeOctahedral in the vertex shader
+glm::vec3 decodeOctahedral(glm::vec2 encoded) {
+	glm::vec3 direction(
+		encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y)
+	);
+	const float fold = std::max(-direction.z, 0.0f);
+	direction.x += direction.x >= 0.0f ? -fold : fold;
+	direction.y += direction.y >= 0.0f ? -fold : fold;
+	return glm::normalize(direction);
+}
+
+// Orthonormal basis around a unit normal, from Duff et al., "Building an
+// Orthonormal Basis, Revisited". Same as getBasis in the vertex shader.
+std::array<glm::vec3, 2> getBasis(glm::vec3 normal) {
+	const float sign = normal.z >= 0.0f ? 1.0f : -1.0f;
+	const float a = -1.0f / (sign + normal.z);
+	const float b = normal.x * normal.y * a;
+	return {
+		glm::vec3(
+			1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x
+		),
+		glm::vec3(b, sign + normal.y * normal.y * a, -normal.y)
+	};
+}
+
+constexpr uint16_t TANGENT_ANGLE_MASK = 0x7FFF;
+constexpr uint16_t TANGENT_FLIPPED_BIT = 0x8000;
+
+// `normal` is the one the shaders decode, so both build the same basis
+uint16_t encodeTangent(glm::vec3 normal, glm::vec3 tangent, bool isFlipped) {
+	const auto [tangentBasis, bitangentBasis] = getBasis(normal);
+	float angle = std::atan2(
+		glm::dot(tangent, bitangentBasis), glm::dot(tangent, tangentBasis)
+	);
+	// Degenerate texture coordinates leave tangents that are not numbers
+	if (!std::isfinite(angle)) angle = 0.0f;
+	const float normalizedAngle = angle / glm::pi<float>() * 0.5f + 0.5f;
+	const uint16_t quantizedAngle = static_cast<uint16_t>(std::lround(
+		std::clamp(normalizedAngle, 0.0f, 1.0f) * TANGENT_ANGLE_MASK
+	));
+	return static_cast<uint16_t>(
+		quantizedAngle | (isFlipped ? TANGENT_FLIPPED_BIT : 0)
+	);
+}
+
+glm::vec3 decodeTangent(glm::vec3 normal, uint16_t tangent) {
+	const auto [tangentBasis, bitangentBasis] = getBasis(normal);
+	const float angle =
+		(static_cast<float>(tangent & TANGENT_ANGLE_MASK) / TANGENT_ANGLE_MASK *
+			 2.0f -
+		 1.0f) *
+		glm::pi<float>();
+	return std::cos(angle) * tangentBasis + std::sin(angle) * bitangentBasis;
+}
+
+uint16_t encodeColor(glm::vec3 color) {
+	const glm::vec3 clamped = glm::clamp(color, 0.0f, 1.0f);
+	const uint32_t red = static_cast<uint32_t>(std::lround(clamped.r * 31.0f));
+	const uint32_t green =
+		static_cast<uint32_t>(std::lround(clamped.g * 63.0f));
+	const uint32_t blue = static_cast<uint32_t>(std::lround(clamped.b * 31.0f));
+	return static_cast<uint16_t>(red << 11 | green << 5 | blue);
+}
+
+glm::vec3 decodeColor(uint16_t color) {
+	return glm::vec3(
+		static_cast<float>(color >> 11) / 31.0f,
+		static_cast<float>((color >> 5) & 63) / 63.0f,
+		static_cast<float>(color & 31) / 31.0f
+	);
+}
+}  // namespace
+
+namespace std {
+
+size_t hash<graphics::Vertex>::operator()(graphics::Vertex const& vertex
+) const {
+	size_t hash_value = 0;
+	hash_value = (hash_value << 4) ^ hash<glm::vec3>()(vertex.position);
+	hash_value = (hash_value << 4) ^ hash<glm::vec3>()(vertex.normal);
+	hash_value = (hash_value << 4) ^ hash<glm::vec3>()(vertex.color);
+	hash_value = (hash_value << 4) ^ hash<glm::vec2>()(vertex.texCoord);
+	return hash_value;
+}
+
+}  // namespace std
+
+namespace graphics {
+
+std::vector<PackedVertex> pack(
+	std::span<const Vertex> vertices, std::span<const IndexType> indices
+) {
+	// Texture coordinates are flipped vertically at load, so the bitangent
+	// the shaders build from cross(normal, tangent) should point where
+	// texCoord.y decreases. It is flipped where it points the other way.
+	std::vector<float> handedness(vertices.size(), 0.0f);
+	constexpr int NUM_OF_VERTS_PER_TRIANGLE = 3;
+	for (size_t i = 0; i + 2 < indices.size(); i += NUM_OF_VERTS_PER_TRIANGLE) {
+		const Vertex& v0 = vertices[indices[i]];
+		const Vertex& v1 = vertices[indices[i + 1]];
+		const Vertex& v2 = vertices[indices[i + 2]];
+
+		const glm::vec3 edge01 = v1.position - v0.position;
+		const glm::vec3 edge02 = v2.position - v0.position;
+		const glm::vec2 deltaUV01 = v1.texCoord - v0.texCoord;
+		const glm::vec2 deltaUV02 = v2.texCoord - v0.texCoord;
+		const float determinant =
+			deltaUV01.x * deltaUV02.y - deltaUV01.y * deltaUV02.x;
+		const glm::vec3 bitangent =
+			(deltaUV01.x * edge02 - deltaUV02.x * edge01) *
+			(determinant < 0.0f ? -1.0f : 1.0f);
+
+		for (int k = 0; k < NUM_OF_VERTS_PER_TRIANGLE; k++) {
+			const Vertex& vertex = vertices[indices[i + k]];
+			handedness[indices[i + k]] += glm::dot(
+				glm::cross(vertex.normal, vertex.tangent), bitangent
+			);
+		}
+	}
+
+	std::vector<PackedVertex> packed;
+	packed.reserve(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++) {
+		const Vertex& vertex = vertices[i];
+		const glm::vec2 octahedral = encodeOctahedral(vertex.normal);
+		const glm::i16vec2 normal(
+			toSnorm16(octahedral.x), toSnorm16(octahedral.y)
+		);
+		const glm::vec3 decodedNormal = decodeOctahedral(
+			glm::vec2(fromSnorm16(normal.x), fromSnorm16(normal.y))
+		);
+		packed.push_back(PackedVertex{
+			.position = vertex.position,
+			.normal = normal,
+			.tangent = encodeTangent(
+				decodedNormal, vertex.tangent, handedness[i] > 0.0f
+			),
+			.color = encodeColor(vertex.color),
+			.texCoord = glm::u16vec2(
+				glm::packHalf1x16(vertex.texCoord.x),
+				glm::packHalf1x16(vertex.texCoord.y)
+			),
+		});
+	}
+	return packed;
+}
+
+Vertex unpack(const PackedVertex& vertex) {
+	const glm::vec3 normal = decodeOctahedral(glm::vec2(
+		fromSnorm16(vertex.normal.x), fromSnorm16(vertex.normal.y)
+	));
+	return Vertex{
+		.position = vertex.position,
+		.normal = normal,
+		.tangent = decodeTangent(normal, vertex.tangent),
+		.color = decodeColor(vertex.color),
+		.texCoord = glm::vec2(
+			glm::unpackHalf1x16(vertex.texCoord.x),
+			glm::unpackHalf1x16(vertex.texCoord.y)
+		),
+	};
+}
+
+glm::vec3 getTangent(
+	const graphics::Vertex& v0,
+	const graphics::Vertex& v1,
+	const graphics::Vertex& v2
+) {
+	const glm::vec3 edge01 = v1.position - v0.position;
+	const glm::vec3 edge02 = v2.position - v0.position;
+
+	const glm::vec2 deltaUV01 = v1.texCoord - v0.texCoord;
+	const glm::vec2 deltaUV02 = v2.texCoord - v0.texCoord;
+
+	const float normalizer =
+		1.0f / (deltaUV01.x * deltaUV02.y - deltaUV01.y * deltaUV02.x);
+
+	const glm::vec3 tangent =
+		(deltaUV02.y * edge01 - deltaUV01.y * edge02) * normalizer;
+	return tangent;
+}
+
+}  // namespace graphics
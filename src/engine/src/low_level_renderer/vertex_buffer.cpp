@@ -2,84 +2,121 @@
 
 #include <tiny_obj_loader.h>
 
+#include <algorithm>
 #include <cstddef>
-#include <glm/gtx/hash.hpp>
+#include <glm/geometric.hpp>
+#include <unordered_map>
 
 #include "core/logger/assert.h"
+#include "core/logger/logger.h"
+#include "low_level_renderer/mesh_optimizer.h"
 #include "private/buffer_templated.cpp"
 
 namespace {
-consteval vk::IndexType getIndexType() {
-	if (std::is_same_v<graphics::IndexType, uint32_t>)
-		return vk::IndexType::eUint32;
-	if (std::is_same_v<graphics::IndexType, uint16_t>)
-		return vk::IndexType::eUint16;
-	if (std::is_same_v<graphics::IndexType, uint8_t>)
-		return vk::IndexType::eUint8KHR;
-	return vk::IndexType::eNoneKHR;
+// Enough for a few large meshes before the first growth
+constexpr uint64_t INITIAL_VERTEX_CAPACITY = 1 << 18;
+constexpr uint64_t INITIAL_INDEX_CAPACITY = 1 << 21;
+constexpr uint64_t INITIAL_MESHLET_CAPACITY = 1 << 14;
+// Transfer source to grow, defragment, and let captures read meshes back
+constexpr vk::BufferUsageFlags VERTEX_BUFFER_USAGE =
+	vk::BufferUsageFlagBits::eVertexBuffer |
+	vk::BufferUsageFlagBits::eTransferSrc |
+	vk::BufferUsageFlagBits::eTransferDst;
+constexpr vk::BufferUsageFlags INDEX_BUFFER_USAGE =
+	vk::BufferUsageFlagBits::eIndexBuffer |
+	vk::BufferUsageFlagBits::eTransferSrc |
+	vk::BufferUsageFlagBits::eTransferDst;
+constexpr vk::BufferUsageFlags MESHLET_BUFFER_USAGE =
+	vk::BufferUsageFlagBits::eStorageBuffer |
+	vk::BufferUsageFlagBits::eTransferSrc |
+	vk::BufferUsageFlagBits::eTransferDst;
+
+// Index buffer ranges are counted in 16 bit indices
+uint64_t getIndexUnits(vk::IndexType indexType) {
+	return indexType == vk::IndexType::eUint16 ? 1 : 2;
 }
-}  // namespace
-
-namespace std {
 
-size_t hash<graphics::Vertex>::operator()(graphics::Vertex const& vertex
-) const {
-	size_t hash_value = 0;
-	hash_value = (hash_value << 4) ^ hash<glm::vec3>()(vertex.position);
-	hash_value = (hash_value << 4) ^ hash<glm::vec3>()(vertex.normal);
-	hash_value = (hash_value << 4) ^ hash<glm::vec3>()(vertex.color);
-	hash_value = (hash_value << 4) ^ hash<glm::vec2>()(vertex.texCoord);
-	return hash_value;
+// Replaces the buffer with one of `capacity` elements that starts with the
+// old one's contents once the transfer manager's batch is done, and retires
+// the old one
+void grow(
+	vk::Buffer& buffer,
+	graphics::DeviceAllocation& memory,
+	algo::RangeAllocator& ranges,
+	std::vector<graphics::RetiredBuffer>& retired,
+	uint64_t capacity,
+	vk::DeviceSize stride,
+	vk::BufferUsageFlags usage,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	graphics::TransferManager& transfers
+) {
+	const auto [grownBuffer, grownMemory] = Buffer::create(
+		device,
+		physicalDevice,
+		stride * capacity,
+		usage,
+		vk::MemoryPropertyFlagBits::eDeviceLocal,
+		graphics::AllocationStrategy::eFreeList,
+		transfers.sharedQueueFamilies
+	);
+	if (buffer) {
+		const vk::BufferCopy region(0, 0, stride * ranges.capacity);
+		graphics::copyBuffer(transfers, buffer, grownBuffer, {&region, 1});
+		retired.push_back({.buffer = buffer, .memory = memory});
+	}
+	buffer = grownBuffer;
+	memory = grownMemory;
+	algo::grow(ranges, capacity);
+	LLOG_INFO << "Geometry buffer grown to " << capacity << " elements of "
+			  << stride << " bytes";
 }
-
-}  // namespace std
+}  // namespace
 
 namespace graphics {
 
 std::array<vk::VertexInputAttributeDescription, 5>
-Vertex::getAttributeDescriptions() {
+getPackedVertexAttributeDescriptions() {
 	static std::array<vk::VertexInputAttributeDescription, 5>
 		attributeDescriptions = {
 			vk::VertexInputAttributeDescription(
 				0,	// location
 				0,	// binding
 				vk::Format::eR32G32B32Sfloat,
-				offsetof(Vertex, position)
+				offsetof(PackedVertex, position)
 			),
 			vk::VertexInputAttributeDescription(
 				1,	// location
 				0,	// binding
-				vk::Format::eR32G32B32Sfloat,
-				offsetof(Vertex, normal)
+				vk::Format::eR16G16Snorm,
+				offsetof(PackedVertex, normal)
 			),
 			vk::VertexInputAttributeDescription(
 				2,	// location
 				0,	// binding
-				vk::Format::eR32G32B32Sfloat,
-				offsetof(Vertex, tangent)
+				vk::Format::eR16Uint,
+				offsetof(PackedVertex, tangent)
 			),
 			vk::VertexInputAttributeDescription(
 				3,	// location
 				0,	// binding
-				vk::Format::eR32G32B32Sfloat,
-				offsetof(Vertex, color)
+				vk::Format::eR16Uint,
+				offsetof(PackedVertex, color)
 			),
 			vk::VertexInputAttributeDescription(
 				4,	// location
 				0,	// binding
-				vk::Format::eR32G32Sfloat,
-				offsetof(Vertex, texCoord)
+				vk::Format::eR16G16Sfloat,
+				offsetof(PackedVertex, texCoord)
 			)
 		};
 	return attributeDescriptions;
 }
 
-VertexBuffer VertexBuffer::create(
+void loadFromObj(
 	std::string_view filePath,
-	const vk::Device& device,
-	const vk::PhysicalDevice& physicalDevice,
-	const vk::CommandPool& commandPool,
-	const vk::Queue& graphicsQueue
+	std::vector<Vertex>& vertices,
+	std::vector<IndexType>& indices
 ) {
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
@@ -94,8 +131,8 @@ VertexBuffer VertexBuffer::create(
 		"Can't load model at " << filePath << " " << warn << " " << err
 	);
 
-	std::vector<Vertex> vertices;
-	std::vector<uint32_t> indices;
+	vertices.clear();
+	indices.clear();
 
 	{  // populate vertices and indices arrays
 		std::unordered_map<Vertex, uint32_t> unique_vertices;
@@ -195,90 +232,394 @@ VertexBuffer VertexBuffer::create(
 			vertices[i].tangent = glm::normalize(vertices[i].tangent);
 	}
 
-	return create(
-		vertices, indices, device, physicalDevice, commandPool, graphicsQueue
-	);
+	optimizeMesh(vertices, indices, filePath);
 }
 
-glm::vec3 getTangent(
-	const graphics::Vertex& v0,
-	const graphics::Vertex& v1,
-	const graphics::Vertex& v2
+GeometryBuffer GeometryBuffer::create() {
+	return GeometryBuffer{
+		.vertexBuffer = nullptr,
+		.vertexMemory = {},
+		.indexBuffer = nullptr,
+		.indexMemory = {},
+		.meshletBuffer = nullptr,
+		.meshletMemory = {},
+		.vertexRanges = algo::RangeAllocator::create(0),
+		.indexRanges = algo::RangeAllocator::create(0),
+		.meshletRanges = algo::RangeAllocator::create(0),
+		.retired = {},
+	};
+}
+
+MeshRange upload(
+	GeometryBuffer& geometry,
+	const std::vector<Vertex>& vertices,
+	const std::vector<IndexType>& indices,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	TransferManager& transfers
 ) {
-	const glm::vec3 edge01 = v1.position - v0.position;
-	const glm::vec3 edge02 = v2.position - v0.position;
+	ASSERT(
+		!vertices.empty() && !indices.empty(),
+		"Uploading a mesh of " << vertices.size() << " vertices and "
+							   << indices.size() << " indices"
+	);
+
+	std::optional<uint64_t> firstVertex =
+		algo::allocate(geometry.vertexRanges, vertices.size());
+	if (!firstVertex) {
+		grow(
+			geometry.vertexBuffer,
+			geometry.vertexMemory,
+			geometry.vertexRanges,
+			geometry.retired,
+			std::max(
+				{INITIAL_VERTEX_CAPACITY,
+				 geometry.vertexRanges.capacity * 2,
+				 geometry.vertexRanges.capacity +
+					 static_cast<uint64_t>(vertices.size())}
+			),
+			sizeof(PackedVertex),
+			VERTEX_BUFFER_USAGE,
+			device,
+			physicalDevice,
+			transfers
+		);
+		firstVertex = algo::allocate(geometry.vertexRanges, vertices.size());
+	}
+	// Index 0xFFFF is left alone, as it restarts primitives where that is on
+	const vk::IndexType indexType = vertices.size() <= 0xFFFF
+										? vk::IndexType::eUint16
+										: vk::IndexType::eUint32;
+	const uint64_t indexUnits = getIndexUnits(indexType);
+	std::optional<uint64_t> firstIndex = algo::allocate(
+		geometry.indexRanges, indexUnits * indices.size(), indexUnits
+	);
+	if (!firstIndex) {
+		grow(
+			geometry.indexBuffer,
+			geometry.indexMemory,
+			geometry.indexRanges,
+			geometry.retired,
+			std::max(
+				{INITIAL_INDEX_CAPACITY,
+				 geometry.indexRanges.capacity * 2,
+				 geometry.indexRanges.capacity +
+					 indexUnits * static_cast<uint64_t>(indices.size()) +
+					 indexUnits}
+			),
+			sizeof(uint16_t),
+			INDEX_BUFFER_USAGE,
+			device,
+			physicalDevice,
+			transfers
+		);
+		firstIndex = algo::allocate(
+			geometry.indexRanges, indexUnits * indices.size(), indexUnits
+		);
+	}
+	const std::vector<Meshlet> meshlets = buildMeshlets(vertices, indices);
+	std::optional<uint64_t> firstMeshlet =
+		algo::allocate(geometry.meshletRanges, meshlets.size());
+	if (!firstMeshlet) {
+		grow(
+			geometry.meshletBuffer,
+			geometry.meshletMemory,
+			geometry.meshletRanges,
+			geometry.retired,
+			std::max(
+				{INITIAL_MESHLET_CAPACITY,
+				 geometry.meshletRanges.capacity * 2,
+				 geometry.meshletRanges.capacity +
+					 static_cast<uint64_t>(meshlets.size())}
+			),
+			sizeof(Meshlet),
+			MESHLET_BUFFER_USAGE,
+			device,
+			physicalDevice,
+			transfers
+		);
+		firstMeshlet = algo::allocate(geometry.meshletRanges, meshlets.size());
+	}
 
-	const glm::vec2 deltaUV01 = v1.texCoord - v0.texCoord;
-	const glm::vec2 deltaUV02 = v2.texCoord - v0.texCoord;
+	stageBuffer(
+		transfers,
+		std::as_bytes(std::span(pack(vertices, indices))),
+		geometry.vertexBuffer,
+		sizeof(PackedVertex) * *firstVertex
+	);
+	if (indexType == vk::IndexType::eUint16) {
+		const std::vector<uint16_t> shortIndices(
+			indices.begin(), indices.end()
+		);
+		stageBuffer(
+			transfers,
+			std::as_bytes(std::span(shortIndices)),
+			geometry.indexBuffer,
+			sizeof(uint16_t) * *firstIndex
+		);
+	} else {
+		stageBuffer(
+			transfers,
+			std::as_bytes(std::span(indices)),
+			geometry.indexBuffer,
+			sizeof(uint16_t) * *firstIndex
+		);
+	}
 
-	const float normalizer =
-		1.0f / (deltaUV01.x * deltaUV02.y - deltaUV01.y * deltaUV02.x);
+	stageBuffer(
+		transfers,
+		std::as_bytes(std::span(meshlets)),
+		geometry.meshletBuffer,
+		sizeof(Meshlet) * *firstMeshlet
+	);
 
-	const glm::vec3 tangent =
-		(deltaUV02.y * edge01 - deltaUV01.y * edge02) * normalizer;
-	return tangent;
+	std::vector<glm::vec3> positions;
+	positions.reserve(vertices.size());
+	for (const Vertex& vertex : vertices) positions.push_back(vertex.position);
+
+	return MeshRange{
+		.firstVertex = static_cast<uint32_t>(*firstVertex),
+		.vertexCount = static_cast<uint32_t>(vertices.size()),
+		.firstIndex = static_cast<uint32_t>(*firstIndex / indexUnits),
+		.indexCount = static_cast<uint32_t>(indices.size()),
+		.indexType = indexType,
+		.firstMeshlet = static_cast<uint32_t>(*firstMeshlet),
+		.meshletCount = static_cast<uint32_t>(meshlets.size()),
+		.bounds = math::computeBounds(positions),
+	};
 }
 
-VertexBuffer VertexBuffer::create(
-	const std::vector<Vertex>& vertices,
-	const std::vector<IndexType>& indices,
+void release(GeometryBuffer& geometry, const MeshRange& range) {
+	algo::release(
+		geometry.vertexRanges,
+		{.offset = range.firstVertex, .size = range.vertexCount}
+	);
+	const uint64_t indexUnits = getIndexUnits(range.indexType);
+	algo::release(
+		geometry.indexRanges,
+		{.offset = indexUnits * range.firstIndex,
+		 .size = indexUnits * range.indexCount}
+	);
+	algo::release(
+		geometry.meshletRanges,
+		{.offset = range.firstMeshlet, .size = range.meshletCount}
+	);
+}
+
+void defragment(
+	GeometryBuffer& geometry,
+	std::span<MeshRange* const> ranges,
 	vk::Device device,
 	vk::PhysicalDevice physicalDevice,
-	vk::CommandPool commandPool,
-	vk::Queue graphicsQueue
+	TransferManager& transfers
 ) {
-	auto [vertexBuffer, deviceMemory] = Buffer::loadToBuffer(
-		device,
-		physicalDevice,
-		commandPool,
-		graphicsQueue,
-		vertices,
-		vk::BufferUsageFlagBits::eVertexBuffer
-	);
+	if (!geometry.vertexBuffer) return;
+
+	std::vector<vk::BufferCopy> vertexCopies;
+	std::vector<vk::BufferCopy> indexCopies;
+	std::vector<vk::BufferCopy> meshletCopies;
+	vertexCopies.reserve(ranges.size());
+	indexCopies.reserve(ranges.size());
+	meshletCopies.reserve(ranges.size());
+	uint32_t vertexEnd = 0;
+	// In 16 bit indices
+	uint32_t indexEnd = 0;
+	uint32_t meshletEnd = 0;
+	for (MeshRange* range : ranges) {
+		const uint32_t indexUnits =
+			static_cast<uint32_t>(getIndexUnits(range->indexType));
+		indexEnd = (indexEnd + indexUnits - 1) / indexUnits * indexUnits;
+		vertexCopies.emplace_back(
+			sizeof(PackedVertex) * range->firstVertex,
+			sizeof(PackedVertex) * vertexEnd,
+			sizeof(PackedVertex) * range->vertexCount
+		);
+		indexCopies.emplace_back(
+			sizeof(uint16_t) * indexUnits * range->firstIndex,
+			sizeof(uint16_t) * indexEnd,
+			sizeof(uint16_t) * indexUnits * range->indexCount
+		);
+		meshletCopies.emplace_back(
+			sizeof(Meshlet) * range->firstMeshlet,
+			sizeof(Meshlet) * meshletEnd,
+			sizeof(Meshlet) * range->meshletCount
+		);
+		range->firstVertex = vertexEnd;
+		range->firstIndex = indexEnd / indexUnits;
+		range->firstMeshlet = meshletEnd;
+		vertexEnd += range->vertexCount;
+		indexEnd += indexUnits * range->indexCount;
+		meshletEnd += range->meshletCount;
+	}
 
-	auto [indexBuffer, indexDeviceMemory] = Buffer::loadToBuffer(
-		device,
-		physicalDevice,
-		commandPool,
-		graphicsQueue,
-		indices,
-		vk::BufferUsageFlagBits::eIndexBuffer
+	// Copied into new buffers rather than within the old ones, as moved
+	// ranges could overlap where they were
+	const auto repack = [&](vk::Buffer& buffer,
+							DeviceAllocation& memory,
+							algo::RangeAllocator& allocator,
+							vk::DeviceSize stride,
+							vk::BufferUsageFlags usage,
+							std::span<const vk::BufferCopy> copies,
+							uint32_t end) {
+		const auto [packedBuffer, packedMemory] = Buffer::create(
+			device,
+			physicalDevice,
+			stride * allocator.capacity,
+			usage,
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			AllocationStrategy::eFreeList,
+			transfers.sharedQueueFamilies
+		);
+		copyBuffer(transfers, buffer, packedBuffer, copies);
+		geometry.retired.push_back({.buffer = buffer, .memory = memory});
+		buffer = packedBuffer;
+		memory = packedMemory;
+
+		algo::reset(allocator);
+		if (end > 0) {
+			[[maybe_unused]] const std::optional<uint64_t> offset =
+				algo::allocate(allocator, end);
+			ASSERT(offset == 0u, "Packed ranges did not start the buffer");
+		}
+	};
+	repack(
+		geometry.vertexBuffer,
+		geometry.vertexMemory,
+		geometry.vertexRanges,
+		sizeof(PackedVertex),
+		VERTEX_BUFFER_USAGE,
+		vertexCopies,
+		vertexEnd
+	);
+	repack(
+		geometry.indexBuffer,
+		geometry.indexMemory,
+		geometry.indexRanges,
+		sizeof(uint16_t),
+		INDEX_BUFFER_USAGE,
+		indexCopies,
+		indexEnd
 	);
+	repack(
+		geometry.meshletBuffer,
+		geometry.meshletMemory,
+		geometry.meshletRanges,
+		sizeof(Meshlet),
+		MESHLET_BUFFER_USAGE,
+		meshletCopies,
+		meshletEnd
+	);
+}
 
-	return VertexBuffer{
-		vertexBuffer,
-		deviceMemory,
-		indexBuffer,
-		indexDeviceMemory,
-		static_cast<uint32_t>(vertices.size()),
-		static_cast<uint32_t>(indices.size())
+GeometryHandles getHandles(const GeometryBuffer& geometry) {
+	return GeometryHandles{
+		.vertexBuffer = geometry.vertexBuffer,
+		.indexBuffer = geometry.indexBuffer,
+		.meshletBuffer = geometry.meshletBuffer,
 	};
 }
 
-void bind(vk::CommandBuffer commandBuffer, const VertexBuffer& vertexBuffer) {
-	vk::DeviceSize offsets[] = {0};
-    ASSERT(commandBuffer, "Cannot bind to null command buffer");
-    ASSERT(vertexBuffer.vertexBuffer, "Cannot bind to null command buffer");
-	commandBuffer.bindVertexBuffers(0, 1, &vertexBuffer.vertexBuffer, offsets);
-	commandBuffer.bindIndexBuffer(vertexBuffer.indexBuffer, 0, getIndexType());
+void takeRetired(
+	GeometryBuffer& geometry, std::vector<RetiredBuffer>& retired
+) {
+	retired.insert(
+		retired.end(), geometry.retired.begin(), geometry.retired.end()
+	);
+	geometry.retired.clear();
+}
+
+void destroy(std::span<const RetiredBuffer> retired, vk::Device device) {
+	for (const RetiredBuffer& buffer : retired)
+		Buffer::destroy(device, buffer.buffer, buffer.memory);
+}
+
+void bind(vk::CommandBuffer commandBuffer, const GeometryHandles& geometry) {
+	ASSERT(commandBuffer, "Cannot bind to null command buffer");
+	if (!geometry.vertexBuffer) return;
+	const vk::DeviceSize offsets[] = {0};
+	commandBuffer.bindVertexBuffers(0, 1, &geometry.vertexBuffer, offsets);
+}
+
+void bindIndices(
+	vk::CommandBuffer commandBuffer,
+	const GeometryHandles& geometry,
+	vk::IndexType indexType
+) {
+	ASSERT(commandBuffer, "Cannot bind to null command buffer");
+	if (!geometry.indexBuffer) return;
+	commandBuffer.bindIndexBuffer(geometry.indexBuffer, 0, indexType);
 }
 
 void drawVertices(
 	vk::CommandBuffer commandBuffer,
-	const VertexBuffer& vertexBuffer,
-	uint16_t instanceCount
+	const MeshRange& range,
+	uint16_t instanceCount,
+	uint32_t firstInstance
 ) {
 	commandBuffer.drawIndexed(
-		vertexBuffer.numberOfIndices, instanceCount, 0, 0, 0
+		range.indexCount,
+		instanceCount,
+		range.firstIndex,
+		static_cast<int32_t>(range.firstVertex),
+		firstInstance
 	);
 }
 
-void destroy(std::span<const VertexBuffer> vertexBuffers, vk::Device device) {
-	for (const VertexBuffer& vertexBuffer : vertexBuffers) {
-		device.destroyBuffer(vertexBuffer.vertexBuffer);
-		device.freeMemory(vertexBuffer.vertexMemory);
-		device.destroyBuffer(vertexBuffer.indexBuffer);
-		device.freeMemory(vertexBuffer.indexMemory);
+void readBack(
+	const GeometryBuffer& geometry,
+	const MeshRange& range,
+	std::vector<Vertex>& vertices,
+	std::vector<IndexType>& indices,
+	vk::Device device,
+	vk::PhysicalDevice physicalDevice,
+	vk::CommandPool commandPool,
+	vk::Queue graphicsQueue
+) {
+	const std::vector<PackedVertex> packed =
+		Buffer::readFromBuffer<PackedVertex>(
+			device,
+			physicalDevice,
+			commandPool,
+			graphicsQueue,
+			geometry.vertexBuffer,
+			range.firstVertex,
+			range.vertexCount
+		);
+	vertices.clear();
+	vertices.reserve(packed.size());
+	for (const PackedVertex& vertex : packed)
+		vertices.push_back(unpack(vertex));
+
+	if (range.indexType == vk::IndexType::eUint16) {
+		const std::vector<uint16_t> shortIndices =
+			Buffer::readFromBuffer<uint16_t>(
+				device,
+				physicalDevice,
+				commandPool,
+				graphicsQueue,
+				geometry.indexBuffer,
+				range.firstIndex,
+				range.indexCount
+			);
+		indices.assign(shortIndices.begin(), shortIndices.end());
+	} else {
+		indices = Buffer::readFromBuffer<IndexType>(
+			device,
+			physicalDevice,
+			commandPool,
+			graphicsQueue,
+			geometry.indexBuffer,
+			range.firstIndex,
+			range.indexCount
+		);
 	}
 }
+
+void destroy(const GeometryBuffer& geometry, vk::Device device) {
+	destroy(geometry.retired, device);
+	if (!geometry.vertexBuffer) return;
+	Buffer::destroy(device, geometry.vertexBuffer, geometry.vertexMemory);
+	Buffer::destroy(device, geometry.indexBuffer, geometry.indexMemory);
+	Buffer::destroy(device, geometry.meshletBuffer, geometry.meshletMemory);
+}
 };	// namespace graphics
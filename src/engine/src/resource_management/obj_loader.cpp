@@ -2,9 +2,11 @@
 
 #include <tiny_obj_loader.h>
 #include <glm/gtx/string_cast.hpp>
+#include <string>
 #include <unordered_map>
 
 #include "core/logger/assert.h"
+#include "low_level_renderer/mesh_optimizer.h"
 
 namespace resource_management {
 
@@ -186,6 +188,11 @@ Model loadObj(
 			vertex.tangent = globalTangents[uniqueGlobalVertices[vertex]];
 
 		PerMaterialData materialData = materialDatas[materialId];
+		graphics::optimizeMesh(
+			materialData.vertices,
+			materialData.indices,
+			std::string(objPath) + " material " + std::to_string(materialId)
+		);
 		const graphics::MeshID mesh = graphics.loadMesh(materialData.vertices, materialData.indices);
 
 		loadedMeshes.push_back(mesh);
@@ -202,6 +209,7 @@ Model loadObj(
 			.ambient = reinterpret_cast<const glm::vec3&>(material.ambient),
 			.emission = reinterpret_cast<const glm::vec3&>(material.emission),
 			.shininess = material.shininess,
+			.opacity = material.dissolve,
 		};
 
 		LLOG_VERBOSE << "Material " << materialId << " " << glm::to_string(properties.specular) << " "
@@ -228,7 +236,9 @@ Model loadObj(
 			.displacement = displacement,
 			.emission = emission,
 			.materialProperties = properties,
-			.sampler = graphics::SamplerType::eLinear
+			.sampler = graphics::SamplerType::eLinear,
+			.queue = material.dissolve < 1.0f ? graphics::RenderQueue::eTransparent
+											  : graphics::RenderQueue::eOpaque
 		};
 
 		loadedMaterials.push_back(graphics.loadMaterial(createInfo));
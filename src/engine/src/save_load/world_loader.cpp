@@ -338,5 +338,6 @@ void WorldLoader::load(
 	}();
 
 	game_world::emplaceStatics(world, variants, transforms, materials, meshes);
+	game_world::buildStaticsIndex(world, graphics.meshes);
 }
 }  // namespace save_load
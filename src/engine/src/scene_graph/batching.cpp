@@ -0,0 +1,95 @@
+#include "scene_graph/batching.h"
+
+#include <algorithm>
+
+namespace scene_graph {
+
+namespace {
+
+bool isSameBatch(
+	const graphics::RenderObject& r0, const graphics::RenderObject& r1
+) {
+	return r0.variant == r1.variant && r0.material == r1.material &&
+		   r0.mesh == r1.mesh;
+}
+
+void addBatch(
+	Batcher& batcher, std::span<const graphics::RenderObject> group
+) {
+	const graphics::RenderObject& first = group.front();
+	batcher.batches.push_back({
+		.variant = first.variant,
+		.material = first.material,
+		.mesh = first.mesh,
+		.count = static_cast<uint16_t>(group.size()),
+	});
+	if (batcher.batchData.size() < batcher.batches.size())
+		batcher.batchData.emplace_back();
+
+	std::vector<graphics::InstanceData>& data = batcher.batchData.at(
+		batcher.batches.size() - 1
+	);
+	data.clear();
+	for (const graphics::RenderObject& object : group)
+		data.push_back({.transform = object.transform});
+}
+
+}  // namespace
+
+Batcher Batcher::create() {
+	return Batcher{
+		.singles = {},
+		.batches = {},
+		.batchData = {},
+		.numObjects = 0,
+	};
+}
+
+void build(Batcher& batcher, std::span<const graphics::RenderObject> objects) {
+	batcher.singles.clear();
+	batcher.batches.clear();
+	batcher.numObjects = static_cast<uint32_t>(objects.size());
+
+	size_t groupBegin = 0;
+	while (groupBegin < objects.size()) {
+		size_t groupEnd = groupBegin + 1;
+		while (groupEnd < objects.size() &&
+			   isSameBatch(objects[groupEnd], objects[groupBegin]))
+			groupEnd++;
+
+		const std::span<const graphics::RenderObject> group =
+			objects.subspan(groupBegin, groupEnd - groupBegin);
+		if (group.size() < Batcher::MIN_BATCH_SIZE) {
+			batcher.singles.insert(
+				batcher.singles.end(), group.begin(), group.end()
+			);
+		} else {
+			for (size_t offset = 0; offset < group.size();
+				 offset += Batcher::MAX_BATCH_SIZE)
+				addBatch(
+					batcher,
+					group.subspan(
+						offset,
+						std::min<size_t>(
+							Batcher::MAX_BATCH_SIZE, group.size() - offset
+						)
+					)
+				);
+		}
+		groupBegin = groupEnd;
+	}
+}
+
+std::span<const std::vector<graphics::InstanceData>> getBatchData(
+	const Batcher& batcher
+) {
+	return std::span(batcher.batchData).first(batcher.batches.size());
+}
+
+uint32_t getDrawCallCount(const Batcher& batcher) {
+	return static_cast<uint32_t>(
+		batcher.singles.size() + batcher.batches.size()
+	);
+}
+
+}  // namespace scene_graph
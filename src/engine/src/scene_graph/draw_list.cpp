@@ -0,0 +1,181 @@
+#include "scene_graph/draw_list.h"
+
+#include <algorithm>
+
+#include "core/logger/assert.h"
+
+namespace scene_graph {
+
+namespace {
+
+bool isDrawnBefore(
+	const graphics::RenderObject& r0, const graphics::RenderObject& r1
+) {
+	if (r0.variant == r1.variant) return r0.material < r1.material;
+	return r0.variant < r1.variant;
+}
+
+graphics::RenderObject& getObject(DrawList& drawList, RenderObjectID id) {
+	ASSERT(
+		algo::isIndexValid(drawList.ids, id),
+		"Render object " << id.index << " has been removed"
+	);
+	const DrawListSlot slot = drawList.slots[id.index];
+	return slot.isPending ? drawList.pendingObjects[slot.position]
+						  : drawList.objects[slot.position];
+}
+
+// Moves an object whose sort key changed back into the pending queue.
+void requeue(DrawList& drawList, RenderObjectID id) {
+	DrawListSlot& slot = drawList.slots[id.index];
+	if (slot.isPending) return;
+
+	drawList.pendingObjects.push_back(drawList.objects[slot.position]);
+	drawList.pendingOwners.push_back(id.index);
+	drawList.owners[slot.position] = DrawList::REMOVED;
+	drawList.numRemoved++;
+	slot = {
+		.position = static_cast<uint32_t>(drawList.pendingObjects.size() - 1),
+		.isPending = true
+	};
+}
+
+}  // namespace
+
+DrawList DrawList::create() {
+	return DrawList{
+		.objects = {},
+		.owners = {},
+		.ids = algo::GenerationIndexArray::create(),
+		.slots = {},
+		.pendingObjects = {},
+		.pendingOwners = {},
+		.numRemoved = 0,
+		.changedTransforms = {},
+		.mergedObjects = {},
+		.mergedOwners = {},
+		.pendingOrder = {},
+	};
+}
+
+RenderObjectID add(DrawList& drawList, const graphics::RenderObject& object) {
+	const RenderObjectID id = algo::reserveIndex(drawList.ids);
+	drawList.slots.ensureCapacity(algo::getCapacity(drawList.ids));
+	drawList.pendingObjects.push_back(object);
+	drawList.pendingOwners.push_back(id.index);
+	drawList.slots[id.index] = {
+		.position = static_cast<uint32_t>(drawList.pendingObjects.size() - 1),
+		.isPending = true
+	};
+	return id;
+}
+
+void remove(DrawList& drawList, RenderObjectID id) {
+	ASSERT(
+		algo::isIndexValid(drawList.ids, id),
+		"Render object " << id.index << " has already been removed"
+	);
+	const DrawListSlot slot = drawList.slots[id.index];
+	if (slot.isPending) {
+		drawList.pendingOwners[slot.position] = DrawList::REMOVED;
+	} else {
+		drawList.owners[slot.position] = DrawList::REMOVED;
+		drawList.numRemoved++;
+	}
+	algo::destroy(drawList.ids, {&id, 1});
+}
+
+void setTransform(
+	DrawList& drawList, RenderObjectID id, const glm::mat4& transform
+) {
+	getObject(drawList, id).transform = transform;
+	const DrawListSlot slot = drawList.slots[id.index];
+	if (!slot.isPending) drawList.changedTransforms.push_back(slot.position);
+}
+
+void setVariant(
+	DrawList& drawList,
+	RenderObjectID id,
+	const graphics::PipelineSpecializationConstants& variant
+) {
+	if (getObject(drawList, id).variant == variant) return;
+	requeue(drawList, id);
+	getObject(drawList, id).variant = variant;
+}
+
+void setMaterial(
+	DrawList& drawList, RenderObjectID id, graphics::MaterialInstanceID material
+) {
+	if (getObject(drawList, id).material == material) return;
+	requeue(drawList, id);
+	getObject(drawList, id).material = material;
+}
+
+bool flush(DrawList& drawList) {
+	if (drawList.pendingObjects.empty() && drawList.numRemoved == 0)
+		return false;
+
+	drawList.pendingOrder.clear();
+	for (uint32_t i = 0; i < drawList.pendingObjects.size(); i++)
+		if (drawList.pendingOwners[i] != DrawList::REMOVED)
+			drawList.pendingOrder.push_back(i);
+	std::stable_sort(
+		drawList.pendingOrder.begin(),
+		drawList.pendingOrder.end(),
+		[&](uint32_t a, uint32_t b) {
+			return isDrawnBefore(
+				drawList.pendingObjects[a], drawList.pendingObjects[b]
+			);
+		}
+	);
+
+	drawList.mergedObjects.clear();
+	drawList.mergedOwners.clear();
+	const auto emit = [&](const graphics::RenderObject& object, uint32_t owner
+					  ) {
+		drawList.slots[owner] = {
+			.position = static_cast<uint32_t>(drawList.mergedObjects.size()),
+			.isPending = false
+		};
+		drawList.mergedObjects.push_back(object);
+		drawList.mergedOwners.push_back(owner);
+	};
+
+	// Merge the retained list, minus tombstones, with the sorted additions.
+	// Retained objects go first on ties so their relative order is stable.
+	size_t retained = 0;
+	size_t pending = 0;
+	while (retained < drawList.objects.size() ||
+		   pending < drawList.pendingOrder.size()) {
+		if (retained < drawList.objects.size() &&
+			drawList.owners[retained] == DrawList::REMOVED) {
+			retained++;
+			continue;
+		}
+
+		const bool takePending =
+			retained == drawList.objects.size() ||
+			(pending < drawList.pendingOrder.size() &&
+			 isDrawnBefore(
+				 drawList.pendingObjects[drawList.pendingOrder[pending]],
+				 drawList.objects[retained]
+			 ));
+		if (takePending) {
+			const uint32_t index = drawList.pendingOrder[pending++];
+			emit(drawList.pendingObjects[index], drawList.pendingOwners[index]);
+		} else {
+			emit(drawList.objects[retained], drawList.owners[retained]);
+			retained++;
+		}
+	}
+
+	std::swap(drawList.objects, drawList.mergedObjects);
+	std::swap(drawList.owners, drawList.mergedOwners);
+	drawList.pendingObjects.clear();
+	drawList.pendingOwners.clear();
+	drawList.numRemoved = 0;
+	drawList.changedTransforms.clear();
+	return true;
+}
+
+}  // namespace scene_graph
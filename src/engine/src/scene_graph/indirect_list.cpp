@@ -0,0 +1,160 @@
+#include "scene_graph/indirect_list.h"
+
+#include <algorithm>
+
+#include "core/algo/radix_sort.h"
+
+namespace scene_graph {
+
+IndirectList IndirectList::create() {
+	return IndirectList{
+		.objects = {},
+		.transforms = {},
+		.buckets = {},
+		.transparentIndices = {},
+		.positions = {},
+		.isLayoutChanged = false,
+		.changedPositions = {},
+		.changedTransforms = {},
+		.isBuilt = false,
+		.meshLayoutVersion = 0,
+		.sortKeys = {},
+		.sortKeyScratch = {},
+		.order = {},
+		.orderScratch = {},
+	};
+}
+
+bool needsBuild(
+	const IndirectList& list, const graphics::MeshStorage& meshes
+) {
+	return !list.isBuilt || list.meshLayoutVersion != meshes.layoutVersion;
+}
+
+void build(
+	IndirectList& list,
+	std::span<const graphics::RenderObject> objects,
+	const graphics::MeshStorage& meshes
+) {
+	list.objects.clear();
+	list.transforms.clear();
+	list.buckets.clear();
+	list.transparentIndices.clear();
+	list.positions.assign(objects.size(), IndirectList::NOT_INDIRECT);
+	list.sortKeys.clear();
+	list.order.clear();
+	// The whole list is uploaded again, so patches are moot
+	list.isLayoutChanged = true;
+	list.changedPositions.clear();
+	list.changedTransforms.clear();
+	list.isBuilt = true;
+	list.meshLayoutVersion = meshes.layoutVersion;
+
+	// With the index type in place of the mesh and without a depth, the sort
+	// key of an opaque object tells apart exactly what buckets share
+	for (uint32_t i = 0; i < objects.size(); i++) {
+		const graphics::RenderObject& object = objects[i];
+		if (object.variant.queue == graphics::RenderQueue::eTransparent) {
+			list.transparentIndices.push_back(i);
+			continue;
+		}
+		const vk::IndexType indexType =
+			graphics::getRange(meshes, object.mesh).indexType;
+		list.sortKeys.push_back(graphics::getSortKey(
+			object.variant,
+			object.material.index,
+			indexType == vk::IndexType::eUint16 ? 0 : 1,
+			0
+		));
+		list.order.push_back(i);
+	}
+	algo::radixSort(
+		list.sortKeys, list.order, list.sortKeyScratch, list.orderScratch
+	);
+
+	// Commands are laid out one per meshlet, bucket after bucket
+	uint32_t commandCount = 0;
+	for (uint32_t i = 0; i < list.order.size(); i++) {
+		const graphics::RenderObject& object = objects[list.order[i]];
+		const graphics::MeshRange& range =
+			graphics::getRange(meshes, object.mesh);
+		const bool isNewBucket =
+			list.buckets.empty() || list.sortKeys[i] != list.sortKeys[i - 1];
+		if (isNewBucket)
+			list.buckets.push_back({
+				.variant = object.variant,
+				.material = object.material,
+				.indexType = range.indexType,
+				.firstCommand = commandCount,
+				.capacity = 0,
+			});
+		graphics::IndirectBucket& bucket = list.buckets.back();
+		bucket.capacity += range.meshletCount;
+		commandCount += range.meshletCount;
+
+		list.objects.push_back(graphics::IndirectObject::create(
+			meshes,
+			object.mesh,
+			bucket.firstCommand,
+			static_cast<uint32_t>(list.buckets.size() - 1)
+		));
+		list.transforms.push_back({.transform = object.transform});
+		list.positions[list.order[i]] =
+			static_cast<uint32_t>(list.objects.size() - 1);
+	}
+}
+
+void updateTransforms(
+	IndirectList& list,
+	std::span<const graphics::RenderObject> objects,
+	std::span<const uint32_t> changedPositions
+) {
+	if (changedPositions.empty()) return;
+	for (uint32_t position : changedPositions) {
+		const uint32_t indirectPosition = list.positions[position];
+		if (indirectPosition == IndirectList::NOT_INDIRECT) continue;
+		list.transforms[indirectPosition] = {
+			.transform = objects[position].transform
+		};
+		list.changedPositions.push_back(indirectPosition);
+	}
+	std::sort(list.changedPositions.begin(), list.changedPositions.end());
+	list.changedPositions.erase(
+		std::unique(list.changedPositions.begin(), list.changedPositions.end()),
+		list.changedPositions.end()
+	);
+
+	// So the upload copies each run of neighbours at once
+	list.changedTransforms.clear();
+	for (uint32_t position : list.changedPositions) {
+		if (!list.changedTransforms.empty()) {
+			graphics::IndirectRange& range = list.changedTransforms.back();
+			if (range.first + range.count == position) {
+				range.count++;
+				continue;
+			}
+		}
+		list.changedTransforms.push_back({.first = position, .count = 1});
+	}
+}
+
+void clear(IndirectList& list) {
+	if (!list.isBuilt) return;
+	list.objects.clear();
+	list.transforms.clear();
+	list.buckets.clear();
+	list.transparentIndices.clear();
+	list.positions.clear();
+	list.isLayoutChanged = true;
+	list.changedPositions.clear();
+	list.changedTransforms.clear();
+	list.isBuilt = false;
+}
+
+void clearChanges(IndirectList& list) {
+	list.isLayoutChanged = false;
+	list.changedPositions.clear();
+	list.changedTransforms.clear();
+}
+
+}  // namespace scene_graph
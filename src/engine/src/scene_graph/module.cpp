@@ -1,9 +1,14 @@
 #include "scene_graph/module.h"
 
+#include <algorithm>
+#include <numeric>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/string_cast.hpp>
 
+#include "core/algo/radix_sort.h"
 #include "core/logger/assert.h"
+#include "core/jobs/scheduler.h"
+#include "core/math/frustum.h"
 #include "game_specific/cameras/module.h"
 #include "game_specific/cameras/perspective_camera.h"
 
@@ -15,6 +20,11 @@
 namespace scene_graph {
 std::optional<Module> module;
 
+namespace {
+// Objects whose bounds one job brings to world space
+constexpr uint32_t CULLING_BATCH_SIZE = 1024;
+}  // namespace
+
 Module Module::create() {
 	graphics::GPUSceneData sceneData{
 		.view = glm::mat4(1),
@@ -28,9 +38,21 @@ Module Module::create() {
 	return Module{
 		.sceneData = sceneData,
 		.renderSubmission = graphics::RenderSubmission::create(),
-		.renderObjects = {},
+		.drawList = DrawList::create(),
+		.transforms = TransformGraph::create(),
+		.isGPUDriven = false,
+		.indirectList = IndirectList::create(),
+		.cullCandidates = {},
+		.worldBounds = {},
+		.visibleIndices = {},
+		.sortKeys = {},
+		.sortKeyScratch = {},
+		.sortIndexScratch = {},
+		.visibleObjects = {},
+		.batcher = Batcher::create(),
 		.instancedRenderObjects = {},
-		.instancedRenderData = {}
+		.instancedRenderData = {},
+		.instancedRenderPositions = {}
 	};
 }
 
@@ -39,12 +61,39 @@ void Module::destroy() {}
 void Module::addInstancedObjects(
 	std::span<const graphics::InstancedRenderObject> instancedRenderObjects
 ) {
-	this->instancedRenderObjects.insert(
-		this->instancedRenderObjects.end(),
-		instancedRenderObjects.begin(),
-		instancedRenderObjects.end()
-	);
-	instancedRenderData.resize(this->instancedRenderObjects.size());
+	for (const graphics::InstancedRenderObject& object : instancedRenderObjects) {
+		instancedRenderPositions.push_back(this->instancedRenderObjects.size());
+		this->instancedRenderObjects.push_back(object);
+		instancedRenderData.emplace_back();
+	}
+
+	// Instanced objects are few and only added at load, so re-sorting them
+	// here keeps drawFrame free of any sorting
+	std::vector<size_t> order(this->instancedRenderObjects.size());
+	for (size_t i = 0; i < order.size(); i++) order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		const graphics::InstancedRenderObject& r0 =
+			this->instancedRenderObjects[a];
+		const graphics::InstancedRenderObject& r1 =
+			this->instancedRenderObjects[b];
+		if (r0.variant == r1.variant) return r0.material < r1.material;
+		return r0.variant < r1.variant;
+	});
+
+	std::vector<graphics::InstancedRenderObject> sortedObjects;
+	std::vector<std::vector<graphics::InstanceData>> sortedData;
+	std::vector<size_t> newPositions(order.size());
+	sortedObjects.reserve(order.size());
+	sortedData.reserve(order.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		sortedObjects.push_back(this->instancedRenderObjects[order[i]]);
+		sortedData.push_back(std::move(instancedRenderData[order[i]]));
+		newPositions[order[i]] = i;
+	}
+	for (size_t& position : instancedRenderPositions)
+		position = newPositions[position];
+	this->instancedRenderObjects = std::move(sortedObjects);
+	instancedRenderData = std::move(sortedData);
 }
 
 void Module::updateInstance(
@@ -58,25 +107,57 @@ void Module::updateInstance(
 	);
 	for (size_t i = 0; i < indices.size(); i++) {
 		ASSERT(
-			indices[i] < instancedRenderData.size(),
+			indices[i] < instancedRenderPositions.size(),
 			"Index " << i << " is out of the range [0, "
-					 << instancedRenderData.size() << ")"
+					 << instancedRenderPositions.size() << ")"
+		);
+		instancedRenderData[instancedRenderPositions[indices[i]]].assign(
+			data[i].begin(), data[i].end()
 		);
-		std::vector<graphics::InstanceData> copiedData;
-		copiedData.insert(copiedData.end(), data[i].begin(), data[i].end());
-		instancedRenderData[indices[i]] = copiedData;
 	}
 }
 
-void Module::addObjects(std::span<const graphics::RenderObject> renderObjects) {
-	this->renderObjects.insert(
-		this->renderObjects.end(), renderObjects.begin(), renderObjects.end()
-	);
+std::vector<RenderObjectID> Module::addObjects(
+	std::span<const graphics::RenderObject> renderObjects
+) {
+	std::vector<RenderObjectID> ids;
+	ids.reserve(renderObjects.size());
+	for (const graphics::RenderObject& object : renderObjects)
+		ids.push_back(add(drawList, object));
+	return ids;
+}
+
+void Module::removeObjects(std::span<const RenderObjectID> ids) {
+	for (RenderObjectID id : ids) remove(drawList, id);
+}
+
+void Module::updateObjects(
+	std::span<const std::tuple<RenderObjectID, glm::mat4>> updates
+) {
+	for (const auto& [id, transform] : updates)
+		setTransform(drawList, id, transform);
+}
+
+TransformID Module::addTransform(
+	const math::Transform& local, std::optional<TransformID> parent
+) {
+	return addNode(transforms, local, parent);
+}
+
+void Module::removeTransform(TransformID id) { removeNode(transforms, id); }
+
+void Module::setLocalTransform(TransformID id, const math::Transform& local) {
+	setLocal(transforms, id, local);
 }
 
-void Module::updateObjects(std::vector<std::tuple<int, glm::mat4>> updates) {
-	for (const auto& [index, transform] : updates)
-		this->renderObjects[index].transform = transform;
+void Module::setTransformParent(
+	TransformID id, std::optional<TransformID> parent
+) {
+	setParent(transforms, id, parent);
+}
+
+void Module::attachObject(TransformID id, RenderObjectID object) {
+	attachRenderObject(transforms, id, object);
 }
 
 bool Module::drawFrame(graphics::Module& graphics) {
@@ -91,6 +172,7 @@ bool Module::drawFrame(graphics::Module& graphics) {
 		-1.0,
 		1.0
 	);
+	ImGui::Checkbox("GPU Culling", &isGPUDriven);
 	ImGui::End();
 
 	sceneData.view = mainCamera.view;
@@ -100,57 +182,155 @@ bool Module::drawFrame(graphics::Module& graphics) {
 	sceneData.inverseView = glm::inverse(sceneData.view);
 	sceneData.viewProjection = sceneData.projection * sceneData.view;
 
-	for (size_t i = 0; i < renderObjects.size(); i++) {
-	    /* ImGui::Begin(("Render Object " + std::to_string(i)).c_str()); */
-		/* const std::string label = "Object " + std::to_string(i); */
-		/* ImGui::TextColored( */
-			/* ImVec4(1, 0, 0, 1), "Object %ud", static_cast<uint32_t>(i) */
-		/* ); */
-
-		graphics::PipelineSpecializationConstants& variant =
-			renderObjects[i].variant;
-		/* bool hasAlbedo = */
-		/* 	variant.samplerInclusion & graphics::SamplerInclusionBits::eAlbedo; */
-		/* bool hasNormal = */
-		/* 	variant.samplerInclusion & graphics::SamplerInclusionBits::eNormal; */
-		/* bool hasDisplacement = variant.samplerInclusion & */
-		/* 					   graphics::SamplerInclusionBits::eDisplacement; */
-		/* bool hasEmission = variant.samplerInclusion & */
-		/* 				   graphics::SamplerInclusionBits::eEmission; */
-		/* ImGui::Checkbox("Albedo: ", &hasAlbedo); */
-		/* ImGui::Checkbox("Normal: ", &hasNormal); */
-		/* ImGui::Checkbox("Displacement: ", &hasDisplacement); */
-		/* ImGui::Checkbox("Emission: ", &hasEmission); */
-
-		/* variant.samplerInclusion = */
-		/* 	hasAlbedo * graphics::SamplerInclusionBits::eAlbedo + */
-		/* 	hasNormal * graphics::SamplerInclusionBits::eNormal + */
-		/* 	hasDisplacement * graphics::SamplerInclusionBits::eDisplacement + */
-		/* 	hasEmission * graphics::SamplerInclusionBits::eEmission; */
-
-		/* const std::array<const char*, 4> labelParallaxMappingMethods = { */
-		/* 	"Basic", "Steep", "Parallax Occlusion", "Improv" */
-		/* }; */
-		/* int parallaxMappingMode = static_cast<int>(variant.parallaxMappingMode); */
-		/* ImGui::Combo( */
-		/* 	"Parallax mapping method: ", */
-		/* 	&parallaxMappingMode, */
-		/* 	labelParallaxMappingMethods.data(), */
-		/* 	labelParallaxMappingMethods.size() */
-		/* ); */
-		/* variant.parallaxMappingMode = */
-		/* 	static_cast<graphics::ParallaxMappingMode>(parallaxMappingMode); */
-
-		graphics.createPipelineVariant(variant);
-	    /* ImGui::End(); */
+	update(transforms);
+	for (RenderObjectID object : transforms.removedRenderObjects)
+		if (algo::isIndexValid(drawList.ids, object)) remove(drawList, object);
+	for (uint32_t position : transforms.changed) {
+		const std::optional<RenderObjectID> object =
+			transforms.renderObjects[position];
+		if (object && algo::isIndexValid(drawList.ids, *object))
+			setTransform(drawList, *object, transforms.world[position]);
+	}
+
+	// Only objects added or changed since the last frame can need a new
+	// pipeline variant
+	for (const graphics::RenderObject& object : drawList.pendingObjects)
+		graphics.createPipelineVariant(object.variant);
+	const bool isDrawListChanged = flush(drawList);
+
+	// Instanced objects are few and spread out, so they are always drawn.
+	const math::Frustum frustum =
+		math::Frustum::create(sceneData.viewProjection);
+	if (isGPUDriven) {
+		// Most frames only move objects, which are patched in place
+		if (isDrawListChanged || needsBuild(indirectList, graphics.meshes))
+			build(indirectList, drawList.objects, graphics.meshes);
+		else
+			updateTransforms(
+				indirectList, drawList.objects, drawList.changedTransforms
+			);
+		cullCandidates.assign(
+			indirectList.transparentIndices.begin(),
+			indirectList.transparentIndices.end()
+		);
+	} else {
+		clear(indirectList);
+		cullCandidates.resize(drawList.objects.size());
+		std::iota(cullCandidates.begin(), cullCandidates.end(), 0);
+	}
+	drawList.changedTransforms.clear();
+	math::resize(worldBounds, cullCandidates.size());
+	jobs::parallelFor(
+		jobs::scheduler.value(),
+		static_cast<uint32_t>(cullCandidates.size()),
+		CULLING_BATCH_SIZE,
+		[&](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				const graphics::RenderObject& object =
+					drawList.objects[cullCandidates[i]];
+				const math::Sphere& bounds =
+					graphics::getBounds(graphics.meshes, object.mesh).sphere;
+				math::set(
+					worldBounds, i, math::transform(bounds, object.transform)
+				);
+			}
+		}
+	);
+	visibleIndices.clear();
+	math::cull(frustum, worldBounds, visibleIndices);
+
+	// Depth changes with the camera every frame, so visible objects are
+	// re-sorted here rather than kept in order by the draw list
+	sortKeys.clear();
+	for (uint32_t& index : visibleIndices) {
+		const glm::vec3 center(
+			worldBounds.centerX[index],
+			worldBounds.centerY[index],
+			worldBounds.centerZ[index]
+		);
+		index = cullCandidates[index];
+		const float viewDepth = -(sceneData.view * glm::vec4(center, 1.0f)).z;
+		sortKeys.push_back(graphics::getSortKey(
+			drawList.objects[index],
+			graphics::quantizeDepth(
+				viewDepth,
+				mainCamera.getNearPlane(),
+				mainCamera.getFarPlane()
+			)
+		));
 	}
+	algo::radixSort(sortKeys, visibleIndices, sortKeyScratch, sortIndexScratch);
+	visibleObjects.clear();
+	for (uint32_t index : visibleIndices)
+		visibleObjects.push_back(drawList.objects[index]);
+	const size_t opaqueCount = static_cast<size_t>(std::distance(
+		sortKeys.begin(),
+		std::partition_point(
+			sortKeys.begin(),
+			sortKeys.end(),
+			[](graphics::SortKey key) { return !graphics::isTransparent(key); }
+		)
+	));
+	const std::span<const graphics::RenderObject> opaqueObjects =
+		std::span(visibleObjects).first(opaqueCount);
+	const std::span<const graphics::RenderObject> transparentObjects =
+		std::span(visibleObjects).subspan(opaqueCount);
+
+	// Instancing would lose the back to front order, so only opaque objects
+	// are batched
+	build(batcher, opaqueObjects);
 
-	submit(renderSubmission, renderObjects);
-	submit(renderSubmission, instancedRenderObjects, instancedRenderData);
+	// Meshlets and objects are counted apart, as the GPU culls and draws
+	// meshlets of the opaque objects while transparent ones stay whole
+	const uint32_t numOpaqueObjects =
+		static_cast<uint32_t>(opaqueObjects.size());
+	const uint32_t numTransparentObjects =
+		static_cast<uint32_t>(transparentObjects.size());
+	const uint32_t numIndirectDraws =
+		static_cast<uint32_t>(indirectList.buckets.size());
+	ImGui::Begin("Scene");
+	ImGui::Text(
+		"Draw calls: %u, %u before instancing",
+		getDrawCallCount(batcher) + numIndirectDraws + numTransparentObjects,
+		numOpaqueObjects + numIndirectDraws + numTransparentObjects
+	);
+	if (isGPUDriven) {
+		// Read back once its frame is done, so it lags behind by the frames
+		// in flight and the frames queued for the render thread
+		ImGui::Text(
+			"Visible opaque meshlets: %u, culled on the GPU",
+			graphics.stats.indirectVisibleCount
+		);
+	} else {
+		ImGui::Text(
+			"Visible opaque objects: %u, culled on the CPU", numOpaqueObjects
+		);
+	}
+	ImGui::Text(
+		"Visible transparent objects: %u, culled on the CPU",
+		numTransparentObjects
+	);
+	ImGui::End();
 
-	bool isRenderSuccessful = graphics.drawFrame(renderSubmission, sceneData);
-	clear(renderSubmission);
+	renderSubmission = {
+		.renderObjects = batcher.singles,
+		.transparentObjects = transparentObjects,
+		.sceneObjects = drawList.objects,
+		.instances = instancedRenderObjects,
+		.instanceData = instancedRenderData,
+		.batches = batcher.batches,
+		.batchData = getBatchData(batcher),
+		.indirectObjects = indirectList.objects,
+		.indirectTransforms = indirectList.transforms,
+		.indirectBuckets = indirectList.buckets,
+		.isIndirectLayoutChanged = indirectList.isLayoutChanged,
+		.changedIndirectTransforms = indirectList.changedTransforms,
+		.frustum = frustum,
+	};
 
-	return isRenderSuccessful;
+	const bool isDrawn = graphics.drawFrame(renderSubmission, sceneData);
+	// The snapshot now carries the list's changes to the render thread
+	clearChanges(indirectList);
+	return isDrawn;
 }
 }  // namespace scene_graph
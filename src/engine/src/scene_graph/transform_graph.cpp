@@ -0,0 +1,245 @@
+#include "scene_graph/transform_graph.h"
+
+#include <algorithm>
+
+#include "core/logger/assert.h"
+
+namespace scene_graph {
+
+namespace {
+
+constexpr uint32_t UNKNOWN_DEPTH = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t REMOVED_DEPTH = UNKNOWN_DEPTH - 1;
+
+uint32_t getPosition(const TransformGraph& graph, TransformID id) {
+	ASSERT(
+		algo::isIndexValid(graph.ids, id),
+		"Transform " << id.index << " has been removed"
+	);
+	return graph.positions[id.index];
+}
+
+void markDirty(TransformGraph& graph, uint32_t position) {
+	graph.isDirty[position] = 1;
+	graph.firstDirty = std::min(graph.firstDirty, position);
+}
+
+// Fills `graph.depths` for `start` and any unresolved ancestors. Nodes that
+// were removed, or whose ancestor was, get REMOVED_DEPTH.
+void resolveDepth(TransformGraph& graph, uint32_t start) {
+	graph.chain.clear();
+	uint32_t current = start;
+	while (graph.depths[current] == UNKNOWN_DEPTH) {
+		graph.chain.push_back(current);
+		const bool isChainTop =
+			!algo::isIndexValid(graph.ids, graph.owners[current]) ||
+			graph.parent[current] == TransformGraph::NO_PARENT;
+		if (isChainTop) break;
+		current = graph.parent[current];
+	}
+
+	for (auto node = graph.chain.rbegin(); node != graph.chain.rend(); node++) {
+		uint32_t& depth = graph.depths[*node];
+		if (!algo::isIndexValid(graph.ids, graph.owners[*node])) {
+			depth = REMOVED_DEPTH;
+		} else if (graph.parent[*node] == TransformGraph::NO_PARENT) {
+			depth = 0;
+		} else {
+			const uint32_t parentDepth = graph.depths[graph.parent[*node]];
+			depth = parentDepth == REMOVED_DEPTH ? REMOVED_DEPTH
+												 : parentDepth + 1;
+		}
+	}
+}
+
+// Drops removed subtrees and restores breadth-first order with a counting
+// sort on depth, which keeps siblings in their previous relative order.
+void rebuildLayout(TransformGraph& graph) {
+	const uint32_t numNodes = static_cast<uint32_t>(graph.owners.size());
+	graph.depths.assign(numNodes, UNKNOWN_DEPTH);
+	for (uint32_t i = 0; i < numNodes; i++) resolveDepth(graph, i);
+
+	std::vector<uint32_t> depthCounts;
+	for (uint32_t i = 0; i < numNodes; i++) {
+		const uint32_t depth = graph.depths[i];
+		if (depth == REMOVED_DEPTH) {
+			if (graph.renderObjects[i])
+				graph.removedRenderObjects.push_back(*graph.renderObjects[i]);
+			// Descendants of a removed node go with it
+			if (algo::isIndexValid(graph.ids, graph.owners[i]))
+				algo::destroy(graph.ids, {&graph.owners[i], 1});
+			continue;
+		}
+		if (depth >= depthCounts.size()) depthCounts.resize(depth + 1, 0);
+		depthCounts[depth]++;
+	}
+
+	std::vector<uint32_t> depthStarts(depthCounts.size(), 0);
+	for (size_t depth = 1; depth < depthCounts.size(); depth++)
+		depthStarts[depth] = depthStarts[depth - 1] + depthCounts[depth - 1];
+	const uint32_t numAlive =
+		depthCounts.empty() ? 0 : depthStarts.back() + depthCounts.back();
+
+	std::vector<uint32_t> newPositions(numNodes, TransformGraph::NO_PARENT);
+	for (uint32_t i = 0; i < numNodes; i++)
+		if (graph.depths[i] != REMOVED_DEPTH)
+			newPositions[i] = depthStarts[graph.depths[i]]++;
+
+	std::vector<math::Transform> local(numAlive);
+	std::vector<glm::mat4> world(numAlive);
+	std::vector<uint32_t> parent(numAlive);
+	std::vector<uint8_t> isDirty(numAlive);
+	std::vector<TransformID> owners(numAlive);
+	std::vector<std::optional<RenderObjectID>> renderObjects(numAlive);
+	graph.firstDirty = TransformGraph::NONE_DIRTY;
+	for (uint32_t i = 0; i < numNodes; i++) {
+		const uint32_t position = newPositions[i];
+		if (position == TransformGraph::NO_PARENT) continue;
+
+		local[position] = graph.local[i];
+		world[position] = graph.world[i];
+		parent[position] = graph.parent[i] == TransformGraph::NO_PARENT
+							   ? TransformGraph::NO_PARENT
+							   : newPositions[graph.parent[i]];
+		isDirty[position] = graph.isDirty[i];
+		owners[position] = graph.owners[i];
+		renderObjects[position] = graph.renderObjects[i];
+		graph.positions[graph.owners[i].index] = position;
+		if (isDirty[position])
+			graph.firstDirty = std::min(graph.firstDirty, position);
+	}
+
+	graph.local = std::move(local);
+	graph.world = std::move(world);
+	graph.parent = std::move(parent);
+	graph.isDirty = std::move(isDirty);
+	graph.owners = std::move(owners);
+	graph.renderObjects = std::move(renderObjects);
+	graph.isLayoutDirty = false;
+}
+
+}  // namespace
+
+TransformGraph TransformGraph::create() {
+	return TransformGraph{
+		.local = {},
+		.world = {},
+		.parent = {},
+		.isDirty = {},
+		.owners = {},
+		.renderObjects = {},
+		.ids = algo::GenerationIndexArray::create(),
+		.positions = {},
+		.firstDirty = NONE_DIRTY,
+		.isLayoutDirty = false,
+		.changed = {},
+		.removedRenderObjects = {},
+		.depths = {},
+		.chain = {},
+	};
+}
+
+TransformID addNode(
+	TransformGraph& graph,
+	const math::Transform& local,
+	std::optional<TransformID> parent
+) {
+	const uint32_t parentPosition = parent.has_value()
+										? getPosition(graph, parent.value())
+										: TransformGraph::NO_PARENT;
+
+	const TransformID id = algo::reserveIndex(graph.ids);
+	graph.positions.ensureCapacity(algo::getCapacity(graph.ids));
+	const uint32_t position = static_cast<uint32_t>(graph.owners.size());
+	graph.positions[id.index] = position;
+
+	graph.local.push_back(local);
+	graph.world.push_back(glm::mat4(1));
+	graph.parent.push_back(parentPosition);
+	graph.isDirty.push_back(0);
+	graph.owners.push_back(id);
+	graph.renderObjects.push_back(std::nullopt);
+	markDirty(graph, position);
+	// Appending keeps parents ahead of children but not breadth-first order
+	graph.isLayoutDirty = true;
+	return id;
+}
+
+void removeNode(TransformGraph& graph, TransformID id) {
+	getPosition(graph, id);
+	algo::destroy(graph.ids, {&id, 1});
+	graph.isLayoutDirty = true;
+}
+
+void setParent(
+	TransformGraph& graph, TransformID id, std::optional<TransformID> parent
+) {
+	const uint32_t position = getPosition(graph, id);
+	const uint32_t parentPosition = parent.has_value()
+										? getPosition(graph, parent.value())
+										: TransformGraph::NO_PARENT;
+	for (uint32_t ancestor = parentPosition;
+		 ancestor != TransformGraph::NO_PARENT;
+		 ancestor = graph.parent[ancestor])
+		ASSERT(
+			ancestor != position,
+			"Parenting transform " << id.index
+								   << " to its own descendant makes a cycle"
+		);
+
+	graph.parent[position] = parentPosition;
+	markDirty(graph, position);
+	graph.isLayoutDirty = true;
+}
+
+void setLocal(
+	TransformGraph& graph, TransformID id, const math::Transform& local
+) {
+	const uint32_t position = getPosition(graph, id);
+	graph.local[position] = local;
+	markDirty(graph, position);
+}
+
+const math::Transform& getLocal(const TransformGraph& graph, TransformID id) {
+	return graph.local[getPosition(graph, id)];
+}
+
+const glm::mat4& getWorld(const TransformGraph& graph, TransformID id) {
+	return graph.world[getPosition(graph, id)];
+}
+
+void attachRenderObject(
+	TransformGraph& graph, TransformID id, RenderObjectID renderObject
+) {
+	const uint32_t position = getPosition(graph, id);
+	graph.renderObjects[position] = renderObject;
+	markDirty(graph, position);
+}
+
+void update(TransformGraph& graph) {
+	graph.changed.clear();
+	graph.removedRenderObjects.clear();
+	if (graph.isLayoutDirty) rebuildLayout(graph);
+	if (graph.firstDirty == TransformGraph::NONE_DIRTY) return;
+
+	const uint32_t numNodes = static_cast<uint32_t>(graph.owners.size());
+	for (uint32_t position = graph.firstDirty; position < numNodes;
+		 position++) {
+		const uint32_t parent = graph.parent[position];
+		const bool isParentDirty =
+			parent != TransformGraph::NO_PARENT && graph.isDirty[parent];
+		if (!graph.isDirty[position] && !isParentDirty) continue;
+
+		graph.isDirty[position] = 1;
+		const glm::mat4 local = math::toMat4(graph.local[position]);
+		graph.world[position] = parent == TransformGraph::NO_PARENT
+									? local
+									: graph.world[parent] * local;
+		graph.changed.push_back(position);
+	}
+
+	for (uint32_t position : graph.changed) graph.isDirty[position] = 0;
+	graph.firstDirty = TransformGraph::NONE_DIRTY;
+}
+
+}  // namespace scene_graph
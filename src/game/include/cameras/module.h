@@ -1,12 +1,17 @@
 #pragma once
 
 #include <optional>
+#include <vector>
+
 #include "cameras/debug_camera_controller.h"
+#include "input_management.h"
 
 namespace game_cameras {
 
 struct Module {
 	DebugCameraController debugCameraController;
+	std::vector<input::RangedSubscription> rangedSubscriptions;
+	std::vector<input::ToggledSubscription> toggledSubscriptions;
 
    public:
     static Module create();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <unordered_map>
 
 #include "SDL3/SDL_events.h"
 #include "core/algo/event_system.h"
@@ -8,11 +9,13 @@
 namespace input {
 enum class Instant {
     Escape,
+    Count,
 };
 enum class Toggled {
 	Jump,
 	Crouch,
     MouseDown,
+    Count,
 };
 enum class Ranged {
 	MouseX,
@@ -20,8 +23,13 @@ enum class Ranged {
 	MovementX,
 	MovementY,
 	Rotate,
+	Count,
 };
 
+using InstantSubscription = EventSystem<Instant>::Subscription;
+using ToggledSubscription = EventSystem<Toggled, bool>::Subscription;
+using RangedSubscription = EventSystem<Ranged, float>::Subscription;
+
 enum class Mode {
     Uninitialized,
     GUI,
@@ -32,9 +40,25 @@ class Manager {
    public:
 	static Manager create();
 	void handleEvent(SDL_Event sdlEvent);
-	void subscribe(Instant input, std::function<void()> listener);
-	void subscribe(Toggled input, std::function<void(bool)> listener);
-	void subscribe(Ranged input, std::function<void(float)> listener);
+	// Dispatches the high frequency inputs gathered by handleEvent since the
+	// last call. Call once per frame after polling events.
+	void flush();
+
+	[[nodiscard]]
+	InstantSubscription subscribe(
+		Instant input, EventSystem<Instant>::EventListener listener
+	);
+	[[nodiscard]]
+	ToggledSubscription subscribe(
+		Toggled input, EventSystem<Toggled, bool>::EventListener listener
+	);
+	[[nodiscard]]
+	RangedSubscription subscribe(
+		Ranged input, EventSystem<Ranged, float>::EventListener listener
+	);
+	void unsubscribe(InstantSubscription subscription);
+	void unsubscribe(ToggledSubscription subscription);
+	void unsubscribe(RangedSubscription subscription);
 
    private:
     void switchMode(Mode newMode);
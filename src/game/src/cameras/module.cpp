@@ -21,18 +21,19 @@ Module Module::create() {
 			 .currentXInput = 0,
 			 .currentYInput = 0,
 			 .upInput = false,
-			 .downInput = false}
+			 .downInput = false},
+		.rangedSubscriptions = {
+			input::manager->subscribe(input::Ranged::MouseX, onMouseDeltaX),
+			input::manager->subscribe(input::Ranged::MouseY, onMouseDeltaY),
+			input::manager->subscribe(input::Ranged::MovementX, onMovementX),
+			input::manager->subscribe(input::Ranged::MovementY, onMovementY),
+		},
+		.toggledSubscriptions = {
+			input::manager->subscribe(input::Toggled::Jump, onJump),
+			input::manager->subscribe(input::Toggled::Crouch, onCrouch),
+		},
 	};
 
-	input::manager->subscribe(input::Ranged::MouseX, onMouseDeltaX);
-	input::manager->subscribe(input::Ranged::MouseY, onMouseDeltaY);
-
-	input::manager->subscribe(input::Ranged::MovementX, onMovementX);
-	input::manager->subscribe(input::Ranged::MovementY, onMovementY);
-
-	input::manager->subscribe(input::Toggled::Jump, onJump);
-	input::manager->subscribe(input::Toggled::Crouch, onCrouch);
-
 	return module;
 }
 void Module::destroy() {
@@ -41,6 +42,13 @@ void Module::destroy() {
 		"cameras module must be unloaded after game_cameras module"
 	);
 	ASSERT(input::manager, "input module must be unloaded after game_cameras");
+
+	for (input::RangedSubscription subscription : rangedSubscriptions)
+		input::manager->unsubscribe(subscription);
+	for (input::ToggledSubscription subscription : toggledSubscriptions)
+		input::manager->unsubscribe(subscription);
+	rangedSubscriptions.clear();
+	toggledSubscriptions.clear();
 }
 
 void Module::update(float deltaTime) {
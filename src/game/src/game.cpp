@@ -10,6 +10,7 @@
 #pragma GCC diagnostic pop
 
 #include "cameras/module.h"
+#include "core/jobs/scheduler.h"
 #include "core/logger/logger.h"
 #include "engine.h"
 #include "game_specific/cameras/module.h"
@@ -34,7 +35,7 @@ void game::run() {
 		serializer.loadWorld("scenes/sponza.json");
 
 	ASSERT(worldLoader.isValid(serializedWorld), "Loaded world is not valid");
-	game_world::World world = {};
+	game_world::World world = game_world::World::create();
 	worldLoader.load(graphics::module.value(), world, serializedWorld);
 
 	game_world::addToSceneGraph(world, scene_graph::module.value());
@@ -74,6 +75,8 @@ void game::run() {
 			graphics::module->handleEvent(sdlEvent);
 			input::manager->handleEvent(sdlEvent);
 		}
+		input::manager->flush();
+		jobs::runMainThreadJobs(jobs::scheduler.value());
 
         if (!isMinimized) {
 		    graphics::module->beginFrame();
@@ -90,8 +93,6 @@ void game::run() {
             game_cameras::module->update(deltaTime);
 
             if (!scene_graph::module->drawFrame(graphics::module.value())) break;
-
-            graphics::module->endFrame();
         }
 
 		lastTime = time;
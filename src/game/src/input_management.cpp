@@ -17,16 +17,40 @@ Manager Manager::create() {
 	return manager;
 }
 
-void Manager::subscribe(Instant input, std::function<void()> listener) {
-	instantInputs.Register(input, listener);
+InstantSubscription Manager::subscribe(
+	Instant input, EventSystem<Instant>::EventListener listener
+) {
+	return instantInputs.Register(input, std::move(listener));
 }
 
-void Manager::subscribe(Toggled input, std::function<void(bool)> listener) {
-	toggledInputs.Register(input, listener);
+ToggledSubscription Manager::subscribe(
+	Toggled input, EventSystem<Toggled, bool>::EventListener listener
+) {
+	return toggledInputs.Register(input, std::move(listener));
 }
 
-void Manager::subscribe(Ranged input, std::function<void(float)> listener) {
-	rangedInputs.Register(input, listener);
+RangedSubscription Manager::subscribe(
+	Ranged input, EventSystem<Ranged, float>::EventListener listener
+) {
+	return rangedInputs.Register(input, std::move(listener));
+}
+
+void Manager::unsubscribe(InstantSubscription subscription) {
+	instantInputs.Remove(subscription);
+}
+
+void Manager::unsubscribe(ToggledSubscription subscription) {
+	toggledInputs.Remove(subscription);
+}
+
+void Manager::unsubscribe(RangedSubscription subscription) {
+	rangedInputs.Remove(subscription);
+}
+
+void Manager::flush() {
+	instantInputs.Flush();
+	toggledInputs.Flush();
+	rangedInputs.Flush();
 }
 
 void Manager::handleEvent(SDL_Event sdlEvent) {
@@ -55,11 +79,13 @@ void Manager::handleEvent(SDL_Event sdlEvent) {
 	switch (sdlEvent.type) {
 		case SDL_EVENT_KEY_DOWN: onKeyDown(sdlEvent.key.scancode); break;
 		case SDL_EVENT_KEY_UP:	 onKeyUp(sdlEvent.key.scancode); break;
+		// Mouse motion can arrive many times per frame, so it is queued and
+		// dispatched in one batch by flush()
 		case SDL_EVENT_MOUSE_MOTION:
 			if (sdlEvent.motion.xrel != 0)
-				rangedInputs.Trigger(Ranged::MouseX, sdlEvent.motion.xrel);
+				rangedInputs.Enqueue(Ranged::MouseX, sdlEvent.motion.xrel);
 			if (sdlEvent.motion.yrel != 0)
-				rangedInputs.Trigger(Ranged::MouseY, sdlEvent.motion.yrel);
+				rangedInputs.Enqueue(Ranged::MouseY, sdlEvent.motion.yrel);
 			break;
 	}
 }
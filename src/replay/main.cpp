@@ -0,0 +1,618 @@
+// Replays a frame capture written from the Graphics window, drawing its
+// frames in order a number of times, and reports CPU and GPU frame times.
+//
+//     replay <capture file> [passes] [--defragment] [--validate-culling]
+//     replay --synthetic <objects> [frames]
+//
+// The first pass only warms up pipelines and caches and is not measured.
+// With --defragment, every mesh is loaded between two scratch copies that
+// are then unloaded, and the geometry is defragmented before drawing, so the
+// frames are drawn from meshes that were moved.
+//
+// With --validate-culling, nothing is timed. Each frame culled on the GPU is
+// drawn until the count of meshlets the GPU found visible is its own, and
+// that count is checked against the same tests run on the CPU. Needs a
+// capture taken with GPU culling on.
+//
+// With --synthetic, no capture is read. A grid of cubes, each drawn on its
+// own, is drawn for a number of frames with the main pass recorded on one
+// thread, then on two, four, eight and so on, and last on every scheduler
+// thread. The main pass recording times are reported as a table with a row
+// per thread count.
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "SDL3/SDL_events.h"
+#include "core/jobs/scheduler.h"
+#include "core/logger/assert.h"
+#include "core/logger/logger.h"
+#include "engine.h"
+#include "low_level_renderer/frame_capture.h"
+#include "low_level_renderer/graphics_module.h"
+#include "low_level_renderer/mesh_optimizer.h"
+
+namespace {
+constexpr uint32_t DEFAULT_PASSES = 10;
+constexpr uint32_t DEFAULT_SYNTHETIC_FRAMES = 100;
+// Objects of the synthetic scene are split evenly among the materials, so
+// recording binds a material now and then, as it would in a real scene
+constexpr uint32_t SYNTHETIC_MATERIAL_COUNT = 16;
+constexpr float SYNTHETIC_SPACING = 2.0f;
+// Draws of a frame before the visible count read back is its own: the count
+// comes back once the frame is done, behind the frames in flight, and the
+// stats come back behind the submission queue
+constexpr uint32_t CULLING_SETTLE_FRAMES =
+	graphics::MAX_SUBMISSION_QUEUE_DEPTH + graphics::MAX_FRAMES_IN_FLIGHT + 1;
+// Rounding apart from the GPU's, relative to the distances compared
+constexpr float CULLING_TOLERANCE = 1e-4f;
+
+using Milliseconds = std::chrono::duration<float, std::milli>;
+
+bool parse(std::string_view argument, uint32_t& value) {
+	const auto [end, error] = std::from_chars(
+		argument.data(), argument.data() + argument.size(), value
+	);
+	return error == std::errc() && end == argument.data() + argument.size();
+}
+
+void printTimes(std::string_view name, std::vector<Milliseconds>& times) {
+	if (times.empty()) return;
+	std::sort(times.begin(), times.end());
+	const Milliseconds total =
+		std::accumulate(times.begin(), times.end(), Milliseconds::zero());
+	std::cout << name << ": min " << times.front().count() << " ms, median "
+			  << times[times.size() / 2].count() << " ms, mean "
+			  << total.count() / static_cast<float>(times.size()) << " ms\n";
+}
+
+// Points the capture's IDs, which are positions in its asset lists, at the
+// assets created from them. The indirect objects' ranges are read again from
+// `storage`, as the meshes were loaded at other places than captured.
+void remap(
+	graphics::RenderSubmissionCopy& submission,
+	std::span<const graphics::MeshID> meshes,
+	std::span<const graphics::MaterialInstanceID> materials,
+	const graphics::MeshStorage& storage
+) {
+	const auto remapObject = [&](auto& object) {
+		object.mesh = meshes[object.mesh.index];
+		object.material = materials[object.material.index];
+	};
+	std::for_each(
+		submission.renderObjects.begin(),
+		submission.renderObjects.end(),
+		remapObject
+	);
+	std::for_each(
+		submission.transparentObjects.begin(),
+		submission.transparentObjects.end(),
+		remapObject
+	);
+	std::for_each(
+		submission.sceneObjects.begin(),
+		submission.sceneObjects.end(),
+		remapObject
+	);
+	std::for_each(
+		submission.instances.begin(), submission.instances.end(), remapObject
+	);
+	std::for_each(
+		submission.batches.begin(), submission.batches.end(), remapObject
+	);
+	for (graphics::IndirectBucket& bucket : submission.indirectBuckets)
+		bucket.material = materials[bucket.material.index];
+	for (graphics::IndirectObject& object : submission.indirectObjects)
+		object = graphics::IndirectObject::create(
+			storage,
+			meshes[object.mesh.index],
+			object.firstCommand,
+			object.bucket
+		);
+}
+
+// Meshlets of the indirect objects that pass the culling shader's tests,
+// with every comparison moved by `slack` times the distances compared. A
+// positive slack keeps what rounding could have let the GPU keep, a negative
+// one drops what it could have let the GPU drop.
+uint32_t countVisibleMeshlets(
+	const graphics::RenderSubmissionCopy& submission,
+	const std::unordered_map<uint32_t, std::vector<graphics::Meshlet>>&
+		meshlets,
+	glm::vec3 cameraPosition,
+	float slack
+) {
+	const auto isInFrustum = [&](glm::vec3 center, float radius) {
+		const float tolerance = slack * (glm::length(center) + radius);
+		return math::intersects(
+			submission.frustum,
+			{.center = center, .radius = radius + tolerance}
+		);
+	};
+
+	uint32_t count = 0;
+	for (size_t i = 0; i < submission.indirectObjects.size(); i++) {
+		const graphics::IndirectObject& object = submission.indirectObjects[i];
+		const glm::mat4& transform = submission.indirectTransforms[i].transform;
+		const glm::vec3 scalesSquared(
+			glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+			glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+			glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))
+		);
+		const float maxScaleSquared = std::max(
+			{scalesSquared.x, scalesSquared.y, scalesSquared.z}
+		);
+		const float minScaleSquared = std::min(
+			{scalesSquared.x, scalesSquared.y, scalesSquared.z}
+		);
+		const float scale = std::sqrt(maxScaleSquared);
+
+		const glm::vec3 center = glm::vec3(
+			transform * glm::vec4(glm::vec3(object.boundingSphere), 1)
+		);
+		if (!isInFrustum(center, object.boundingSphere.w * scale)) continue;
+
+		const bool canConeCull =
+			minScaleSquared >= 0.99f * maxScaleSquared &&
+			glm::determinant(glm::mat3(transform)) > 0;
+		const auto objectMeshlets = meshlets.find(object.mesh.index);
+		ASSERT(
+			objectMeshlets != meshlets.end() &&
+				objectMeshlets->second.size() == object.meshletCount,
+			"Indirect object " << i << " has no meshlets to check against"
+		);
+		for (const graphics::Meshlet& meshlet : objectMeshlets->second) {
+			const glm::vec3 meshletCenter = glm::vec3(
+				transform * glm::vec4(glm::vec3(meshlet.boundingSphere), 1)
+			);
+			const float meshletRadius = meshlet.boundingSphere.w * scale;
+			if (!isInFrustum(meshletCenter, meshletRadius)) continue;
+
+			if (canConeCull && meshlet.cone.w < 1) {
+				const glm::vec3 axis = glm::normalize(
+					glm::mat3(transform) * glm::vec3(meshlet.cone)
+				);
+				const glm::vec3 fromCamera = meshletCenter - cameraPosition;
+				const float distance = glm::length(fromCamera);
+				const float tolerance = slack * (distance + meshletRadius);
+				if (glm::dot(fromCamera, axis) >=
+					meshlet.cone.w * distance + meshletRadius + tolerance)
+					continue;
+			}
+			count++;
+		}
+	}
+	return count;
+}
+
+// Stops once the window is closed or the render thread fails
+bool drawFrame(
+	graphics::Module& graphics,
+	const graphics::RenderSubmission& submission,
+	const graphics::GPUSceneData& sceneData
+) {
+	bool isQuit = false;
+	SDL_Event sdlEvent;
+	while (SDL_PollEvent(&sdlEvent)) {
+		if (sdlEvent.type == SDL_EVENT_QUIT) isQuit = true;
+		graphics.handleEvent(sdlEvent);
+	}
+	jobs::runMainThreadJobs(jobs::scheduler.value());
+
+	graphics.beginFrame();
+	return graphics.drawFrame(submission, sceneData) && !isQuit;
+}
+
+// Checks the GPU's visible meshlet count of each frame culled on the GPU
+// against the CPU's, printing the frames where they disagree by more than
+// rounding accounts for
+int validateCulling(
+	graphics::Module& graphics,
+	std::span<const graphics::CapturedFrame> frames,
+	std::span<const graphics::RenderSubmission> submissions,
+	const std::unordered_map<uint32_t, std::vector<graphics::Meshlet>>&
+		meshlets
+) {
+	uint32_t checkedCount = 0;
+	uint32_t mismatchCount = 0;
+	uint64_t gpuTotal = 0;
+	uint64_t cpuTotal = 0;
+	for (size_t i = 0; i < submissions.size(); i++) {
+		const graphics::CapturedFrame& frame = frames[i];
+		if (frame.submission.indirectObjects.empty()) continue;
+		for (uint32_t draw = 0; draw < CULLING_SETTLE_FRAMES; draw++)
+			if (!drawFrame(graphics, submissions[i], frame.sceneData))
+				return 1;
+
+		const glm::vec3 cameraPosition(frame.sceneData.inverseView[3]);
+		const uint32_t gpuCount = graphics.stats.indirectVisibleCount;
+		const uint32_t cpuCount =
+			countVisibleMeshlets(frame.submission, meshlets, cameraPosition, 0);
+		const uint32_t lowest = countVisibleMeshlets(
+			frame.submission, meshlets, cameraPosition, -CULLING_TOLERANCE
+		);
+		const uint32_t highest = countVisibleMeshlets(
+			frame.submission, meshlets, cameraPosition, CULLING_TOLERANCE
+		);
+		checkedCount++;
+		gpuTotal += gpuCount;
+		cpuTotal += cpuCount;
+		if (gpuCount < lowest || gpuCount > highest) {
+			mismatchCount++;
+			std::cout << "Frame " << i << ": " << gpuCount
+					  << " visible meshlets on the GPU, " << cpuCount
+					  << " on the CPU, " << lowest << " to " << highest
+					  << " within rounding\n";
+		}
+	}
+
+	if (checkedCount == 0) {
+		std::cerr << "No frame of the capture was culled on the GPU"
+				  << std::endl;
+		return 1;
+	}
+	std::cout << "Culling agreed on " << checkedCount - mismatchCount
+			  << " of " << checkedCount << " frames culled on the GPU, with "
+			  << gpuTotal << " visible meshlets on the GPU and " << cpuTotal
+			  << " on the CPU\n";
+	return mismatchCount == 0 ? 0 : 1;
+}
+
+void createVariants(
+	graphics::Module& graphics,
+	const graphics::RenderSubmissionCopy& submission
+) {
+	const auto createVariant = [&](const auto& object) {
+		graphics.createPipelineVariant(object.variant);
+	};
+	std::for_each(
+		submission.renderObjects.begin(),
+		submission.renderObjects.end(),
+		createVariant
+	);
+	std::for_each(
+		submission.transparentObjects.begin(),
+		submission.transparentObjects.end(),
+		createVariant
+	);
+	std::for_each(
+		submission.instances.begin(), submission.instances.end(), createVariant
+	);
+	std::for_each(
+		submission.batches.begin(), submission.batches.end(), createVariant
+	);
+	std::for_each(
+		submission.indirectBuckets.begin(),
+		submission.indirectBuckets.end(),
+		createVariant
+	);
+}
+
+// Flat shaded, with four vertices to a face
+void createCube(
+	std::vector<graphics::Vertex>& vertices,
+	std::vector<graphics::IndexType>& indices
+) {
+	const std::array<glm::vec2, 4> corners = {
+		glm::vec2(-1, -1), glm::vec2(1, -1), glm::vec2(1, 1), glm::vec2(-1, 1)
+	};
+	const std::array<graphics::IndexType, 6> faceIndices = {0, 1, 2, 0, 2, 3};
+	for (int axis = 0; axis < 3; axis++) {
+		for (float sign : {-1.0f, 1.0f}) {
+			glm::vec3 normal(0);
+			normal[axis] = sign;
+			glm::vec3 tangent(0);
+			tangent[(axis + 1) % 3] = 1;
+			const glm::vec3 bitangent = glm::cross(normal, tangent);
+
+			const graphics::IndexType first =
+				static_cast<graphics::IndexType>(vertices.size());
+			for (const glm::vec2 corner : corners)
+				vertices.push_back({
+					.position = 0.5f * (normal + corner.x * tangent +
+										corner.y * bitangent),
+					.normal = normal,
+					.tangent = tangent,
+					.color = glm::vec3(1),
+					.texCoord = 0.5f * (corner + glm::vec2(1)),
+				});
+			for (graphics::IndexType index : faceIndices)
+				indices.push_back(first + index);
+		}
+	}
+}
+
+int runSynthetic(uint32_t objectCount, uint32_t frames) {
+	engine::init();
+	graphics::Module& graphics = graphics::module.value();
+
+	std::vector<graphics::Vertex> vertices;
+	std::vector<graphics::IndexType> indices;
+	createCube(vertices, indices);
+	const graphics::MeshID cube = graphics.loadMesh(vertices, indices);
+
+	graphics::MaterialCreateInfo createInfo = {
+		.albedo = std::nullopt,
+		.normal = std::nullopt,
+		.displacement = std::nullopt,
+		.emission = std::nullopt,
+		.materialProperties = {},
+		.sampler = graphics::SamplerType::eLinear,
+		.queue = graphics::RenderQueue::eOpaque,
+	};
+	// Untextured, so every material shares one variant
+	const graphics::PipelineSpecializationConstants variant =
+		graphics::createSpecializationConstant(createInfo);
+	graphics.createPipelineVariant(variant);
+	std::vector<graphics::MaterialInstanceID> materials;
+	for (uint32_t i = 0; i < SYNTHETIC_MATERIAL_COUNT; i++) {
+		createInfo.materialProperties.diffuse =
+			glm::vec3(i % 2, (i / 2) % 2, (i / 4) % 2) * 0.5f + 0.25f;
+		materials.push_back(graphics.loadMaterial(createInfo));
+	}
+
+	// Laid out in a square, seen whole from above one of its edges
+	const uint32_t columns = static_cast<uint32_t>(
+		std::ceil(std::sqrt(static_cast<float>(objectCount)))
+	);
+	const float extent = static_cast<float>(columns) * SYNTHETIC_SPACING;
+	graphics::GPUSceneData sceneData = {
+		.view = glm::lookAt(
+			glm::vec3(0, extent, extent), glm::vec3(0), glm::vec3(0, 1, 0)
+		),
+		.inverseView = glm::mat4(1),
+		.projection = glm::perspective(
+			glm::radians(60.0f), 16 / 9.0f, 0.1f, 4 * extent
+		),
+		.viewProjection = glm::mat4(1),
+		.ambientColor = glm::vec3(0.2f),
+		.mainLightDirection = glm::normalize(glm::vec3(-1, -2, -1)),
+		.mainLightColor = glm::vec3(1),
+	};
+	// Vulkan's clip space is upside down from OpenGL's
+	sceneData.projection[1][1] *= -1;
+	sceneData.inverseView = glm::inverse(sceneData.view);
+	sceneData.viewProjection = sceneData.projection * sceneData.view;
+
+	// Sorted by material, as the scene graph's draw list would have them
+	std::vector<graphics::RenderObject> objects;
+	objects.reserve(objectCount);
+	const uint32_t objectsPerMaterial =
+		(objectCount + SYNTHETIC_MATERIAL_COUNT - 1) / SYNTHETIC_MATERIAL_COUNT;
+	for (uint32_t i = 0; i < objectCount; i++) {
+		const glm::vec3 cell(
+			static_cast<float>(i % columns), 0, static_cast<float>(i / columns)
+		);
+		const glm::vec3 position =
+			SYNTHETIC_SPACING * cell - glm::vec3(extent / 2, 0, extent / 2);
+		objects.push_back({
+			.variant = variant,
+			.transform = glm::translate(glm::mat4(1), position),
+			.material = materials[i / objectsPerMaterial],
+			.mesh = cube,
+		});
+	}
+	// Drawn on their own, leaving out the scene graph's batching, and not
+	// voxelized into the radiance cascade, which is recorded on one thread
+	graphics::RenderSubmission submission =
+		graphics::RenderSubmission::create();
+	submission.renderObjects = objects;
+	submission.frustum = math::Frustum::create(sceneData.viewProjection);
+
+	const uint32_t threadCount = jobs::getThreadCount(jobs::scheduler.value());
+	std::vector<uint32_t> threadCounts;
+	for (uint32_t threads = 1; threads < threadCount; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(threadCount);
+
+	struct Row {
+		uint32_t threads;
+		uint32_t chunks;
+		std::vector<Milliseconds> recordTimes;
+	};
+	std::vector<Row> rows;
+	bool isStopped = false;
+	for (size_t i = 0; i < threadCounts.size() && !isStopped; i++) {
+		graphics.maxRecordingThreads = threadCounts[i];
+		Row& row = rows.emplace_back(Row{
+			.threads = threadCounts[i],
+			.chunks = 0,
+			.recordTimes = {},
+		});
+		for (uint32_t frame = 0; frame < frames; frame++) {
+			if (!drawFrame(graphics, submission, sceneData)) {
+				isStopped = true;
+				break;
+			}
+			// Stats come back from the render thread up to the queue depth
+			// behind, still recorded on the previous thread count
+			if (frame < graphics::MAX_SUBMISSION_QUEUE_DEPTH) continue;
+			row.recordTimes.push_back(graphics.stats.mainPassRecordTime);
+		}
+		row.chunks = graphics.stats.mainPassRecordChunks;
+		std::sort(row.recordTimes.begin(), row.recordTimes.end());
+	}
+
+	std::cout << "Main pass recording of " << objectCount << " objects, over "
+			  << frames - graphics::MAX_SUBMISSION_QUEUE_DEPTH
+			  << " frames per thread count\n"
+			  << "threads  chunks    min ms  median ms    mean ms  speedup\n"
+			  << std::fixed << std::setprecision(3);
+	const auto getMedian = [](const Row& row) {
+		return row.recordTimes[row.recordTimes.size() / 2];
+	};
+	for (const Row& row : rows) {
+		if (row.recordTimes.empty()) continue;
+		const Milliseconds total = std::accumulate(
+			row.recordTimes.begin(), row.recordTimes.end(), Milliseconds::zero()
+		);
+		// Of the median, against recording on one thread
+		const float speedup = getMedian(rows.front()).count() /
+							  std::max(getMedian(row).count(), 1e-6f);
+		std::cout << std::setw(7) << row.threads << std::setw(8) << row.chunks
+				  << std::setw(10) << row.recordTimes.front().count()
+				  << std::setw(11) << getMedian(row).count() << std::setw(11)
+				  << total.count() / static_cast<float>(row.recordTimes.size())
+				  << std::setw(8) << std::setprecision(2) << speedup << "x\n"
+				  << std::setprecision(3);
+	}
+
+	engine::destroy();
+	return isStopped ? 1 : 0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+	const std::span<char*> arguments(argv, static_cast<size_t>(argc));
+	if (arguments.size() < 2) {
+		std::cerr << "Usage: replay <capture file> [passes] [--defragment] "
+					 "[--validate-culling]\n"
+				  << "       replay --synthetic <objects> [frames]"
+				  << std::endl;
+		return 1;
+	}
+
+	if (std::string_view(arguments[1]) == "--synthetic") {
+		uint32_t objectCount = 0;
+		if (arguments.size() < 3 || !parse(arguments[2], objectCount) ||
+			objectCount == 0) {
+			std::cerr << "Objects must be a number of at least 1" << std::endl;
+			return 1;
+		}
+		uint32_t frames = DEFAULT_SYNTHETIC_FRAMES;
+		const uint32_t minFrames = graphics::MAX_SUBMISSION_QUEUE_DEPTH + 1;
+		if (arguments.size() > 3 &&
+			(!parse(arguments[3], frames) || frames < minFrames)) {
+			std::cerr << "Frames must be a number of at least " << minFrames
+					  << std::endl;
+			return 1;
+		}
+		Logging::initializeLogger();
+		return runSynthetic(objectCount, frames);
+	}
+
+	uint32_t passes = DEFAULT_PASSES;
+	bool shouldDefragment = false;
+	bool shouldValidateCulling = false;
+	for (size_t i = 2; i < arguments.size(); i++) {
+		const std::string_view argument = arguments[i];
+		if (argument == "--defragment") {
+			shouldDefragment = true;
+			continue;
+		}
+		if (argument == "--validate-culling") {
+			shouldValidateCulling = true;
+			continue;
+		}
+		if (!parse(argument, passes) || passes < 2) {
+			std::cerr << "Passes must be a number of at least 2" << std::endl;
+			return 1;
+		}
+	}
+
+	Logging::initializeLogger();
+	std::optional<graphics::FrameCapture> capture =
+		graphics::loadCapture(arguments[1]);
+	if (!capture) return 1;
+
+	engine::init();
+	graphics::Module& graphics = graphics::module.value();
+
+	std::vector<graphics::TextureID> textures;
+	for (const graphics::TextureSource& texture : capture->textures)
+		textures.push_back(
+			graphics.loadTexture(texture.filePath, texture.formatHint)
+		);
+	std::vector<graphics::MaterialInstanceID> materials;
+	for (graphics::MaterialCreateInfo createInfo : capture->materials) {
+		for (std::optional<graphics::TextureID>* texture :
+			 {&createInfo.albedo,
+			  &createInfo.normal,
+			  &createInfo.displacement,
+			  &createInfo.emission})
+			if (*texture) **texture = textures[(*texture)->index];
+		materials.push_back(graphics.loadMaterial(createInfo));
+	}
+	std::vector<graphics::MeshID> meshes;
+	std::vector<graphics::MeshID> scratchMeshes;
+	// Built from the same vertices and indices as the loaded meshes' own, so
+	// they match those the GPU culls
+	std::unordered_map<uint32_t, std::vector<graphics::Meshlet>> meshlets;
+	for (const graphics::CapturedMesh& mesh : capture->meshes) {
+		if (shouldDefragment)
+			scratchMeshes.push_back(
+				graphics.loadMesh(mesh.vertices, mesh.indices)
+			);
+		meshes.push_back(graphics.loadMesh(mesh.vertices, mesh.indices));
+		if (shouldValidateCulling)
+			meshlets[meshes.back().index] =
+				graphics::buildMeshlets(mesh.vertices, mesh.indices);
+		if (shouldDefragment)
+			scratchMeshes.push_back(
+				graphics.loadMesh(mesh.vertices, mesh.indices)
+			);
+	}
+	// Leaves a gap on both sides of every mesh, so that each of them moves
+	for (graphics::MeshID mesh : scratchMeshes) graphics.unloadMesh(mesh);
+	if (shouldDefragment) graphics.defragmentMeshes();
+
+	std::vector<graphics::RenderSubmission> submissions;
+	for (graphics::CapturedFrame& frame : capture->frames) {
+		remap(frame.submission, meshes, materials, graphics.meshes);
+		createVariants(graphics, frame.submission);
+		submissions.push_back(graphics::getSubmission(frame.submission));
+	}
+
+	if (shouldValidateCulling) {
+		const int result =
+			validateCulling(graphics, capture->frames, submissions, meshlets);
+		engine::destroy();
+		return result;
+	}
+
+	// Stats come back from the render thread the queue depth behind, which
+	// only shifts them within the measured passes
+	std::vector<Milliseconds> frameTimes;
+	std::vector<Milliseconds> recordTimes;
+	std::vector<Milliseconds> gpuTimes;
+	bool isStopped = false;
+	for (uint32_t pass = 0; pass < passes && !isStopped; pass++) {
+		for (size_t i = 0; i < submissions.size() && !isStopped; i++) {
+			const std::chrono::steady_clock::time_point frameStart =
+				std::chrono::steady_clock::now();
+			if (!drawFrame(
+					graphics, submissions[i], capture->frames[i].sceneData
+				)) {
+				isStopped = true;
+				break;
+			}
+			if (pass == 0) continue;
+			frameTimes.push_back(std::chrono::steady_clock::now() - frameStart);
+			recordTimes.push_back(graphics.stats.mainPassRecordTime);
+			gpuTimes.push_back(graphics.stats.gpuFrameTime);
+		}
+	}
+
+	std::cout << "Replayed " << submissions.size() << " frames "
+			  << frameTimes.size() / std::max<size_t>(submissions.size(), 1)
+			  << " times after a warmup pass\n";
+	printTimes("Frame", frameTimes);
+	printTimes("Main pass recording", recordTimes);
+	printTimes("GPU", gpuTimes);
+
+	engine::destroy();
+	return isStopped ? 1 : 0;
+}